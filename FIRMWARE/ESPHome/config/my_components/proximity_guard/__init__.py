@@ -0,0 +1,126 @@
+"""Near/far protection state machine driven directly by VL53L3CX frames."""
+
+import esphome.codegen as cg
+import esphome.config_validation as cv
+from esphome import automation
+from esphome.components import binary_sensor
+from esphome.const import (
+    CONF_ID,
+    CONF_TRIGGER_ID,
+)
+
+from ..vl53l3cx import CONF_VL53L3CX_ID, VL53L3CXComponent
+
+CODEOWNERS = ["@mssaleh"]
+DEPENDENCIES = ["vl53l3cx"]
+AUTO_LOAD = ["binary_sensor"]
+
+# Configuration keys
+CONF_CLOSE_THRESHOLD = "close_threshold"
+CONF_FAR_THRESHOLD = "far_threshold"
+CONF_CLOSE_GRACE = "close_grace"
+CONF_FAR_HOLD = "far_hold"
+CONF_ENABLED = "enabled"
+CONF_PROTECTION_ACTIVE = "protection_active"
+CONF_ON_NEAR = "on_near"
+CONF_ON_FAR = "on_far"
+CONF_PREDICTIVE = "predictive"
+CONF_LEAD_TIME = "lead_time"
+CONF_MIN_APPROACH_SPEED = "min_approach_speed"
+CONF_CONFIRM_FRAMES = "confirm_frames"
+
+proximity_guard_ns = cg.esphome_ns.namespace("proximity_guard")
+ProximityGuard = proximity_guard_ns.class_("ProximityGuard", cg.Component)
+NearTrigger = proximity_guard_ns.class_("NearTrigger", automation.Trigger.template())
+FarTrigger = proximity_guard_ns.class_("FarTrigger", automation.Trigger.template())
+
+
+def _validate_thresholds(config):
+    if config[CONF_FAR_THRESHOLD] < config[CONF_CLOSE_THRESHOLD] + 0.1:
+        raise cv.Invalid(
+            f"{CONF_FAR_THRESHOLD} must be at least 0.1m above {CONF_CLOSE_THRESHOLD}"
+        )
+    return config
+
+
+CONFIG_SCHEMA = cv.All(
+    cv.Schema(
+        {
+            cv.GenerateID(): cv.declare_id(ProximityGuard),
+            cv.GenerateID(CONF_VL53L3CX_ID): cv.use_id(VL53L3CXComponent),
+            # Dual thresholds: near below close, far above far, deadband in between
+            cv.Optional(CONF_CLOSE_THRESHOLD, default="0.8m"): cv.All(
+                cv.distance, cv.float_range(min=0.05, max=4.0)
+            ),
+            cv.Optional(CONF_FAR_THRESHOLD, default="1.0m"): cv.All(
+                cv.distance, cv.float_range(min=0.1, max=5.0)
+            ),
+            # Time the zone must hold before the near/far action fires
+            cv.Optional(
+                CONF_CLOSE_GRACE, default="2s"
+            ): cv.positive_time_period_milliseconds,
+            cv.Optional(
+                CONF_FAR_HOLD, default="2s"
+            ): cv.positive_time_period_milliseconds,
+            cv.Optional(CONF_ENABLED, default=True): cv.boolean,
+            # Fire on_near early when an approach, braking included, will pass close_threshold
+            # within lead_time (the IR/TV reaction budget)
+            cv.Optional(CONF_PREDICTIVE): cv.Schema(
+                {
+                    cv.Optional(
+                        CONF_LEAD_TIME, default="400ms"
+                    ): cv.positive_time_period_milliseconds,
+                    # m/s
+                    cv.Optional(CONF_MIN_APPROACH_SPEED, default=0.25): cv.float_range(
+                        min=0.05, max=5.0
+                    ),
+                    cv.Optional(CONF_CONFIRM_FRAMES, default=3): cv.int_range(min=1, max=10),
+                }
+            ),
+            cv.Optional(CONF_PROTECTION_ACTIVE): binary_sensor.binary_sensor_schema(
+                icon="mdi:shield-alert",
+            ),
+            cv.Optional(CONF_ON_NEAR): automation.validate_automation(
+                {cv.GenerateID(CONF_TRIGGER_ID): cv.declare_id(NearTrigger)}
+            ),
+            cv.Optional(CONF_ON_FAR): automation.validate_automation(
+                {cv.GenerateID(CONF_TRIGGER_ID): cv.declare_id(FarTrigger)}
+            ),
+        }
+    ).extend(cv.COMPONENT_SCHEMA),
+    _validate_thresholds,
+)
+
+
+async def to_code(config):
+    """Generate the C++ code for the proximity guard."""
+    var = cg.new_Pvariable(config[CONF_ID])
+    await cg.register_component(var, config)
+
+    hub = await cg.get_variable(config[CONF_VL53L3CX_ID])
+    cg.add(var.set_hub(hub))
+
+    cg.add(var.set_close_threshold(config[CONF_CLOSE_THRESHOLD]))
+    cg.add(var.set_far_threshold(config[CONF_FAR_THRESHOLD]))
+    cg.add(var.set_close_grace_ms(config[CONF_CLOSE_GRACE].total_milliseconds))
+    cg.add(var.set_far_hold_ms(config[CONF_FAR_HOLD].total_milliseconds))
+    cg.add(var.set_enabled(config[CONF_ENABLED]))
+
+    if CONF_PREDICTIVE in config:
+        predictive = config[CONF_PREDICTIVE]
+        cg.add(var.set_predictive(
+            predictive[CONF_LEAD_TIME].total_milliseconds,
+            predictive[CONF_MIN_APPROACH_SPEED],
+            predictive[CONF_CONFIRM_FRAMES],
+        ))
+
+    if CONF_PROTECTION_ACTIVE in config:
+        sens = await binary_sensor.new_binary_sensor(config[CONF_PROTECTION_ACTIVE])
+        cg.add(var.set_active_binary_sensor(sens))
+
+    for conf in config.get(CONF_ON_NEAR, []):
+        trigger = cg.new_Pvariable(conf[CONF_TRIGGER_ID], var)
+        await automation.build_automation(trigger, [], conf)
+    for conf in config.get(CONF_ON_FAR, []):
+        trigger = cg.new_Pvariable(conf[CONF_TRIGGER_ID], var)
+        await automation.build_automation(trigger, [], conf)
@@ -0,0 +1,322 @@
+#include "proximity_guard.h"
+#include "esphome/core/log.h"
+#include "esp_timer.h"
+#include <algorithm>
+
+namespace esphome {
+namespace proximity_guard {
+
+static const char *const TAG = "proximity_guard";
+
+// Minimum deadband kept between the close and far thresholds
+static const int32_t MIN_DEADBAND_MM = 100;
+// Range history restarts after a gap or a jump this large (a different object)
+static const uint64_t HISTORY_GAP_US = 500000;
+static const int32_t HISTORY_JUMP_MM = 400;
+// Samples needed before the approach speed is trusted
+static const uint8_t MIN_HISTORY = 4;
+// How far past the close threshold the projected range must reach for a predicted trigger
+static const int32_t PREDICTION_MARGIN_MM = 75;
+// Slowing below this is the ripple of the range estimate; a walker stopping brakes harder
+static const int32_t MIN_DECELERATION_MMPS2 = 500;
+
+static const char *state_to_string(GuardState state) {
+  switch (state) {
+    case GUARD_STATE_IDLE:
+      return "IDLE";
+    case GUARD_STATE_NEAR_PENDING:
+      return "NEAR_PENDING";
+    case GUARD_STATE_ACTIVE:
+      return "ACTIVE";
+    case GUARD_STATE_FAR_PENDING:
+      return "FAR_PENDING";
+    default:
+      return "UNKNOWN";
+  }
+}
+
+void ProximityGuard::setup() {
+  this->hub_->add_on_frame_callback([this](const vl53l3cx::Frame &frame) { this->on_frame_(frame); });
+  if (this->active_binary_sensor_ != nullptr) {
+    this->active_binary_sensor_->publish_initial_state(false);
+  }
+}
+
+void ProximityGuard::loop() {
+  // Timers also expire between frames, so a stalled sensor cannot hold a decision back
+  if (this->state_ == GUARD_STATE_NEAR_PENDING || this->state_ == GUARD_STATE_FAR_PENDING) {
+    this->evaluate_(esp_timer_get_time());
+  }
+}
+
+void ProximityGuard::dump_config() {
+  ESP_LOGCONFIG(TAG, "Proximity Guard:");
+  ESP_LOGCONFIG(TAG, "  Close Threshold: %d mm", (int) this->close_threshold_mm_);
+  ESP_LOGCONFIG(TAG, "  Far Threshold: %d mm", (int) this->far_threshold_mm_);
+  ESP_LOGCONFIG(TAG, "  Close Grace: %u ms", (uint32_t)(this->close_grace_us_ / 1000));
+  ESP_LOGCONFIG(TAG, "  Far Hold: %u ms", (uint32_t)(this->far_hold_us_ / 1000));
+  ESP_LOGCONFIG(TAG, "  Enabled: %s", YESNO(this->enabled_));
+  if (this->predictive_) {
+    ESP_LOGCONFIG(TAG, "  Predictive: lead %u ms, min approach %d mm/s, %u confirm frames",
+                  this->lead_time_us_ / 1000, (int) this->min_approach_mmps_, this->confirm_frames_);
+  }
+  LOG_BINARY_SENSOR("  ", "Protection Active", this->active_binary_sensor_);
+}
+
+void ProximityGuard::set_close_threshold(float threshold_m) {
+  this->close_threshold_mm_ = (int32_t)(threshold_m * 1000.0f);
+  if (this->far_threshold_mm_ < this->close_threshold_mm_ + MIN_DEADBAND_MM) {
+    this->far_threshold_mm_ = this->close_threshold_mm_ + MIN_DEADBAND_MM;
+    ESP_LOGW(TAG, "Close threshold %d mm leaves no deadband, far threshold raised to %d mm",
+             (int) this->close_threshold_mm_, (int) this->far_threshold_mm_);
+  }
+}
+
+void ProximityGuard::set_far_threshold(float threshold_m) {
+  this->far_threshold_mm_ = (int32_t)(threshold_m * 1000.0f);
+  if (this->far_threshold_mm_ < this->close_threshold_mm_ + MIN_DEADBAND_MM) {
+    this->far_threshold_mm_ = this->close_threshold_mm_ + MIN_DEADBAND_MM;
+    ESP_LOGW(TAG, "Far threshold too close to close threshold, using %d mm", (int) this->far_threshold_mm_);
+  }
+}
+
+void ProximityGuard::set_enabled(bool enabled) {
+  if (enabled == this->enabled_) {
+    return;
+  }
+  this->enabled_ = enabled;
+  // Either way the latch starts over; disabling never fires the far action
+  this->set_state_(GUARD_STATE_IDLE);
+  this->history_count_ = 0;
+  this->predict_votes_ = 0;
+  this->prediction_deadline_us_ = 0;
+  ESP_LOGI(TAG, "Protection %s", enabled ? "enabled" : "disabled");
+}
+
+ProximityGuard::Zone ProximityGuard::classify_() const {
+  if (this->distance_mm_ < 0 || this->distance_mm_ > this->far_threshold_mm_) {
+    return ZONE_FAR;
+  }
+  if (this->distance_mm_ < this->close_threshold_mm_) {
+    return ZONE_NEAR;
+  }
+  return ZONE_DEADBAND;
+}
+
+void ProximityGuard::on_frame_(const vl53l3cx::Frame &frame) {
+  // Nearest target the hub would publish (valid or merged pulse, not background)
+  int32_t nearest_mm = -1;
+  for (uint8_t i = 0; i < frame.num_targets; i++) {
+    const vl53l3cx::FrameTarget &target = frame.targets[i];
+    if (target.is_background || (target.range_status != VL53LX_RANGESTATUS_RANGE_VALID &&
+                                 target.range_status != VL53LX_RANGESTATUS_RANGE_VALID_MERGED_PULSE)) {
+      continue;
+    }
+    if (target.range_mm > 0 && (nearest_mm < 0 || target.range_mm < nearest_mm)) {
+      nearest_mm = target.range_mm;
+    }
+  }
+  this->distance_mm_ = nearest_mm;
+  this->zone_ = this->classify_();
+  if (this->predictive_) {
+    this->push_history_(frame.timestamp_us);
+  }
+
+  if (!this->enabled_) {
+    return;
+  }
+
+  // Zone changes open or cancel the pending transitions; the deadband cancels both
+  switch (this->state_) {
+    case GUARD_STATE_IDLE:
+      if (this->zone_ == ZONE_NEAR) {
+        this->pending_since_us_ = frame.timestamp_us;
+        this->set_state_(GUARD_STATE_NEAR_PENDING);
+      }
+      break;
+    case GUARD_STATE_NEAR_PENDING:
+      if (this->zone_ != ZONE_NEAR) {
+        this->set_state_(GUARD_STATE_IDLE);
+      }
+      break;
+    case GUARD_STATE_ACTIVE:
+      if (this->zone_ == ZONE_FAR) {
+        this->pending_since_us_ = frame.timestamp_us;
+        this->set_state_(GUARD_STATE_FAR_PENDING);
+      }
+      break;
+    case GUARD_STATE_FAR_PENDING:
+      if (this->zone_ != ZONE_FAR) {
+        this->set_state_(GUARD_STATE_ACTIVE);
+      }
+      break;
+  }
+
+  if (this->predictive_) {
+    this->track_prediction_(frame.timestamp_us);
+    if ((this->state_ == GUARD_STATE_IDLE || this->state_ == GUARD_STATE_NEAR_PENDING) &&
+        this->check_prediction_(frame.timestamp_us)) {
+      return;
+    }
+  }
+
+  this->evaluate_(esp_timer_get_time());
+}
+
+void ProximityGuard::push_history_(uint64_t timestamp_us) {
+  if (this->distance_mm_ < 0) {
+    this->history_count_ = 0;
+    return;
+  }
+  if (this->history_count_ > 0) {
+    const Sample &last = this->history_[(this->history_head_ + HISTORY_SIZE - 1) % HISTORY_SIZE];
+    const int32_t jump_mm = this->distance_mm_ - last.range_mm;
+    if (timestamp_us - last.timestamp_us > HISTORY_GAP_US || jump_mm > HISTORY_JUMP_MM ||
+        jump_mm < -HISTORY_JUMP_MM) {
+      this->history_count_ = 0;
+    }
+  }
+  this->history_[this->history_head_] = Sample{timestamp_us, this->distance_mm_};
+  this->history_head_ = (this->history_head_ + 1) % HISTORY_SIZE;
+  if (this->history_count_ < HISTORY_SIZE) {
+    this->history_count_++;
+  }
+}
+
+int32_t ProximityGuard::approach_speed_mmps_() const {
+  if (this->history_count_ < MIN_HISTORY) {
+    return 0;
+  }
+  return this->slope_mmps_(0, this->history_count_);
+}
+
+int32_t ProximityGuard::slope_mmps_(uint8_t skip, uint8_t n) const {
+  // Least-squares slope over n samples from the skip-th oldest, integer-only: t in ms from the first
+  const uint8_t first = (this->history_head_ + HISTORY_SIZE - this->history_count_ + skip) % HISTORY_SIZE;
+  const uint64_t t0_us = this->history_[first].timestamp_us;
+  int64_t sum_t = 0, sum_r = 0, sum_tt = 0, sum_tr = 0;
+  for (uint8_t k = 0; k < n; k++) {
+    const Sample &sample = this->history_[(first + k) % HISTORY_SIZE];
+    const int64_t t = (int64_t)((sample.timestamp_us - t0_us) / 1000);
+    sum_t += t;
+    sum_r += sample.range_mm;
+    sum_tt += t * t;
+    sum_tr += t * sample.range_mm;
+  }
+  const int64_t den = n * sum_tt - sum_t * sum_t;
+  if (den <= 0) {
+    return 0;
+  }
+  // mm/ms -> mm/s; negated so that closing in is positive
+  return (int32_t)(-(n * sum_tr - sum_t * sum_r) * 1000 / den);
+}
+
+int32_t ProximityGuard::deceleration_mmps2_() const {
+  // The newer half of the history closing in slower than the older half; 0 while speeding up.
+  // Each half needs three samples for a slope.
+  const uint8_t half = this->history_count_ / 2;
+  if (half < 3) {
+    return 0;
+  }
+  const uint8_t first = (this->history_head_ + HISTORY_SIZE - this->history_count_) % HISTORY_SIZE;
+  const uint8_t skip = this->history_count_ - half;
+  const uint64_t older_us = this->history_[first].timestamp_us;
+  const uint64_t newer_us = this->history_[(first + skip) % HISTORY_SIZE].timestamp_us;
+  const int32_t slowing_mmps = this->slope_mmps_(0, half) - this->slope_mmps_(skip, half);
+  if (slowing_mmps <= 0 || newer_us <= older_us) {
+    return 0;
+  }
+  const int32_t decel_mmps2 = (int32_t)((int64_t) slowing_mmps * 1000000 / (int64_t)(newer_us - older_us));
+  return decel_mmps2 < MIN_DECELERATION_MMPS2 ? 0 : decel_mmps2;
+}
+
+bool ProximityGuard::check_prediction_(uint64_t timestamp_us) {
+  const int32_t speed_mmps = this->approach_speed_mmps_();
+  if (this->distance_mm_ < 0 || speed_mmps < this->min_approach_mmps_) {
+    this->predict_votes_ = 0;
+    return false;
+  }
+
+  // Range at the end of the lead time, or where the target stops if it brakes before then.
+  // An approach must reach past the close threshold by a margin; one that stops short does not.
+  const int32_t decel_mmps2 = this->deceleration_mmps2_();
+  int64_t horizon_us = this->lead_time_us_;
+  if (decel_mmps2 > 0) {
+    horizon_us = std::min<int64_t>(horizon_us, (int64_t) speed_mmps * 1000000 / decel_mmps2);
+  }
+  const int32_t projected_mm =
+      this->distance_mm_ - (int32_t)((int64_t) speed_mmps * horizon_us / 1000000) +
+      (int32_t)((int64_t) decel_mmps2 * (horizon_us / 1000) * (horizon_us / 1000) / 2000000);
+  if (projected_mm > this->close_threshold_mm_ - PREDICTION_MARGIN_MM) {
+    this->predict_votes_ = 0;
+    return false;
+  }
+  if (++this->predict_votes_ < this->confirm_frames_) {
+    return false;
+  }
+
+  this->predict_votes_ = 0;
+  this->predicted_triggers_++;
+  this->prediction_deadline_us_ = timestamp_us + this->lead_time_us_ + this->close_grace_us_;
+  this->last_decision_latency_us_ = 0;
+  this->set_state_(GUARD_STATE_ACTIVE);
+  ESP_LOGI(TAG, "Near (predicted): target at %d mm approaching at %d mm/s, slowing by %d mm/s², projected to %d mm",
+           (int) this->distance_mm_, (int) speed_mmps, (int) decel_mmps2, (int) projected_mm);
+  this->near_callback_.call();
+  return true;
+}
+
+void ProximityGuard::track_prediction_(uint64_t timestamp_us) {
+  // A predicted trigger counts as false if the near zone is not reached in time
+  if (this->prediction_deadline_us_ == 0) {
+    return;
+  }
+  if (this->zone_ == ZONE_NEAR) {
+    this->prediction_deadline_us_ = 0;
+  } else if (timestamp_us > this->prediction_deadline_us_) {
+    this->prediction_deadline_us_ = 0;
+    this->false_predictions_++;
+    ESP_LOGW(TAG, "Predicted approach did not reach the close threshold (%u of %u predictions false)",
+             this->false_predictions_, this->predicted_triggers_);
+  }
+}
+
+void ProximityGuard::evaluate_(uint64_t now_us) {
+  if (!this->enabled_) {
+    return;
+  }
+
+  if (this->state_ == GUARD_STATE_NEAR_PENDING) {
+    const uint64_t deadline_us = this->pending_since_us_ + this->close_grace_us_;
+    if (now_us >= deadline_us) {
+      this->last_decision_latency_us_ = (uint32_t)(now_us - deadline_us);
+      this->set_state_(GUARD_STATE_ACTIVE);
+      ESP_LOGI(TAG, "Near: target at %d mm (decision latency %u µs)", (int) this->distance_mm_,
+               this->last_decision_latency_us_);
+      this->near_callback_.call();
+    }
+  } else if (this->state_ == GUARD_STATE_FAR_PENDING) {
+    const uint64_t deadline_us = this->pending_since_us_ + this->far_hold_us_;
+    if (now_us >= deadline_us) {
+      this->last_decision_latency_us_ = (uint32_t)(now_us - deadline_us);
+      this->set_state_(GUARD_STATE_IDLE);
+      ESP_LOGI(TAG, "Far: zone clear (decision latency %u µs)", this->last_decision_latency_us_);
+      this->far_callback_.call();
+    }
+  }
+}
+
+void ProximityGuard::set_state_(GuardState state) {
+  if (state == this->state_) {
+    return;
+  }
+  const bool was_active = this->is_active();
+  ESP_LOGD(TAG, "State %s -> %s", state_to_string(this->state_), state_to_string(state));
+  this->state_ = state;
+  if (this->active_binary_sensor_ != nullptr && this->is_active() != was_active) {
+    this->active_binary_sensor_->publish_state(this->is_active());
+  }
+}
+
+}  // namespace proximity_guard
+}  // namespace esphome
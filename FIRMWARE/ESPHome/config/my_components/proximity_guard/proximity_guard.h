@@ -0,0 +1,141 @@
+#pragma once
+
+#include "esphome/core/component.h"
+#include "esphome/core/automation.h"
+#include "esphome/core/helpers.h"
+#include "esphome/components/binary_sensor/binary_sensor.h"
+#include "../vl53l3cx/vl53l3cx.h"
+#include <array>
+
+namespace esphome {
+namespace proximity_guard {
+
+enum GuardState : uint8_t {
+  GUARD_STATE_IDLE = 0,          // Inactive, nothing pending
+  GUARD_STATE_NEAR_PENDING = 1,  // Inactive, near zone held for less than the grace time
+  GUARD_STATE_ACTIVE = 2,        // Protection latched
+  GUARD_STATE_FAR_PENDING = 3,   // Active, far zone held for less than the hold time
+};
+
+// Near/far decision logic of the VisionGuard, evaluated on every frame of a
+// VL53L3CX hub. Dual thresholds give a deadband, the grace and hold timers
+// debounce both transitions, and the active state latches so the near and far
+// actions fire exactly once per episode.
+class ProximityGuard : public Component {
+ public:
+  void setup() override;
+  void loop() override;
+  void dump_config() override;
+  // After the hub, whose frames drive the state machine
+  float get_setup_priority() const override { return setup_priority::PROCESSOR; }
+
+  // Configuration setters (also used at runtime from number/switch entities)
+  void set_hub(vl53l3cx::VL53L3CXComponent *hub) { this->hub_ = hub; }
+  void set_close_threshold(float threshold_m);
+  void set_far_threshold(float threshold_m);
+  void set_close_grace_ms(uint32_t grace_ms) { this->close_grace_us_ = (uint64_t) grace_ms * 1000; }
+  void set_far_hold_ms(uint32_t hold_ms) { this->far_hold_us_ = (uint64_t) hold_ms * 1000; }
+  void set_enabled(bool enabled);
+  // Predictive mode: fire the near action early once an approach, braking
+  // included, would pass the close threshold within lead_time (the IR/TV
+  // reaction budget)
+  void set_predictive(uint32_t lead_time_ms, float min_approach_speed_mps, uint8_t confirm_frames) {
+    this->predictive_ = true;
+    this->lead_time_us_ = lead_time_ms * 1000;
+    this->min_approach_mmps_ = (int32_t)(min_approach_speed_mps * 1000.0f);
+    this->confirm_frames_ = confirm_frames;
+  }
+  void set_active_binary_sensor(binary_sensor::BinarySensor *sensor) { this->active_binary_sensor_ = sensor; }
+
+  // Runtime state
+  bool is_enabled() const { return this->enabled_; }
+  bool is_active() const {
+    return this->state_ == GUARD_STATE_ACTIVE || this->state_ == GUARD_STATE_FAR_PENDING;
+  }
+  GuardState get_state() const { return this->state_; }
+  // Nearest accepted target of the latest frame, NaN if none
+  float get_distance() const { return this->distance_mm_ < 0 ? NAN : this->distance_mm_ / 1000.0f; }
+  // How late the last transition fired after its grace/hold time ran out
+  uint32_t get_last_decision_latency_us() const { return this->last_decision_latency_us_; }
+  // Approach speed estimated from the range history (mm/s, positive = approaching)
+  int32_t get_approach_speed_mmps() const { return this->approach_speed_mmps_(); }
+  // Predicted near triggers, and those not followed by the near zone in time
+  uint32_t get_predicted_triggers() const { return this->predicted_triggers_; }
+  uint32_t get_false_predictions() const { return this->false_predictions_; }
+
+  void add_on_near_callback(std::function<void()> &&callback) { this->near_callback_.add(std::move(callback)); }
+  void add_on_far_callback(std::function<void()> &&callback) { this->far_callback_.add(std::move(callback)); }
+
+ protected:
+  enum Zone : uint8_t { ZONE_NEAR, ZONE_DEADBAND, ZONE_FAR };
+
+  // Range history of the nearest target, one entry per frame
+  static const uint8_t HISTORY_SIZE = 8;
+  struct Sample {
+    uint64_t timestamp_us;
+    int32_t range_mm;
+  };
+
+  void on_frame_(const vl53l3cx::Frame &frame);
+  Zone classify_() const;
+  void evaluate_(uint64_t now_us);
+  void set_state_(GuardState state);
+  void push_history_(uint64_t timestamp_us);
+  int32_t approach_speed_mmps_() const;
+  // Approach speed over n history samples, skipping the oldest `skip`
+  int32_t slope_mmps_(uint8_t skip, uint8_t n) const;
+  // How fast the approach slows down (mm/s², 0 if it does not)
+  int32_t deceleration_mmps2_() const;
+  bool check_prediction_(uint64_t timestamp_us);
+  void track_prediction_(uint64_t timestamp_us);
+
+  vl53l3cx::VL53L3CXComponent *hub_{nullptr};
+
+  // Configuration parameters
+  int32_t close_threshold_mm_{800};
+  int32_t far_threshold_mm_{1000};
+  uint64_t close_grace_us_{2000000};
+  uint64_t far_hold_us_{2000000};
+  bool enabled_{true};
+  bool predictive_{false};
+  uint32_t lead_time_us_{400000};
+  int32_t min_approach_mmps_{250};
+  uint8_t confirm_frames_{3};
+
+  // State machine
+  GuardState state_{GUARD_STATE_IDLE};
+  Zone zone_{ZONE_FAR};
+  int32_t distance_mm_{-1};  // Nearest accepted target, -1 if none
+  uint64_t pending_since_us_{0};  // Data-ready time of the frame that opened the pending zone
+  uint32_t last_decision_latency_us_{0};
+
+  // Predictive mode
+  std::array<Sample, HISTORY_SIZE> history_{};
+  uint8_t history_head_{0};
+  uint8_t history_count_{0};
+  uint8_t predict_votes_{0};  // Consecutive frames predicting a crossing within the lead time
+  uint64_t prediction_deadline_us_{0};  // Non-zero while a predicted trigger awaits the near zone
+  uint32_t predicted_triggers_{0};
+  uint32_t false_predictions_{0};
+
+  binary_sensor::BinarySensor *active_binary_sensor_{nullptr};
+  CallbackManager<void()> near_callback_;
+  CallbackManager<void()> far_callback_;
+};
+
+class NearTrigger : public Trigger<> {
+ public:
+  explicit NearTrigger(ProximityGuard *parent) {
+    parent->add_on_near_callback([this]() { this->trigger(); });
+  }
+};
+
+class FarTrigger : public Trigger<> {
+ public:
+  explicit FarTrigger(ProximityGuard *parent) {
+    parent->add_on_far_callback([this]() { this->trigger(); });
+  }
+};
+
+}  // namespace proximity_guard
+}  // namespace esphome
@@ -2,13 +2,24 @@
 
 import esphome.codegen as cg
 import esphome.config_validation as cv
-from esphome.components import i2c
+from esphome.components import binary_sensor, i2c, sensor, text_sensor
 from esphome import pins
-from esphome.const import CONF_ID, CONF_UPDATE_INTERVAL
+import esphome.final_validate as fv
+from esphome.const import (
+    CONF_ADDRESS,
+    CONF_ID,
+    CONF_UPDATE_INTERVAL,
+    STATE_CLASS_MEASUREMENT,
+    STATE_CLASS_TOTAL_INCREASING,
+    ENTITY_CATEGORY_DIAGNOSTIC,
+    DEVICE_CLASS_PROBLEM,
+    UNIT_PERCENT,
+)
 from esphome.core import TimePeriod
 
 CODEOWNERS = ["@mssaleh"]
 DEPENDENCIES = ["i2c"]
+AUTO_LOAD = ["sensor", "binary_sensor", "text_sensor"]
 MULTI_CONF = True
 
 # Component is built for ESP32 with ESP-IDF only
@@ -34,6 +45,50 @@ CONF_ROI_TOP_LEFT_X = "top_left_x"
 CONF_ROI_TOP_LEFT_Y = "top_left_y"
 CONF_ROI_BOTTOM_RIGHT_X = "bottom_right_x"
 CONF_ROI_BOTTOM_RIGHT_Y = "bottom_right_y"
+CONF_ADAPTIVE_TIMING = "adaptive_timing"
+CONF_MIN_TIMING_BUDGET = "min_timing_budget"
+CONF_MAX_TIMING_BUDGET = "max_timing_budget"
+CONF_TARGET_SIGMA = "target_sigma"
+CONF_HOLD_FRAMES = "hold_frames"
+CONF_METRICS = "metrics"
+CONF_FRAME_RATE = "frame_rate"
+CONF_FRAMES = "frames"
+CONF_PUBLISHES = "publishes"
+CONF_MISSED_MEASUREMENTS = "missed_measurements"
+CONF_CONSECUTIVE_ERRORS = "consecutive_errors"
+CONF_TOTAL_MEASUREMENTS = "total_measurements"
+CONF_VALID_MEASUREMENTS = "valid_measurements"
+CONF_I2C_BYTES = "i2c_bytes"
+CONF_I2C_READ_TIME = "i2c_read_time"
+CONF_PROCESSING_TIME = "processing_time"
+CONF_PUBLISH_LATENCY = "publish_latency"
+CONF_PERFORMANCE_DEGRADED = "performance_degraded"
+CONF_HEALTH = "health"
+CONF_RECOVERIES = "recoveries"
+CONF_TIME_TO_RECOVER = "time_to_recover"
+CONF_RECOVERY = "recovery"
+CONF_LOW_POWER = "low_power"
+CONF_WAKE_DISTANCE = "wake_distance"
+CONF_IDLE_AFTER = "idle_after"
+CONF_IDLE_PERIOD = "idle_period"
+CONF_IDLE_TIMING_BUDGET = "idle_timing_budget"
+CONF_I2C_THROUGHPUT = "i2c_throughput"
+CONF_WAKE_LATENCY = "wake_latency"
+CONF_DMAX_CACHE_HIT_RATE = "dmax_cache_hit_rate"
+CONF_INITIAL_BACKOFF = "initial_backoff"
+CONF_MAX_BACKOFF = "max_backoff"
+CONF_LOG_SUMMARY_INTERVAL = "log_summary_interval"
+CONF_FRAME_DEBUG = "frame_debug"
+CONF_HISTOGRAM_PIPELINE = "histogram_pipeline"
+CONF_PEAK_ESTIMATOR = "peak_estimator"
+CONF_HISTOGRAM_CAPTURE = "histogram_capture"
+CONF_HISTOGRAM_ACCUMULATION = "histogram_accumulation"
+CONF_NEAR_DISTANCE = "near_distance"
+CONF_TRACKING = "tracking"
+CONF_GATE = "gate"
+CONF_TIMEOUT = "timeout"
+CONF_BACKGROUND = "background"
+CONF_LEARN_DURATION = "learn_duration"
 
 # Distance modes
 DISTANCE_MODES = {"SHORT": 1, "MEDIUM": 2, "LONG": 3}
@@ -52,6 +107,16 @@ TARGET_ORDER_MODES = {
     "SIGNAL_STRENGTH": 2,  # Strongest signal first
 }
 
+# Sub-bin peak estimators (VL53LX_HIST_PEAK_ESTIMATOR__*)
+PEAK_ESTIMATORS = {
+    "FILTER": 0,  # ST's interpolation (default)
+    "GAUSSIAN": 1,  # Gaussian fit for narrow pulses
+}
+
+# The merge sums at most VL53LX_BIN_REC_SIZE histograms: the driver keeps
+# no more, and a larger tp_hist_merge_max_size writes past multi_bins_rec
+HIST_MERGE_MAX_FRAMES = 6
+
 # Namespace and class declarations
 vl53l3cx_ns = cg.esphome_ns.namespace("vl53l3cx")
 VL53L3CXComponent = vl53l3cx_ns.class_(
@@ -101,19 +166,74 @@ def _validate_roi(cfg):
             raise cv.Invalid("ROI top_left_y must be <= bottom_right_y")
     return cfg
 
+
+def _validate_adaptive_timing(cfg):
+    if CONF_ADAPTIVE_TIMING in cfg:
+        adaptive = cfg[CONF_ADAPTIVE_TIMING]
+        if adaptive[CONF_MIN_TIMING_BUDGET] > adaptive[CONF_MAX_TIMING_BUDGET]:
+            raise cv.Invalid("adaptive_timing min_timing_budget must be <= max_timing_budget")
+    return cfg
+
+
+def _validate_histogram_accumulation(cfg):
+    if CONF_HISTOGRAM_ACCUMULATION in cfg:
+        # It is the histogram merge, sized by frames; a changing budget would restart the sum
+        if cfg.get(CONF_HIST_MERGE) is False:
+            raise cv.Invalid(f"{CONF_HISTOGRAM_ACCUMULATION} needs {CONF_HIST_MERGE}")
+        for key in (CONF_HIST_MERGE_MAX_SIZE, CONF_ADAPTIVE_TIMING):
+            if key in cfg:
+                raise cv.Invalid(f"{key} cannot be combined with {CONF_HISTOGRAM_ACCUMULATION}")
+    return cfg
+
+
+TIMING_BUDGET_RANGE = cv.All(
+    cv.positive_time_period_microseconds,
+    cv.Range(
+        min=TimePeriod(microseconds=20000),
+        max=TimePeriod(microseconds=1000000),
+    ),
+)
+
+
+def _validate_low_power(cfg):
+    budget = cfg.get(CONF_IDLE_TIMING_BUDGET)
+    if budget is not None and budget.total_milliseconds > cfg[CONF_IDLE_PERIOD].total_milliseconds:
+        raise cv.Invalid(f"{CONF_IDLE_PERIOD} must be >= {CONF_IDLE_TIMING_BUDGET}")
+    return cfg
+
+
+def _validate_recovery(cfg):
+    if cfg[CONF_MAX_BACKOFF] < cfg[CONF_INITIAL_BACKOFF]:
+        raise cv.Invalid(f"{CONF_MAX_BACKOFF} must not be shorter than {CONF_INITIAL_BACKOFF}")
+    return cfg
+
+
+def _counter_schema(icon):
+    return sensor.sensor_schema(
+        accuracy_decimals=0,
+        state_class=STATE_CLASS_TOTAL_INCREASING,
+        entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+        icon=icon,
+    )
+
+
+def _duration_schema(icon):
+    return sensor.sensor_schema(
+        unit_of_measurement="ms",
+        accuracy_decimals=2,
+        state_class=STATE_CLASS_MEASUREMENT,
+        entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+        icon=icon,
+    )
+
+
 CONFIG_SCHEMA = cv.All(
     cv.Schema(
         {
             cv.GenerateID(): cv.declare_id(VL53L3CXComponent),
             # Keep original working default style for core options
             cv.Optional(CONF_DISTANCE_MODE): cv.enum(DISTANCE_MODES, upper=True),
-            cv.Optional(CONF_TIMING_BUDGET): cv.All(
-                cv.positive_time_period_microseconds,
-                cv.Range(
-                    min=TimePeriod(microseconds=20000),
-                    max=TimePeriod(microseconds=1000000),
-                ),
-            ),
+            cv.Optional(CONF_TIMING_BUDGET): TIMING_BUDGET_RANGE,
             cv.Optional(CONF_SIGNAL_RATE_LIMIT): cv.All(
                 cv.float_range(min=0.1, max=100.0),
                 cv.positive_float,
@@ -136,7 +256,7 @@ CONFIG_SCHEMA = cv.All(
             # Advanced histogram tuning (optional)
             cv.Optional(CONF_HIST_MERGE): cv.boolean,
             cv.Optional(CONF_HIST_NOISE_THRESHOLD): cv.int_range(min=10, max=200),
-            cv.Optional(CONF_HIST_MERGE_MAX_SIZE): cv.int_range(min=1, max=16),
+            cv.Optional(CONF_HIST_MERGE_MAX_SIZE): cv.int_range(min=1, max=HIST_MERGE_MAX_FRAMES),
             cv.Optional(CONF_ROI): cv.Schema(
                 {
                     cv.Required(CONF_ROI_TOP_LEFT_X): cv.int_range(min=0, max=15),
@@ -145,6 +265,180 @@ CONFIG_SCHEMA = cv.All(
                     cv.Required(CONF_ROI_BOTTOM_RIGHT_Y): cv.int_range(min=0, max=15),
                 }
             ),
+            # Closed-loop timing budget driven by per-frame sigma/signal/ambient
+            cv.Optional(CONF_ADAPTIVE_TIMING): cv.Schema(
+                {
+                    cv.Optional(CONF_MIN_TIMING_BUDGET, default="20ms"): TIMING_BUDGET_RANGE,
+                    cv.Optional(CONF_MAX_TIMING_BUDGET, default="200ms"): TIMING_BUDGET_RANGE,
+                    cv.Optional(CONF_TARGET_SIGMA, default=10.0): cv.float_range(min=1.0, max=100.0),
+                    cv.Optional(CONF_HOLD_FRAMES, default=5): cv.int_range(min=1, max=50),
+                }
+            ),
+            # Frame-to-frame target tracking; sensor target numbers become track slots
+            cv.Optional(CONF_TRACKING): cv.Schema(
+                {
+                    cv.Optional(CONF_GATE, default="250mm"): cv.All(
+                        cv.distance, cv.float_range(min=0.02, max=2.0)
+                    ),
+                    cv.Optional(
+                        CONF_TIMEOUT, default="500ms"
+                    ): cv.positive_time_period_microseconds,
+                }
+            ),
+            # Duty-cycled ranging while no target is within wake_distance
+            cv.Optional(CONF_LOW_POWER): cv.All(
+                cv.Schema(
+                    {
+                        cv.Optional(CONF_WAKE_DISTANCE, default="2.0m"): cv.All(
+                            cv.distance, cv.float_range(min=0.1, max=6.0)
+                        ),
+                        cv.Optional(CONF_IDLE_AFTER, default="30s"): cv.All(
+                            cv.positive_time_period_milliseconds,
+                            cv.Range(min=TimePeriod(seconds=1)),
+                        ),
+                        cv.Optional(CONF_IDLE_PERIOD, default="500ms"): cv.All(
+                            cv.positive_time_period_milliseconds,
+                            cv.Range(min=TimePeriod(milliseconds=100), max=TimePeriod(seconds=10)),
+                        ),
+                        cv.Optional(CONF_IDLE_TIMING_BUDGET): TIMING_BUDGET_RANGE,
+                    }
+                ),
+                _validate_low_power,
+            ),
+            # Background subtraction of learned static returns (see learn_background button)
+            cv.Optional(CONF_BACKGROUND): cv.Schema(
+                {
+                    cv.Optional(CONF_LEARN_DURATION, default="30s"): cv.All(
+                        cv.positive_time_period_microseconds,
+                        cv.Range(min=TimePeriod(seconds=2), max=TimePeriod(seconds=600)),
+                    ),
+                }
+            ),
+            # Optional runtime metric sensors
+            cv.Optional(CONF_METRICS): cv.Schema(
+                {
+                    cv.Optional(CONF_TIMING_BUDGET): sensor.sensor_schema(
+                        unit_of_measurement="ms",
+                        accuracy_decimals=0,
+                        state_class=STATE_CLASS_MEASUREMENT,
+                        entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+                        icon="mdi:timer-outline",
+                    ),
+                    cv.Optional(CONF_FRAME_RATE): sensor.sensor_schema(
+                        unit_of_measurement="Hz",
+                        accuracy_decimals=1,
+                        state_class=STATE_CLASS_MEASUREMENT,
+                        entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+                        icon="mdi:speedometer",
+                    ),
+                    # Frames processed vs distance states published, to size the publish policy savings
+                    cv.Optional(CONF_FRAMES): _counter_schema("mdi:counter"),
+                    cv.Optional(CONF_PUBLISHES): _counter_schema("mdi:upload-network-outline"),
+                    # Measurement counters since boot
+                    cv.Optional(CONF_MISSED_MEASUREMENTS): _counter_schema("mdi:skip-next-outline"),
+                    cv.Optional(CONF_TOTAL_MEASUREMENTS): _counter_schema("mdi:counter"),
+                    cv.Optional(CONF_VALID_MEASUREMENTS): _counter_schema("mdi:check-circle-outline"),
+                    cv.Optional(CONF_CONSECUTIVE_ERRORS): sensor.sensor_schema(
+                        accuracy_decimals=0,
+                        state_class=STATE_CLASS_MEASUREMENT,
+                        entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+                        icon="mdi:alert-circle-outline",
+                    ),
+                    # Per-frame averages over each 5 s interval
+                    cv.Optional(CONF_I2C_BYTES): sensor.sensor_schema(
+                        unit_of_measurement="B",
+                        accuracy_decimals=0,
+                        state_class=STATE_CLASS_MEASUREMENT,
+                        entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+                        icon="mdi:swap-horizontal",
+                    ),
+                    cv.Optional(CONF_I2C_READ_TIME): _duration_schema("mdi:timer-sand"),
+                    cv.Optional(CONF_PROCESSING_TIME): _duration_schema("mdi:chip"),
+                    cv.Optional(CONF_PUBLISH_LATENCY): _duration_schema("mdi:timer-outline"),
+                    # Error, missed-frame or frame-rate trouble over a rolling 30 s window
+                    cv.Optional(
+                        CONF_PERFORMANCE_DEGRADED
+                    ): binary_sensor.binary_sensor_schema(
+                        device_class=DEVICE_CLASS_PROBLEM,
+                        entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+                    ),
+                    # Self-healing supervisor: current stage, recoveries and the last fault -> frame time
+                    cv.Optional(CONF_HEALTH): text_sensor.text_sensor_schema(
+                        entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+                        icon="mdi:heart-pulse",
+                    ),
+                    cv.Optional(CONF_RECOVERIES): _counter_schema("mdi:restart"),
+                    # Low-power mode: current proxies and wake-up time
+                    cv.Optional(CONF_LOW_POWER): binary_sensor.binary_sensor_schema(
+                        entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+                        icon="mdi:sleep",
+                    ),
+                    cv.Optional(CONF_I2C_THROUGHPUT): sensor.sensor_schema(
+                        unit_of_measurement="B/s",
+                        accuracy_decimals=0,
+                        state_class=STATE_CLASS_MEASUREMENT,
+                        entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+                        icon="mdi:swap-horizontal",
+                    ),
+                    cv.Optional(CONF_WAKE_LATENCY): _duration_schema("mdi:alarm"),
+                    cv.Optional(CONF_DMAX_CACHE_HIT_RATE): sensor.sensor_schema(
+                        unit_of_measurement=UNIT_PERCENT,
+                        accuracy_decimals=0,
+                        state_class=STATE_CLASS_MEASUREMENT,
+                        entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+                        icon="mdi:cached",
+                    ),
+                    cv.Optional(CONF_TIME_TO_RECOVER): sensor.sensor_schema(
+                        unit_of_measurement="s",
+                        accuracy_decimals=1,
+                        state_class=STATE_CLASS_MEASUREMENT,
+                        entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+                        icon="mdi:timer-refresh-outline",
+                    ),
+                }
+            ),
+            # Back-off between recovery attempts after read errors or a stalled sensor
+            cv.Optional(CONF_RECOVERY, default={}): cv.All(
+                cv.Schema(
+                    {
+                        cv.Optional(
+                            CONF_INITIAL_BACKOFF, default="1s"
+                        ): cv.positive_time_period_milliseconds,
+                        cv.Optional(
+                            CONF_MAX_BACKOFF, default="5min"
+                        ): cv.positive_time_period_milliseconds,
+                    }
+                ),
+                _validate_recovery,
+            ),
+            # Frame-path events are counted and logged as one summary line per interval (0s = off)
+            cv.Optional(
+                CONF_LOG_SUMMARY_INTERVAL, default="60s"
+            ): cv.positive_time_period_milliseconds,
+            # Compile in per-frame/per-target debug logs (VL53L3CX_FRAME_DEBUG)
+            cv.Optional(CONF_FRAME_DEBUG, default=False): cv.boolean,
+            # Gen4 histogram post-processing: ST's C code, or the C++ port
+            # specialised per bin/slot count (VL53LX_HIST_TEMPLATED)
+            cv.Optional(CONF_HISTOGRAM_PIPELINE, default="C"): cv.one_of(
+                "C", "TEMPLATED", upper=True
+            ),
+            cv.Optional(CONF_PEAK_ESTIMATOR, default="FILTER"): cv.enum(
+                PEAK_ESTIMATORS, upper=True
+            ),
+            # Sum each timing's histograms over the last frames (ST histogram merge) for far
+            # targets on a short budget; a target within near_distance restarts the sum
+            cv.Optional(CONF_HISTOGRAM_ACCUMULATION): cv.Schema(
+                {
+                    cv.Optional(CONF_FRAMES, default=HIST_MERGE_MAX_FRAMES): cv.int_range(
+                        min=2, max=HIST_MERGE_MAX_FRAMES
+                    ),
+                    cv.Optional(CONF_NEAR_DISTANCE, default="1.0m"): cv.All(
+                        cv.distance, cv.float_range(min=0.1, max=6.0)
+                    ),
+                }
+            ),
+            # Log the driver state and each frame's I2C reads for host replay (tools/hist_sweep)
+            cv.Optional(CONF_HISTOGRAM_CAPTURE, default=False): cv.boolean,
             cv.Optional(CONF_XSHUT_PIN): pins.gpio_output_pin_schema,
             cv.Optional(CONF_INTERRUPT_PIN): pins.gpio_input_pin_schema,
         }
@@ -153,9 +447,33 @@ CONFIG_SCHEMA = cv.All(
     .extend(i2c.i2c_device_schema(0x29)),
     _validate_timing,
     _validate_roi,
+    _validate_adaptive_timing,
+    _validate_histogram_accumulation,
 )
 
 
+def _final_validate_xshut_group(cfg):
+    if CONF_XSHUT_PIN not in cfg or cfg[CONF_ADDRESS] != 0x29:
+        return cfg
+    # Every XSHUT sensor leaves reset (setup, hard-reset recovery) on 0x29, so no
+    # member of the group may stay there once a second sensor shares its bus
+    hubs = fv.full_config.get().get("vl53l3cx", [])
+    group = [
+        hub
+        for hub in hubs
+        if CONF_XSHUT_PIN in hub and hub.get(i2c.CONF_I2C_ID) == cfg.get(i2c.CONF_I2C_ID)
+    ]
+    if len(group) > 1:
+        raise cv.Invalid(
+            f"{CONF_ADDRESS} 0x29 is where the other {CONF_XSHUT_PIN} sensors boot; "
+            "give each sensor with an xshut_pin its own address"
+        )
+    return cfg
+
+
+FINAL_VALIDATE_SCHEMA = _final_validate_xshut_group
+
+
 async def to_code(config):
     """Generate the C++ code for the VL53L3CX component."""
     var = cg.new_Pvariable(config[CONF_ID])
@@ -198,8 +516,13 @@ async def to_code(config):
     cg.add(var.set_hist_merge_enabled(hist_merge_enabled))
     hist_noise_threshold = config.get(CONF_HIST_NOISE_THRESHOLD, 50)
     cg.add(var.set_hist_noise_threshold(hist_noise_threshold))
-    hist_merge_max_size = config.get(CONF_HIST_MERGE_MAX_SIZE, 8)
+    hist_merge_max_size = config.get(CONF_HIST_MERGE_MAX_SIZE, HIST_MERGE_MAX_FRAMES)
+    if CONF_HISTOGRAM_ACCUMULATION in config:
+        accumulation = config[CONF_HISTOGRAM_ACCUMULATION]
+        hist_merge_max_size = accumulation[CONF_FRAMES]
+        cg.add(var.set_histogram_accumulation(int(round(accumulation[CONF_NEAR_DISTANCE] * 1000))))
     cg.add(var.set_hist_merge_max_size(hist_merge_max_size))
+    cg.add(var.set_peak_estimator(PEAK_ESTIMATORS[config[CONF_PEAK_ESTIMATOR]]))
     
     # Set ROI if configured
     if CONF_ROI in config:
@@ -207,6 +530,104 @@ async def to_code(config):
         cg.add(var.set_roi(roi[CONF_ROI_TOP_LEFT_X], roi[CONF_ROI_TOP_LEFT_Y], 
                           roi[CONF_ROI_BOTTOM_RIGHT_X], roi[CONF_ROI_BOTTOM_RIGHT_Y]))
 
+    if CONF_ADAPTIVE_TIMING in config:
+        adaptive = config[CONF_ADAPTIVE_TIMING]
+        cg.add(var.set_adaptive_timing(
+            int(adaptive[CONF_MIN_TIMING_BUDGET].total_microseconds),
+            int(adaptive[CONF_MAX_TIMING_BUDGET].total_microseconds),
+            adaptive[CONF_TARGET_SIGMA],
+            adaptive[CONF_HOLD_FRAMES],
+        ))
+
+    if CONF_TRACKING in config:
+        tracking = config[CONF_TRACKING]
+        cg.add(var.set_tracking(
+            int(round(tracking[CONF_GATE] * 1000)),
+            int(tracking[CONF_TIMEOUT].total_microseconds),
+        ))
+
+    if CONF_LOW_POWER in config:
+        low_power = config[CONF_LOW_POWER]
+        idle_budget = low_power.get(CONF_IDLE_TIMING_BUDGET)
+        cg.add(var.set_low_power(
+            int(round(low_power[CONF_WAKE_DISTANCE] * 1000)),
+            low_power[CONF_IDLE_AFTER].total_milliseconds,
+            low_power[CONF_IDLE_PERIOD].total_milliseconds,
+            int(idle_budget.total_microseconds) if idle_budget is not None else 0,
+        ))
+
+    if CONF_BACKGROUND in config:
+        background = config[CONF_BACKGROUND]
+        cg.add(var.set_background_learn_duration(
+            int(background[CONF_LEARN_DURATION].total_microseconds)
+        ))
+
+    if CONF_METRICS in config:
+        metrics = config[CONF_METRICS]
+        if CONF_TIMING_BUDGET in metrics:
+            sens = await sensor.new_sensor(metrics[CONF_TIMING_BUDGET])
+            cg.add(var.set_timing_budget_sensor(sens))
+        if CONF_FRAME_RATE in metrics:
+            sens = await sensor.new_sensor(metrics[CONF_FRAME_RATE])
+            cg.add(var.set_frame_rate_sensor(sens))
+        if CONF_FRAMES in metrics:
+            sens = await sensor.new_sensor(metrics[CONF_FRAMES])
+            cg.add(var.set_frames_sensor(sens))
+        if CONF_PUBLISHES in metrics:
+            sens = await sensor.new_sensor(metrics[CONF_PUBLISHES])
+            cg.add(var.set_publishes_sensor(sens))
+        for key, setter in (
+            (CONF_MISSED_MEASUREMENTS, var.set_missed_measurements_sensor),
+            (CONF_CONSECUTIVE_ERRORS, var.set_consecutive_errors_sensor),
+            (CONF_TOTAL_MEASUREMENTS, var.set_total_measurements_sensor),
+            (CONF_VALID_MEASUREMENTS, var.set_valid_measurements_sensor),
+            (CONF_I2C_BYTES, var.set_i2c_bytes_sensor),
+            (CONF_I2C_READ_TIME, var.set_i2c_read_time_sensor),
+            (CONF_PROCESSING_TIME, var.set_processing_time_sensor),
+            (CONF_PUBLISH_LATENCY, var.set_publish_latency_sensor),
+        ):
+            if key in metrics:
+                sens = await sensor.new_sensor(metrics[key])
+                cg.add(setter(sens))
+        if CONF_PERFORMANCE_DEGRADED in metrics:
+            sens = await binary_sensor.new_binary_sensor(metrics[CONF_PERFORMANCE_DEGRADED])
+            cg.add(var.set_performance_degraded_binary_sensor(sens))
+        if CONF_RECOVERIES in metrics:
+            sens = await sensor.new_sensor(metrics[CONF_RECOVERIES])
+            cg.add(var.set_recoveries_sensor(sens))
+        if CONF_TIME_TO_RECOVER in metrics:
+            sens = await sensor.new_sensor(metrics[CONF_TIME_TO_RECOVER])
+            cg.add(var.set_time_to_recover_sensor(sens))
+        if CONF_LOW_POWER in metrics:
+            sens = await binary_sensor.new_binary_sensor(metrics[CONF_LOW_POWER])
+            cg.add(var.set_low_power_binary_sensor(sens))
+        if CONF_I2C_THROUGHPUT in metrics:
+            sens = await sensor.new_sensor(metrics[CONF_I2C_THROUGHPUT])
+            cg.add(var.set_i2c_throughput_sensor(sens))
+        if CONF_WAKE_LATENCY in metrics:
+            sens = await sensor.new_sensor(metrics[CONF_WAKE_LATENCY])
+            cg.add(var.set_wake_latency_sensor(sens))
+        if CONF_DMAX_CACHE_HIT_RATE in metrics:
+            sens = await sensor.new_sensor(metrics[CONF_DMAX_CACHE_HIT_RATE])
+            cg.add(var.set_dmax_cache_hit_rate_sensor(sens))
+        if CONF_HEALTH in metrics:
+            sens = await text_sensor.new_text_sensor(metrics[CONF_HEALTH])
+            cg.add(var.set_health_text_sensor(sens))
+
+    recovery = config[CONF_RECOVERY]
+    cg.add(var.set_recovery_backoff(
+        recovery[CONF_INITIAL_BACKOFF].total_milliseconds,
+        recovery[CONF_MAX_BACKOFF].total_milliseconds,
+    ))
+
+    cg.add(var.set_log_summary_interval(config[CONF_LOG_SUMMARY_INTERVAL].total_milliseconds))
+    if config[CONF_FRAME_DEBUG]:
+        cg.add_define("VL53L3CX_FRAME_DEBUG")
+    cg.add(var.set_histogram_capture(config[CONF_HISTOGRAM_CAPTURE]))
+    if config[CONF_HISTOGRAM_PIPELINE] == "TEMPLATED":
+        # A build flag rather than a define: the C driver sources need it too
+        cg.add_build_flag("-DVL53LX_HIST_TEMPLATED")
+
     # Configure GPIO pins if specified
     if CONF_XSHUT_PIN in config:
         xshut_pin = await cg.gpio_pin_expression(config[CONF_XSHUT_PIN])
@@ -0,0 +1,113 @@
+#include "background_model.h"
+#include <algorithm>
+
+namespace esphome {
+namespace vl53l3cx {
+
+// A bin is background when it returned a target in at least this share of learning frames (percent)
+static const uint16_t MIN_OCCUPANCY_PCT = 50;
+
+static bool is_valid_return(const FrameTarget &target) {
+  return target.range_mm > 0 && (target.range_status == VL53LX_RANGESTATUS_RANGE_VALID ||
+                                 target.range_status == VL53LX_RANGESTATUS_RANGE_VALID_MERGED_PULSE);
+}
+
+uint8_t BackgroundModel::bin_of_(int16_t range_mm) {
+  return (uint8_t) std::min<int32_t>(range_mm / BIN_MM, NUM_BINS - 1);
+}
+
+uint8_t BackgroundModel::level_of_(FixPoint1616_t signal_rate_mcps) {
+  // 0.25 MCPS steps, at least 1 so a learned bin is never 0
+  return (uint8_t) std::max<uint32_t>(std::min<uint32_t>(signal_rate_mcps >> 14, UINT8_MAX), 1);
+}
+
+void BackgroundModel::start_learning(uint64_t now_us, uint32_t duration_us) {
+  this->learning_ = true;
+  this->learn_until_us_ = now_us + duration_us;
+  this->learn_frames_ = 0;
+  this->hits_.fill(0);
+  this->learn_level_.fill(0);
+}
+
+bool BackgroundModel::learn(const Frame &frame) {
+  if (!this->learning_) {
+    return false;
+  }
+
+  if (this->learn_frames_ < UINT16_MAX) {
+    this->learn_frames_++;
+    std::array<uint8_t, VL53LX_MAX_RANGE_RESULTS> counted{};
+    uint8_t num_counted = 0;
+    for (uint8_t i = 0; i < frame.num_targets; i++) {
+      const FrameTarget &target = frame.targets[i];
+      if (!is_valid_return(target)) {
+        continue;
+      }
+      const uint8_t bin = bin_of_(target.range_mm);
+      // Count a bin once per frame, however many targets fall into it
+      if (std::find(counted.begin(), counted.begin() + num_counted, bin) == counted.begin() + num_counted) {
+        counted[num_counted++] = bin;
+        this->hits_[bin]++;
+      }
+      this->learn_level_[bin] = std::max(this->learn_level_[bin], level_of_(target.signal_rate_mcps));
+    }
+  }
+
+  if (frame.timestamp_us < this->learn_until_us_) {
+    return false;
+  }
+
+  // Keep bins that saw returns and whose neighbourhood (a static return
+  // jitters across bin edges) was occupied for most of the learning window
+  this->learning_ = false;
+  for (uint8_t bin = 0; bin < NUM_BINS; bin++) {
+    uint32_t hits = this->hits_[bin];
+    if (bin > 0) {
+      hits += this->hits_[bin - 1];
+    }
+    if (bin < NUM_BINS - 1) {
+      hits += this->hits_[bin + 1];
+    }
+    const bool occupied = this->hits_[bin] > 0 && hits * 100 >= (uint32_t) this->learn_frames_ * MIN_OCCUPANCY_PCT;
+    this->table_.level[bin] = occupied ? this->learn_level_[bin] : 0;
+  }
+  return true;
+}
+
+void BackgroundModel::clear() {
+  this->learning_ = false;
+  this->table_.level.fill(0);
+}
+
+bool BackgroundModel::is_background(const FrameTarget &target) const {
+  if (!is_valid_return(target)) {
+    return false;
+  }
+  const uint8_t bin = bin_of_(target.range_mm);
+  const uint8_t level = level_of_(target.signal_rate_mcps);
+  // Neighbouring bins absorb range noise; a much stronger return than learned
+  // (someone right in front of the sofa) stays foreground
+  for (int16_t b = std::max<int16_t>(bin - 1, 0); b <= std::min<int16_t>(bin + 1, NUM_BINS - 1); b++) {
+    const uint8_t learned = this->table_.level[b];
+    if (learned != 0 && level <= learned + learned / 2 + 1) {
+      return true;
+    }
+  }
+  return false;
+}
+
+uint8_t BackgroundModel::count_bins() const {
+  return (uint8_t) std::count_if(this->table_.level.begin(), this->table_.level.end(),
+                                 [](uint8_t level) { return level != 0; });
+}
+
+bool BackgroundModel::set_table(const Table &table) {
+  if (table.version != TABLE_VERSION) {
+    return false;
+  }
+  this->table_ = table;
+  return true;
+}
+
+}  // namespace vl53l3cx
+}  // namespace esphome
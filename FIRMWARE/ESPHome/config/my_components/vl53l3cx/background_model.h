@@ -0,0 +1,54 @@
+#pragma once
+
+#include "frame.h"
+#include <array>
+#include <cstdint>
+
+namespace esphome {
+namespace vl53l3cx {
+
+// Learned static returns (sofa, walls, furniture) of an empty scene, kept as
+// one byte per range bin so the table can be persisted as-is. A target is
+// background when a learned bin within one bin of its range holds a signal
+// level at least comparable to its own.
+class BackgroundModel {
+ public:
+  static const uint8_t NUM_BINS = 128;
+  static const uint16_t BIN_MM = 32;  // Bins cover 0..4096 mm, the last one open-ended
+
+  // Persisted form: strongest learned signal per bin in 0.25 MCPS steps, 0 = no background
+  struct Table {
+    uint8_t version;
+    std::array<uint8_t, NUM_BINS> level;
+  };
+  static const uint8_t TABLE_VERSION = 1;
+
+  void start_learning(uint64_t now_us, uint32_t duration_us);
+  // Accumulate one frame while learning. Returns true on the frame that
+  // completes learning, after the new table has replaced the old one.
+  bool learn(const Frame &frame);
+  void clear();
+
+  bool is_learning() const { return this->learning_; }
+  bool is_background(const FrameTarget &target) const;
+  uint8_t count_bins() const;
+
+  const Table &get_table() const { return this->table_; }
+  bool set_table(const Table &table);
+
+ protected:
+  static uint8_t bin_of_(int16_t range_mm);
+  static uint8_t level_of_(FixPoint1616_t signal_rate_mcps);
+
+  Table table_{TABLE_VERSION, {}};
+
+  // Learning accumulators
+  bool learning_{false};
+  uint64_t learn_until_us_{0};
+  uint16_t learn_frames_{0};
+  std::array<uint16_t, NUM_BINS> hits_{};
+  std::array<uint8_t, NUM_BINS> learn_level_{};
+};
+
+}  // namespace vl53l3cx
+}  // namespace esphome
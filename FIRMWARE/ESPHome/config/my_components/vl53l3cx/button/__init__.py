@@ -11,11 +11,15 @@ RefSpadCalibrationButton = vl53l3cx_ns.class_("RefSpadCalibrationButton", button
 CrosstalkCalibrationButton = vl53l3cx_ns.class_("CrosstalkCalibrationButton", button.Button)
 OffsetCalibrationButton = vl53l3cx_ns.class_("OffsetCalibrationButton", button.Button)
 ZeroDistanceCalibrationButton = vl53l3cx_ns.class_("ZeroDistanceCalibrationButton", button.Button)
+LearnBackgroundButton = vl53l3cx_ns.class_("LearnBackgroundButton", button.Button)
+ResetBackgroundButton = vl53l3cx_ns.class_("ResetBackgroundButton", button.Button)
 
 CONF_REFSPAD_CALIBRATION = "refspad_calibration"
 CONF_CROSSTALK_CALIBRATION = "crosstalk_calibration"
 CONF_OFFSET_CALIBRATION = "offset_calibration"
 CONF_ZERO_DISTANCE_CALIBRATION = "zero_distance_calibration"
+CONF_LEARN_BACKGROUND = "learn_background"
+CONF_RESET_BACKGROUND = "reset_background"
 
 CONFIG_SCHEMA = {
     cv.GenerateID(CONF_VL53L3CX_ID): cv.use_id(VL53L3CXComponent),
@@ -39,6 +43,16 @@ CONFIG_SCHEMA = {
         entity_category=ENTITY_CATEGORY_CONFIG,
         icon="mdi:target-variant",
     ),
+    cv.Optional(CONF_LEARN_BACKGROUND): button.button_schema(
+        LearnBackgroundButton,
+        entity_category=ENTITY_CATEGORY_CONFIG,
+        icon="mdi:sofa",
+    ),
+    cv.Optional(CONF_RESET_BACKGROUND): button.button_schema(
+        ResetBackgroundButton,
+        entity_category=ENTITY_CATEGORY_CONFIG,
+        icon="mdi:sofa-outline",
+    ),
 }
 
 
@@ -63,4 +77,14 @@ async def to_code(config):
     if zero_config := config.get(CONF_ZERO_DISTANCE_CALIBRATION):
         b = await button.new_button(zero_config)
         await cg.register_parented(b, config[CONF_VL53L3CX_ID])
-        cg.add(vl53l3cx_component.set_zero_distance_calibration_button(b))
\ No newline at end of file
+        cg.add(vl53l3cx_component.set_zero_distance_calibration_button(b))
+
+    if learn_config := config.get(CONF_LEARN_BACKGROUND):
+        b = await button.new_button(learn_config)
+        await cg.register_parented(b, config[CONF_VL53L3CX_ID])
+        cg.add(vl53l3cx_component.set_learn_background_button(b))
+
+    if reset_config := config.get(CONF_RESET_BACKGROUND):
+        b = await button.new_button(reset_config)
+        await cg.register_parented(b, config[CONF_VL53L3CX_ID])
+        cg.add(vl53l3cx_component.set_reset_background_button(b))
\ No newline at end of file
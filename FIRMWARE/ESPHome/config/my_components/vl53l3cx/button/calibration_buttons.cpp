@@ -26,5 +26,15 @@ void ZeroDistanceCalibrationButton::press_action() {
   this->parent_->perform_zero_distance_calibration();
 }
 
+void LearnBackgroundButton::press_action() {
+  ESP_LOGD(TAG, "Learn background button pressed");
+  this->parent_->start_background_learning();
+}
+
+void ResetBackgroundButton::press_action() {
+  ESP_LOGD(TAG, "Reset background button pressed");
+  this->parent_->reset_background();
+}
+
 }  // namespace vl53l3cx
 }  // namespace esphome
\ No newline at end of file
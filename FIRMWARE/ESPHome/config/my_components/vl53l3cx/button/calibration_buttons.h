@@ -38,5 +38,21 @@ class ZeroDistanceCalibrationButton : public button::Button, public Parented<VL5
   void press_action() override;
 };
 
+class LearnBackgroundButton : public button::Button, public Parented<VL53L3CXComponent> {
+ public:
+  LearnBackgroundButton() = default;
+
+ protected:
+  void press_action() override;
+};
+
+class ResetBackgroundButton : public button::Button, public Parented<VL53L3CXComponent> {
+ public:
+  ResetBackgroundButton() = default;
+
+ protected:
+  void press_action() override;
+};
+
 }  // namespace vl53l3cx
 }  // namespace esphome
\ No newline at end of file
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+extern "C" {
+#include "vl53lx_def.h"
+}
+
+namespace esphome {
+namespace vl53l3cx {
+
+// One target of a frame, kept in the driver's fixed-point units
+struct FrameTarget {
+  int16_t range_mm{0};
+  uint8_t range_status{VL53LX_RANGESTATUS_NONE};
+  FixPoint1616_t sigma_mm{0};           // 16.16
+  FixPoint1616_t signal_rate_mcps{0};   // 16.16
+  FixPoint1616_t ambient_rate_mcps{0};  // 16.16
+  bool is_background{false};            // Matches the learned static scene
+};
+
+// A complete ranging result as handed to frame listeners (fusion, guard logic)
+struct Frame {
+  uint64_t timestamp_us{0};  // Data-ready time on the µs platform timebase
+  uint8_t stream_count{0};
+  uint8_t num_targets{0};
+  uint8_t histograms{1};  // Histograms the driver's merge summed into this frame
+  std::array<FrameTarget, VL53LX_MAX_RANGE_RESULTS> targets{};
+};
+
+}  // namespace vl53l3cx
+}  // namespace esphome
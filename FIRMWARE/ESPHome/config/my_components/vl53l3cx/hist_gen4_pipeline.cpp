@@ -0,0 +1,16 @@
+#ifdef VL53LX_HIST_TEMPLATED
+
+#include "hist_gen4_pipeline.h"
+
+// The C entry point for vl53lx_hist_funcs.c; the pipeline is in the header
+extern "C" VL53LX_Error VL53LX_f_025_templated(
+    VL53LX_dmax_calibration_data_t *pdmax_cal, VL53LX_hist_gen3_dmax_config_t *pdmax_cfg,
+    VL53LX_hist_post_process_config_t *ppost_cfg, VL53LX_histogram_bin_data_t *pbins,
+    VL53LX_histogram_bin_data_t *pxtalk, VL53LX_hist_gen3_algo_private_data_t *palgo,
+    VL53LX_hist_gen4_algo_filtered_data_t *pfiltered, VL53LX_hist_gen3_dmax_private_data_t *pdmax_algo,
+    VL53LX_dmax_cache_t *pdmax_cache, VL53LX_range_results_t *presults, uint8_t histo_merge_nb) {
+  return esphome::vl53l3cx::hist_gen4_process(pdmax_cal, pdmax_cfg, ppost_cfg, pbins, pxtalk, palgo, pfiltered,
+                                               pdmax_algo, pdmax_cache, presults, histo_merge_nb);
+}
+
+#endif  // VL53LX_HIST_TEMPLATED
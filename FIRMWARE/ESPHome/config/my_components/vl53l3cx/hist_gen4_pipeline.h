@@ -0,0 +1,448 @@
+#pragma once
+
+// C++17 port of the ST gen4 histogram pipeline (VL53LX_f_025 and the gen3
+// stages it runs), specialised on the bin count left after ambient removal
+// and on the VCSEL period in timing slots. With both fixed, every bin loop
+// has constant bounds and every "% slots" / "% bins" is a constant modulo,
+// so the compiler can unroll and strength-reduce them. A template argument
+// of 0 reads that value from the frame instead.
+//
+// Results are bit-identical to the C path: each stage keeps the C types,
+// loop order and integer promotions, and writes the same private state.
+// Scalar maths that runs a handful of times per frame (sigma, dmax, phase
+// interpolation and refinement, range conversion) is shared with the C driver.
+//
+// The pipeline and its dispatch are header-only. hist_gen4_pipeline.cpp only
+// gives the C driver its VL53LX_f_025_templated symbol.
+
+#include <cstdint>
+#include <cstring>
+
+extern "C" {
+#include "vl53lx_types.h"
+#include "vl53lx_error_codes.h"
+#include "vl53lx_core_support.h"
+#include "vl53lx_hist_core.h"
+#include "vl53lx_hist_algos_gen3.h"
+#include "vl53lx_hist_algos_gen4.h"
+#include "vl53lx_sigma_estimate.h"
+#include "vl53lx_dmax.h"
+}
+
+namespace esphome {
+namespace vl53l3cx {
+
+template<uint8_t Bins, uint8_t Slots> class HistGen4Pipeline {
+ public:
+  // Same contract as VL53LX_f_025. The caller checks that the frame has
+  // Bins bins once its ambient bins are removed and a Slots-slot period.
+  static VL53LX_Error process(VL53LX_dmax_calibration_data_t *pdmax_cal, VL53LX_hist_gen3_dmax_config_t *pdmax_cfg,
+                              VL53LX_hist_post_process_config_t *ppost_cfg, VL53LX_histogram_bin_data_t *pbins_input,
+                              VL53LX_histogram_bin_data_t *pxtalk, VL53LX_hist_gen3_algo_private_data_t *palgo,
+                              VL53LX_hist_gen4_algo_filtered_data_t *pfiltered,
+                              VL53LX_hist_gen3_dmax_private_data_t *pdmax_algo, VL53LX_dmax_cache_t *pdmax_cache,
+                              VL53LX_range_results_t *presults, uint8_t histo_merge_nb) {
+    VL53LX_Error status = VL53LX_ERROR_NONE;
+    VL53LX_histogram_bin_data_t *pB = &palgo->VL53LX_p_006;
+
+    VL53LX_f_003(palgo);
+    memcpy(pB, pbins_input, sizeof(VL53LX_histogram_bin_data_t));
+
+    presults->cfg_device_state = pbins_input->cfg_device_state;
+    presults->rd_device_state = pbins_input->rd_device_state;
+    presults->zone_id = pbins_input->zone_id;
+    presults->stream_count = pbins_input->result__stream_count;
+    presults->wrap_dmax_mm = 0;
+    presults->max_results = VL53LX_MAX_RANGE_RESULTS;
+    presults->active_results = 0;
+    for (uint8_t p = 0; p < VL53LX_MAX_AMBIENT_DMAX_VALUES; p++)
+      presults->VL53LX_p_022[p] = 0;
+
+    VL53LX_hist_calc_zero_distance_phase(pB);
+    VL53LX_hist_estimate_and_remove_ambient((int32_t) ppost_cfg->ambient_thresh_sigma0, pB);
+
+    const uint8_t xtalk_enable = ppost_cfg->algo__crosstalk_compensation_enable;
+    if (xtalk_enable > 0)
+      VL53LX_f_005(pxtalk, pB, &palgo->VL53LX_p_047);
+
+    pdmax_cfg->ambient_thresh_sigma = ppost_cfg->ambient_thresh_sigma1;
+    for (uint8_t p = 0; p < VL53LX_MAX_AMBIENT_DMAX_VALUES; p++) {
+      if (status == VL53LX_ERROR_NONE)
+        status = VL53LX_f_001(pdmax_cfg->target_reflectance_for_dmax_calc[p], pdmax_cal, pdmax_cfg, pB, pdmax_algo,
+                              pdmax_cache, &presults->VL53LX_p_022[p]);
+    }
+    if (status != VL53LX_ERROR_NONE)
+      return status;
+
+    const uint8_t nb = bins_(pB);
+    const uint8_t ns = Slots != 0 ? Slots : VL53LX_decode_vcsel_period(pB->VL53LX_p_005);
+
+    find_events_(ppost_cfg->ambient_thresh_events_scaler, (int32_t) pdmax_cfg->ambient_thresh_sigma,
+                 (int32_t) ppost_cfg->min_ambient_thresh_events, xtalk_enable, pB, &palgo->VL53LX_p_047, palgo, ns);
+    find_start_(palgo, nb, ns);
+    number_pulses_(palgo, nb, ns);
+    bound_pulses_(palgo, nb, ns);
+
+    for (uint8_t p = 0; p < palgo->VL53LX_p_046; p++) {
+      VL53LX_hist_pulse_data_t *pdata = &palgo->VL53LX_p_003[p];
+
+      event_sums_(pdata, pB, palgo, ns);
+      // The source histograms do not change inside this loop, so only the
+      // first pulse needs the full copy
+      pulse_histogram_(pdata, pB, palgo, pB->VL53LX_p_028, &palgo->VL53LX_p_048, p == 0, nb, ns);
+      pulse_histogram_(pdata, pB, palgo, 0, &palgo->VL53LX_p_049, p == 0, nb, ns);
+      pulse_histogram_(pdata, &palgo->VL53LX_p_047, palgo, 0, &palgo->VL53LX_p_050, p == 0,
+                       palgo->VL53LX_p_047.VL53LX_p_021, ns);
+      filter_(pdata, &palgo->VL53LX_p_048, palgo, pfiltered, nb, ns);
+      detect_(pdata, pfiltered, palgo, nb, ns);
+      VL53LX_hist_refine_peak_phase(p, ppost_cfg->hist_peak_estimator, &palgo->VL53LX_p_048, palgo);
+      sigma_(pdata->VL53LX_p_023, ppost_cfg->sigma_estimator__sigma_ref_mm, pdata->VL53LX_p_051, xtalk_enable,
+             &palgo->VL53LX_p_048, &palgo->VL53LX_p_049, &palgo->VL53LX_p_050, &pdata->VL53LX_p_002, nb, ns);
+      phase_window_(pdata, 1, pB, ns);
+    }
+
+    status = VL53LX_f_016(ppost_cfg->hist_target_order, palgo);
+
+    for (uint8_t p = 0; p < palgo->VL53LX_p_046; p++) {
+      VL53LX_hist_pulse_data_t *pdata = &palgo->VL53LX_p_003[p];
+      if (!(presults->active_results < presults->max_results))
+        continue;
+      if (pdata->VL53LX_p_010 > ppost_cfg->signal_total_events_limit && pdata->VL53LX_p_023 < 0xFF) {
+        VL53LX_range_data_t *prange = &presults->VL53LX_p_003[presults->active_results];
+        if (status == VL53LX_ERROR_NONE)
+          VL53LX_f_017(presults->active_results, ppost_cfg->valid_phase_low, ppost_cfg->valid_phase_high,
+                       ppost_cfg->sigma_thresh, pB, pdata, prange);
+        if (status == VL53LX_ERROR_NONE)
+          status = VL53LX_f_018(pB->vcsel_width, pB->VL53LX_p_015, pB->total_periods_elapsed,
+                                pB->result__dss_actual_effective_spads, prange, histo_merge_nb);
+        if (status == VL53LX_ERROR_NONE)
+          VL53LX_f_019(ppost_cfg->gain_factor, ppost_cfg->range_offset_mm, prange);
+        presults->active_results++;
+      }
+    }
+    return status;
+  }
+
+ protected:
+  static uint8_t bins_(const VL53LX_histogram_bin_data_t *pbins) { return Bins != 0 ? Bins : pbins->VL53LX_p_021; }
+
+  // VL53LX_f_022: a/b/c sums of a 2*woi+1 window centred on bin i
+  static void window_sums_(uint8_t i, uint8_t woi, const VL53LX_histogram_bin_data_t *pbins, uint8_t nb, int32_t *pa,
+                           int32_t *pb, int32_t *pc) {
+    int32_t a = 0;
+    int32_t c = 0;
+    for (uint8_t w = 0; w < woi; w++)
+      a += pbins->bin_data[(uint8_t)(((int) i + w + nb - woi) % nb)];
+    for (uint8_t w = woi + 1; w < ((woi << 1) + 1); w++)
+      c += pbins->bin_data[(uint8_t)(((int) i + w + nb - woi) % nb)];
+    *pa = a;
+    *pb = pbins->bin_data[i];
+    *pc = c;
+  }
+
+  // VL53LX_f_006: per-bin ambient thresholds and bins above them
+  static void find_events_(uint16_t ambient_threshold_events_scaler, int32_t ambient_threshold_sigma,
+                           int32_t min_ambient_threshold_events, uint8_t xtalk_enable,
+                           const VL53LX_histogram_bin_data_t *pbins, const VL53LX_histogram_bin_data_t *pxtalk,
+                           VL53LX_hist_gen3_algo_private_data_t *palgo, uint8_t ns) {
+    const uint8_t nb = bins_(pbins);
+    palgo->VL53LX_p_020 = pbins->VL53LX_p_020;
+    palgo->VL53LX_p_019 = pbins->VL53LX_p_019;
+    palgo->VL53LX_p_021 = pbins->VL53LX_p_021;
+    palgo->VL53LX_p_028 = pbins->VL53LX_p_028;
+    palgo->VL53LX_p_030 = ns;
+
+    int64_t tmp = (int64_t) pbins->VL53LX_p_028 * (int64_t) ambient_threshold_events_scaler + 2048;
+    const int32_t amb_events = (int32_t) (tmp / 4096);
+
+    for (uint8_t lb = 0; lb < nb; lb++) {
+      const int32_t samples = (int32_t) pbins->bin_rep[lb >> 2];
+      if (samples <= 0)
+        continue;
+      int32_t thresh;
+      if (lb < pxtalk->VL53LX_p_021 && xtalk_enable > 0)
+        thresh = samples * (amb_events + pxtalk->bin_data[lb]);
+      else
+        thresh = samples * amb_events;
+      thresh = VL53LX_isqrt(thresh);
+      thresh += samples / 2;
+      thresh /= samples;
+      thresh *= ambient_threshold_sigma;
+      thresh += 8;
+      thresh /= 16;
+      thresh += amb_events;
+      if (thresh < min_ambient_threshold_events)
+        thresh = min_ambient_threshold_events;
+      palgo->VL53LX_p_052[lb] = thresh;
+      palgo->VL53LX_p_031 = thresh;
+    }
+
+    palgo->VL53LX_p_039 = 0;
+    for (uint8_t lb = pbins->VL53LX_p_019; lb < nb; lb++) {
+      const uint8_t above = pbins->bin_data[lb] > palgo->VL53LX_p_052[lb];
+      palgo->VL53LX_p_040[lb] = above;
+      palgo->VL53LX_p_041[lb] = above;
+      palgo->VL53LX_p_039 += above;
+    }
+  }
+
+  // VL53LX_f_007: first rising edge of the event mask
+  static void find_start_(VL53LX_hist_gen3_algo_private_data_t *palgo, uint8_t nb, uint8_t ns) {
+    palgo->VL53LX_p_044 = 0;
+    for (uint8_t i = 0; i < ns; i++) {
+      const uint8_t j = (i + 1) % ns;
+      if (i < nb && j < nb && palgo->VL53LX_p_041[i] == 0 && palgo->VL53LX_p_041[j] == 1) {
+        palgo->VL53LX_p_044 = i;
+        return;
+      }
+    }
+  }
+
+  // VL53LX_f_008: number the pulses around the period
+  static void number_pulses_(VL53LX_hist_gen3_algo_private_data_t *palgo, uint8_t nb, uint8_t ns) {
+    const uint8_t start = palgo->VL53LX_p_044;
+    for (uint8_t lb = start; lb < (start + ns); lb++) {
+      const uint8_t i = lb % ns;
+      const uint8_t j = (lb + 1) % ns;
+      if (i < nb && j < nb) {
+        if (palgo->VL53LX_p_041[i] == 0 && palgo->VL53LX_p_041[j] == 1)
+          palgo->VL53LX_p_046++;
+        if (palgo->VL53LX_p_046 > palgo->VL53LX_p_045)
+          palgo->VL53LX_p_046 = palgo->VL53LX_p_045;
+        palgo->VL53LX_p_042[i] = palgo->VL53LX_p_041[i] > 0 ? palgo->VL53LX_p_046 : 0;
+      }
+    }
+  }
+
+  // VL53LX_f_009: start/end bins and filter width of each pulse
+  static void bound_pulses_(VL53LX_hist_gen3_algo_private_data_t *palgo, uint8_t nb, uint8_t ns) {
+    const uint8_t max_filter_half_width = (uint8_t) (ns - 1) >> 1;
+    const uint8_t start = palgo->VL53LX_p_044;
+    for (uint8_t blb = start; blb < (start + ns); blb++) {
+      const uint8_t i = blb % ns;
+      const uint8_t j = (blb + 1) % ns;
+      if (!(i < nb && j < nb))
+        continue;
+      if (palgo->VL53LX_p_042[i] == 0 && palgo->VL53LX_p_042[j] > 0) {
+        const uint8_t pulse_no = palgo->VL53LX_p_042[j] - 1;
+        if (pulse_no < palgo->VL53LX_p_045) {
+          VL53LX_hist_pulse_data_t *pdata = &palgo->VL53LX_p_003[pulse_no];
+          pdata->VL53LX_p_012 = blb;
+          pdata->VL53LX_p_019 = blb + 1;
+          pdata->VL53LX_p_023 = 0xFF;
+          pdata->VL53LX_p_024 = 0;
+          pdata->VL53LX_p_013 = 0;
+        }
+      }
+      if (palgo->VL53LX_p_042[i] > 0 && palgo->VL53LX_p_042[j] == 0) {
+        const uint8_t pulse_no = palgo->VL53LX_p_042[i] - 1;
+        if (pulse_no < palgo->VL53LX_p_045) {
+          VL53LX_hist_pulse_data_t *pdata = &palgo->VL53LX_p_003[pulse_no];
+          pdata->VL53LX_p_024 = blb;
+          pdata->VL53LX_p_013 = blb + 1;
+          pdata->VL53LX_p_025 = (pdata->VL53LX_p_024 + 1) - pdata->VL53LX_p_019;
+          pdata->VL53LX_p_051 = (pdata->VL53LX_p_013 + 1) - pdata->VL53LX_p_012;
+          if (pdata->VL53LX_p_051 > max_filter_half_width)
+            pdata->VL53LX_p_051 = max_filter_half_width;
+        }
+      }
+    }
+  }
+
+  // VL53LX_f_010: total and ambient events under a pulse
+  static void event_sums_(VL53LX_hist_pulse_data_t *pdata, const VL53LX_histogram_bin_data_t *pbins,
+                          const VL53LX_hist_gen3_algo_private_data_t *palgo, uint8_t ns) {
+    int32_t total = 0;
+    int32_t ambient = 0;
+    for (uint8_t lb = pdata->VL53LX_p_012; lb <= pdata->VL53LX_p_013; lb++) {
+      total += pbins->bin_data[lb % ns];
+      ambient += palgo->VL53LX_p_028;
+    }
+    pdata->VL53LX_p_017 = total;
+    pdata->VL53LX_p_016 = ambient;
+    pdata->VL53LX_p_010 = total - ambient;
+  }
+
+  // VL53LX_f_011: copy of pbins with the bins outside the pulse padded.
+  // Without full_copy only the bin data is refreshed.
+  static void pulse_histogram_(const VL53LX_hist_pulse_data_t *pdata, const VL53LX_histogram_bin_data_t *pbins,
+                               const VL53LX_hist_gen3_algo_private_data_t *palgo, int32_t pad_value,
+                               VL53LX_histogram_bin_data_t *ppulse, bool full_copy, uint8_t nb, uint8_t ns) {
+    if (full_copy)
+      memcpy(ppulse, pbins, sizeof(VL53LX_histogram_bin_data_t));
+    else
+      memcpy(ppulse->bin_data, pbins->bin_data, sizeof(ppulse->bin_data));
+    const uint8_t start = palgo->VL53LX_p_044;
+    for (uint8_t lb = start; lb < (start + ns); lb++) {
+      if (lb < pdata->VL53LX_p_012 || lb > pdata->VL53LX_p_013) {
+        const uint8_t i = lb % ns;
+        if (i < nb)
+          ppulse->bin_data[i] = pad_value;
+      }
+    }
+  }
+
+  // VL53LX_f_026: a/b/c filter outputs and their differences over the pulse
+  static void filter_(const VL53LX_hist_pulse_data_t *pdata, const VL53LX_histogram_bin_data_t *ppulse,
+                      const VL53LX_hist_gen3_algo_private_data_t *palgo,
+                      VL53LX_hist_gen4_algo_filtered_data_t *pfiltered, uint8_t nb, uint8_t ns) {
+    pfiltered->VL53LX_p_020 = palgo->VL53LX_p_020;
+    pfiltered->VL53LX_p_019 = palgo->VL53LX_p_019;
+    pfiltered->VL53LX_p_021 = palgo->VL53LX_p_021;
+    const int32_t amb = palgo->VL53LX_p_028;
+    for (uint8_t lb = pdata->VL53LX_p_012; lb <= pdata->VL53LX_p_013; lb++) {
+      const uint8_t i = lb % ns;
+      int32_t suma, sumb, sumc;
+      window_sums_(i, pdata->VL53LX_p_051, ppulse, nb, &suma, &sumb, &sumc);
+      pfiltered->VL53LX_p_007[i] = suma;
+      pfiltered->VL53LX_p_032[i] = sumb;
+      pfiltered->VL53LX_p_001[i] = sumc;
+      pfiltered->VL53LX_p_053[i] = (suma + sumb) - (sumc + amb);
+      pfiltered->VL53LX_p_054[i] = (sumb + sumc) - (suma + amb);
+    }
+  }
+
+  // VL53LX_f_027: zero crossings of the filter differences, with the phase
+  // of the last one kept for the pulse
+  static void detect_(VL53LX_hist_pulse_data_t *pdata, VL53LX_hist_gen4_algo_filtered_data_t *pfiltered,
+                      const VL53LX_hist_gen3_algo_private_data_t *palgo, uint8_t nb, uint8_t ns) {
+    for (uint8_t lb = pdata->VL53LX_p_012; lb < pdata->VL53LX_p_013; lb++) {
+      const uint8_t i = lb % ns;
+      const uint8_t j = (lb + 1) % ns;
+      if (!(i < nb && j < nb))
+        continue;
+      const int32_t d0 = pfiltered->VL53LX_p_053[i];
+      const int32_t d1 = pfiltered->VL53LX_p_054[i];
+      uint8_t hit;
+      if (d0 == 0 && d1 == 0)
+        hit = 0;
+      else if (d0 >= 0 && d1 >= 0)
+        hit = 1;
+      else
+        hit = d0 < 0 && d1 >= 0 && pfiltered->VL53LX_p_053[j] >= 0 && pfiltered->VL53LX_p_054[j] < 0;
+      pfiltered->VL53LX_p_040[i] = hit;
+      if (hit) {
+        pdata->VL53LX_p_023 = lb;
+        if (VL53LX_f_028(lb, pfiltered->VL53LX_p_007[i], pfiltered->VL53LX_p_032[i], pfiltered->VL53LX_p_001[i], 0, 0,
+                         0, palgo->VL53LX_p_028, palgo->VL53LX_p_030,
+                         &pdata->VL53LX_p_011) == VL53LX_ERROR_DIVISION_BY_ZERO)
+          pfiltered->VL53LX_p_040[i] = 0;
+      }
+    }
+  }
+
+  // VL53LX_f_014: sigma estimate of the pulse peak
+  static void sigma_(uint8_t bin, uint8_t sigma_ref_mm, uint8_t woi, uint8_t xtalk_enable,
+                     const VL53LX_histogram_bin_data_t *pap, const VL53LX_histogram_bin_data_t *pzp,
+                     const VL53LX_histogram_bin_data_t *pxtalk, uint16_t *psigma_est, uint8_t nb, uint8_t ns) {
+    if (ns == 0) {
+      *psigma_est = 0xFFFF;
+      return;
+    }
+    const uint8_t i = bin % ns;
+    int32_t a, b, c, a_zp, c_zp;
+    int32_t ax = 0;
+    int32_t bx = 0;
+    int32_t cx = 0;
+    window_sums_(i, woi, pzp, nb, &a_zp, &b, &c_zp);
+    window_sums_(i, woi, pap, nb, &a, &b, &c);
+    if (xtalk_enable > 0)
+      window_sums_(i, woi, pxtalk, bins_(pxtalk), &ax, &bx, &cx);
+    if (VL53LX_f_023(sigma_ref_mm, (uint32_t) a, (uint32_t) b, (uint32_t) c, (uint32_t) a_zp, (uint32_t) c_zp,
+                     (uint32_t) bx, (uint32_t) ax, (uint32_t) cx, (uint32_t) pap->VL53LX_p_028, pap->VL53LX_p_015,
+                     psigma_est) == VL53LX_ERROR_DIVISION_BY_ZERO)
+      *psigma_est = 0xFFFF;
+  }
+
+  // VL53LX_f_020: event-weighted mean phase of bins [first, last]
+  static uint32_t mean_phase_(int16_t first, int16_t last, uint8_t clip_events, const VL53LX_histogram_bin_data_t *pbins,
+                              uint8_t ns) {
+    int64_t event_sum = 0;
+    int64_t weighted_sum = 0;
+    for (int16_t lb = first; lb <= last; lb++) {
+      const int16_t i = lb < 0 ? (int16_t) (lb + (int16_t) ns) : (int16_t) (lb % (int16_t) ns);
+      if (i < 0 || i >= VL53LX_HISTOGRAM_BUFFER_SIZE)
+        continue;
+      int64_t events = (int64_t) pbins->bin_data[i] - (int64_t) pbins->VL53LX_p_028;
+      if (clip_events > 0 && events < 0)
+        events = 0;
+      event_sum += events;
+      weighted_sum += events * (1024 + (2048 * (int64_t) lb));
+    }
+    if (event_sum <= 0)
+      return VL53LX_MAX_ALLOWED_PHASE;
+    weighted_sum += event_sum / 2;
+    weighted_sum /= event_sum;
+    return weighted_sum < 0 ? 0 : (uint32_t) weighted_sum;
+  }
+
+  // VL53LX_f_015: phase window around the pulse peak
+  static void phase_window_(VL53LX_hist_pulse_data_t *pdata, uint8_t clip_events,
+                            const VL53LX_histogram_bin_data_t *pbins, uint8_t ns) {
+    if (pdata->VL53LX_p_023 == 0xFF)
+      pdata->VL53LX_p_023 = 1;
+    const uint8_t i = pdata->VL53LX_p_023 % ns;
+    const int16_t first = (int16_t) i + (int16_t) pdata->VL53LX_p_012 - (int16_t) pdata->VL53LX_p_023;
+    const int16_t last = (int16_t) i + (int16_t) pdata->VL53LX_p_013 - (int16_t) pdata->VL53LX_p_023;
+    int16_t window_width = last - first;
+    if (window_width > 3)
+      window_width = 3;
+
+    pdata->VL53LX_p_026 = mean_phase_(first, first + window_width, clip_events, pbins, ns);
+    pdata->VL53LX_p_027 = mean_phase_(last - window_width, last, clip_events, pbins, ns);
+    if (pdata->VL53LX_p_026 > pdata->VL53LX_p_027) {
+      const uint32_t tmp_phase = pdata->VL53LX_p_026;
+      pdata->VL53LX_p_026 = pdata->VL53LX_p_027;
+      pdata->VL53LX_p_027 = tmp_phase;
+    }
+    if (pdata->VL53LX_p_011 < pdata->VL53LX_p_026)
+      pdata->VL53LX_p_026 = pdata->VL53LX_p_011;
+    if (pdata->VL53LX_p_011 > pdata->VL53LX_p_027)
+      pdata->VL53LX_p_027 = pdata->VL53LX_p_011;
+  }
+};
+
+// VL53LX_f_025 through the specialisation for the frame's shape. Every
+// preset's averaged frame has as many bins, once its ambient bins are
+// removed, as its VCSEL period has slots: 8 and 12 in short mode, 12 and 16
+// in medium mode, 20 and 24 in long mode (phase A and B). Other shapes keep
+// the C pipeline.
+inline VL53LX_Error hist_gen4_process(VL53LX_dmax_calibration_data_t *pdmax_cal,
+                                      VL53LX_hist_gen3_dmax_config_t *pdmax_cfg,
+                                      VL53LX_hist_post_process_config_t *ppost_cfg,
+                                      VL53LX_histogram_bin_data_t *pbins, VL53LX_histogram_bin_data_t *pxtalk,
+                                      VL53LX_hist_gen3_algo_private_data_t *palgo,
+                                      VL53LX_hist_gen4_algo_filtered_data_t *pfiltered,
+                                      VL53LX_hist_gen3_dmax_private_data_t *pdmax_algo,
+                                      VL53LX_dmax_cache_t *pdmax_cache, VL53LX_range_results_t *presults,
+                                      uint8_t histo_merge_nb) {
+  // Bins left once hist_estimate_and_remove_ambient has dropped the ambient bins
+  const uint8_t bins = pbins->VL53LX_p_021 - pbins->number_of_ambient_bins;
+  const uint8_t slots = VL53LX_decode_vcsel_period(pbins->VL53LX_p_005);
+  if (pbins->number_of_ambient_bins <= pbins->VL53LX_p_021 && bins == slots) {
+    switch (bins) {
+      case 8:
+        return HistGen4Pipeline<8, 8>::process(pdmax_cal, pdmax_cfg, ppost_cfg, pbins, pxtalk, palgo, pfiltered,
+                                               pdmax_algo, pdmax_cache, presults, histo_merge_nb);
+      case 12:
+        return HistGen4Pipeline<12, 12>::process(pdmax_cal, pdmax_cfg, ppost_cfg, pbins, pxtalk, palgo, pfiltered,
+                                                 pdmax_algo, pdmax_cache, presults, histo_merge_nb);
+      case 16:
+        return HistGen4Pipeline<16, 16>::process(pdmax_cal, pdmax_cfg, ppost_cfg, pbins, pxtalk, palgo, pfiltered,
+                                                 pdmax_algo, pdmax_cache, presults, histo_merge_nb);
+      case 20:
+        return HistGen4Pipeline<20, 20>::process(pdmax_cal, pdmax_cfg, ppost_cfg, pbins, pxtalk, palgo, pfiltered,
+                                                 pdmax_algo, pdmax_cache, presults, histo_merge_nb);
+      case 24:
+        return HistGen4Pipeline<24, 24>::process(pdmax_cal, pdmax_cfg, ppost_cfg, pbins, pxtalk, palgo, pfiltered,
+                                                 pdmax_algo, pdmax_cache, presults, histo_merge_nb);
+      default:
+        break;
+    }
+  }
+  return VL53LX_f_025(pdmax_cal, pdmax_cfg, ppost_cfg, pbins, pxtalk, palgo, pfiltered, pdmax_algo, pdmax_cache,
+                      presults, histo_merge_nb);
+}
+
+}  // namespace vl53l3cx
+}  // namespace esphome
@@ -0,0 +1,59 @@
+#include "publish_policy.h"
+
+namespace esphome {
+namespace vl53l3cx {
+
+void PublishPolicy::configure(uint16_t deadband_mm, uint32_t min_interval_us, uint32_t max_interval_us,
+                              bool on_status_change) {
+  this->configured_ = true;
+  this->deadband_mm_ = (int32_t) deadband_mm << 16;
+  this->min_interval_us_ = min_interval_us;
+  this->max_interval_us_ = max_interval_us;
+  this->on_status_change_ = on_status_change;
+  this->reset();
+}
+
+void PublishPolicy::reset() {
+  this->has_published_ = false;
+  this->last_was_range_ = false;
+}
+
+bool PublishPolicy::check_range(int32_t range_mm, uint8_t range_status, uint64_t now_us) {
+  bool publish;
+  const uint64_t elapsed_us = now_us - this->last_publish_us_;
+  if (!this->has_published_ || !this->last_was_range_) {
+    // First range, or the first one after a published loss
+    publish = true;
+  } else if (this->on_status_change_ && range_status != this->last_status_) {
+    // Status changes bypass the deadband and the minimum interval
+    publish = true;
+  } else if (elapsed_us < this->min_interval_us_) {
+    publish = false;
+  } else {
+    const int32_t diff = range_mm - this->last_range_mm_;
+    publish = (diff < 0 ? -diff : diff) >= this->deadband_mm_ ||
+              (this->max_interval_us_ != 0 && elapsed_us >= this->max_interval_us_);
+  }
+
+  if (publish) {
+    this->has_published_ = true;
+    this->last_was_range_ = true;
+    this->last_range_mm_ = range_mm;
+    this->last_status_ = range_status;
+    this->last_publish_us_ = now_us;
+  }
+  return publish;
+}
+
+bool PublishPolicy::check_lost(uint8_t range_status, uint64_t now_us) {
+  if (!this->on_status_change_ || !this->has_published_ || !this->last_was_range_) {
+    return false;
+  }
+  this->last_was_range_ = false;
+  this->last_status_ = range_status;
+  this->last_publish_us_ = now_us;
+  return true;
+}
+
+}  // namespace vl53l3cx
+}  // namespace esphome
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+
+namespace esphome {
+namespace vl53l3cx {
+
+// Per-slot publish gate run on the filtered range (mm, 16.16) before it is
+// converted to a float state. Defaults publish every frame, as before.
+class PublishPolicy {
+ public:
+  // deadband_mm: minimum change worth publishing. min/max interval in µs, 0 = off.
+  void configure(uint16_t deadband_mm, uint32_t min_interval_us, uint32_t max_interval_us, bool on_status_change);
+  bool is_configured() const { return this->configured_; }
+  void reset();
+
+  // A publishable range for the slot. Returns true (and records it) when it should be published.
+  bool check_range(int32_t range_mm, uint8_t range_status, uint64_t now_us);
+  // The slot has no publishable range this frame. Returns true when the slot
+  // should publish NaN once, i.e. on_status_change is set and a range was
+  // published last.
+  bool check_lost(uint8_t range_status, uint64_t now_us);
+
+  uint16_t get_deadband_mm() const { return (uint16_t)(this->deadband_mm_ >> 16); }
+  uint32_t get_min_interval_us() const { return this->min_interval_us_; }
+  uint32_t get_max_interval_us() const { return this->max_interval_us_; }
+  bool get_on_status_change() const { return this->on_status_change_; }
+
+ protected:
+  bool configured_{false};
+  int32_t deadband_mm_{0};  // 16.16
+  uint32_t min_interval_us_{0};
+  uint32_t max_interval_us_{0};
+  bool on_status_change_{false};
+
+  // Last published state
+  bool has_published_{false};
+  bool last_was_range_{false};
+  int32_t last_range_mm_{0};  // 16.16
+  uint8_t last_status_{0};
+  uint64_t last_publish_us_{0};
+};
+
+}  // namespace vl53l3cx
+}  // namespace esphome
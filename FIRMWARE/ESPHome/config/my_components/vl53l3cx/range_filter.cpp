@@ -0,0 +1,142 @@
+#include "range_filter.h"
+#include <algorithm>
+
+namespace esphome {
+namespace vl53l3cx {
+
+// One-euro cutoffs are clamped to this, which also bounds the 64-bit products below
+static const uint32_t MAX_CUTOFF_UHZ = 100000000;  // 100 Hz
+
+// Smoothing factor of a first-order low-pass at cutoff fc sampled after dt,
+// alpha = 1 / (1 + tau/dt) with tau = 1/(2*pi*fc), in 0.16.
+static uint32_t low_pass_alpha(uint32_t cutoff_uhz, uint32_t dt_us) {
+  // 2*pi*fc*dt, scaled by 1e12 (µHz * µs)
+  const uint64_t r = (uint64_t) cutoff_uhz * dt_us * 6283 / 1000;
+  return 65536u - (uint32_t)((65536ull * 1000000000000ull) / (r + 1000000000000ull));
+}
+
+void RangeFilter::configure_median(uint8_t window) {
+  this->type_ = RANGE_FILTER_MEDIAN;
+  this->window_size_ = std::max<uint8_t>(1, std::min<uint8_t>(window, MAX_MEDIAN_WINDOW));
+  this->reset();
+}
+
+void RangeFilter::configure_one_euro(float min_cutoff_hz, float beta, float d_cutoff_hz) {
+  this->type_ = RANGE_FILTER_ONE_EURO;
+  this->min_cutoff_uhz_ = std::min<uint32_t>((uint32_t)(min_cutoff_hz * 1e6f), MAX_CUTOFF_UHZ);
+  // Hz per m/s -> µHz per mm/s
+  this->beta_uhz_per_mmps_ = (uint32_t)(beta * 1000.0f);
+  this->d_cutoff_uhz_ = std::min<uint32_t>((uint32_t)(d_cutoff_hz * 1e6f), MAX_CUTOFF_UHZ);
+  this->reset();
+}
+
+void RangeFilter::configure_kalman(float process_noise) {
+  this->type_ = RANGE_FILTER_KALMAN;
+  this->process_noise_q_ = (uint64_t)(process_noise * process_noise * 65536.0f);
+  this->reset();
+}
+
+int32_t RangeFilter::update(int16_t range_mm, FixPoint1616_t sigma_mm, uint64_t timestamp_us) {
+  if (this->type_ == RANGE_FILTER_NONE) {
+    return (int32_t) range_mm << 16;
+  }
+
+  uint64_t dt_us = timestamp_us - this->last_timestamp_us_;
+  const int32_t jump_mm = (int32_t) range_mm - this->last_range_mm_;
+  if (this->count_ > 0 && (dt_us > RESET_GAP_US || jump_mm > RESET_JUMP_MM || jump_mm < -RESET_JUMP_MM)) {
+    this->reset();
+  }
+  this->last_timestamp_us_ = timestamp_us;
+  this->last_range_mm_ = range_mm;
+  if (dt_us == 0) {
+    dt_us = 1;
+  }
+
+  int32_t filtered;
+  switch (this->type_) {
+    case RANGE_FILTER_MEDIAN:
+      filtered = this->update_median_(range_mm);
+      break;
+    case RANGE_FILTER_ONE_EURO:
+      filtered = this->update_one_euro_((int32_t) range_mm << 16, (uint32_t) dt_us);
+      break;
+    case RANGE_FILTER_KALMAN:
+      filtered = this->update_kalman_((int32_t) range_mm << 16, sigma_mm, (uint32_t) dt_us);
+      break;
+    default:
+      filtered = (int32_t) range_mm << 16;
+      break;
+  }
+  if (this->count_ < UINT8_MAX) {
+    this->count_++;
+  }
+  return filtered;
+}
+
+int32_t RangeFilter::update_median_(int16_t range_mm) {
+  if (this->count_ == 0) {
+    this->window_head_ = 0;
+  }
+  this->window_[this->window_head_] = range_mm;
+  this->window_head_ = (this->window_head_ + 1) % this->window_size_;
+
+  // Insertion sort of a copy; at most MAX_MEDIAN_WINDOW entries
+  const uint8_t n = std::min<uint8_t>(this->count_ + 1, this->window_size_);
+  std::array<int16_t, MAX_MEDIAN_WINDOW> sorted;
+  for (uint8_t i = 0; i < n; i++) {
+    int16_t value = this->window_[i];
+    uint8_t j = i;
+    while (j > 0 && sorted[j - 1] > value) {
+      sorted[j] = sorted[j - 1];
+      j--;
+    }
+    sorted[j] = value;
+  }
+  return (int32_t) sorted[n / 2] << 16;
+}
+
+int32_t RangeFilter::update_one_euro_(int32_t x, uint32_t dt_us) {
+  if (this->count_ == 0) {
+    this->x_hat_ = x;
+    this->dx_hat_ = 0;
+    return x;
+  }
+
+  // Low-passed speed of the signal (mm/s, 16.16)
+  const int64_t dx = (int64_t)(x - this->x_hat_) * 1000000 / dt_us;
+  const uint32_t alpha_d = low_pass_alpha(this->d_cutoff_uhz_, dt_us);
+  this->dx_hat_ += ((dx - this->dx_hat_) * alpha_d) >> 16;
+
+  // Cutoff rises with speed: little lag when moving, strong smoothing when still
+  const uint64_t speed_mmps = (uint64_t)(this->dx_hat_ < 0 ? -this->dx_hat_ : this->dx_hat_) >> 16;
+  const uint64_t cutoff_uhz = this->min_cutoff_uhz_ + speed_mmps * this->beta_uhz_per_mmps_;
+  const uint32_t alpha = low_pass_alpha((uint32_t) std::min<uint64_t>(cutoff_uhz, MAX_CUTOFF_UHZ), dt_us);
+  this->x_hat_ += (int32_t)(((int64_t)(x - this->x_hat_) * alpha) >> 16);
+  return this->x_hat_;
+}
+
+int32_t RangeFilter::update_kalman_(int32_t z, FixPoint1616_t sigma_mm, uint32_t dt_us) {
+  // Measurement noise from the driver's per-target sigma estimate (mm^2, 16.16)
+  uint64_t r = ((uint64_t) sigma_mm * sigma_mm) >> 16;
+  if (r < 65536) {
+    r = 65536;  // Floor at 1 mm^2
+  }
+
+  if (this->count_ == 0) {
+    this->x_hat_ = z;
+    this->p_ = r;
+    return z;
+  }
+
+  // Predict: random walk, variance grows linearly with time
+  this->p_ += this->process_noise_q_ * dt_us / 1000000;
+
+  // Update
+  const uint64_t gain = (this->p_ << 16) / (this->p_ + r);  // 0.16
+  this->x_hat_ += (int32_t)(((int64_t)(z - this->x_hat_) * (int64_t) gain) >> 16);
+  this->p_ = (this->p_ * (65536 - gain)) >> 16;
+  return this->x_hat_;
+}
+
+}  // namespace vl53l3cx
+}  // namespace esphome
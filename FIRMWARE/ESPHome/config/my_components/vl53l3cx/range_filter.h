@@ -0,0 +1,73 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+extern "C" {
+#include "vl53lx_types.h"
+}
+
+namespace esphome {
+namespace vl53l3cx {
+
+enum RangeFilterType : uint8_t {
+  RANGE_FILTER_NONE = 0,
+  RANGE_FILTER_MEDIAN = 1,    // Median of the last N ranges
+  RANGE_FILTER_ONE_EURO = 2,  // Speed-adaptive low-pass (Casiez et al.)
+  RANGE_FILTER_KALMAN = 3,    // 1-D random-walk Kalman, per-target sigma as measurement noise
+};
+
+// Per-target smoothing stage run on raw driver ranges before publishing.
+// All state is fixed-size and the arithmetic is integer-only: ranges are
+// carried as mm in 16.16, like the driver's sigma and rate fields.
+class RangeFilter {
+ public:
+  static const uint8_t MAX_MEDIAN_WINDOW = 9;
+  // Gap after which the filter restarts from the next range
+  static const uint32_t RESET_GAP_US = 1000000;
+  // Jump between two raw ranges after which the filter restarts: without
+  // tracking a slot holds whichever object is n-th nearest, and a filter that
+  // blended two objects would publish ranges where neither is
+  static const int16_t RESET_JUMP_MM = 300;
+
+  void configure_median(uint8_t window);
+  // min_cutoff/d_cutoff in Hz, beta in Hz per m/s
+  void configure_one_euro(float min_cutoff_hz, float beta, float d_cutoff_hz);
+  // Random-walk process noise in mm/sqrt(s)
+  void configure_kalman(float process_noise);
+
+  RangeFilterType get_type() const { return this->type_; }
+  void reset() { this->count_ = 0; }
+
+  // Feed one range and return the filtered range (mm, 16.16)
+  int32_t update(int16_t range_mm, FixPoint1616_t sigma_mm, uint64_t timestamp_us);
+
+ protected:
+  int32_t update_median_(int16_t range_mm);
+  int32_t update_one_euro_(int32_t x, uint32_t dt_us);
+  int32_t update_kalman_(int32_t z, FixPoint1616_t sigma_mm, uint32_t dt_us);
+
+  RangeFilterType type_{RANGE_FILTER_NONE};
+  uint8_t count_{0};  // Samples since the last reset (saturates)
+  uint64_t last_timestamp_us_{0};
+  int16_t last_range_mm_{0};  // Raw
+
+  // Median: ring buffer of raw ranges
+  std::array<int16_t, MAX_MEDIAN_WINDOW> window_{};
+  uint8_t window_size_{5};
+  uint8_t window_head_{0};
+
+  // One-euro: cutoffs in µHz, beta in µHz per mm/s
+  uint32_t min_cutoff_uhz_{1000000};
+  uint32_t beta_uhz_per_mmps_{0};
+  uint32_t d_cutoff_uhz_{1000000};
+  int32_t x_hat_{0};   // mm, 16.16
+  int64_t dx_hat_{0};  // mm/s, 16.16
+
+  // Kalman: variances in mm^2, 16.16
+  uint64_t process_noise_q_{0};  // Variance growth per second
+  uint64_t p_{0};
+};
+
+}  // namespace vl53l3cx
+}  // namespace esphome
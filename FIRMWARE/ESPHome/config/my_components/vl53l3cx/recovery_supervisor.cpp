@@ -0,0 +1,72 @@
+#include "recovery_supervisor.h"
+#include <algorithm>
+
+namespace esphome {
+namespace vl53l3cx {
+
+void RecoverySupervisor::report_fault(uint64_t now_us, RecoveryStage first_stage) {
+  if (this->stage_ != RECOVERY_NONE || first_stage == RECOVERY_NONE) {
+    return;
+  }
+  // The first step runs immediately; back-off only starts once it fails
+  this->stage_ = first_stage;
+  this->verifying_ = false;
+  this->fault_start_us_ = now_us;
+  this->next_attempt_us_ = now_us;
+  this->backoff_us_ = this->initial_backoff_us_;
+  this->attempts_ = 0;
+}
+
+RecoveryStage RecoverySupervisor::poll(uint64_t now_us) {
+  if (this->stage_ == RECOVERY_NONE) {
+    return RECOVERY_NONE;
+  }
+  if (this->verifying_) {
+    if (now_us < this->verify_deadline_us_) {
+      return RECOVERY_NONE;
+    }
+    // The action reported success but the sensor still produces nothing
+    this->verifying_ = false;
+    this->escalate_(now_us);
+    return RECOVERY_NONE;
+  }
+  if (now_us < this->next_attempt_us_) {
+    return RECOVERY_NONE;
+  }
+  this->attempts_++;
+  return this->stage_;
+}
+
+void RecoverySupervisor::report_action(bool ok, uint64_t now_us) {
+  if (this->stage_ == RECOVERY_NONE) {
+    return;
+  }
+  if (ok) {
+    this->verifying_ = true;
+    this->verify_deadline_us_ = now_us + this->verify_timeout_us_;
+  } else {
+    this->escalate_(now_us);
+  }
+}
+
+bool RecoverySupervisor::report_frame(uint64_t now_us) {
+  if (this->stage_ == RECOVERY_NONE) {
+    return false;
+  }
+  this->stage_ = RECOVERY_NONE;
+  this->verifying_ = false;
+  this->recoveries_++;
+  this->last_recovery_us_ = (uint32_t) std::min<uint64_t>(now_us - this->fault_start_us_, UINT32_MAX);
+  return true;
+}
+
+void RecoverySupervisor::escalate_(uint64_t now_us) {
+  if (this->stage_ < RECOVERY_REINIT) {
+    this->stage_ = (RecoveryStage)(this->stage_ + 1);
+  }
+  this->next_attempt_us_ = now_us + this->backoff_us_;
+  this->backoff_us_ = (uint32_t) std::min<uint64_t>((uint64_t) this->backoff_us_ * 2, this->max_backoff_us_);
+}
+
+}  // namespace vl53l3cx
+}  // namespace esphome
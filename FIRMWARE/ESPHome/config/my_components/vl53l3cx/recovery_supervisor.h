@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+
+namespace esphome {
+namespace vl53l3cx {
+
+enum RecoveryStage : uint8_t {
+  RECOVERY_NONE = 0,          // Healthy
+  RECOVERY_SOFT_RESTART = 1,  // Stop/start ranging
+  RECOVERY_HARD_RESET = 2,    // XSHUT reset, boot and re-init with cached calibration
+  RECOVERY_REINIT = 3,        // Fresh driver state, reset, boot and re-init; repeated until it works
+};
+
+// Escalation and back-off policy for a faulted sensor. The hub reports
+// faults and frames and runs whatever stage poll() hands out; an action
+// only counts as a recovery once a frame arrives within the verify timeout.
+class RecoverySupervisor {
+ public:
+  void set_backoff(uint32_t initial_us, uint32_t max_us) {
+    this->initial_backoff_us_ = initial_us;
+    this->max_backoff_us_ = max_us;
+  }
+  void set_verify_timeout(uint32_t timeout_us) { this->verify_timeout_us_ = timeout_us; }
+
+  // Enter recovery at first_stage (no-op while already recovering)
+  void report_fault(uint64_t now_us, RecoveryStage first_stage = RECOVERY_SOFT_RESTART);
+  // Stage to run now, RECOVERY_NONE while healthy, backing off or verifying
+  RecoveryStage poll(uint64_t now_us);
+  // Outcome of the stage handed out by the last poll()
+  void report_action(bool ok, uint64_t now_us);
+  // A good frame arrived. Returns true when it completes a recovery.
+  bool report_frame(uint64_t now_us);
+
+  bool is_healthy() const { return this->stage_ == RECOVERY_NONE; }
+  RecoveryStage get_stage() const { return this->stage_; }
+  uint32_t get_recoveries() const { return this->recoveries_; }
+  uint32_t get_attempts() const { return this->attempts_; }  // Actions run in the current fault
+  uint32_t get_last_recovery_us() const { return this->last_recovery_us_; }  // Fault -> first good frame
+
+ protected:
+  void escalate_(uint64_t now_us);
+
+  uint32_t initial_backoff_us_{1000000};
+  uint32_t max_backoff_us_{300000000};
+  uint32_t verify_timeout_us_{2000000};
+
+  RecoveryStage stage_{RECOVERY_NONE};
+  bool verifying_{false};
+  uint64_t fault_start_us_{0};
+  uint64_t next_attempt_us_{0};
+  uint64_t verify_deadline_us_{0};
+  uint32_t backoff_us_{0};
+  uint32_t attempts_{0};
+  uint32_t recoveries_{0};
+  uint32_t last_recovery_us_{0};
+};
+
+}  // namespace vl53l3cx
+}  // namespace esphome
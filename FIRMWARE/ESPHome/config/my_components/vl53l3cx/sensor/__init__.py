@@ -5,6 +5,7 @@ import esphome.config_validation as cv
 from esphome.components import sensor
 from esphome.const import (
     CONF_ID,
+    CONF_TYPE,
     DEVICE_CLASS_DISTANCE,
     STATE_CLASS_MEASUREMENT,
     UNIT_METER,
@@ -15,10 +16,67 @@ from .. import vl53l3cx_ns, VL53L3CXComponent, CONF_VL53L3CX_ID
 DEPENDENCIES = ["vl53l3cx"]
 
 CONF_TARGET_NUMBER = "target_number"
+CONF_RANGE_FILTER = "range_filter"
+CONF_WINDOW_SIZE = "window_size"
+CONF_MIN_CUTOFF = "min_cutoff"
+CONF_BETA = "beta"
+CONF_DERIVATIVE_CUTOFF = "derivative_cutoff"
+CONF_PROCESS_NOISE = "process_noise"
+CONF_VELOCITY = "velocity"
+CONF_DEADBAND = "deadband"
+CONF_MIN_PUBLISH_INTERVAL = "min_publish_interval"
+CONF_MAX_PUBLISH_INTERVAL = "max_publish_interval"
+CONF_PUBLISH_ON_STATUS_CHANGE = "publish_on_status_change"
+
+PUBLISH_POLICY_KEYS = (
+    CONF_DEADBAND,
+    CONF_MIN_PUBLISH_INTERVAL,
+    CONF_MAX_PUBLISH_INTERVAL,
+    CONF_PUBLISH_ON_STATUS_CHANGE,
+)
+
+# Smoothing applied by the hub on raw ranges, before ESPHome's own filters
+RANGE_FILTER_SCHEMA = cv.typed_schema(
+    {
+        "MEDIAN": cv.Schema(
+            {
+                # Must stay <= RangeFilter::MAX_MEDIAN_WINDOW
+                cv.Optional(CONF_WINDOW_SIZE, default=5): cv.int_range(min=3, max=9),
+            }
+        ),
+        "ONE_EURO": cv.Schema(
+            {
+                cv.Optional(CONF_MIN_CUTOFF, default=0.5): cv.float_range(min=0.01, max=50.0),
+                # Hz of extra cutoff per m/s of target speed
+                cv.Optional(CONF_BETA, default=0.5): cv.float_range(min=0.0, max=100.0),
+                cv.Optional(CONF_DERIVATIVE_CUTOFF, default=1.0): cv.float_range(min=0.01, max=50.0),
+            }
+        ),
+        "KALMAN": cv.Schema(
+            {
+                # Random-walk process noise, mm/sqrt(s)
+                cv.Optional(CONF_PROCESS_NOISE, default=30.0): cv.float_range(min=0.1, max=10000.0),
+            }
+        ),
+    },
+    upper=True,
+    key=CONF_TYPE,
+)
 
 VL53L3CXSensor = vl53l3cx_ns.class_("VL53L3CXSensor", sensor.Sensor, cg.Component)
 
-CONFIG_SCHEMA = (
+
+def _validate_publish_intervals(config):
+    min_interval = config.get(CONF_MIN_PUBLISH_INTERVAL)
+    max_interval = config.get(CONF_MAX_PUBLISH_INTERVAL)
+    if min_interval is not None and max_interval is not None and max_interval < min_interval:
+        raise cv.Invalid(
+            f"{CONF_MAX_PUBLISH_INTERVAL} must not be shorter than {CONF_MIN_PUBLISH_INTERVAL}"
+        )
+    return config
+
+
+CONFIG_SCHEMA = cv.All(
     sensor.sensor_schema(
         VL53L3CXSensor,
         unit_of_measurement=UNIT_METER,
@@ -30,9 +88,24 @@ CONFIG_SCHEMA = (
         {
             cv.GenerateID(CONF_VL53L3CX_ID): cv.use_id(VL53L3CXComponent),
             cv.Optional(CONF_TARGET_NUMBER, default=0): cv.int_range(min=0, max=3),
+            cv.Optional(CONF_RANGE_FILTER): RANGE_FILTER_SCHEMA,
+            # Radial velocity of the tracked target (needs hub `tracking`), positive = receding
+            cv.Optional(CONF_VELOCITY): sensor.sensor_schema(
+                unit_of_measurement="m/s",
+                accuracy_decimals=2,
+                state_class=STATE_CLASS_MEASUREMENT,
+                icon="mdi:speedometer",
+            ),
+            # Publish gate applied by the hub on the filtered range, before float conversion
+            cv.Optional(CONF_DEADBAND): cv.All(cv.distance, cv.float_range(min=0.0, max=1.0)),
+            cv.Optional(CONF_MIN_PUBLISH_INTERVAL): cv.positive_time_period_milliseconds,
+            # Heartbeat: republish an unchanged range after this long
+            cv.Optional(CONF_MAX_PUBLISH_INTERVAL): cv.positive_time_period_milliseconds,
+            cv.Optional(CONF_PUBLISH_ON_STATUS_CHANGE): cv.boolean,
         }
     )
-    .extend(cv.COMPONENT_SCHEMA)
+    .extend(cv.COMPONENT_SCHEMA),
+    _validate_publish_intervals,
 )
 
 
@@ -44,4 +117,38 @@ async def to_code(config):
 
     # Get the parent component and register with cast to base class
     hub = await cg.get_variable(config[CONF_VL53L3CX_ID])
-    cg.add(hub.register_distance_sensor(cg.RawExpression(f"static_cast<esphome::vl53l3cx::VL53L3CXSensorBase*>({var})"), config[CONF_TARGET_NUMBER]))
\ No newline at end of file
+    cg.add(hub.register_distance_sensor(cg.RawExpression(f"static_cast<esphome::vl53l3cx::VL53L3CXSensorBase*>({var})"), config[CONF_TARGET_NUMBER]))
+
+    if CONF_RANGE_FILTER in config:
+        conf = config[CONF_RANGE_FILTER]
+        target = config[CONF_TARGET_NUMBER]
+        if conf[CONF_TYPE] == "MEDIAN":
+            cg.add(hub.set_median_filter(target, conf[CONF_WINDOW_SIZE]))
+        elif conf[CONF_TYPE] == "ONE_EURO":
+            cg.add(
+                hub.set_one_euro_filter(
+                    target,
+                    conf[CONF_MIN_CUTOFF],
+                    conf[CONF_BETA],
+                    conf[CONF_DERIVATIVE_CUTOFF],
+                )
+            )
+        else:
+            cg.add(hub.set_kalman_filter(target, conf[CONF_PROCESS_NOISE]))
+
+    if any(key in config for key in PUBLISH_POLICY_KEYS):
+        min_interval = config.get(CONF_MIN_PUBLISH_INTERVAL)
+        max_interval = config.get(CONF_MAX_PUBLISH_INTERVAL)
+        cg.add(
+            hub.set_publish_policy(
+                config[CONF_TARGET_NUMBER],
+                int(round(config.get(CONF_DEADBAND, 0.0) * 1000)),
+                min_interval.total_milliseconds if min_interval is not None else 0,
+                max_interval.total_milliseconds if max_interval is not None else 0,
+                config.get(CONF_PUBLISH_ON_STATUS_CHANGE, False),
+            )
+        )
+
+    if CONF_VELOCITY in config:
+        sens = await sensor.new_sensor(config[CONF_VELOCITY])
+        cg.add(hub.register_velocity_sensor(sens, config[CONF_TARGET_NUMBER]))
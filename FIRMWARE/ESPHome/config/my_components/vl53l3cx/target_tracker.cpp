@@ -0,0 +1,145 @@
+#include "target_tracker.h"
+#include <algorithm>
+
+namespace esphome {
+namespace vl53l3cx {
+
+// Alpha-beta filter gains (0.16)
+static const int64_t TRACK_ALPHA = 32768;  // 0.5
+static const int64_t TRACK_BETA = 9830;    // 0.15
+// Association cost of a 100% signal-rate change, in mm of range difference
+static const uint32_t SIGNAL_COST_MM = 100;
+static const uint32_t MAX_SIGNAL_COST_MM = 200;
+
+static bool is_trackable(const FrameTarget &target) {
+  if (target.range_mm <= 0 || target.is_background) {
+    return false;
+  }
+  return target.range_status == VL53LX_RANGESTATUS_RANGE_VALID ||
+         target.range_status == VL53LX_RANGESTATUS_RANGE_VALID_MERGED_PULSE;
+}
+
+void TargetTracker::reset() {
+  for (Track &track : this->tracks_) {
+    track = Track{};
+  }
+}
+
+int32_t TargetTracker::predict_(const Track &track, uint64_t timestamp_us) const {
+  const int64_t dt_us = (int64_t)(timestamp_us - track.last_update_us);
+  return track.range_mm + (int32_t)((int64_t) track.velocity_mmps * dt_us / 1000000);
+}
+
+uint32_t TargetTracker::cost_(const Track &track, int32_t predicted_mm, const FrameTarget &target) const {
+  const int32_t diff = ((int32_t) target.range_mm << 16) - predicted_mm;
+  const uint32_t range_cost = (uint32_t)(diff < 0 ? -diff : diff) >> 16;
+  if (range_cost > this->gate_mm_) {
+    return UINT32_MAX;
+  }
+  // Relative signal change; a sofa and a child at similar ranges rarely return the same rate
+  const uint64_t signal_diff = target.signal_rate_mcps > track.signal_rate_mcps
+                                   ? target.signal_rate_mcps - track.signal_rate_mcps
+                                   : track.signal_rate_mcps - target.signal_rate_mcps;
+  const uint64_t signal_cost = signal_diff * SIGNAL_COST_MM / std::max<uint64_t>(track.signal_rate_mcps, 1);
+  return range_cost + (uint32_t) std::min<uint64_t>(signal_cost, MAX_SIGNAL_COST_MM);
+}
+
+uint8_t TargetTracker::update(const Frame &frame) {
+  const uint64_t now_us = frame.timestamp_us;
+  std::array<int32_t, MAX_TRACKS> predicted{};
+  for (uint8_t slot = 0; slot < MAX_TRACKS; slot++) {
+    Track &track = this->tracks_[slot];
+    track.updated = false;
+    if (track.is_active()) {
+      predicted[slot] = this->predict_(track, now_us);
+    }
+  }
+
+  // Greedy association: repeatedly take the cheapest remaining pair inside the gate
+  uint8_t used_targets = 0;
+  for (uint8_t round = 0; round < MAX_TRACKS; round++) {
+    uint32_t best_cost = UINT32_MAX;
+    uint8_t best_slot = 0;
+    uint8_t best_target = 0;
+    for (uint8_t slot = 0; slot < MAX_TRACKS; slot++) {
+      const Track &track = this->tracks_[slot];
+      if (!track.is_active() || track.updated) {
+        continue;
+      }
+      for (uint8_t i = 0; i < frame.num_targets; i++) {
+        if ((used_targets & (1 << i)) || !is_trackable(frame.targets[i])) {
+          continue;
+        }
+        const uint32_t cost = this->cost_(track, predicted[slot], frame.targets[i]);
+        if (cost < best_cost) {
+          best_cost = cost;
+          best_slot = slot;
+          best_target = i;
+        }
+      }
+    }
+    if (best_cost == UINT32_MAX) {
+      break;
+    }
+
+    Track &track = this->tracks_[best_slot];
+    const FrameTarget &target = frame.targets[best_target];
+    const int64_t dt_us = std::max<int64_t>((int64_t)(now_us - track.last_update_us), 1);
+    const int64_t residual = ((int64_t) target.range_mm << 16) - predicted[best_slot];
+    track.range_mm = predicted[best_slot] + (int32_t)((residual * TRACK_ALPHA) >> 16);
+    track.velocity_mmps += (int32_t)(((residual * TRACK_BETA) >> 16) * 1000000 / dt_us);
+    track.sigma_mm = target.sigma_mm;
+    track.signal_rate_mcps = target.signal_rate_mcps;
+    track.last_update_us = now_us;
+    if (track.hits < UINT8_MAX) {
+      track.hits++;
+    }
+    track.updated = true;
+    used_targets |= 1 << best_target;
+  }
+
+  // Unconfirmed tracks die on their first miss, confirmed ones after the timeout
+  uint8_t dropped = 0;
+  for (uint8_t slot = 0; slot < MAX_TRACKS; slot++) {
+    Track &track = this->tracks_[slot];
+    if (!track.is_active() || track.updated) {
+      continue;
+    }
+    if (track.hits < CONFIRM_HITS) {
+      track = Track{};
+    } else if (now_us - track.last_update_us > this->timeout_us_) {
+      track = Track{};
+      dropped |= 1 << slot;
+    }
+  }
+
+  // Remaining detections open new tracks in the lowest free slots
+  for (uint8_t i = 0; i < frame.num_targets; i++) {
+    if ((used_targets & (1 << i)) || !is_trackable(frame.targets[i])) {
+      continue;
+    }
+    for (Track &track : this->tracks_) {
+      if (track.is_active()) {
+        continue;
+      }
+      const FrameTarget &target = frame.targets[i];
+      track.id = this->next_id_++;
+      if (this->next_id_ == 0) {
+        this->next_id_ = 1;
+      }
+      track.range_mm = (int32_t) target.range_mm << 16;
+      track.velocity_mmps = 0;
+      track.sigma_mm = target.sigma_mm;
+      track.signal_rate_mcps = target.signal_rate_mcps;
+      track.last_update_us = now_us;
+      track.hits = 1;
+      track.updated = true;
+      break;
+    }
+  }
+
+  return dropped;
+}
+
+}  // namespace vl53l3cx
+}  // namespace esphome
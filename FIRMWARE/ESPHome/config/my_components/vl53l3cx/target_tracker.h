@@ -0,0 +1,59 @@
+#pragma once
+
+#include "frame.h"
+#include <array>
+#include <cstdint>
+
+namespace esphome {
+namespace vl53l3cx {
+
+// One tracked target. Range and velocity come from an alpha-beta filter on
+// the associated detections.
+struct Track {
+  uint16_t id{0};                      // 0 = slot unused
+  int32_t range_mm{0};                 // 16.16
+  int32_t velocity_mmps{0};            // 16.16, positive = receding
+  FixPoint1616_t sigma_mm{0};          // Of the last associated detection
+  FixPoint1616_t signal_rate_mcps{0};  // Of the last associated detection
+  uint64_t last_update_us{0};
+  uint8_t hits{0};                     // Associated detections (saturates)
+  bool updated{false};                 // Associated in the latest frame
+
+  bool is_active() const { return this->id != 0; }
+};
+
+// Frame-to-frame association of detections into up to MAX_TRACKS tracks
+// with stable slots. Detections are matched greedily on predicted range,
+// plus a penalty for signal-rate changes, inside a range gate; unmatched
+// detections open new tracks in the lowest free slot.
+class TargetTracker {
+ public:
+  static const uint8_t MAX_TRACKS = 4;
+  // Tracks are only reported once seen this many times
+  static const uint8_t CONFIRM_HITS = 2;
+
+  void set_gate_mm(uint16_t gate_mm) { this->gate_mm_ = gate_mm; }
+  void set_timeout_us(uint32_t timeout_us) { this->timeout_us_ = timeout_us; }
+
+  // Associate the valid targets of a frame. Returns a bit mask of the slots
+  // whose track was dropped by this frame.
+  uint8_t update(const Frame &frame);
+  void reset();
+
+  const Track &get_track(uint8_t slot) const { return this->tracks_[slot]; }
+  bool is_reported(uint8_t slot) const {
+    return this->tracks_[slot].is_active() && this->tracks_[slot].hits >= CONFIRM_HITS;
+  }
+
+ protected:
+  int32_t predict_(const Track &track, uint64_t timestamp_us) const;
+  uint32_t cost_(const Track &track, int32_t predicted_mm, const FrameTarget &target) const;
+
+  std::array<Track, MAX_TRACKS> tracks_{};
+  uint16_t next_id_{1};
+  uint16_t gate_mm_{250};
+  uint32_t timeout_us_{500000};
+};
+
+}  // namespace vl53l3cx
+}  // namespace esphome
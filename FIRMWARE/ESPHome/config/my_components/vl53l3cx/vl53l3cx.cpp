@@ -1,21 +1,37 @@
 #include "vl53l3cx.h"
 #include "esphome/core/log.h"
 #include "esphome/core/helpers.h"
+#include <cmath>
 #include <cstring>
 
 // Include ST library headers
 extern "C" {
 #include "vl53lx_api.h"
 #include "vl53lx_api_core.h"
+#include "vl53lx_core.h"
+#include "vl53lx_platform.h"
 }
 
-// External function to set component for platform layer
-extern void vl53lx_set_i2c_component(esphome::vl53l3cx::VL53L3CXComponent *component);
-
 namespace esphome {
 namespace vl53l3cx {
 
 static const char *const TAG = "vl53l3cx";
+// Capture lines, parsed by tools/hist_sweep
+static const char *const CAPTURE_TAG = "vl53l3cx.capture";
+static const size_t CAPTURE_LINE_BYTES = 64;  // Keeps lines within the logger's buffer
+
+// Per-frame detail logs are compiled in only with the hub's frame_debug
+// option. Otherwise the frame path just counts events for the periodic summary.
+#ifdef VL53L3CX_FRAME_DEBUG
+#define FRAME_LOGD(...) ESP_LOGD(TAG, __VA_ARGS__)
+#define FRAME_LOGV(...) ESP_LOGV(TAG, __VA_ARGS__)
+#else
+#define FRAME_LOGD(...) do { } while (0)
+#define FRAME_LOGV(...) do { } while (0)
+#endif
+
+// Address every VL53L3CX answers on after power-up or XSHUT release
+static const uint8_t DEFAULT_I2C_ADDRESS = 0x29;
 
 static const char* get_error_string(VL53LX_Error error) {
   switch(error) {
@@ -66,50 +82,183 @@ static const char* get_error_string(VL53LX_Error error) {
   }
 }
 
+#ifdef VL53L3CX_FRAME_DEBUG
+static const char *get_range_status_string(uint8_t status) {
+  switch (status) {
+    case VL53LX_RANGESTATUS_RANGE_VALID: return "VALID";
+    case VL53LX_RANGESTATUS_SIGMA_FAIL: return "SIGMA_FAIL";
+    case VL53LX_RANGESTATUS_SIGNAL_FAIL: return "SIGNAL_FAIL";
+    case VL53LX_RANGESTATUS_OUTOFBOUNDS_FAIL: return "OUT_OF_BOUNDS";
+    case VL53LX_RANGESTATUS_HARDWARE_FAIL: return "HARDWARE_FAIL";
+    case VL53LX_RANGESTATUS_RANGE_VALID_NO_WRAP_CHECK_FAIL: return "NO_WRAP_CHECK";
+    case VL53LX_RANGESTATUS_WRAP_TARGET_FAIL: return "WRAP_FAIL";
+    case VL53LX_RANGESTATUS_SYNCRONISATION_INT: return "SYNC";
+    case VL53LX_RANGESTATUS_RANGE_VALID_MERGED_PULSE: return "MERGED_PULSE";
+    case VL53LX_RANGESTATUS_TARGET_PRESENT_LACK_OF_SIGNAL: return "LACK_OF_SIGNAL";
+    case VL53LX_RANGESTATUS_NONE: return "NONE";
+    default: return "UNKNOWN";
+  }
+}
+#endif
+
+// Current value of the platform µs timebase
+static uint64_t now_us() {
+  uint64_t t = 0;
+  VL53LX_GetTimestampUs(&t);
+  return t;
+}
+
+std::vector<VL53L3CXComponent *> VL53L3CXComponent::xshut_group_;
+bool VL53L3CXComponent::xshut_group_booted_ = false;
+
 void VL53L3CXComponent::setup() {
   ESP_LOGCONFIG(TAG, "Setting up VL53L3CX...");
   
+  if (this->xshut_pin_ != nullptr) {
+    // Sensors with XSHUT all boot at the default address, so they are brought
+    // up together by whichever hub gets here first
+    if (!xshut_group_booted_) {
+      bring_up_xshut_group_();
+    }
+    if (this->device_ == nullptr) {
+      ESP_LOGE(TAG, "Failed to initialize VL53L3CX");
+      this->mark_failed();
+      return;
+    }
+    if (!this->device_initialized_) {
+      // Keep retrying from update(): the sensor may just be late or wedged
+      ESP_LOGE(TAG, "Failed to initialize VL53L3CX, will retry");
+      this->enter_recovery_(now_us(), RECOVERY_HARD_RESET);
+      return;
+    }
+    ESP_LOGCONFIG(TAG, "VL53L3CX setup complete");
+    return;
+  }
+  
+  // Setup GPIO pins
+  this->setup_gpio_pins_();
+  
+  if (!this->prepare_device_()) {
+    ESP_LOGE(TAG, "Failed to initialize VL53L3CX");
+    this->mark_failed();
+    return;
+  }
+  if (!this->boot_device_() || !this->start_device_()) {
+    ESP_LOGE(TAG, "Failed to initialize VL53L3CX, will retry");
+    this->enter_recovery_(now_us(), RECOVERY_HARD_RESET);
+    return;
+  }
+  
+  ESP_LOGCONFIG(TAG, "VL53L3CX setup complete");
+}
+
+void VL53L3CXComponent::bring_up_xshut_group_() {
+  xshut_group_booted_ = true;
+  const uint64_t start_us = now_us();
+  
+  // Hold every sensor in reset; each one leaves it on the shared default address
+  for (auto *hub : xshut_group_) {
+    hub->setup_gpio_pins_();
+  }
+  delay(20);
+  
+  // Release and readdress every sensor first, one at a time, as each one
+  // boots on the shared default address. Then configure them. The driver's
+  // DataInit and NVM reads block on this one thread, so the configuration of
+  // one sensor cannot overlap the waits of another: the bring-up is serial.
+  std::vector<VL53L3CXComponent *> booted;
+  for (auto *hub : xshut_group_) {
+    if (!hub->prepare_device_()) {
+      continue;
+    }
+    hub->xshut_pin_->digital_write(true);
+    if (hub->boot_device_()) {
+      booted.push_back(hub);
+    }
+  }
+  for (auto *hub : booted) {
+    hub->start_device_();
+  }
+  
+  ESP_LOGI(TAG, "Brought up %u sensor(s) in %u us", (unsigned) xshut_group_.size(),
+           (uint32_t)(now_us() - start_us));
+}
+
+bool VL53L3CXComponent::prepare_device_() {
   // Initialize calibration preference object (persist in flash)
   // Use a stable type key based on I2C address to support multiple sensors
   if (global_preferences != nullptr) {
     uint32_t pref_type = 0x564C5300u | (uint32_t)(this->address_ & 0x7Fu); // 'VLS' + addr
     this->calibration_pref_ = global_preferences->make_preference<VL53LX_CalibrationData_t>(pref_type, true);
+    if (this->background_enabled_) {
+      uint32_t background_type = 0x564C4200u | (uint32_t)(this->address_ & 0x7Fu); // 'VLB' + addr
+      this->background_pref_ = global_preferences->make_preference<BackgroundModel::Table>(background_type, true);
+      BackgroundModel::Table table{};
+      if (this->background_pref_.load(&table) && this->background_.set_table(table)) {
+        ESP_LOGI(TAG, "Loaded background model (%u bins)", this->background_.count_bins());
+      }
+    }
   }
   
-  // Set this component for platform functions to use
-  vl53lx_set_i2c_component(this);
-  ESP_LOGD(TAG, "Platform component set");
-  
-  // Setup GPIO pins
-  this->setup_gpio_pins_();
-  
-  // Reset device if XSHUT pin available
-  this->reset_device_();
-  
   // Allocate device structure
   ESP_LOGD(TAG, "Allocating device structure (size: %u bytes)", sizeof(VL53LX_Dev_t));
   this->device_ = new VL53LX_Dev_t();
   if (!this->device_) {
     ESP_LOGE(TAG, "Failed to allocate device structure");
-    this->mark_failed();
-    return;
+    return false;
   }
   memset(this->device_, 0, sizeof(VL53LX_Dev_t));
   this->device_->i2c_slave_address = this->address_ << 1;  // Convert 7-bit to 8-bit
+  this->device_->comms_handle = this;  // Route platform I2C calls to this hub
   ESP_LOGD(TAG, "Device structure allocated, I2C address: 0x%02X", this->device_->i2c_slave_address);
   
   // Load calibration data (if available)
-  bool has_calibration = this->load_calibration_data_();
+  this->load_calibration_data_();
+  return true;
+}
+
+bool VL53L3CXComponent::boot_device_() {
+  // Out of XSHUT reset the sensor always answers on the default address
+  const uint8_t target_address = this->address_;
+  if (this->xshut_pin_ != nullptr) {
+    this->set_i2c_address(DEFAULT_I2C_ADDRESS);
+    this->device_->i2c_slave_address = DEFAULT_I2C_ADDRESS << 1;
+  }
   
+  // Wait for device boot
+  ESP_LOGD(TAG, "Waiting for device boot...");
+  VL53LX_Error status = VL53LX_WaitDeviceBooted(this->device_);
+  if (status != VL53LX_ERROR_NONE) {
+    ESP_LOGE(TAG, "Device boot timeout: %d (%s)", status, get_error_string(status));
+    this->set_i2c_address(target_address);
+    this->hold_in_reset_();
+    return false;
+  }
+  ESP_LOGD(TAG, "Device booted successfully");
+  
+  // Move off the default address so the next sensor can be released
+  if (this->xshut_pin_ != nullptr && target_address != DEFAULT_I2C_ADDRESS) {
+    status = VL53LX_SetDeviceAddress(this->device_, target_address << 1);
+    this->set_i2c_address(target_address);
+    if (status != VL53LX_ERROR_NONE) {
+      ESP_LOGE(TAG, "Failed to set I2C address 0x%02X: %d (%s)", target_address, status, get_error_string(status));
+      this->hold_in_reset_();
+      return false;
+    }
+    this->device_->i2c_slave_address = target_address << 1;
+    ESP_LOGD(TAG, "I2C address changed to 0x%02X", target_address);
+  }
+  return true;
+}
+
+bool VL53L3CXComponent::start_device_() {
   // Initialize the device
   if (!this->initialize_device_()) {
-    ESP_LOGE(TAG, "Failed to initialize VL53L3CX");
-    this->mark_failed();
-    return;
+    return false;
   }
   
   // Log calibration status
-  if (has_calibration) {
+  if (this->calibration_loaded_) {
     ESP_LOGI(TAG, "Using stored calibration data");
   } else {
     ESP_LOGW(TAG, "No calibration data found - using factory defaults. Consider running calibration.");
@@ -123,15 +272,25 @@ void VL53L3CXComponent::setup() {
     ESP_LOGW(TAG, "Failed to enable crosstalk compensation: %d (%s)", status, get_error_string(status));
     // Continue anyway but log warning
   }
-  
-  ESP_LOGCONFIG(TAG, "VL53L3CX setup complete");
+  return true;
 }
 
 void VL53L3CXComponent::update() {
+  const uint64_t poll_us = now_us();
+  this->supervise_(poll_us);
   if (!this->device_initialized_) {
     return;
   }
   
+  // Also runs when no frame arrives, so a stalled sensor still shows up in the metrics
+  this->update_metrics_(poll_us);
+  
+  // A scheduled sensor's last result stays flagged ready until its next trigger
+  // clears the interrupt; only a triggered range has anything new
+  if (this->externally_triggered_ && !this->range_in_flight_) {
+    return;
+  }
+  
   // Check if measurement is ready
   uint8_t data_ready = 0;
   VL53LX_Error status = VL53LX_GetMeasurementDataReady(this->device_, &data_ready);
@@ -142,12 +301,14 @@ void VL53L3CXComponent::update() {
   }
   
   if (data_ready) {
+    const uint64_t data_ready_us = now_us();
+    
     // Update binary sensor
     if (this->binary_sensor_ != nullptr) {
       this->binary_sensor_->publish_state(true);
     }
     
-    this->read_measurement_();
+    this->read_measurement_(data_ready_us);
     
     // Clear binary sensor after reading
     if (this->binary_sensor_ != nullptr) {
@@ -170,6 +331,11 @@ void VL53L3CXComponent::dump_config() {
   
   ESP_LOGCONFIG(TAG, "  Distance Mode: %s", mode_str);
   ESP_LOGCONFIG(TAG, "  Timing Budget: %u µs", this->timing_budget_us_);
+  if (this->adaptive_timing_) {
+    ESP_LOGCONFIG(TAG, "  Adaptive Timing: %u..%u µs, target sigma %.1f mm, hold %u frames",
+                  this->min_timing_budget_us_, this->max_timing_budget_us_, this->target_sigma_ / 65536.0f,
+                  this->adapt_hold_frames_);
+  }
   ESP_LOGCONFIG(TAG, "  Signal Rate Limit: %.2f MCPS", this->signal_rate_limit_mcps_);
   ESP_LOGCONFIG(TAG, "  Sigma Threshold: %.1f mm", this->sigma_threshold_mm_);
   const char *smudge_mode_str = "UNKNOWN";
@@ -192,6 +358,11 @@ void VL53L3CXComponent::dump_config() {
   ESP_LOGCONFIG(TAG, "  Hist Merge: %s", this->hist_merge_enabled_ ? "ENABLED" : "DISABLED");
   ESP_LOGCONFIG(TAG, "  Hist Noise Threshold: %u", this->hist_noise_threshold_);
   ESP_LOGCONFIG(TAG, "  Hist Merge Max Size: %u", this->hist_merge_max_size_);
+  ESP_LOGCONFIG(TAG, "  Peak Estimator: %s",
+                this->peak_estimator_ == VL53LX_HIST_PEAK_ESTIMATOR__GAUSSIAN ? "GAUSSIAN" : "FILTER");
+  if (this->histogram_capture_) {
+    ESP_LOGCONFIG(TAG, "  Histogram Capture: ENABLED (%s)", CAPTURE_TAG);
+  }
   
   if (this->roi_configured_) {
     ESP_LOGCONFIG(TAG, "  ROI: (%u,%u) to (%u,%u)", 
@@ -214,13 +385,61 @@ void VL53L3CXComponent::dump_config() {
   
   for (size_t i = 0; i < this->distance_sensors_.size(); i++) {
     if (this->distance_sensors_[i] != nullptr) {
-      ESP_LOGCONFIG(TAG, "  Target %u: Distance sensor registered", i);
+      static const char *const FILTER_NAMES[] = {"none", "median", "one-euro", "kalman"};
+      ESP_LOGCONFIG(TAG, "  Target %u: Distance sensor registered (filter: %s)", i,
+                    FILTER_NAMES[this->range_filters_[i].get_type()]);
+      const PublishPolicy &policy = this->publish_policies_[i];
+      if (policy.is_configured()) {
+        ESP_LOGCONFIG(TAG, "    Publish: deadband %u mm, interval %u-%u ms, on status change: %s",
+                      policy.get_deadband_mm(), policy.get_min_interval_us() / 1000,
+                      policy.get_max_interval_us() / 1000, YESNO(policy.get_on_status_change()));
+      }
     }
+    LOG_SENSOR("    ", "Velocity", this->velocity_sensors_[i]);
+  }
+  ESP_LOGCONFIG(TAG, "  Target Tracking: %s", YESNO(this->tracking_));
+  if (this->low_power_) {
+    ESP_LOGCONFIG(TAG, "  Low Power: idle after %u s without a target within %u mm, period %u ms",
+                  (uint32_t)(this->idle_after_us_ / 1000000), this->wake_distance_mm_, this->idle_period_ms_);
+  }
+  if (this->accumulation_) {
+    ESP_LOGCONFIG(TAG, "  Histogram Accumulation: up to %u histograms per timing, restarted within %u mm",
+                  this->hist_merge_max_size_, this->accumulation_near_mm_);
+  }
+  if (this->background_enabled_) {
+    ESP_LOGCONFIG(TAG, "  Background Subtraction: %u bins, learn %u s", this->background_.count_bins(),
+                  this->background_learn_duration_us_ / 1000000);
   }
   
   if (this->binary_sensor_ != nullptr) {
     ESP_LOGCONFIG(TAG, "  Binary sensor: Data Ready sensor registered");
   }
+  if (this->log_summary_interval_us_ != 0) {
+    ESP_LOGCONFIG(TAG, "  Log Summary Interval: %u s", (uint32_t)(this->log_summary_interval_us_ / 1000000));
+  }
+#ifdef VL53L3CX_FRAME_DEBUG
+  ESP_LOGCONFIG(TAG, "  Frame Debug Logging: YES");
+#endif
+  LOG_SENSOR("  ", "Timing Budget", this->timing_budget_sensor_);
+  LOG_SENSOR("  ", "Frame Rate", this->frame_rate_sensor_);
+  LOG_SENSOR("  ", "Frames", this->frames_sensor_);
+  LOG_SENSOR("  ", "Publishes", this->publishes_sensor_);
+  LOG_SENSOR("  ", "Missed Measurements", this->missed_measurements_sensor_);
+  LOG_SENSOR("  ", "Consecutive Errors", this->consecutive_errors_sensor_);
+  LOG_SENSOR("  ", "Total Measurements", this->total_measurements_sensor_);
+  LOG_SENSOR("  ", "Valid Measurements", this->valid_measurements_sensor_);
+  LOG_SENSOR("  ", "I2C Bytes", this->i2c_bytes_sensor_);
+  LOG_SENSOR("  ", "I2C Read Time", this->i2c_read_time_sensor_);
+  LOG_SENSOR("  ", "Processing Time", this->processing_time_sensor_);
+  LOG_SENSOR("  ", "Publish Latency", this->publish_latency_sensor_);
+  LOG_BINARY_SENSOR("  ", "Performance Degraded", this->performance_degraded_binary_sensor_);
+  LOG_TEXT_SENSOR("  ", "Health", this->health_text_sensor_);
+  LOG_BINARY_SENSOR("  ", "Low Power", this->low_power_binary_sensor_);
+  LOG_SENSOR("  ", "I2C Throughput", this->i2c_throughput_sensor_);
+  LOG_SENSOR("  ", "Wake Latency", this->wake_latency_sensor_);
+  LOG_SENSOR("  ", "Dmax Cache Hit Rate", this->dmax_cache_hit_rate_sensor_);
+  LOG_SENSOR("  ", "Recoveries", this->recoveries_sensor_);
+  LOG_SENSOR("  ", "Time To Recover", this->time_to_recover_sensor_);
 }
 
 float VL53L3CXComponent::get_setup_priority() const {
@@ -255,18 +474,9 @@ bool VL53L3CXComponent::is_data_ready() {
 bool VL53L3CXComponent::initialize_device_() {
   ESP_LOGD(TAG, "Initializing VL53L3CX device...");
   
-  // Wait for device boot
-  ESP_LOGD(TAG, "Waiting for device boot...");
-  VL53LX_Error status = VL53LX_WaitDeviceBooted(this->device_);
-  if (status != VL53LX_ERROR_NONE) {
-    ESP_LOGE(TAG, "Device boot timeout: %d (%s)", status, get_error_string(status));
-    return false;
-  }
-  ESP_LOGD(TAG, "Device booted successfully");
-  
   // Initialize device
   ESP_LOGD(TAG, "Initializing device data...");
-  status = VL53LX_DataInit(this->device_);
+  VL53LX_Error status = VL53LX_DataInit(this->device_);
   if (status != VL53LX_ERROR_NONE) {
     ESP_LOGE(TAG, "Data init failed: %d (%s)", status, get_error_string(status));
     return false;
@@ -341,8 +551,8 @@ bool VL53L3CXComponent::initialize_device_() {
   
   // Configure sigma threshold using histogram sigma threshold tuning parameter
   ESP_LOGD(TAG, "Setting sigma threshold: %.1f mm", this->sigma_threshold_mm_);
-  // Convert mm to fixed-point (same format as limit check)
-  int32_t sigma_threshold_value = (int32_t)(this->sigma_threshold_mm_ * 65536.0f);
+  // The histogram threshold is in quarter mm (14.2), unlike the 16.16 limit checks
+  int32_t sigma_threshold_value = (int32_t) std::lround(this->sigma_threshold_mm_ * 4.0f);
   status = VL53LX_SetTuningParameter(this->device_, VL53LX_TUNINGPARM_HIST_SIGMA_THRESH_MM, sigma_threshold_value);
   if (status != VL53LX_ERROR_NONE) {
     ESP_LOGW(TAG, "Failed to set sigma threshold tuning parameter: %d (%s)", status, get_error_string(status));
@@ -419,6 +629,22 @@ bool VL53L3CXComponent::initialize_device_() {
   if (status != VL53LX_ERROR_NONE) {
     ESP_LOGW(TAG, "Failed to set HIST_MERGE_MAX_SIZE: %d (%s)", status, get_error_string(status));
   }
+  // Sub-bin peak estimator
+  ESP_LOGD(TAG, "Applying HIST_PEAK_ESTIMATOR: %u", this->peak_estimator_);
+  status = VL53LX_SetTuningParameter(this->device_, VL53LX_TUNINGPARM_HIST_PEAK_ESTIMATOR, (int32_t)this->peak_estimator_);
+  if (status != VL53LX_ERROR_NONE) {
+    ESP_LOGW(TAG, "Failed to set HIST_PEAK_ESTIMATOR: %d (%s)", status, get_error_string(status));
+  }
+  
+  if (this->externally_triggered_) {
+    // One range per trigger; the scheduler decides when this sensor emits
+    VL53LXDevDataSet(this->device_, LLData.measurement_mode, VL53LX_DEVICEMEASUREMENTMODE_SINGLESHOT);
+    this->measurement_started_ = false;
+    this->range_in_flight_ = false;
+    this->device_initialized_ = true;
+    ESP_LOGD(TAG, "VL53L3CX initialized successfully (externally triggered)");
+    return true;
+  }
   
   // Start measurements
   status = VL53LX_StartMeasurement(this->device_);
@@ -432,25 +658,50 @@ bool VL53L3CXComponent::initialize_device_() {
   return true;
 }
 
-bool VL53L3CXComponent::read_measurement_() {
+bool VL53L3CXComponent::read_measurement_(uint64_t data_ready_us) {
   VL53LX_MultiRangingData_t ranging_data;
   const uint32_t MAX_CONSECUTIVE_ERRORS = 10;
   const uint32_t MAX_RETRIES = 3;
+  FrameTiming timing{};
   
   this->total_measurements_++;
+  this->range_in_flight_ = false;  // Data ready: the triggered range is complete
+  timing.data_ready_us = data_ready_us;
+  this->capture_begin_();
   
   // Retry logic for robust operation
   for (uint32_t retry = 0; retry < MAX_RETRIES; retry++) {
+    // Split the call into bus time and host post-processing; the platform
+    // layer accumulates bus time for every transfer
+    const uint32_t bus_bytes_before = this->i2c_bytes_;
+    const uint32_t bus_us_before = this->i2c_busy_us_;
+    const uint64_t call_start_us = now_us();
+    if (retry == 0) {
+      // Covers the binary sensor publish and capture setup between the poll and the read
+      timing.ready_to_read_us = (uint32_t)(call_start_us - data_ready_us);
+    }
     VL53LX_Error status = VL53LX_GetMultiRangingData(this->device_, &ranging_data);
+    const uint32_t call_us = (uint32_t)(now_us() - call_start_us);
+    timing.i2c_bytes = this->i2c_bytes_ - bus_bytes_before;
+    timing.i2c_read_us = this->i2c_busy_us_ - bus_us_before;
+    timing.processing_us = call_us > timing.i2c_read_us ? call_us - timing.i2c_read_us : 0;
     
     if (status == VL53LX_ERROR_NONE) {
       this->consecutive_errors_ = 0;  // Reset error counter on success
       this->valid_measurements_++;  // Track successful measurements
+      this->last_activity_us_ = data_ready_us;
+      if (this->supervisor_.report_frame(data_ready_us)) {
+        ESP_LOGI(TAG, "Sensor recovered after %u ms (%u recoveries)", this->supervisor_.get_last_recovery_us() / 1000,
+                 this->supervisor_.get_recoveries());
+        this->status_clear_warning();
+        this->publish_health_();
+      }
       break;  // Success - exit retry loop
     }
     
     // Error occurred - apply recovery strategy
     this->consecutive_errors_++;
+    this->capture_abort_();
     ESP_LOGW(TAG, "Failed to get ranging data (attempt %u/%u): %d (%s)", 
              retry + 1, MAX_RETRIES, status, get_error_string(status));
     
@@ -488,8 +739,8 @@ bool VL53L3CXComponent::read_measurement_() {
     
     // Check for persistent failures
     if (this->consecutive_errors_ > MAX_CONSECUTIVE_ERRORS) {
-      ESP_LOGE(TAG, "Too many consecutive errors (%u), sensor may have failed", this->consecutive_errors_);
-      this->mark_failed();
+      ESP_LOGE(TAG, "Too many consecutive errors (%u), starting recovery", this->consecutive_errors_);
+      this->enter_recovery_(now_us(), RECOVERY_SOFT_RESTART);
       return false;
     }
     
@@ -500,11 +751,16 @@ bool VL53L3CXComponent::read_measurement_() {
     }
   }
   
-  // Clear interrupt and start next measurement
-  VL53LX_Error status = VL53LX_ClearInterruptAndStartMeasurement(this->device_);
-  if (status != VL53LX_ERROR_NONE) {
-    ESP_LOGW(TAG, "Failed to clear interrupt: %d (%s)", status, get_error_string(status));
+  // Clear interrupt and start next measurement (externally triggered sensors
+  // wait for their next slot instead)
+  if (!this->externally_triggered_) {
+    VL53LX_Error status = VL53LX_ClearInterruptAndStartMeasurement(this->device_);
+    if (status != VL53LX_ERROR_NONE) {
+      ESP_LOGW(TAG, "Failed to clear interrupt: %d (%s)", status, get_error_string(status));
+      this->capture_abort_();
+    }
   }
+  this->capture_end_(ranging_data.StreamCount);
   
   // CRITICAL: Discard the very first measurement (Range1) per ST guide
   // Range1 lacks wrap-around validation and is not reliable
@@ -515,8 +771,7 @@ bool VL53L3CXComponent::read_measurement_() {
   }
   
   // Process measurement data for all targets (Range2 onwards)
-  ESP_LOGD(TAG, "=== MEASUREMENT DEBUG: Objects found: %u, StreamCount: %u ===", 
-           ranging_data.NumberOfObjectsFound, ranging_data.StreamCount);
+  FRAME_LOGD("Frame: %u objects, StreamCount %u", ranging_data.NumberOfObjectsFound, ranging_data.StreamCount);
   
   // CRITICAL: StreamCount rollover detection per ST guide (0-255, then 128-255)
   // Check for missed measurements using StreamCount rollover behavior
@@ -548,114 +803,692 @@ bool VL53L3CXComponent::read_measurement_() {
       }
       
       this->missed_measurements_ += missed_count;
-      ESP_LOGW(TAG, "Missed %u measurement(s). Expected StreamCount: %u, Got: %u (Total missed: %u)",
+      FRAME_LOGD("Missed %u measurement(s). Expected StreamCount: %u, Got: %u (Total missed: %u)",
                missed_count, expected_count, ranging_data.StreamCount, this->missed_measurements_);
     }
   }
   this->last_stream_count_ = ranging_data.StreamCount;
   
+  // Fixed-point copy of the result for the tracker and frame listeners
+  Frame frame;
+  frame.timestamp_us = timing.data_ready_us;
+  frame.stream_count = ranging_data.StreamCount;
+  frame.num_targets = std::min<uint8_t>(ranging_data.NumberOfObjectsFound, VL53LX_MAX_RANGE_RESULTS);
+  // Read before update_accumulation_ can restart the merge
+  VL53LX_compute_histo_merge_nb(this->device_, &frame.histograms);
+  frame.histograms = std::max<uint8_t>(frame.histograms, 1);
+  for (uint8_t i = 0; i < frame.num_targets; i++) {
+    const VL53LX_TargetRangeData_t &src = ranging_data.RangeData[i];
+    FrameTarget &dst = frame.targets[i];
+    dst.range_mm = src.RangeMilliMeter;
+    dst.range_status = src.RangeStatus;
+    dst.sigma_mm = src.SigmaMilliMeter;
+    dst.signal_rate_mcps = src.SignalRateRtnMegaCps;
+    dst.ambient_rate_mcps = src.AmbientRateRtnMegaCps;
+    this->frame_log_counts_.status[std::min<uint8_t>(src.RangeStatus, FrameLogCounts::OTHER_STATUS)]++;
+    if (src.RangeStatus == VL53LX_RANGESTATUS_HARDWARE_FAIL) {
+      // Not a per-frame condition: report it immediately
+      ESP_LOGE(TAG, "Result %u: hardware/VCSEL failure (status 5)", i);
+    }
+  }
+  
+  if (this->background_enabled_) {
+    if (this->background_.learn(frame)) {
+      ESP_LOGI(TAG, "Background learned: %u static bins", this->background_.count_bins());
+      if (global_preferences != nullptr && this->background_pref_.save(&this->background_.get_table())) {
+        global_preferences->sync();
+      }
+    }
+    for (uint8_t i = 0; i < frame.num_targets; i++) {
+      frame.targets[i].is_background = this->background_.is_background(frame.targets[i]);
+    }
+  }
+  
+  // Sensor slots list foreground results only, in driver order
+  std::array<uint8_t, VL53LX_MAX_RANGE_RESULTS> slot_result{};
+  uint8_t num_slots = 0;
+  for (uint8_t i = 0; i < frame.num_targets; i++) {
+    if (!frame.targets[i].is_background) {
+      slot_result[num_slots++] = i;
+    } else {
+      this->frame_log_counts_.background++;
+      FRAME_LOGV("Result %u at %d mm matches the background", i, frame.targets[i].range_mm);
+    }
+  }
+  
+  const uint64_t publish_start_us = now_us();
+  
   // Update all 4 sensor slots - process detected targets and clear undetected ones
   for (uint8_t i = 0; i < 4; i++) {
     if (this->distance_sensors_[i] == nullptr) {
       continue; // Skip unregistered sensors
     }
     
-    if (i < ranging_data.NumberOfObjectsFound) {
+    if (i < num_slots) {
       // Process detected target
-      const VL53LX_TargetRangeData_t* target = &ranging_data.RangeData[i];
-      uint16_t distance_mm = target->RangeMilliMeter;
-      uint8_t range_status = target->RangeStatus;
-      float signal_rate = (float)target->SignalRateRtnMegaCps / 65536.0f;
-      float sigma = (float)target->SigmaMilliMeter / 65536.0f;
-      
-      ESP_LOGD(TAG, "Target %u: Distance=%u mm, Status=%u, Signal=%.2f Mcps, Sigma=%.2f mm, RangeMax=%u, RangeMin=%u",
-               i, distance_mm, range_status, signal_rate, sigma, target->RangeMaxMilliMeter, target->RangeMinMilliMeter);
-      
-      // Process measurement based on range status
-      bool should_publish = false;
-      float distance_m = distance_mm / 1000.0f;
+      const VL53LX_TargetRangeData_t* target = &ranging_data.RangeData[slot_result[i]];
+      const uint8_t range_status = target->RangeStatus;
+      FRAME_LOGD("Target %u: %u mm, status %u (%s), signal %.2f Mcps, sigma %.2f mm, range %u-%u mm", i,
+                 target->RangeMilliMeter, range_status, get_range_status_string(range_status),
+                 target->SignalRateRtnMegaCps / 65536.0f, target->SigmaMilliMeter / 65536.0f,
+                 target->RangeMinMilliMeter, target->RangeMaxMilliMeter);
       
-      switch (range_status) {
-        case VL53LX_RANGESTATUS_RANGE_VALID:
-          // Valid measurement - always publish
-          ESP_LOGI(TAG, "✅ Valid measurement: Target %u = %.3f m", i, distance_m);
-          should_publish = true;
-          break;
-          
-        case VL53LX_RANGESTATUS_RANGE_VALID_MERGED_PULSE:
-          // Multiple targets merged - still useful data
-          ESP_LOGW(TAG, "⚠️ Target %u: Multiple targets merged (status=11), Distance=%.3f m", i, distance_m);
-          should_publish = true;
-          break;
-          
-        case VL53LX_RANGESTATUS_NONE:
-          // No target detected for this slot (valid condition)
-          ESP_LOGD(TAG, "🔍 Target %u: No target detected (status=255)", i);
-          // Don't publish - sensor will show unavailable
-          break;
-          
-        case VL53LX_RANGESTATUS_SIGNAL_FAIL:
-          ESP_LOGW(TAG, "❌ Target %u: Signal too weak (status=2), Signal=%.2f Mcps", i, signal_rate);
-          break;
-          
-        case VL53LX_RANGESTATUS_SIGMA_FAIL:
-          ESP_LOGW(TAG, "❌ Target %u: Signal quality too low (status=1), Sigma=%.2f mm", i, sigma);
-          break;
-          
-        case VL53LX_RANGESTATUS_OUTOFBOUNDS_FAIL:
-          ESP_LOGW(TAG, "❌ Target %u: Measurement out of bounds (status=4)", i);
-          break;
-          
-        case VL53LX_RANGESTATUS_HARDWARE_FAIL:
-          ESP_LOGE(TAG, "❌ Target %u: Hardware/VCSEL failure (status=5)", i);
-          break;
-          
-        case VL53LX_RANGESTATUS_TARGET_PRESENT_LACK_OF_SIGNAL:
-          ESP_LOGW(TAG, "❌ Target %u: Target present but signal too weak (status=12)", i);
-          break;
-          
-        case VL53LX_RANGESTATUS_SYNCRONISATION_INT:
-          // Synchronization measurement - ignore
-          ESP_LOGD(TAG, "🔧 Target %u: Synchronization measurement - ignoring (status=10)", i);
-          break;
-          
-        case VL53LX_RANGESTATUS_RANGE_VALID_NO_WRAP_CHECK_FAIL:
-          // This should have been discarded as Range1
-          ESP_LOGW(TAG, "⚠️ Target %u: Range1 measurement detected - should have been discarded (status=6)", i);
-          break;
-          
-        case VL53LX_RANGESTATUS_WRAP_TARGET_FAIL:
-          ESP_LOGW(TAG, "❌ Target %u: Wraparound error (status=7)", i);
-          break;
-          
-        default:
-          ESP_LOGW(TAG, "❌ Target %u: Unknown measurement error, status=%u", i, range_status);
-          break;
-      }
+      // Valid and merged-pulse ranges are published; every status is counted
+      // for the periodic summary instead of being logged per frame
+      const bool should_publish = range_status == VL53LX_RANGESTATUS_RANGE_VALID ||
+                                  range_status == VL53LX_RANGESTATUS_RANGE_VALID_MERGED_PULSE;
       
-      // Publish valid measurements
-      if (should_publish) {
-        this->distance_sensors_[i]->publish_distance_state(distance_m);
+      // Publish valid measurements, smoothed by the slot's range filter
+      // (with tracking enabled, slots are published per track below)
+      if (should_publish && !this->tracking_) {
+        const int32_t filtered = this->range_filters_[i].update(target->RangeMilliMeter, target->SigmaMilliMeter,
+                                                                timing.data_ready_us);
+        this->publish_range_(i, filtered, range_status, timing.data_ready_us);
+      } else if (!this->tracking_) {
+        this->publish_lost_(i, range_status, timing.data_ready_us);
       }
     } else {
       // No target detected in this slot
-      ESP_LOGV(TAG, "Target %u: No data available (only %u targets detected)", i, ranging_data.NumberOfObjectsFound);
+      FRAME_LOGV("Target %u: No data available (only %u foreground targets)", i, num_slots);
       // Don't publish - let Home Assistant show "unavailable" for unused sensors
+      // (unless the slot's publish policy reports status changes)
+      if (!this->tracking_) {
+        this->publish_lost_(i, VL53LX_RANGESTATUS_NONE, timing.data_ready_us);
+      }
     }
   }
   
+  if (this->tracking_) {
+    this->publish_tracks_(frame);
+  }
+  
+  const uint64_t publish_end_us = now_us();
+  timing.publish_us = (uint32_t)(publish_end_us - publish_start_us);
+  timing.latency_us = (uint32_t)(publish_end_us - timing.data_ready_us);
+  this->last_frame_timing_ = timing;
+  this->metrics_i2c_bytes_ += timing.i2c_bytes;
+  this->metrics_i2c_read_us_ += timing.i2c_read_us;
+  this->metrics_processing_us_ += timing.processing_us;
+  this->metrics_latency_us_ += timing.latency_us;
+  FRAME_LOGV("Frame timing: ready->read=%u us, i2c=%u us (%u B), processing=%u us, publish=%u us",
+           timing.ready_to_read_us, timing.i2c_read_us, timing.i2c_bytes, timing.processing_us,
+           timing.publish_us);
+  
   // Store primary target distance for backward compatibility
   if (ranging_data.NumberOfObjectsFound > 0 && 
       ranging_data.RangeData[0].RangeStatus == VL53LX_RANGESTATUS_RANGE_VALID) {
     this->last_distance_mm_ = ranging_data.RangeData[0].RangeMilliMeter;
-    this->last_measurement_time_ = millis();
+    this->last_frame_time_us_ = timing.data_ready_us;
   }
   
   // Log crosstalk compensation events
   if (ranging_data.HasXtalkValueChanged) {
-    ESP_LOGD(TAG, "Crosstalk compensation applied (smudge correction)");
+    this->frame_log_counts_.xtalk_updates++;
+    FRAME_LOGD("Crosstalk compensation applied (smudge correction)");
+  }
+  
+  // Hand the raw frame to listeners (fusion, guard logic)
+  this->frame_callback_.call(frame);
+  
+  this->frame_count_++;
+  this->metrics_frames_++;
+  this->log_frame_summary_(timing.data_ready_us);
+  
+  if (this->low_power_ && !this->externally_triggered_) {
+    this->update_duty_cycle_(frame);
+  }
+  if (this->accumulation_) {
+    this->update_accumulation_(frame);
+  }
+  if (this->adaptive_timing_ && !this->idle_) {
+    this->adapt_timing_budget_(frame);
+  }
+  
+  return true;
+}
+
+bool VL53L3CXComponent::publish_range_(uint8_t slot, int32_t range_mm, uint8_t range_status, uint64_t timestamp_us) {
+  // Gate on the fixed-point range; only published values pay for the float conversion
+  if (!this->publish_policies_[slot].check_range(range_mm, range_status, timestamp_us)) {
+    this->suppressed_count_++;
+    return false;
+  }
+  this->publish_count_++;
+  this->distance_sensors_[slot]->publish_distance_state(range_mm / 65536000.0f);
+  return true;
+}
+
+void VL53L3CXComponent::publish_lost_(uint8_t slot, uint8_t range_status, uint64_t timestamp_us) {
+  if (this->publish_policies_[slot].check_lost(range_status, timestamp_us)) {
+    FRAME_LOGD("Target %u: status %u, clearing published range", slot, range_status);
+    this->publish_count_++;
+    this->distance_sensors_[slot]->publish_distance_state(NAN);
+  }
+}
+
+void VL53L3CXComponent::publish_tracks_(const Frame &frame) {
+  const uint8_t dropped = this->tracker_.update(frame);
+  
+  for (uint8_t slot = 0; slot < TargetTracker::MAX_TRACKS; slot++) {
+    if (dropped & (1 << slot)) {
+      // Track lost: clear its slot once so consumers do not hold a stale range
+      ESP_LOGD(TAG, "Track slot %u lost", slot);
+      this->range_filters_[slot].reset();
+      this->publish_policies_[slot].reset();
+      if (this->distance_sensors_[slot] != nullptr) {
+        this->publish_count_++;
+        this->distance_sensors_[slot]->publish_distance_state(NAN);
+      }
+      if (this->velocity_sensors_[slot] != nullptr) {
+        this->velocity_sensors_[slot]->publish_state(NAN);
+      }
+      continue;
+    }
+    
+    const Track &track = this->tracker_.get_track(slot);
+    if (!track.updated || !this->tracker_.is_reported(slot)) {
+      continue;
+    }
+    FRAME_LOGV("Track %u (slot %u): %.3f m, %.2f m/s, %u hits", track.id, slot, track.range_mm / 65536000.0f,
+             track.velocity_mmps / 65536000.0f, track.hits);
+    // Velocity follows the distance sensor's publish decision
+    bool published = true;
+    if (this->distance_sensors_[slot] != nullptr) {
+      const int32_t filtered = this->range_filters_[slot].update((int16_t)(track.range_mm >> 16), track.sigma_mm,
+                                                                 frame.timestamp_us);
+      published = this->publish_range_(slot, filtered, VL53LX_RANGESTATUS_RANGE_VALID, frame.timestamp_us);
+    }
+    if (published && this->velocity_sensors_[slot] != nullptr) {
+      this->velocity_sensors_[slot]->publish_state(track.velocity_mmps / 65536000.0f);
+    }
+  }
+}
+
+void VL53L3CXComponent::adapt_timing_budget_(const Frame &frame) {
+  // Minimum time between two budget changes, on top of the frame-count hysteresis
+  const uint64_t MIN_DWELL_US = 1000000;
+  
+  // Judge the primary target: a long budget is wasted on a strong, tight
+  // return, and a short one starves a weak or ambient-dominated one. A frame
+  // without any target is neutral, so an empty room keeps the budget where it
+  // is instead of ramping it up and slowing the reaction to the next arrival.
+  int8_t vote = 0;
+  const FrameTarget &primary = frame.targets[0];
+  const bool valid = primary.range_status == VL53LX_RANGESTATUS_RANGE_VALID ||
+                     primary.range_status == VL53LX_RANGESTATUS_RANGE_VALID_MERGED_PULSE;
+  if (frame.num_targets == 0) {
+    // Neutral
+  } else if (!valid || primary.sigma_mm > this->target_sigma_ ||
+             primary.signal_rate_mcps < primary.ambient_rate_mcps) {
+    vote = 1;
+  } else if (primary.sigma_mm < this->target_sigma_ / 2) {
+    vote = -1;
+  }
+  
+  // Hysteresis: a step needs hold_frames consecutive agreeing votes
+  if (vote == 0 || (vote > 0) != (this->adapt_votes_ > 0)) {
+    this->adapt_votes_ = vote;
+    return;
+  }
+  if (std::abs(this->adapt_votes_) < this->adapt_hold_frames_) {
+    this->adapt_votes_ += vote;
+    return;
+  }
+  if (frame.timestamp_us - this->last_budget_change_us_ < MIN_DWELL_US) {
+    return;
+  }
+  
+  // Multiplicative steps: x1.5 up, x0.75 down, clamped to the configured bounds
+  uint32_t budget = vote > 0 ? this->timing_budget_us_ + this->timing_budget_us_ / 2
+                             : this->timing_budget_us_ - this->timing_budget_us_ / 4;
+  budget = clamp(budget, this->min_timing_budget_us_, this->max_timing_budget_us_);
+  this->adapt_votes_ = 0;
+  if (budget == this->timing_budget_us_) {
+    return;
+  }
+  
+  ESP_LOGD(TAG, "Adaptive timing: %u -> %u µs (sigma=%.1f mm, signal=%.2f Mcps, ambient=%.2f Mcps)",
+           this->timing_budget_us_, budget, primary.sigma_mm / 65536.0f, primary.signal_rate_mcps / 65536.0f,
+           primary.ambient_rate_mcps / 65536.0f);
+  if (this->apply_timing_budget_(budget)) {
+    this->last_budget_change_us_ = frame.timestamp_us;
+  }
+}
+
+bool VL53L3CXComponent::apply_timing_budget_(uint32_t budget_us, uint32_t period_ms) {
+  // Budget and period are only latched by a full start, so stop, reprogram
+  // and restart ranging; the rest of the configuration is left untouched.
+  // A non-zero period_ms (low-power idle) overrides the configured period.
+  VL53LX_StopMeasurement(this->device_);
+  
+  VL53LX_Error status = VL53LX_SetMeasurementTimingBudgetMicroSeconds(this->device_, budget_us);
+  if (status != VL53LX_ERROR_NONE) {
+    ESP_LOGW(TAG, "Failed to set timing budget: %d (%s)", status, get_error_string(status));
+    budget_us = this->timing_budget_us_;
+  }
+  this->timing_budget_us_ = budget_us;
+  
+  uint32_t imp_ms;
+  if (period_ms != 0) {
+    imp_ms = std::max<uint32_t>(period_ms, budget_us / 1000u);
+  } else if (this->inter_measurement_period_set_) {
+    imp_ms = std::max<uint32_t>(this->inter_measurement_period_ms_, budget_us / 1000u);
+  } else {
+    imp_ms = (budget_us / 1000u) + 5;  // Same guard interval as initialize_device_
+    this->inter_measurement_period_ms_ = imp_ms;
+  }
+  VL53LX_Error imp_status = VL53LX_set_inter_measurement_period_ms(this->device_, imp_ms);
+  if (imp_status != VL53LX_ERROR_NONE) {
+    ESP_LOGW(TAG, "Failed to set inter-measurement period: %d (%s)", imp_status, get_error_string(imp_status));
+  }
+  
+  // The first range after a restart has no wrap-around check and the stream
+  // count starts over
+  this->first_measurement_discarded_ = false;
+  this->last_stream_count_ = 0;
+  this->capture_snapshot_pending_ = true;
+  
+  if (this->externally_triggered_) {
+    // Next trigger performs the full start
+    this->measurement_started_ = false;
+    this->range_in_flight_ = false;
+  } else {
+    VL53LX_Error start_status = VL53LX_StartMeasurement(this->device_);
+    if (start_status != VL53LX_ERROR_NONE) {
+      ESP_LOGW(TAG, "Failed to restart measurement: %d (%s)", start_status, get_error_string(start_status));
+      return false;
+    }
+  }
+  
+  if (this->timing_budget_sensor_ != nullptr) {
+    this->timing_budget_sensor_->publish_state(this->timing_budget_us_ / 1000.0f);
+  }
+  return status == VL53LX_ERROR_NONE;
+}
+
+uint32_t VL53L3CXComponent::frame_period_ms_() const {
+  const uint32_t period_ms = this->idle_ ? this->idle_period_ms_ : this->inter_measurement_period_ms_;
+  return std::max<uint32_t>(period_ms, this->timing_budget_us_ / 1000);
+}
+
+void VL53L3CXComponent::update_duty_cycle_(const Frame &frame) {
+  const uint64_t now = frame.timestamp_us;
+  bool present = false;
+  for (uint8_t i = 0; i < frame.num_targets; i++) {
+    const FrameTarget &target = frame.targets[i];
+    if ((target.range_status == VL53LX_RANGESTATUS_RANGE_VALID ||
+         target.range_status == VL53LX_RANGESTATUS_RANGE_VALID_MERGED_PULSE) &&
+        !target.is_background && target.range_mm > 0 && target.range_mm < this->wake_distance_mm_) {
+      present = true;
+      break;
+    }
+  }
+  if (present || this->last_presence_us_ == 0) {
+    this->last_presence_us_ = now;
+  }
+  
+  // First frame at full rate after a wake-up
+  if (!this->idle_ && this->wake_frame_us_ != 0) {
+    const uint32_t latency_us = (uint32_t)(now - this->wake_frame_us_);
+    this->wake_frame_us_ = 0;
+    ESP_LOGD(TAG, "Full rate resumed %u ms after the waking frame", latency_us / 1000);
+    if (this->wake_latency_sensor_ != nullptr) {
+      this->wake_latency_sensor_->publish_state(latency_us / 1000.0f);
+    }
+  }
+  
+  if (this->idle_ && present) {
+    ESP_LOGI(TAG, "Target within %u mm, back to full rate", this->wake_distance_mm_);
+    this->wake_frame_us_ = now;
+    this->set_idle_(false, now);
+  } else if (!this->idle_ && now - this->last_presence_us_ >= this->idle_after_us_) {
+    ESP_LOGI(TAG, "No target within %u mm for %u s, ranging every %u ms", this->wake_distance_mm_,
+             (uint32_t)(this->idle_after_us_ / 1000000), this->idle_period_ms_);
+    this->set_idle_(true, now);
+  }
+}
+
+void VL53L3CXComponent::update_accumulation_(const Frame &frame) {
+  int16_t nearest_mm = INT16_MAX;
+  for (uint8_t i = 0; i < frame.num_targets; i++) {
+    const FrameTarget &target = frame.targets[i];
+    if ((target.range_status == VL53LX_RANGESTATUS_RANGE_VALID ||
+         target.range_status == VL53LX_RANGESTATUS_RANGE_VALID_MERGED_PULSE) &&
+        !target.is_background && target.range_mm > 0) {
+      nearest_mm = std::min(nearest_mm, target.range_mm);
+    }
+  }
+  if (nearest_mm == INT16_MAX) {
+    return;
+  }
+  const uint8_t band = std::min<uint8_t>(nearest_mm / 1000, FrameLogCounts::ACCUMULATION_BANDS - 1);
+  this->frame_log_counts_.band_frames[band]++;
+  this->frame_log_counts_.band_histograms[band] += frame.histograms;
+  
+  // A near target is strong enough in one histogram and may be moving: sum
+  // from the next histogram only, so its range stays fresh
+  if (nearest_mm < this->accumulation_near_mm_) {
+    VL53LX_restart_histo_merge(this->device_);
+  }
+}
+
+void VL53L3CXComponent::set_idle_(bool idle, uint64_t now_us) {
+  if (idle == this->idle_) {
+    return;
+  }
+  this->idle_ = idle;
+  this->last_duty_change_us_ = now_us;
+  if (idle) {
+    this->active_timing_budget_us_ = this->timing_budget_us_;
+    this->active_update_interval_ms_ = this->get_update_interval();
+    const uint32_t budget_us =
+        this->idle_timing_budget_us_ != 0 ? this->idle_timing_budget_us_ : this->timing_budget_us_;
+    this->apply_timing_budget_(budget_us, this->idle_period_ms_);
+    // Poll for data-ready at half the idle period instead of the full-rate interval
+    this->set_update_interval(std::max<uint32_t>(this->active_update_interval_ms_, this->idle_period_ms_ / 2));
+  } else {
+    // A recovering sensor gets the active budget from its re-init instead
+    if (this->device_initialized_) {
+      this->apply_timing_budget_(this->active_timing_budget_us_);
+    } else {
+      this->timing_budget_us_ = this->active_timing_budget_us_;
+    }
+    this->set_update_interval(this->active_update_interval_ms_);
+  }
+  this->start_poller();  // Re-arms update() with the new interval
+  if (this->low_power_binary_sensor_ != nullptr) {
+    this->low_power_binary_sensor_->publish_state(idle);
+  }
+}
+
+void VL53L3CXComponent::update_metrics_(uint64_t now_us) {
+  // Metric sensors are published at most this often
+  const uint64_t METRICS_INTERVAL_US = 5000000;
+  
+  if (this->metrics_start_us_ == 0) {
+    this->metrics_start_us_ = now_us;
+    this->metrics_frames_ = 0;
+    this->metrics_i2c_bytes_ = 0;
+    this->metrics_i2c_read_us_ = 0;
+    this->metrics_processing_us_ = 0;
+    this->metrics_latency_us_ = 0;
+    if (this->timing_budget_sensor_ != nullptr) {
+      this->timing_budget_sensor_->publish_state(this->timing_budget_us_ / 1000.0f);
+    }
+    if (this->performance_degraded_binary_sensor_ != nullptr) {
+      this->performance_degraded_binary_sensor_->publish_initial_state(false);
+    }
+    if (this->low_power_binary_sensor_ != nullptr) {
+      this->low_power_binary_sensor_->publish_initial_state(this->idle_);
+    }
+    this->metrics_i2c_total_start_ = this->i2c_bytes_;
+    this->metrics_dmax_lookups_start_ = VL53LXDevDataGet(this->device_, LLData.dmax_cache.lookups);
+    this->metrics_dmax_hits_start_ = VL53LXDevDataGet(this->device_, LLData.dmax_cache.hits);
+    return;
+  }
+  const uint64_t elapsed_us = now_us - this->metrics_start_us_;
+  if (elapsed_us < METRICS_INTERVAL_US) {
+    return;
   }
   
+  if (this->frame_rate_sensor_ != nullptr) {
+    this->frame_rate_sensor_->publish_state(this->metrics_frames_ * 1e6f / elapsed_us);
+  }
+  if (this->frames_sensor_ != nullptr) {
+    this->frames_sensor_->publish_state(this->frame_count_);
+  }
+  if (this->publishes_sensor_ != nullptr) {
+    this->publishes_sensor_->publish_state(this->publish_count_);
+  }
+  if (this->missed_measurements_sensor_ != nullptr) {
+    this->missed_measurements_sensor_->publish_state(this->missed_measurements_);
+  }
+  if (this->consecutive_errors_sensor_ != nullptr) {
+    this->consecutive_errors_sensor_->publish_state(this->consecutive_errors_);
+  }
+  if (this->total_measurements_sensor_ != nullptr) {
+    this->total_measurements_sensor_->publish_state(this->total_measurements_);
+  }
+  if (this->valid_measurements_sensor_ != nullptr) {
+    this->valid_measurements_sensor_->publish_state(this->valid_measurements_);
+  }
+  
+  // Per-frame averages over the interval; NaN when no frame arrived
+  const uint32_t frames = this->metrics_frames_;
+  if (this->i2c_bytes_sensor_ != nullptr) {
+    this->i2c_bytes_sensor_->publish_state(frames > 0 ? (float) this->metrics_i2c_bytes_ / frames : NAN);
+  }
+  if (this->i2c_read_time_sensor_ != nullptr) {
+    this->i2c_read_time_sensor_->publish_state(frames > 0 ? this->metrics_i2c_read_us_ / 1000.0f / frames : NAN);
+  }
+  if (this->processing_time_sensor_ != nullptr) {
+    this->processing_time_sensor_->publish_state(frames > 0 ? this->metrics_processing_us_ / 1000.0f / frames : NAN);
+  }
+  if (this->publish_latency_sensor_ != nullptr) {
+    this->publish_latency_sensor_->publish_state(frames > 0 ? this->metrics_latency_us_ / 1000.0f / frames : NAN);
+  }
+  // All bus traffic including data-ready polls: with the frame rate, a proxy for average current
+  if (this->i2c_throughput_sensor_ != nullptr) {
+    this->i2c_throughput_sensor_->publish_state((this->i2c_bytes_ - this->metrics_i2c_total_start_) * 1e6f / elapsed_us);
+  }
+  this->metrics_i2c_total_start_ = this->i2c_bytes_;
+  // Share of dmax stages served from this sensor's memo in the driver
+  const uint32_t dmax_lookups = VL53LXDevDataGet(this->device_, LLData.dmax_cache.lookups);
+  const uint32_t dmax_hits = VL53LXDevDataGet(this->device_, LLData.dmax_cache.hits);
+  if (this->dmax_cache_hit_rate_sensor_ != nullptr) {
+    const uint32_t lookups = dmax_lookups - this->metrics_dmax_lookups_start_;
+    this->dmax_cache_hit_rate_sensor_->publish_state(
+        lookups > 0 ? 100.0f * (dmax_hits - this->metrics_dmax_hits_start_) / lookups : NAN);
+  }
+  this->metrics_dmax_lookups_start_ = dmax_lookups;
+  this->metrics_dmax_hits_start_ = dmax_hits;
+  ESP_LOGV(TAG, "Frames: %u, published: %u, suppressed: %u", this->frame_count_, this->publish_count_,
+           this->suppressed_count_);
+  
+  this->check_performance_(now_us);
+  
+  this->metrics_frames_ = 0;
+  this->metrics_i2c_bytes_ = 0;
+  this->metrics_i2c_read_us_ = 0;
+  this->metrics_processing_us_ = 0;
+  this->metrics_latency_us_ = 0;
+  this->metrics_start_us_ = now_us;
+}
+
+void VL53L3CXComponent::check_performance_(uint64_t now_us) {
+  // Enter degraded above these rates over the window, leave below half of them
+  const uint32_t MAX_ERROR_PCT = 10;   // Failed result reads per attempt
+  const uint32_t MAX_MISSED_PCT = 10;  // Frames lost on the sensor side (StreamCount gaps)
+  const uint32_t MIN_RATE_PCT = 50;    // Achieved vs expected frame rate
+  
+  PerformanceSample &sample = this->performance_samples_[this->performance_sample_index_];
+  sample.timestamp_us = now_us;
+  sample.attempts = this->total_measurements_;
+  sample.valid = this->valid_measurements_;
+  sample.frames = this->frame_count_;
+  sample.missed = this->missed_measurements_;
+  this->performance_sample_index_ = (this->performance_sample_index_ + 1) % PERFORMANCE_WINDOW;
+  this->last_performance_check_ = (uint32_t)(now_us / 1000);
+  if (this->performance_sample_count_ < PERFORMANCE_WINDOW) {
+    this->performance_sample_count_++;
+    return;
+  }
+  
+  // The slot after the newest one is now the oldest sample of the window
+  const PerformanceSample &oldest = this->performance_samples_[this->performance_sample_index_];
+  const uint32_t attempts = sample.attempts - oldest.attempts;
+  const uint32_t failed = attempts - (sample.valid - oldest.valid);
+  const uint32_t frames = sample.frames - oldest.frames;
+  const uint32_t missed = sample.missed - oldest.missed;
+  const uint32_t window_ms = (uint32_t)((sample.timestamp_us - oldest.timestamp_us) / 1000);
+  
+  const uint32_t error_pct = attempts > 0 ? failed * 100 / attempts : 0;
+  const uint32_t missed_pct = frames + missed > 0 ? missed * 100 / (frames + missed) : 0;
+  // A free-running sensor should deliver one frame per inter-measurement period,
+  // or one per poll when polling is slower; the scheduler owns the rate otherwise.
+  // A duty-cycle switch inside the window makes the expected rate meaningless.
+  uint32_t rate_pct = 100;
+  if (!this->externally_triggered_ && sample.timestamp_us - this->last_duty_change_us_ > window_ms * 1000ULL) {
+    const uint32_t frame_period_ms = std::max<uint32_t>(this->frame_period_ms_(), this->get_update_interval());
+    const uint32_t expected = window_ms / std::max<uint32_t>(frame_period_ms, 1);
+    rate_pct = expected > 0 ? std::min<uint32_t>(frames * 100 / expected, 100) : 100;
+  }
+  
+  const bool was_degraded = this->performance_degraded_;
+  if (!was_degraded) {
+    this->performance_degraded_ = error_pct > MAX_ERROR_PCT || missed_pct > MAX_MISSED_PCT || rate_pct < MIN_RATE_PCT;
+  } else {
+    this->performance_degraded_ = error_pct > MAX_ERROR_PCT / 2 || missed_pct > MAX_MISSED_PCT / 2 ||
+                                  rate_pct < 100 - (100 - MIN_RATE_PCT) / 2;
+  }
+  if (this->performance_degraded_ != was_degraded) {
+    if (this->performance_degraded_) {
+      ESP_LOGW(TAG, "Performance degraded over the last %u s: %u%% read errors, %u%% missed, "
+               "%u%% of expected frame rate", window_ms / 1000, error_pct, missed_pct, rate_pct);
+    } else {
+      ESP_LOGI(TAG, "Performance recovered: %u%% read errors, %u%% missed, %u%% of expected frame rate", error_pct,
+               missed_pct, rate_pct);
+    }
+    if (this->performance_degraded_binary_sensor_ != nullptr) {
+      this->performance_degraded_binary_sensor_->publish_state(this->performance_degraded_);
+    }
+  }
+}
+
+void VL53L3CXComponent::log_frame_summary_(uint64_t now_us) {
+  if (this->log_summary_interval_us_ == 0) {
+    return;
+  }
+  if (this->log_summary_start_us_ == 0) {
+    this->log_summary_start_us_ = now_us;
+    return;
+  }
+  const uint64_t elapsed_us = now_us - this->log_summary_start_us_;
+  if (elapsed_us < this->log_summary_interval_us_) {
+    return;
+  }
+  
+  const FrameLogCounts &counts = this->frame_log_counts_;
+  uint32_t other_fail = 0;
+  for (uint8_t status = 0; status < FrameLogCounts::OTHER_STATUS; status++) {
+    if (status != VL53LX_RANGESTATUS_RANGE_VALID && status != VL53LX_RANGESTATUS_RANGE_VALID_MERGED_PULSE &&
+        status != VL53LX_RANGESTATUS_SIGMA_FAIL && status != VL53LX_RANGESTATUS_SIGNAL_FAIL) {
+      other_fail += counts.status[status];
+    }
+  }
+  ESP_LOGI(TAG, "Last %u s: %u frames, %u missed; results: %u valid, %u merged, %u sigma fail, %u signal fail, "
+           "%u other fail, %u none; %u background, %u xtalk updates",
+           (uint32_t)(elapsed_us / 1000000), this->frame_count_ - this->log_summary_frames_,
+           this->missed_measurements_ - this->log_summary_missed_,
+           counts.status[VL53LX_RANGESTATUS_RANGE_VALID], counts.status[VL53LX_RANGESTATUS_RANGE_VALID_MERGED_PULSE],
+           counts.status[VL53LX_RANGESTATUS_SIGMA_FAIL], counts.status[VL53LX_RANGESTATUS_SIGNAL_FAIL], other_fail,
+           counts.status[FrameLogCounts::OTHER_STATUS], counts.background, counts.xtalk_updates);
+  
+  if (this->accumulation_) {
+    // Effective latency: mean age of the summed light at data ready. Half a
+    // budget for the newest histogram; the sensor alternates two timings, so
+    // each older histogram of the same timing is two frame periods older.
+    char bands[FrameLogCounts::ACCUMULATION_BANDS][24];
+    for (uint8_t band = 0; band < FrameLogCounts::ACCUMULATION_BANDS; band++) {
+      if (counts.band_frames[band] == 0) {
+        snprintf(bands[band], sizeof(bands[band]), "-");
+        continue;
+      }
+      const float histograms = (float) counts.band_histograms[band] / counts.band_frames[band];
+      const float latency_ms = this->timing_budget_us_ / 2000.0f + (histograms - 1.0f) * this->frame_period_ms_();
+      snprintf(bands[band], sizeof(bands[band]), "%.1f hist, %.0f ms", histograms, latency_ms);
+    }
+    ESP_LOGI(TAG, "Accumulation by nearest target: <1 m %s; 1-2 m %s; 2-3 m %s; >3 m %s", bands[0], bands[1],
+             bands[2], bands[3]);
+  }
+  
+  this->frame_log_counts_ = FrameLogCounts{};
+  this->log_summary_frames_ = this->frame_count_;
+  this->log_summary_missed_ = this->missed_measurements_;
+  this->log_summary_start_us_ = now_us;
+}
+
+void VL53L3CXComponent::record_i2c_read(uint16_t index, const uint8_t *data, uint32_t count) {
+  if (!this->capturing_) {
+    return;
+  }
+  const uint8_t header[4] = {(uint8_t)(index >> 8), (uint8_t) index, (uint8_t)(count >> 8), (uint8_t) count};
+  this->capture_reads_.insert(this->capture_reads_.end(), header, header + 4);
+  this->capture_reads_.insert(this->capture_reads_.end(), data, data + count);
+}
+
+// A capture is a snapshot of the driver state followed by the I2C reads of
+// every frame. Replaying the reads from the snapshot through the driver
+// reproduces the frames, so the host can re-run post-processing with other
+// tuning (tools/hist_sweep).
+void VL53L3CXComponent::capture_begin_() {
+  if (!this->histogram_capture_) {
+    return;
+  }
+  if (this->capture_snapshot_pending_) {
+    const uint8_t *state = reinterpret_cast<const uint8_t *>(&this->device_->Data);
+    const size_t size = sizeof(this->device_->Data);
+    ESP_LOGI(CAPTURE_TAG, "V %u %u", (uint32_t) VL53LX_DEVDATA_VERSION, (uint32_t) size);
+    for (size_t offset = 0; offset < size; offset += CAPTURE_LINE_BYTES) {
+      ESP_LOGI(CAPTURE_TAG, "S %u %u %s", (uint32_t) size, (uint32_t) offset,
+               format_hex(state + offset, std::min(CAPTURE_LINE_BYTES, size - offset)).c_str());
+    }
+    this->capture_snapshot_pending_ = false;
+  }
+  this->capture_reads_.clear();
+  this->capturing_ = true;
+}
+
+void VL53L3CXComponent::capture_abort_() {
+  // The driver state has moved on without a complete frame: start over from a new snapshot
+  if (this->capturing_) {
+    this->capturing_ = false;
+    this->capture_snapshot_pending_ = true;
+  }
+}
+
+void VL53L3CXComponent::capture_end_(uint8_t stream_count) {
+  if (!this->capturing_) {
+    return;
+  }
+  this->capturing_ = false;
+  size_t pos = 0;
+  while (pos + 4 <= this->capture_reads_.size()) {
+    const uint8_t *header = &this->capture_reads_[pos];
+    const uint16_t index = (header[0] << 8) | header[1];
+    const size_t count = (header[2] << 8) | header[3];
+    const uint8_t *data = header + 4;
+    for (size_t offset = 0; offset < count; offset += CAPTURE_LINE_BYTES) {
+      const std::string hex = format_hex(data + offset, std::min(CAPTURE_LINE_BYTES, count - offset));
+      if (offset == 0) {
+        ESP_LOGI(CAPTURE_TAG, "R %04X %u %s", index, (uint32_t) count, hex.c_str());
+      } else {
+        ESP_LOGI(CAPTURE_TAG, "+ %s", hex.c_str());
+      }
+    }
+    pos += 4 + count;
+  }
+  ESP_LOGI(CAPTURE_TAG, "F %u", stream_count);
+}
+
+bool VL53L3CXComponent::trigger_measurement(bool force) {
+  if (!this->device_initialized_ || (this->range_in_flight_ && !force)) {
+    return false;
+  }
+  
+  VL53LX_Error status = this->measurement_started_ ? VL53LX_ClearInterruptAndStartMeasurement(this->device_)
+                                                   : VL53LX_StartMeasurement(this->device_);
+  if (status != VL53LX_ERROR_NONE) {
+    ESP_LOGW(TAG, "Failed to trigger measurement: %d (%s)", status, get_error_string(status));
+    return false;
+  }
+  this->measurement_started_ = true;
+  if (!this->range_in_flight_) {
+    // Restarting a range that never reported back is not activity, or a wedged
+    // sensor would never reach the stall timeout
+    this->last_activity_us_ = now_us();
+  }
+  this->range_in_flight_ = true;
   return true;
 }
 
@@ -663,7 +1496,7 @@ void VL53L3CXComponent::setup_gpio_pins_() {
   if (this->xshut_pin_) {
     this->xshut_pin_->setup();
     this->xshut_pin_->pin_mode(gpio::FLAG_OUTPUT);
-    this->xshut_pin_->digital_write(true);
+    this->xshut_pin_->digital_write(false);  // Hold in reset until released
     ESP_LOGD(TAG, "XSHUT pin configured");
   }
   
@@ -674,6 +1507,127 @@ void VL53L3CXComponent::setup_gpio_pins_() {
   }
 }
 
+uint32_t VL53L3CXComponent::stall_timeout_us_() const {
+  // Ten frame periods, but never less than 2 s
+  return std::max<uint32_t>(this->frame_period_ms_() * 10000, 2000000);
+}
+
+void VL53L3CXComponent::supervise_(uint64_t poll_us) {
+  if (this->last_activity_us_ == 0) {
+    this->last_activity_us_ = poll_us;
+    this->publish_health_();
+  }
+  
+  // Ranging but nothing read back: a wedged sensor never raises read errors
+  if (this->supervisor_.is_healthy() && this->device_initialized_ &&
+      (!this->externally_triggered_ || this->range_in_flight_) &&
+      poll_us - this->last_activity_us_ > this->stall_timeout_us_()) {
+    ESP_LOGW(TAG, "No frame for %u ms, starting recovery", (uint32_t)((poll_us - this->last_activity_us_) / 1000));
+    this->enter_recovery_(poll_us, RECOVERY_SOFT_RESTART);
+  }
+  
+  const RecoveryStage stage = this->supervisor_.poll(poll_us);
+  if (stage == RECOVERY_NONE) {
+    return;
+  }
+  this->publish_health_();
+  const bool ok = this->run_recovery_(stage);
+  const uint64_t done_us = now_us();
+  ESP_LOGW(TAG, "Recovery attempt %u (%s) %s", this->supervisor_.get_attempts(),
+           stage == RECOVERY_SOFT_RESTART ? "soft restart" : stage == RECOVERY_HARD_RESET ? "hard reset" : "re-init",
+           ok ? "done, waiting for a frame" : "failed");
+  this->supervisor_.set_verify_timeout(this->stall_timeout_us_());
+  this->supervisor_.report_action(ok, done_us);
+  if (ok) {
+    this->last_activity_us_ = done_us;
+  }
+}
+
+void VL53L3CXComponent::enter_recovery_(uint64_t now_us, RecoveryStage first_stage) {
+  if (!this->supervisor_.is_healthy()) {
+    return;
+  }
+  this->supervisor_.report_fault(now_us, first_stage);
+  this->device_initialized_ = false;  // Stops polling and scheduler triggers until a stage succeeds
+  this->status_set_warning();
+  this->publish_health_();
+}
+
+bool VL53L3CXComponent::run_recovery_(RecoveryStage stage) {
+  // Every stage restarts ranging: Range1 is discarded again and StreamCount restarts.
+  // Re-init programs the active budget, so low-power idle is left first.
+  this->device_initialized_ = false;
+  this->set_idle_(false, now_us());
+  this->last_presence_us_ = 0;
+  this->measurement_started_ = false;
+  this->range_in_flight_ = false;
+  this->first_measurement_discarded_ = false;
+  this->last_stream_count_ = 0;
+  this->capture_snapshot_pending_ = true;
+  this->consecutive_errors_ = 0;
+  
+  switch (stage) {
+    case RECOVERY_SOFT_RESTART: {
+      VL53LX_StopMeasurement(this->device_);
+      if (this->externally_triggered_) {
+        // The next trigger starts ranging again
+        this->device_initialized_ = true;
+        return true;
+      }
+      const VL53LX_Error status = VL53LX_StartMeasurement(this->device_);
+      if (status != VL53LX_ERROR_NONE) {
+        ESP_LOGW(TAG, "Soft restart failed: %d (%s)", status, get_error_string(status));
+        return false;
+      }
+      this->device_initialized_ = true;
+      return true;
+    }
+    case RECOVERY_REINIT:
+      // Start over from blank driver state; the calibration cache lives in the hub
+      memset(this->device_, 0, sizeof(VL53LX_Dev_t));
+      this->device_->i2c_slave_address = this->address_ << 1;
+      this->device_->comms_handle = this;
+      this->metrics_dmax_lookups_start_ = 0;  // The driver's dmax cache counters restart too
+      this->metrics_dmax_hits_start_ = 0;
+      // fall through
+    case RECOVERY_HARD_RESET:
+      if (this->xshut_pin_ != nullptr) {
+        this->reset_device_();
+      } else {
+        VL53LX_StopMeasurement(this->device_);
+      }
+      // DataInit, stored calibration and the full configuration are applied again
+      return this->boot_device_() && this->start_device_();
+    default:
+      return false;
+  }
+}
+
+void VL53L3CXComponent::publish_health_() {
+  if (this->health_text_sensor_ != nullptr) {
+    static const char *const HEALTH_NAMES[] = {"OK", "SOFT_RESTART", "HARD_RESET", "REINIT"};
+    this->health_text_sensor_->publish_state(HEALTH_NAMES[this->supervisor_.get_stage()]);
+  }
+  if (this->supervisor_.is_healthy() && this->supervisor_.get_recoveries() > 0) {
+    if (this->recoveries_sensor_ != nullptr) {
+      this->recoveries_sensor_->publish_state(this->supervisor_.get_recoveries());
+    }
+    if (this->time_to_recover_sensor_ != nullptr) {
+      this->time_to_recover_sensor_->publish_state(this->supervisor_.get_last_recovery_us() / 1e6f);
+    }
+  }
+}
+
+void VL53L3CXComponent::hold_in_reset_() {
+  if (this->xshut_pin_ == nullptr) {
+    return;
+  }
+  // A sensor that did not leave the default address would answer for the next
+  // one released there; keep it in reset until recovery tries again
+  this->xshut_pin_->digital_write(false);
+  this->device_->i2c_slave_address = this->address_ << 1;
+}
+
 void VL53L3CXComponent::reset_device_() {
   if (!this->xshut_pin_) {
     return;
@@ -801,6 +1755,24 @@ void VL53L3CXComponent::perform_offset_calibration() {
   VL53LX_StartMeasurement(this->device_);
 }
 
+void VL53L3CXComponent::start_background_learning() {
+  if (!this->background_enabled_) {
+    ESP_LOGW(TAG, "Background subtraction is not configured");
+    return;
+  }
+  ESP_LOGI(TAG, "Learning background for %u s - keep the scene empty", this->background_learn_duration_us_ / 1000000);
+  this->background_.start_learning(now_us(), this->background_learn_duration_us_);
+}
+
+void VL53L3CXComponent::reset_background() {
+  this->background_.clear();
+  if (this->background_enabled_ && global_preferences != nullptr &&
+      this->background_pref_.save(&this->background_.get_table())) {
+    global_preferences->sync();
+  }
+  ESP_LOGI(TAG, "Background model cleared");
+}
+
 void VL53L3CXComponent::perform_zero_distance_calibration() {
   ESP_LOGI(TAG, "Starting Zero-Distance calibration (field calibration)...");
   ESP_LOGI(TAG, "IMPORTANT: Place target (e.g. paper) directly touching the cover glass");
@@ -3,8 +3,20 @@
 #include "esphome/core/component.h"
 #include "esphome/core/hal.h"
 #include "esphome/components/i2c/i2c.h"
+#include "esphome/components/sensor/sensor.h"
+#include "esphome/components/binary_sensor/binary_sensor.h"
+#include "esphome/components/text_sensor/text_sensor.h"
 #include "esphome/core/preferences.h"
+#include "esphome/core/helpers.h"
+#include "frame.h"
+#include "range_filter.h"
+#include "publish_policy.h"
+#include "background_model.h"
+#include "target_tracker.h"
+#include "recovery_supervisor.h"
+#include <algorithm>
 #include <array>
+#include <vector>
 
 // Include the VL53LX device structure definition
 extern "C" {
@@ -25,6 +37,8 @@ class RefSpadCalibrationButton;
 class CrosstalkCalibrationButton;
 class OffsetCalibrationButton;
 class ZeroDistanceCalibrationButton;
+class LearnBackgroundButton;
+class ResetBackgroundButton;
 
 // Base class for sensors to avoid incomplete type issues
 class VL53L3CXSensorBase {
@@ -40,6 +54,41 @@ class VL53L3CXBinarySensorBase {
   virtual void publish_state(bool state) = 0;
 };
 
+// Per-frame latency breakdown. Timestamps come from the µs platform timebase
+// (VL53LX_GetTimestampUs); durations are in µs.
+struct FrameTiming {
+  uint64_t data_ready_us{0};      // When data-ready was observed
+  uint32_t ready_to_read_us{0};   // Data-ready -> start of result read
+  uint32_t i2c_read_us{0};        // Bus time spent inside VL53LX_GetMultiRangingData
+  uint32_t processing_us{0};      // Host-side histogram post-processing (rest of the call)
+  uint32_t publish_us{0};         // Publishing target states
+  uint32_t i2c_bytes{0};          // Bytes moved on the bus for the result read
+  uint32_t latency_us{0};         // Data-ready -> end of publishing
+};
+
+// Cumulative counters at the end of one metrics interval; the degradation
+// detector compares the newest and oldest sample of a rolling window
+struct PerformanceSample {
+  uint64_t timestamp_us{0};
+  uint32_t attempts{0};  // total_measurements_
+  uint32_t valid{0};     // valid_measurements_
+  uint32_t frames{0};    // frame_count_
+  uint32_t missed{0};    // missed_measurements_
+};
+
+// Frame-path events counted between two log summaries, in place of per-frame log lines
+struct FrameLogCounts {
+  static const uint8_t OTHER_STATUS = 13;  // Index shared by NONE (255) and unknown statuses
+  std::array<uint32_t, OTHER_STATUS + 1> status{};  // Results per VL53LX_RANGESTATUS_* code
+  uint32_t background{0};  // Results matching the learned background
+  uint32_t xtalk_updates{0};  // Smudge correction updates
+  // Histogram accumulation: frames, and histograms summed into them, per 1 m
+  // band of the nearest foreground target
+  static const uint8_t ACCUMULATION_BANDS = 4;
+  std::array<uint32_t, ACCUMULATION_BANDS> band_frames{};
+  std::array<uint32_t, ACCUMULATION_BANDS> band_histograms{};
+};
+
 // Main sensor hub component
 class VL53L3CXComponent : public PollingComponent, public i2c::I2CDevice {
  public:
@@ -67,12 +116,111 @@ class VL53L3CXComponent : public PollingComponent, public i2c::I2CDevice {
   void set_merge_threshold(uint32_t threshold) { this->merge_threshold_ = threshold; }
   void set_hist_merge_enabled(bool enabled) { this->hist_merge_enabled_ = enabled; }
   void set_hist_noise_threshold(uint16_t threshold) { this->hist_noise_threshold_ = threshold; }
-  void set_hist_merge_max_size(uint8_t size) { this->hist_merge_max_size_ = size; }
-  void set_xshut_pin(GPIOPin *pin) { this->xshut_pin_ = pin; }
+  void set_hist_merge_max_size(uint8_t size) {
+    this->hist_merge_max_size_ = std::min<uint8_t>(size, VL53LX_BIN_REC_SIZE);
+  }
+  void set_peak_estimator(uint8_t estimator) { this->peak_estimator_ = estimator; }  // VL53LX_HIST_PEAK_ESTIMATOR__*
+  void set_histogram_capture(bool capture) { this->histogram_capture_ = capture; }
+  void set_adaptive_timing(uint32_t min_budget_us, uint32_t max_budget_us, float target_sigma_mm, uint8_t hold_frames) {
+    this->adaptive_timing_ = true;
+    this->min_timing_budget_us_ = min_budget_us;
+    this->max_timing_budget_us_ = max_budget_us;
+    this->target_sigma_ = (FixPoint1616_t)(target_sigma_mm * 65536.0f);
+    this->adapt_hold_frames_ = hold_frames;
+  }
+  // Low-power duty cycle: with no target within wake_distance for idle_after,
+  // range every idle_period (optionally on a shorter budget) until the next detection
+  void set_low_power(uint16_t wake_distance_mm, uint32_t idle_after_ms, uint32_t idle_period_ms,
+                     uint32_t idle_timing_budget_us) {
+    this->low_power_ = true;
+    this->wake_distance_mm_ = wake_distance_mm;
+    this->idle_after_us_ = idle_after_ms * 1000ULL;
+    this->idle_period_ms_ = idle_period_ms;
+    this->idle_timing_budget_us_ = idle_timing_budget_us;
+  }
+  // Histogram accumulation: ST's histogram merge on a short budget, restarted
+  // whenever a foreground target is within near_distance
+  void set_histogram_accumulation(uint16_t near_distance_mm) {
+    this->accumulation_ = true;
+    this->accumulation_near_mm_ = near_distance_mm;
+  }
+  bool is_idle() const { return this->idle_; }
+  void set_timing_budget_sensor(sensor::Sensor *sensor) { this->timing_budget_sensor_ = sensor; }
+  void set_frame_rate_sensor(sensor::Sensor *sensor) { this->frame_rate_sensor_ = sensor; }
+  void set_log_summary_interval(uint32_t interval_ms) { this->log_summary_interval_us_ = interval_ms * 1000ULL; }
+  void set_frames_sensor(sensor::Sensor *sensor) { this->frames_sensor_ = sensor; }
+  void set_missed_measurements_sensor(sensor::Sensor *sensor) { this->missed_measurements_sensor_ = sensor; }
+  void set_consecutive_errors_sensor(sensor::Sensor *sensor) { this->consecutive_errors_sensor_ = sensor; }
+  void set_total_measurements_sensor(sensor::Sensor *sensor) { this->total_measurements_sensor_ = sensor; }
+  void set_valid_measurements_sensor(sensor::Sensor *sensor) { this->valid_measurements_sensor_ = sensor; }
+  void set_i2c_bytes_sensor(sensor::Sensor *sensor) { this->i2c_bytes_sensor_ = sensor; }
+  void set_i2c_read_time_sensor(sensor::Sensor *sensor) { this->i2c_read_time_sensor_ = sensor; }
+  void set_processing_time_sensor(sensor::Sensor *sensor) { this->processing_time_sensor_ = sensor; }
+  void set_publish_latency_sensor(sensor::Sensor *sensor) { this->publish_latency_sensor_ = sensor; }
+  void set_performance_degraded_binary_sensor(binary_sensor::BinarySensor *sensor) {
+    this->performance_degraded_binary_sensor_ = sensor;
+  }
+  void set_low_power_binary_sensor(binary_sensor::BinarySensor *sensor) { this->low_power_binary_sensor_ = sensor; }
+  void set_i2c_throughput_sensor(sensor::Sensor *sensor) { this->i2c_throughput_sensor_ = sensor; }
+  void set_wake_latency_sensor(sensor::Sensor *sensor) { this->wake_latency_sensor_ = sensor; }
+  void set_dmax_cache_hit_rate_sensor(sensor::Sensor *sensor) { this->dmax_cache_hit_rate_sensor_ = sensor; }
+  void set_health_text_sensor(text_sensor::TextSensor *sensor) { this->health_text_sensor_ = sensor; }
+  void set_recoveries_sensor(sensor::Sensor *sensor) { this->recoveries_sensor_ = sensor; }
+  void set_time_to_recover_sensor(sensor::Sensor *sensor) { this->time_to_recover_sensor_ = sensor; }
+  // Back-off between recovery attempts: starts at initial, doubles up to max
+  void set_recovery_backoff(uint32_t initial_ms, uint32_t max_ms) {
+    this->supervisor_.set_backoff(initial_ms * 1000, max_ms * 1000);
+  }
+  void set_publishes_sensor(sensor::Sensor *sensor) { this->publishes_sensor_ = sensor; }
+  void set_xshut_pin(GPIOPin *pin) {
+    this->xshut_pin_ = pin;
+    xshut_group_.push_back(this);
+  }
   void set_interrupt_pin(GPIOPin *pin) { this->interrupt_pin_ = pin; }
 
   // Sensor registration
   void register_distance_sensor(VL53L3CXSensorBase *sensor, uint8_t target_number);
+
+  // Per-target smoothing applied before publishing (see range_filter.h)
+  void set_median_filter(uint8_t target_number, uint8_t window) {
+    this->range_filters_[target_number].configure_median(window);
+  }
+  void set_one_euro_filter(uint8_t target_number, float min_cutoff_hz, float beta, float d_cutoff_hz) {
+    this->range_filters_[target_number].configure_one_euro(min_cutoff_hz, beta, d_cutoff_hz);
+  }
+  void set_kalman_filter(uint8_t target_number, float process_noise) {
+    this->range_filters_[target_number].configure_kalman(process_noise);
+  }
+  // Per-target deadband and publish rate limits, checked on the filtered range (see publish_policy.h)
+  void set_publish_policy(uint8_t target_number, uint16_t deadband_mm, uint32_t min_interval_ms,
+                          uint32_t max_interval_ms, bool on_status_change) {
+    this->publish_policies_[target_number].configure(deadband_mm, min_interval_ms * 1000, max_interval_ms * 1000,
+                                                     on_status_change);
+  }
+
+  // Target tracking: sensor target numbers then address stable track slots
+  // instead of the driver's per-frame result order
+  void set_tracking(uint16_t gate_mm, uint32_t timeout_us) {
+    this->tracking_ = true;
+    this->tracker_.set_gate_mm(gate_mm);
+    this->tracker_.set_timeout_us(timeout_us);
+  }
+  void register_velocity_sensor(sensor::Sensor *sensor, uint8_t target_number) {
+    if (target_number < 4) {
+      this->velocity_sensors_[target_number] = sensor;
+    }
+  }
+  bool is_tracking() const { return this->tracking_; }
+
+  // Background subtraction: static returns of the learned empty scene are
+  // flagged in frames and not published
+  void set_background_learn_duration(uint32_t duration_us) {
+    this->background_enabled_ = true;
+    this->background_learn_duration_us_ = duration_us;
+  }
+  void start_background_learning();
+  void reset_background();
+  const TargetTracker &get_tracker() const { return this->tracker_; }
   void register_binary_sensor(VL53L3CXBinarySensorBase *sensor);
   
   // Button registration
@@ -80,6 +228,8 @@ class VL53L3CXComponent : public PollingComponent, public i2c::I2CDevice {
   void set_crosstalk_calibration_button(CrosstalkCalibrationButton *button) { this->crosstalk_calibration_button_ = button; }
   void set_offset_calibration_button(OffsetCalibrationButton *button) { this->offset_calibration_button_ = button; }
   void set_zero_distance_calibration_button(ZeroDistanceCalibrationButton *button) { this->zero_distance_calibration_button_ = button; }
+  void set_learn_background_button(LearnBackgroundButton *button) { this->learn_background_button_ = button; }
+  void set_reset_background_button(ResetBackgroundButton *button) { this->reset_background_button_ = button; }
   
   // Calibration methods (called by buttons)
   void perform_refspad_calibration();
@@ -93,6 +243,38 @@ class VL53L3CXComponent : public PollingComponent, public i2c::I2CDevice {
   // Check if data is ready
   bool is_data_ready();
 
+  // External ranging control (used by vl53l3cx_scheduler). When enabled the
+  // sensor runs one range per trigger instead of free-running back-to-back.
+  void set_externally_triggered(bool triggered) { this->externally_triggered_ = triggered; }
+  bool trigger_measurement(bool force = false);
+  bool is_range_in_flight() const { return this->range_in_flight_; }
+  bool is_device_ready() const { return this->device_initialized_; }
+  uint32_t get_timing_budget_us() const { return this->timing_budget_us_; }
+
+  // Called with every processed frame (Range2 onwards), after publishing
+  void add_on_frame_callback(std::function<void(const Frame &)> &&callback) {
+    this->frame_callback_.add(std::move(callback));
+  }
+
+  // Timing of the most recently processed frame
+  const FrameTiming &get_last_frame_timing() const { return this->last_frame_timing_; }
+  uint64_t get_last_frame_time_us() const { return this->last_frame_time_us_; }
+
+  // Frames processed versus distance states actually published, since boot
+  uint32_t get_frame_count() const { return this->frame_count_; }
+  uint32_t get_publish_count() const { return this->publish_count_; }
+  uint32_t get_suppressed_count() const { return this->suppressed_count_; }
+  bool is_performance_degraded() const { return this->performance_degraded_; }
+  const RecoverySupervisor &get_supervisor() const { return this->supervisor_; }
+
+  // Called by the platform layer for every I2C transfer
+  void record_i2c_transfer(uint32_t bytes, uint32_t elapsed_us) {
+    this->i2c_bytes_ += bytes;
+    this->i2c_busy_us_ += elapsed_us;
+  }
+  // Called by the platform layer with the data of every I2C read
+  void record_i2c_read(uint16_t index, const uint8_t *data, uint32_t count);
+
  protected:
   // Device structure for ST library
   VL53LX_Dev_t *device_ = nullptr;
@@ -113,26 +295,123 @@ class VL53L3CXComponent : public PollingComponent, public i2c::I2CDevice {
   uint32_t merge_threshold_{15000};  // ST default. Lower value separates targets more.
   bool hist_merge_enabled_{true};     // Default per ST tuning
   uint16_t hist_noise_threshold_{50}; // Default per ST tuning
-  uint8_t hist_merge_max_size_{8};    // Default per ST tuning (implementation defined)
+  uint8_t hist_merge_max_size_{6};    // ST default; the driver keeps at most VL53LX_BIN_REC_SIZE histograms
+  uint8_t peak_estimator_{0};         // ST's filter interpolation
   GPIOPin *xshut_pin_{nullptr};
   GPIOPin *interrupt_pin_{nullptr};
 
+  // Adaptive timing budget (closed loop on per-frame signal quality)
+  bool adaptive_timing_{false};
+  uint32_t min_timing_budget_us_{20000};
+  uint32_t max_timing_budget_us_{200000};
+  FixPoint1616_t target_sigma_{10u << 16};  // Lengthen above, shorten below half of it
+  uint8_t adapt_hold_frames_{5};  // Consecutive agreeing frames before a step
+  int8_t adapt_votes_{0};  // >0 votes to lengthen, <0 to shorten
+  uint64_t last_budget_change_us_{0};
+
+  // Low-power duty cycle
+  bool low_power_{false};
+  uint16_t wake_distance_mm_{2000};
+  uint32_t idle_after_us_{30000000};
+  uint32_t idle_period_ms_{500};
+  uint32_t idle_timing_budget_us_{0};  // 0 = keep the active budget
+  bool idle_{false};
+  uint64_t last_presence_us_{0};  // Last frame with a foreground target within wake_distance
+  uint64_t last_duty_change_us_{0};
+  uint32_t active_timing_budget_us_{0};  // Restored on wake
+  uint32_t active_update_interval_ms_{0};
+  uint64_t wake_frame_us_{0};  // Data-ready of the waking frame, until the first full-rate frame
+
+  // Metric sensors
+  sensor::Sensor *timing_budget_sensor_{nullptr};
+  sensor::Sensor *frame_rate_sensor_{nullptr};
+  sensor::Sensor *frames_sensor_{nullptr};
+  sensor::Sensor *publishes_sensor_{nullptr};
+  sensor::Sensor *missed_measurements_sensor_{nullptr};
+  sensor::Sensor *consecutive_errors_sensor_{nullptr};
+  sensor::Sensor *total_measurements_sensor_{nullptr};
+  sensor::Sensor *valid_measurements_sensor_{nullptr};
+  sensor::Sensor *i2c_bytes_sensor_{nullptr};
+  sensor::Sensor *i2c_read_time_sensor_{nullptr};
+  sensor::Sensor *processing_time_sensor_{nullptr};
+  sensor::Sensor *publish_latency_sensor_{nullptr};
+  binary_sensor::BinarySensor *performance_degraded_binary_sensor_{nullptr};
+  text_sensor::TextSensor *health_text_sensor_{nullptr};
+  binary_sensor::BinarySensor *low_power_binary_sensor_{nullptr};
+  sensor::Sensor *i2c_throughput_sensor_{nullptr};
+  sensor::Sensor *wake_latency_sensor_{nullptr};
+  uint32_t metrics_i2c_total_start_{0};  // i2c_bytes_ at the start of the interval (all traffic, polls included)
+  sensor::Sensor *dmax_cache_hit_rate_sensor_{nullptr};
+  uint32_t metrics_dmax_lookups_start_{0};  // Driver dmax cache counters at the start of the interval
+  uint32_t metrics_dmax_hits_start_{0};
+  sensor::Sensor *recoveries_sensor_{nullptr};
+  sensor::Sensor *time_to_recover_sensor_{nullptr};
+  uint32_t metrics_frames_{0};  // Frames since the last metrics publish
+  uint64_t metrics_start_us_{0};
+  // Per-frame timing sums since the last metrics publish
+  uint32_t metrics_i2c_bytes_{0};
+  uint32_t metrics_i2c_read_us_{0};
+  uint32_t metrics_processing_us_{0};
+  uint32_t metrics_latency_us_{0};
+
+  // Degradation detector: rolling window of metrics-interval samples
+  static const uint8_t PERFORMANCE_WINDOW = 7;  // 6 intervals, 30 s
+  std::array<PerformanceSample, PERFORMANCE_WINDOW> performance_samples_{};
+  uint8_t performance_sample_index_{0};
+  uint8_t performance_sample_count_{0};
+
   // Runtime state
   bool device_initialized_{false};
   bool first_measurement_discarded_{false};  // Track Range1 discard
   uint16_t last_distance_mm_{0};
-  uint32_t last_measurement_time_{0};
+  uint64_t last_frame_time_us_{0};  // µs timestamp of last valid primary target
+  FrameTiming last_frame_timing_{};
+  uint32_t i2c_bytes_{0};  // Running I2C byte counter (wraps, use differences)
+  uint32_t i2c_busy_us_{0};  // Running I2C bus time counter (wraps, use differences)
   uint8_t last_stream_count_{0};  // Track StreamCount for missed measurement detection
   uint32_t missed_measurements_{0};  // Count of missed measurements
   uint32_t consecutive_errors_{0};  // Track consecutive errors for recovery
   uint32_t total_measurements_{0};  // Track total measurement attempts
   uint32_t valid_measurements_{0};  // Track successful measurements
-  uint32_t last_performance_check_{0};  // Last time we checked performance
+  uint32_t frame_count_{0};  // Frames processed (Range2 onwards)
+  uint32_t publish_count_{0};  // Distance states published
+  uint32_t suppressed_count_{0};  // Ranges held back by a publish policy
+
+  // Frame-path log summary
+  uint64_t log_summary_interval_us_{60000000};  // 0 = no summary
+  uint64_t log_summary_start_us_{0};
+  uint32_t log_summary_frames_{0};  // frame_count_ at the start of the window
+  uint32_t log_summary_missed_{0};  // missed_measurements_ at the start of the window
+  FrameLogCounts frame_log_counts_{};
+  uint32_t last_performance_check_{0};  // Last time we checked performance (ms)
   bool performance_degraded_{false};  // Flag for degraded performance
   bool inter_measurement_period_set_{false};
+  bool externally_triggered_{false};
+  bool measurement_started_{false};  // First trigger needs a full StartMeasurement
+  bool range_in_flight_{false};  // Triggered range not read back yet
+
+  bool accumulation_{false};
+  uint16_t accumulation_near_mm_{1000};
+
+  // Histogram capture for the host replay tools (tools/hist_sweep)
+  bool histogram_capture_{false};
+  bool capturing_{false};  // Between capture_begin_() and capture_end_()
+  bool capture_snapshot_pending_{true};  // Driver state is logged again after a restart or a failed read
+  std::vector<uint8_t> capture_reads_;  // index (2), count (2), data, per read
+
+  // Self-healing: faults escalate through restart, reset and re-init instead of mark_failed()
+  RecoverySupervisor supervisor_;
+  uint64_t last_activity_us_{0};  // Last good read, or last trigger when externally triggered
+
+  CallbackManager<void(const Frame &)> frame_callback_;
 
   // Registered sensors (indexed by target number) - using base classes
   std::array<VL53L3CXSensorBase *, 4> distance_sensors_{nullptr, nullptr, nullptr, nullptr};
+  std::array<RangeFilter, 4> range_filters_{};
+  std::array<PublishPolicy, 4> publish_policies_{};
+  std::array<sensor::Sensor *, 4> velocity_sensors_{nullptr, nullptr, nullptr, nullptr};
+  bool tracking_{false};
+  TargetTracker tracker_;
   VL53L3CXBinarySensorBase *binary_sensor_{nullptr};
   
   // Registered calibration buttons
@@ -140,16 +419,54 @@ class VL53L3CXComponent : public PollingComponent, public i2c::I2CDevice {
   CrosstalkCalibrationButton *crosstalk_calibration_button_{nullptr};
   OffsetCalibrationButton *offset_calibration_button_{nullptr};
   ZeroDistanceCalibrationButton *zero_distance_calibration_button_{nullptr};
+  LearnBackgroundButton *learn_background_button_{nullptr};
+  ResetBackgroundButton *reset_background_button_{nullptr};
   
   // Calibration data storage
   ESPPreferenceObject calibration_pref_;
   bool calibration_loaded_{false};
   VL53LX_CalibrationData_t stored_calibration_data_{};
 
+  // Background model and its persisted table
+  bool background_enabled_{false};
+  uint32_t background_learn_duration_us_{30000000};
+  BackgroundModel background_;
+  ESPPreferenceObject background_pref_;
+
+  // All hubs that own an XSHUT pin, in configuration order. The first one to run
+  // setup() brings up the whole group (see bring_up_xshut_group_).
+  static std::vector<VL53L3CXComponent *> xshut_group_;
+  static bool xshut_group_booted_;
+  static void bring_up_xshut_group_();
+
   // Internal methods
+  bool prepare_device_();
+  bool boot_device_();
+  bool start_device_();
   bool initialize_device_();
-  bool read_measurement_();
+  bool read_measurement_(uint64_t data_ready_us);
+  bool publish_range_(uint8_t slot, int32_t range_mm, uint8_t range_status, uint64_t timestamp_us);
+  void publish_lost_(uint8_t slot, uint8_t range_status, uint64_t timestamp_us);
+  void publish_tracks_(const Frame &frame);
+  void adapt_timing_budget_(const Frame &frame);
+  bool apply_timing_budget_(uint32_t budget_us, uint32_t period_ms = 0);
+  void update_duty_cycle_(const Frame &frame);
+  void update_accumulation_(const Frame &frame);
+  void set_idle_(bool idle, uint64_t now_us);
+  uint32_t frame_period_ms_() const;
+  void update_metrics_(uint64_t now_us);
+  void check_performance_(uint64_t now_us);
+  void log_frame_summary_(uint64_t now_us);
+  void capture_begin_();
+  void capture_abort_();
+  void capture_end_(uint8_t stream_count);
   void setup_gpio_pins_();
+  uint32_t stall_timeout_us_() const;
+  void supervise_(uint64_t poll_us);
+  void enter_recovery_(uint64_t now_us, RecoveryStage first_stage);
+  bool run_recovery_(RecoveryStage stage);
+  void publish_health_();
+  void hold_in_reset_();
   void reset_device_();
   
   // Calibration data persistence
@@ -30,6 +30,7 @@
 #include "vl53lx_api_preset_modes.h"
 #include "vl53lx_silicon_core.h"
 #include "vl53lx_api_core.h"
+#include "vl53lx_dmax.h"
 #include "vl53lx_tuning_parm_defaults.h"
 
 #ifdef VL53LX_LOG_ENABLE
@@ -195,6 +196,24 @@ static void vl53lx_histo_merge(VL53LX_DEV Dev,
 	}
 }
 
+VL53LX_Error VL53LX_restart_histo_merge(VL53LX_DEV Dev)
+{
+	VL53LX_LLDriverData_t *pdev =
+			VL53LXDevStructGetLLDriverHandle(Dev);
+
+	LOG_FUNCTION_START("");
+
+	memset(pdev->multi_bins_rec, 0, sizeof(pdev->multi_bins_rec));
+	pdev->bin_rec_pos = 0;
+	pdev->pos_before_next_recom = 0;
+	pdev->hist_merge_restarted = 0;
+	pdev->hist_merge_restarted = 1;
+
+	LOG_FUNCTION_END(VL53LX_ERROR_NONE);
+
+	return VL53LX_ERROR_NONE;
+}
+
 VL53LX_Error VL53LX_load_patch(VL53LX_DEV Dev)
 {
 	VL53LX_Error status = VL53LX_ERROR_NONE;
@@ -388,6 +407,7 @@ VL53LX_Error VL53LX_data_init(
 		VL53LX_OFFSETCORRECTIONMODE__MM1_MM2_OFFSETS;
 	pdev->dmax_mode  =
 		VL53LX_DEVICEDMAXMODE__FMT_CAL_DATA;
+	VL53LX_dmax_cache_invalidate(&(pdev->dmax_cache));
 
 	pdev->phasecal_config_timeout_us  =  1000;
 	pdev->mm_config_timeout_us        =  2000;
@@ -4341,6 +4361,10 @@ VL53LX_Error VL53LX_get_tuning_parm(
 		*ptuning_parm_value =
 		pdev->tuning_parms.tp_uwr_lng_corr_z_5_rangeb;
 	break;
+	case VL53LX_TUNINGPARM_HIST_PEAK_ESTIMATOR:
+		*ptuning_parm_value =
+				(int32_t)pHP->hist_peak_estimator;
+	break;
 
 	default:
 		*ptuning_parm_value = 0x7FFFFFFF;
@@ -5125,6 +5149,10 @@ VL53LX_Error VL53LX_set_tuning_parm(
 		pdev->tuning_parms.tp_uwr_lng_corr_z_5_rangeb =
 			(int16_t)tuning_parm_value;
 	break;
+	case VL53LX_TUNINGPARM_HIST_PEAK_ESTIMATOR:
+		pHP->hist_peak_estimator =
+				(VL53LX_HistPeakEstimator)tuning_parm_value;
+	break;
 
 	default:
 		status = VL53LX_ERROR_INVALID_PARAMS;
@@ -202,6 +202,15 @@ VL53LX_Error VL53LX_get_histogram_bin_data(
 	VL53LX_histogram_bin_data_t *phist_data);
 
 
+/* Empties the histogram merge record, so that merging starts over from
+ * the next histogram without the wait that follows a detected change.
+ * Until the merge is complete again, the smudge corrector takes its
+ * crosstalk samples from the part merges, scaled to a full merge. */
+
+VL53LX_Error VL53LX_restart_histo_merge(
+	VL53LX_DEV                   Dev);
+
+
 
 
 void VL53LX_copy_sys_and_core_results_to_range_results(
@@ -320,6 +320,11 @@ VL53LX_Error VL53LX_init_hist_post_process_config_struct(
 
 
 
+	pdata->hist_peak_estimator =
+			VL53LX_TUNINGPARM_HIST_PEAK_ESTIMATOR_DEFAULT;
+
+
+
 	pdata->filter_woi0                   =
 			VL53LX_TUNINGPARM_HIST_FILTER_WOI_0_DEFAULT;
 	pdata->filter_woi1                   =
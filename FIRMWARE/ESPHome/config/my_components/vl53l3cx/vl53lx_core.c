@@ -3885,16 +3885,16 @@ VL53LX_Error VL53LX_dynamic_xtalk_correction_calc_required_samples(
 		pxmonitor->VL53LX_p_016;
 	if (peak_duration_us == 0)
 		peak_duration_us = 1000;
-	temp64a = do_division_u((temp64a * 1000), peak_duration_us);
-	temp64a = do_division_u((temp64a * 1000), peak_duration_us);
+	temp64a = VL53LX_udiv64((temp64a * 1000), peak_duration_us);
+	temp64a = VL53LX_udiv64((temp64a * 1000), peak_duration_us);
 
 	temp64z = pconfig->noise_margin * pxmonitor->VL53LX_p_004;
 	if (temp64z == 0)
 		temp64z = 1;
 	temp64a = temp64a * 1000 * 256;
-	temp64a = do_division_u(temp64a, temp64z);
+	temp64a = VL53LX_udiv64(temp64a, temp64z);
 	temp64a = temp64a * 1000 * 256;
-	temp64a = do_division_u(temp64a, temp64z);
+	temp64a = VL53LX_udiv64(temp64a, temp64z);
 
 	pint->required_samples = (uint32_t)temp64a;
 
@@ -3967,6 +3967,11 @@ VL53LX_Error VL53LX_dynamic_xtalk_correction_calc_new_xtalk(
 
 		if (histo_merge_nb == 0)
 			histo_merge_nb = 1;
+		if (pdev->hist_merge_restarted &&
+			(pdev->tuning_parms.tp_hist_merge_max_size > 0))
+			/* The corrector's samples are scaled to a full merge */
+			histo_merge_nb =
+				pdev->tuning_parms.tp_hist_merge_max_size;
 		if (pdev->tuning_parms.tp_hist_merge != 1)
 			orig_xtalk_offset =
 			pC->algo__crosstalk_compensation_plane_offset_kcps;
@@ -4116,6 +4121,42 @@ VL53LX_Error VL53LX_dynamic_xtalk_correction_calc_new_xtalk(
 	return status;
 }
 
+void VL53LX_dynamic_xtalk_correction_add_sample(
+	VL53LX_smudge_corrector_internals_t	*pint,
+	uint32_t				xtalk_offset_in
+	)
+{
+
+	/*
+	 * Adds a sample to the accumulator and moves its running mean, so
+	 * that accumulator = mean * current_samples + remainder. A sample
+	 * within current_samples of the mean needs no division, and no
+	 * division is 64-bit unless the sample is.
+	 */
+
+	uint32_t n = pint->current_samples;
+	int64_t  d;
+	uint64_t k;
+
+	pint->accumulator = pint->accumulator + xtalk_offset_in;
+
+	d = (int64_t)pint->accumulator_remainder +
+		(int64_t)xtalk_offset_in -
+		(int64_t)pint->accumulator_mean;
+
+	if (d < 0) {
+		k = VL53LX_udiv64((uint64_t)(-d) + n - 1, n);
+		pint->accumulator_mean -= (uint32_t)k;
+		d += (int64_t)(k * n);
+	} else if (d >= n) {
+		k = VL53LX_udiv64((uint64_t)d, n);
+		pint->accumulator_mean += (uint32_t)k;
+		d -= (int64_t)(k * n);
+	}
+
+	pint->accumulator_remainder = (uint32_t)d;
+}
+
 #define CONT_CONTINUE	0
 #define CONT_NEXT_LOOP	1
 #define CONT_RESET	2
@@ -4154,34 +4195,45 @@ VL53LX_Error VL53LX_dynamic_xtalk_correction_corrector(
 	uint8_t nodetect_index = 0;
 	uint16_t    amr;
 	uint32_t    cco;
-	uint8_t histo_merge_nb;
+	uint8_t histo_merge_nb = 1;
 
 
 	LOG_FUNCTION_START("");
 
-	VL53LX_compute_histo_merge_nb(Dev, &histo_merge_nb);
-	if ((histo_merge_nb == 0) ||
-		(pdev->tuning_parms.tp_hist_merge != 1))
-		histo_merge_nb = 1;
+	VL53LX_dynamic_xtalk_correction_output_init(pres);
 
+	/*
+	 * The frame is sorted first: a crosstalk sample (the xmonitor peak
+	 * was found), a candidate no-target frame, or neither. A frame that
+	 * is neither costs only these checks. The samples' mean is a running
+	 * statistic, moved by each sample rather than divided out of the sum.
+	 */
 
-	VL53LX_dynamic_xtalk_correction_output_init(pres);
+	if ((pconfig->smudge_corr_enabled == 1) &&
+		(pR->xmonitor.range_status
+			== VL53LX_DEVICEERROR_RANGECOMPLETE)) {
 
+		VL53LX_compute_histo_merge_nb(Dev, &histo_merge_nb);
+		if ((histo_merge_nb == 0) ||
+			(pdev->tuning_parms.tp_hist_merge != 1))
+			histo_merge_nb = 1;
 
-	ambient_check = (pconfig->smudge_corr_ambient_threshold == 0) ||
-		((pconfig->smudge_corr_ambient_threshold * histo_merge_nb)  >
-		((uint32_t)pR->xmonitor.ambient_count_rate_mcps));
 
+		ambient_check = (pconfig->smudge_corr_ambient_threshold == 0) ||
+			((pconfig->smudge_corr_ambient_threshold * histo_merge_nb)  >
+			((uint32_t)pR->xmonitor.ambient_count_rate_mcps));
 
-	merging_complete =
-		((pdev->tuning_parms.tp_hist_merge != 1) ||
-		(histo_merge_nb == pdev->tuning_parms.tp_hist_merge_max_size));
-	run_smudge_detection =
-		(pconfig->smudge_corr_enabled == 1) &&
-		ambient_check &&
-		(pR->xmonitor.range_status
-			== VL53LX_DEVICEERROR_RANGECOMPLETE) &&
-		merging_complete;
+
+		merging_complete =
+			((pdev->tuning_parms.tp_hist_merge != 1) ||
+			(histo_merge_nb ==
+				pdev->tuning_parms.tp_hist_merge_max_size));
+		if (merging_complete)
+			pdev->hist_merge_restarted = 0;
+		run_smudge_detection = ambient_check &&
+			(merging_complete || (pdev->hist_merge_restarted &&
+			(pdev->tuning_parms.tp_hist_merge_max_size > 0)));
+	}
 
 
 	if ((pR->xmonitor.range_status
@@ -4243,6 +4295,23 @@ VL53LX_Error VL53LX_dynamic_xtalk_correction_corrector(
 		xtalk_offset_in =
 			pR->xmonitor.VL53LX_p_009;
 
+		/*
+		 * The host restarted the merge (a near target): scale the
+		 * part merge's sample to a full merge, and compare it with
+		 * the full merge's crosstalk. get_device_results() resets
+		 * the plane offset after this call.
+		 */
+		if (!merging_complete) {
+			xtalk_offset_in = (xtalk_offset_in *
+				pdev->tuning_parms.tp_hist_merge_max_size) /
+				histo_merge_nb;
+			histo_merge_nb =
+				pdev->tuning_parms.tp_hist_merge_max_size;
+			pX->algo__crosstalk_compensation_plane_offset_kcps =
+				pdev->xtalk_cal.algo__xtalk_cpo_HistoMerge_kcps[
+					histo_merge_nb - 1];
+		}
+
 
 		cco = pX->algo__crosstalk_compensation_plane_offset_kcps;
 		current_xtalk = ((uint32_t)cco) << 2;
@@ -4276,18 +4345,25 @@ VL53LX_Error VL53LX_dynamic_xtalk_correction_corrector(
 		if (pint->current_samples > pconfig->sample_limit) {
 			pout->sample_limit_exceeded_flag = 1;
 			continue_processing = CONT_RESET;
+
+			/* The count moved without a sample: divide again */
+			pint->accumulator_mean =
+			(uint32_t)(VL53LX_udiv64(pint->accumulator,
+				pint->current_samples));
+			pint->accumulator_remainder =
+				(uint32_t)(pint->accumulator -
+				(uint64_t)pint->accumulator_mean *
+					pint->current_samples);
 		} else {
-			pint->accumulator = pint->accumulator +
-				xtalk_offset_in;
+			VL53LX_dynamic_xtalk_correction_add_sample(pint,
+				xtalk_offset_in);
 		}
 
 		if (pint->current_samples < pint->required_samples)
 			continue_processing = CONT_NEXT_LOOP;
 
 
-		xtalk_offset_out =
-		(uint32_t)(do_division_u(pint->accumulator,
-			pint->current_samples));
+		xtalk_offset_out = pint->accumulator_mean;
 
 
 		itemp32 = xtalk_offset_out - current_xtalk +
@@ -4378,6 +4454,8 @@ VL53LX_Error VL53LX_dynamic_xtalk_correction_corrector(
 			pint->accumulator = 0;
 			pint->current_samples = 0;
 			pint->nodetect_counter = 0;
+			pint->accumulator_mean = 0;
+			pint->accumulator_remainder = 0;
 		}
 
 	}
@@ -4431,6 +4509,8 @@ VL53LX_Error VL53LX_dynamic_xtalk_correction_corrector(
 			pint->accumulator = 0;
 			pint->current_samples = 0;
 			pint->nodetect_counter = 0;
+			pint->accumulator_mean = 0;
+			pint->accumulator_remainder = 0;
 		}
 	}
 
@@ -4503,6 +4583,8 @@ VL53LX_Error VL53LX_dynamic_xtalk_correction_data_init(
 	pdev->smudge_corrector_internals.required_samples = 0;
 	pdev->smudge_corrector_internals.accumulator = 0;
 	pdev->smudge_corrector_internals.nodetect_counter = 0;
+	pdev->smudge_corrector_internals.accumulator_mean = 0;
+	pdev->smudge_corrector_internals.accumulator_remainder = 0;
 
 
 	VL53LX_dynamic_xtalk_correction_output_init(pres);
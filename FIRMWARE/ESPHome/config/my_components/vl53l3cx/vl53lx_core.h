@@ -696,6 +696,13 @@ VL53LX_Error VL53LX_dynamic_xtalk_correction_calc_new_xtalk(
 
 
 
+void VL53LX_dynamic_xtalk_correction_add_sample(
+	VL53LX_smudge_corrector_internals_t	*pint,
+	uint32_t				xtalk_offset_in
+	);
+
+
+
 VL53LX_Error VL53LX_dynamic_xtalk_correction_corrector(
 	VL53LX_DEV                     Dev
 	);
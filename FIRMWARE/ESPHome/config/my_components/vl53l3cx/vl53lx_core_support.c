@@ -139,29 +139,85 @@ uint32_t VL53LX_events_per_spad_maths(
 uint32_t VL53LX_isqrt(uint32_t num)
 {
 
+	/*
+	 * The input is normalized to [2^30, 2^32) by an even shift. The seed
+	 * is the line 0.7083 + x / 3 through sqrt(x) on x = m / 2^30 in
+	 * [1, 4), within 4.2%, and two Newton steps on the normalized input
+	 * land on floor(sqrt(m)) or one above it.
+	 */
 
+	uint32_t  shift = 0;
+	uint32_t  m     = 0;
+	uint32_t  res   = 0;
 
-	uint32_t  res = 0;
-	uint32_t  bit = 1 << 30;
+	if (num == 0)
+		return 0;
 
 
-	while (bit > num)
-		bit >>= 2;
+	shift = (uint32_t)__builtin_clz(num) & ~1U;
+	m     = num << shift;
+	res   = 23211 + (m >> 15) / 3;
+	res   = (res + m / res) >> 1;
+	res   = (res + m / res) >> 1;
+	res >>= shift >> 1;
 
-	while (bit != 0) {
-		if (num >= res + bit)  {
-			num -= res + bit;
-			res = (res >> 1) + bit;
-		} else {
-			res >>= 1;
+
+	res -= (res > 0xFFFF);
+	res -= (res * res > num);
+
+	return res;
+}
+
+
+int32_t VL53LX_log2_q16(uint32_t num)
+{
+
+	/*
+	 * The fraction comes one bit per step from squaring the normalized
+	 * mantissa (31 fraction bits): each square that reaches 2 sets the bit.
+	 */
+
+	uint32_t  shift = 0;
+	uint32_t  bit   = 0;
+	uint64_t  m     = 0;
+	int32_t   res   = 0;
+
+	if (num == 0)
+		return 0;
+
+	shift = (uint32_t)__builtin_clz(num);
+	res   = (int32_t)(31 - shift) << 16;
+	m     = (uint64_t)(num << shift);
+
+	for (bit = 0x8000; bit > 0; bit >>= 1) {
+		m = (m * m) >> 31;
+		if (m >= 0x100000000ULL) {
+			m >>= 1;
+			res += (int32_t)bit;
 		}
-		bit >>= 2;
 	}
 
 	return res;
 }
 
 
+uint64_t VL53LX_udiv64(
+	uint64_t  dividend,
+	uint64_t  divisor)
+{
+
+	/*
+	 * Same result as do_division_u(), but a 32-bit MCU calls a library
+	 * routine for every 64-bit division, and most operands fit.
+	 */
+
+	if (((dividend | divisor) >> 32) == 0)
+		return (uint64_t)((uint32_t)dividend / (uint32_t)divisor);
+
+	return do_division_u(dividend, divisor);
+}
+
+
 void  VL53LX_hist_calc_zero_distance_phase(
 	VL53LX_histogram_bin_data_t   *pdata)
 {
@@ -290,6 +346,106 @@ void  VL53LX_hist_remove_ambient_bins(
 }
 
 
+void  VL53LX_hist_estimate_and_remove_ambient(
+	int32_t                        ambient_threshold_sigma,
+	VL53LX_histogram_bin_data_t   *pdata)
+{
+
+	/*
+	 * Same results as estimate_ambient_from_thresholded_bins,
+	 * estimate_ambient_from_ambient_bins and remove_ambient_bins run in
+	 * that order. Min/max and the ambient bin sum share one pass; the
+	 * thresholded estimate is only needed when there are no ambient bins,
+	 * as the ambient bin estimate overwrites it otherwise. The sums are
+	 * kept in locals, as the compiler cannot tell they do not alias
+	 * bin_data.
+	 */
+
+	uint8_t  bin                      = 0;
+	uint8_t  nab                      = pdata->number_of_ambient_bins;
+	uint8_t  nbins                    = pdata->VL53LX_p_021;
+	uint8_t  samples                  = 0;
+	int32_t  value                    = 0;
+	int32_t  min_value                = 0;
+	int32_t  max_value                = 0;
+	int32_t  ambient_sum              = 0;
+	int32_t  VL53LX_p_031 = 0;
+
+	LOG_FUNCTION_START("");
+
+
+
+	if (nbins > 0) {
+		min_value = pdata->bin_data[0];
+		max_value = pdata->bin_data[0];
+	}
+
+	for (bin = 0; bin < nbins; bin++) {
+
+		value = pdata->bin_data[bin];
+
+		if (min_value > value)
+			min_value = value;
+
+		if (max_value < value)
+			max_value = value;
+
+		if (bin < nab)
+			ambient_sum += value;
+	}
+
+	for (; bin < nab; bin++)
+		ambient_sum += pdata->bin_data[bin];
+
+	if (nbins > 0) {
+		pdata->min_bin_value = min_value;
+		pdata->max_bin_value = max_value;
+	}
+
+
+
+	if (nab > 0) {
+
+		pdata->number_of_ambient_samples = nab;
+		pdata->ambient_events_sum        = ambient_sum;
+
+		pdata->VL53LX_p_028  = ambient_sum;
+		pdata->VL53LX_p_028 += ((int32_t)nab / 2);
+		pdata->VL53LX_p_028 /= (int32_t)nab;
+
+	} else {
+
+		VL53LX_p_031  =
+			(int32_t)VL53LX_isqrt((uint32_t)pdata->min_bin_value);
+		VL53LX_p_031 *= ambient_threshold_sigma;
+		VL53LX_p_031 += 0x07;
+		VL53LX_p_031  = VL53LX_p_031 >> 4;
+		VL53LX_p_031 += pdata->min_bin_value;
+
+		for (bin = 0; bin < nbins; bin++)
+			if (pdata->bin_data[bin] < VL53LX_p_031) {
+				ambient_sum += pdata->bin_data[bin];
+				samples++;
+			}
+
+		pdata->number_of_ambient_samples = samples;
+		pdata->ambient_events_sum        = ambient_sum;
+
+		if (samples > 0) {
+			pdata->VL53LX_p_028  = ambient_sum;
+			pdata->VL53LX_p_028 += ((int32_t)samples / 2);
+			pdata->VL53LX_p_028 /= (int32_t)samples;
+		}
+	}
+
+
+
+	VL53LX_hist_remove_ambient_bins(pdata);
+
+	LOG_FUNCTION_END(0);
+}
+
+
 uint32_t VL53LX_calc_pll_period_mm(
 	uint16_t fast_osc_frequency)
 {
@@ -54,6 +54,23 @@ uint32_t VL53LX_isqrt(
 
 
 
+/* log2(num) in 16.16 fixed point, for num > 0 */
+
+int32_t VL53LX_log2_q16(
+	uint32_t  num);
+
+
+
+
+/* dividend / divisor, in 32-bit arithmetic when both fit in 32 bits */
+
+uint64_t VL53LX_udiv64(
+	uint64_t  dividend,
+	uint64_t  divisor);
+
+
+
+
 void VL53LX_hist_calc_zero_distance_phase(
 	VL53LX_histogram_bin_data_t    *pdata);
 
@@ -73,6 +90,13 @@ void VL53LX_hist_remove_ambient_bins(
 
 
 
+void VL53LX_hist_estimate_and_remove_ambient(
+	int32_t                      ambient_threshold_sigma,
+	VL53LX_histogram_bin_data_t *pdata);
+
+
+
+
 uint32_t VL53LX_calc_pll_period_mm(
 	uint16_t fast_osc_frequency);
 
@@ -44,12 +44,67 @@
 	level, VL53LX_TRACE_FUNCTION_NONE, ##__VA_ARGS__)
 
 
+/*
+ * Most dmax inputs only change with the timing budget, DSS and ambient
+ * level, and the five reflectance calls of a frame share everything but
+ * the reflectance. Results are memoized in two stages keyed on every
+ * input they read: the ambient stage (one entry) and the per-reflectance
+ * stage, which is flushed whenever the ambient stage misses. Each device
+ * has its own cache, so sensors ranging in turn do not evict each other.
+ */
+static uint8_t VL53LX_dmax_cache_lookup_ambient(
+	VL53LX_dmax_cache_t                  *pc,
+	const VL53LX_dmax_ambient_key_t      *pkey)
+{
+	pc->lookups++;
+	if (pc->ambient_valid &&
+		memcmp(&(pc->ambient_key), pkey, sizeof(*pkey)) == 0) {
+		pc->hits++;
+		return 1;
+	}
+
+	pc->ambient_valid     = 0;
+	pc->reflectance_count = 0;
+	pc->reflectance_next  = 0;
+	return 0;
+}
+
+
+static int8_t VL53LX_dmax_cache_lookup_reflectance(
+	VL53LX_dmax_cache_t                  *pc,
+	const VL53LX_dmax_reflectance_key_t  *pkey)
+{
+	uint8_t i = 0;
+
+	pc->lookups++;
+	for (i = 0; i < pc->reflectance_count; i++) {
+		if (memcmp(&(pc->reflectance_key[i]), pkey,
+				sizeof(*pkey)) == 0) {
+			pc->hits++;
+			return (int8_t)i;
+		}
+	}
+
+	return -1;
+}
+
+
+void VL53LX_dmax_cache_invalidate(
+	VL53LX_dmax_cache_t                  *pc)
+{
+	pc->ambient_valid     = 0;
+	pc->reflectance_count = 0;
+	pc->reflectance_next  = 0;
+}
+
+
 VL53LX_Error VL53LX_f_001(
 	uint16_t                              target_reflectance,
 	VL53LX_dmax_calibration_data_t	     *pcal,
 	VL53LX_hist_gen3_dmax_config_t	     *pcfg,
 	VL53LX_histogram_bin_data_t          *pbins,
 	VL53LX_hist_gen3_dmax_private_data_t *pdata,
+	VL53LX_dmax_cache_t                  *pc,
 	int16_t                              *pambient_dmax_mm)
 {
 
@@ -57,6 +112,10 @@ VL53LX_Error VL53LX_f_001(
 
 	VL53LX_Error status  = VL53LX_ERROR_NONE;
 
+	VL53LX_dmax_ambient_key_t     akey;
+	VL53LX_dmax_reflectance_key_t rkey;
+	int8_t      entry               = 0;
+
 	uint32_t    pll_period_us       = 0;
 	uint32_t    periods_elapsed     = 0;
 
@@ -64,6 +123,7 @@ VL53LX_Error VL53LX_f_001(
 	uint64_t    tmp64               = 0;
 
 	uint32_t    amb_thres_delta     = 0;
+	uint32_t    amb_thres_events    = 0;
 
 	LOG_FUNCTION_START("");
 
@@ -81,8 +141,42 @@ VL53LX_Error VL53LX_f_001(
 	*pambient_dmax_mm  = 0;
 
 
-	if ((pbins->VL53LX_p_015        != 0) &&
-		(pbins->total_periods_elapsed      != 0)) {
+	if ((pbins->VL53LX_p_015        == 0) ||
+		(pbins->total_periods_elapsed      == 0)) {
+		LOG_FUNCTION_END(status);
+		return status;
+	}
+
+
+
+	memset(&akey, 0, sizeof(akey));
+	akey.fast_osc_frequency         = pbins->VL53LX_p_015;
+	akey.dss_actual_effective_spads =
+		pbins->result__dss_actual_effective_spads;
+	akey.total_periods_elapsed      = pbins->total_periods_elapsed;
+	akey.ambient_events             = pbins->VL53LX_p_028;
+	akey.max_effective_spads        = pcfg->max_effective_spads;
+	akey.dss_target_total_rate_mcps =
+		pcfg->dss_config__target_total_rate_mcps;
+	akey.min_ambient_thresh_events  = pcfg->min_ambient_thresh_events;
+	akey.ambient_thresh_sigma       = pcfg->ambient_thresh_sigma;
+	akey.ref_actual_effective_spads = pcal->ref__actual_effective_spads;
+	akey.ref_peak_signal_count_rate_mcps =
+		pcal->ref__peak_signal_count_rate_mcps;
+	akey.ref_reflectance_pc         = pcal->ref_reflectance_pc;
+
+	if (VL53LX_dmax_cache_lookup_ambient(pc, &akey)) {
+
+		pdata->VL53LX_p_037 = pc->VL53LX_p_037;
+		pdata->VL53LX_p_038 = pc->VL53LX_p_038;
+		pdata->VL53LX_p_009 = pc->VL53LX_p_009;
+		pdata->VL53LX_p_033 = pc->VL53LX_p_033;
+		pdata->VL53LX_p_034 = pc->VL53LX_p_034;
+		pdata->VL53LX_p_004 = pc->VL53LX_p_004;
+		pdata->VL53LX_p_028 = pc->VL53LX_p_028;
+		amb_thres_events    = pc->amb_thresh_events;
+
+	} else {
 
 
 
@@ -134,42 +228,104 @@ VL53LX_Error VL53LX_f_001(
 			if (tmp64 < (uint64_t)pcfg->max_effective_spads)
 				pdata->VL53LX_p_004 = (uint16_t)tmp64;
 		}
-	}
 
 
 
-	if ((pcal->ref__actual_effective_spads != 0) &&
-		(pbins->VL53LX_p_015        != 0) &&
-		(pcal->ref_reflectance_pc          != 0) &&
-		(pbins->total_periods_elapsed      != 0)) {
+		if ((pcal->ref__actual_effective_spads != 0) &&
+			(pcal->ref_reflectance_pc          != 0)) {
 
 
 
-		tmp64  = (uint64_t)pcal->ref__peak_signal_count_rate_mcps;
-		tmp64 *= (1000 * 256);
-		tmp32  = pcal->ref__actual_effective_spads/2;
-		tmp64 += (uint64_t)tmp32;
-		tmp64  = do_division_u(tmp64,
-			(uint64_t)pcal->ref__actual_effective_spads);
+			tmp64  =
+			(uint64_t)pcal->ref__peak_signal_count_rate_mcps;
+			tmp64 *= (1000 * 256);
+			tmp32  = pcal->ref__actual_effective_spads/2;
+			tmp64 += (uint64_t)tmp32;
+			tmp64  = do_division_u(tmp64,
+				(uint64_t)pcal->ref__actual_effective_spads);
 
-		pdata->VL53LX_p_009   = (uint32_t)tmp64;
-		pdata->VL53LX_p_009 <<= 4;
+			pdata->VL53LX_p_009   = (uint32_t)tmp64;
+			pdata->VL53LX_p_009 <<= 4;
 
 
 
-		tmp64   = (uint64_t)pdata->VL53LX_p_037;
-		tmp64  *= (uint64_t)pdata->VL53LX_p_033;
-		tmp64  *= (uint64_t)pdata->VL53LX_p_004;
-		tmp64  += (1<<(11+7));
-		tmp64 >>= (11+8);
-		tmp64  +=  500;
-		tmp64   = do_division_u(tmp64, 1000);
+			tmp64   = (uint64_t)pdata->VL53LX_p_037;
+			tmp64  *= (uint64_t)pdata->VL53LX_p_033;
+			tmp64  *= (uint64_t)pdata->VL53LX_p_004;
+			tmp64  += (1<<(11+7));
+			tmp64 >>= (11+8);
+			tmp64  +=  500;
+			tmp64   = do_division_u(tmp64, 1000);
 
 
-		if (tmp64 > 0x00FFFFFF)
-			tmp64 = 0x00FFFFFF;
+			if (tmp64 > 0x00FFFFFF)
+				tmp64 = 0x00FFFFFF;
+
+			pdata->VL53LX_p_028     = (uint32_t)tmp64;
+
 
-		pdata->VL53LX_p_028     = (uint32_t)tmp64;
+
+			amb_thres_events  =
+				VL53LX_isqrt(pdata->VL53LX_p_028 << 8);
+			amb_thres_events *=
+				(uint32_t)pcfg->ambient_thresh_sigma;
+
+
+
+			if (pdata->VL53LX_p_028 <
+				(uint32_t)pcfg->min_ambient_thresh_events) {
+
+				amb_thres_delta =
+					pcfg->min_ambient_thresh_events -
+					(uint32_t)pdata->VL53LX_p_028;
+
+
+				amb_thres_delta <<= 8;
+
+				if (amb_thres_events < amb_thres_delta)
+					amb_thres_events = amb_thres_delta;
+			}
+		}
+
+		memcpy(&(pc->ambient_key), &akey, sizeof(akey));
+		pc->ambient_valid     = 1;
+		pc->VL53LX_p_037      = pdata->VL53LX_p_037;
+		pc->VL53LX_p_038      = pdata->VL53LX_p_038;
+		pc->VL53LX_p_009      = pdata->VL53LX_p_009;
+		pc->VL53LX_p_033      = pdata->VL53LX_p_033;
+		pc->VL53LX_p_034      = pdata->VL53LX_p_034;
+		pc->VL53LX_p_004      = pdata->VL53LX_p_004;
+		pc->VL53LX_p_028      = pdata->VL53LX_p_028;
+		pc->amb_thresh_events = amb_thres_events;
+	}
+
+
+
+	if ((pcal->ref__actual_effective_spads == 0) ||
+		(pcal->ref_reflectance_pc          == 0)) {
+		LOG_FUNCTION_END(status);
+		return status;
+	}
+
+
+
+	memset(&rkey, 0, sizeof(rkey));
+	rkey.target_reflectance        = target_reflectance;
+	rkey.coverglass_transmission   = pcal->coverglass_transmission;
+	rkey.ref_distance_mm           = pcal->ref__distance_mm;
+	rkey.vcsel_width               = pbins->vcsel_width;
+	rkey.signal_total_events_limit = pcfg->signal_total_events_limit;
+	rkey.signal_thresh_sigma       = pcfg->signal_thresh_sigma;
+
+	entry = VL53LX_dmax_cache_lookup_reflectance(pc, &rkey);
+
+	if (entry >= 0) {
+
+		pdata->VL53LX_p_035 = pc->VL53LX_p_035[entry];
+		pdata->VL53LX_p_036 = pc->VL53LX_p_036[entry];
+		pdata->VL53LX_p_022 = pc->VL53LX_p_022[entry];
+
+	} else {
 
 
 
@@ -199,30 +355,9 @@ VL53LX_Error VL53LX_f_001(
 
 
 
-		tmp32  = VL53LX_isqrt(pdata->VL53LX_p_028 << 8);
-		tmp32 *= (uint32_t)pcfg->ambient_thresh_sigma;
-
-
-
-		if (pdata->VL53LX_p_028 <
-			(uint32_t)pcfg->min_ambient_thresh_events) {
-
-			amb_thres_delta =
-				pcfg->min_ambient_thresh_events -
-				(uint32_t)pdata->VL53LX_p_028;
-
-
-			amb_thres_delta <<= 8;
-
-			if (tmp32 < amb_thres_delta)
-				tmp32 = amb_thres_delta;
-		}
-
-
-
 		pdata->VL53LX_p_022 =
 			(int16_t)VL53LX_f_002(
-				tmp32,
+				amb_thres_events,
 				pdata->VL53LX_p_035,
 				(uint32_t)pcal->ref__distance_mm,
 				(uint32_t)pcfg->signal_thresh_sigma);
@@ -241,15 +376,25 @@ VL53LX_Error VL53LX_f_001(
 				(uint32_t)pcal->ref__distance_mm,
 				(uint32_t)pcfg->signal_thresh_sigma);
 
+		entry = (int8_t)pc->reflectance_next;
+		memcpy(&(pc->reflectance_key[entry]), &rkey, sizeof(rkey));
+		pc->VL53LX_p_035[entry]    = pdata->VL53LX_p_035;
+		pc->VL53LX_p_036[entry]    = pdata->VL53LX_p_036;
+		pc->VL53LX_p_022[entry]    = pdata->VL53LX_p_022;
+
+		pc->reflectance_next =
+			(pc->reflectance_next + 1) % VL53LX_DMAX_CACHE_SIZE;
+		if (pc->reflectance_count < VL53LX_DMAX_CACHE_SIZE)
+			pc->reflectance_count++;
+	}
 
 
 
-		if (pdata->VL53LX_p_036 < pdata->VL53LX_p_022)
-			*pambient_dmax_mm = pdata->VL53LX_p_036;
-		else
-			*pambient_dmax_mm = pdata->VL53LX_p_022;
 
-	}
+	if (pdata->VL53LX_p_036 < pdata->VL53LX_p_022)
+		*pambient_dmax_mm = pdata->VL53LX_p_036;
+	else
+		*pambient_dmax_mm = pdata->VL53LX_p_022;
 
 	LOG_FUNCTION_END(status);
 
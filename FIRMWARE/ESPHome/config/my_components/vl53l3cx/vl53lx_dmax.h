@@ -27,6 +27,7 @@
 
 #include "vl53lx_types.h"
 #include "vl53lx_hist_structs.h"
+#include "vl53lx_dmax_structs.h"
 #include "vl53lx_dmax_private_structs.h"
 #include "vl53lx_error_codes.h"
 
@@ -43,6 +44,7 @@ VL53LX_Error VL53LX_f_001(
 	VL53LX_hist_gen3_dmax_config_t	     *pcfg,
 	VL53LX_histogram_bin_data_t          *pbins,
 	VL53LX_hist_gen3_dmax_private_data_t *pdata,
+	VL53LX_dmax_cache_t                  *pcache,
 	int16_t                              *pambient_dmax_mm);
 
 
@@ -55,6 +57,12 @@ uint32_t VL53LX_f_002(
 	uint32_t     signal_thresh_sigma);
 
 
+
+
+void VL53LX_dmax_cache_invalidate(
+	VL53LX_dmax_cache_t  *pcache);
+
+
 #ifdef __cplusplus
 }
 #endif
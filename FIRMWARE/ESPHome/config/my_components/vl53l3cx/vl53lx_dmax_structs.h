@@ -84,6 +84,73 @@ typedef struct {
 } VL53LX_hist_gen3_dmax_config_t;
 
 
+
+#define VL53LX_DMAX_CACHE_SIZE  5
+
+
+
+typedef struct {
+
+	uint16_t   fast_osc_frequency;
+	uint16_t   dss_actual_effective_spads;
+	uint32_t   total_periods_elapsed;
+	int32_t    ambient_events;
+
+	uint16_t   max_effective_spads;
+	uint16_t   dss_target_total_rate_mcps;
+	int32_t    min_ambient_thresh_events;
+	uint8_t    ambient_thresh_sigma;
+
+	uint16_t   ref_actual_effective_spads;
+	uint16_t   ref_peak_signal_count_rate_mcps;
+	uint16_t   ref_reflectance_pc;
+
+} VL53LX_dmax_ambient_key_t;
+
+
+
+typedef struct {
+
+	uint16_t   target_reflectance;
+	uint16_t   coverglass_transmission;
+	uint16_t   ref_distance_mm;
+	uint16_t   vcsel_width;
+	int32_t    signal_total_events_limit;
+	uint8_t    signal_thresh_sigma;
+
+} VL53LX_dmax_reflectance_key_t;
+
+
+
+typedef struct {
+
+	uint8_t                        ambient_valid;
+	VL53LX_dmax_ambient_key_t      ambient_key;
+
+	uint32_t   VL53LX_p_037;
+	uint16_t   VL53LX_p_038;
+	uint32_t   VL53LX_p_009;
+	uint32_t   VL53LX_p_033;
+	uint16_t   VL53LX_p_034;
+	uint16_t   VL53LX_p_004;
+	uint32_t   VL53LX_p_028;
+	uint32_t   amb_thresh_events;
+
+
+	uint8_t                        reflectance_count;
+	uint8_t                        reflectance_next;
+	VL53LX_dmax_reflectance_key_t  reflectance_key[VL53LX_DMAX_CACHE_SIZE];
+	uint32_t   VL53LX_p_035[VL53LX_DMAX_CACHE_SIZE];
+	int16_t    VL53LX_p_036[VL53LX_DMAX_CACHE_SIZE];
+	int16_t    VL53LX_p_022[VL53LX_DMAX_CACHE_SIZE];
+
+
+	uint32_t   lookups;
+	uint32_t   hits;
+
+} VL53LX_dmax_cache_t;
+
+
 #ifdef __cplusplus
 }
 #endif
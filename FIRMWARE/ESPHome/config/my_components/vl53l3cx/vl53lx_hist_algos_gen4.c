@@ -47,6 +47,15 @@
 	_LOG_TRACE_PRINT(VL53LX_TRACE_MODULE_HISTOGRAM, \
 	level, VL53LX_TRACE_FUNCTION_NONE, ##__VA_ARGS__)
 
+/*
+ * Least log2 curvature (20.12) of a peak for the Gaussian interpolation:
+ * 1 / (2 * sigma^2 * ln 2) for a pulse sigma of 1 bin.
+ */
+#define VL53LX_HIST_PEAK_MIN_CURVATURE  2955
+
+/* Largest weight of a bin in the Gaussian interpolation's fit */
+#define VL53LX_HIST_PEAK_MAX_WEIGHT     255
+
 
 VL53LX_Error VL53LX_f_025(
 	VL53LX_dmax_calibration_data_t         *pdmax_cal,
@@ -57,6 +66,7 @@ VL53LX_Error VL53LX_f_025(
 	VL53LX_hist_gen3_algo_private_data_t   *palgo3,
 	VL53LX_hist_gen4_algo_filtered_data_t  *pfiltered,
 	VL53LX_hist_gen3_dmax_private_data_t   *pdmax_algo,
+	VL53LX_dmax_cache_t                    *pdmax_cache,
 	VL53LX_range_results_t                 *presults,
 	uint8_t                                histo_merge_nb)
 {
@@ -104,16 +114,10 @@ VL53LX_Error VL53LX_f_025(
 
 
 
-	VL53LX_hist_estimate_ambient_from_thresholded_bins(
+	VL53LX_hist_estimate_and_remove_ambient(
 		(int32_t)ppost_cfg->ambient_thresh_sigma0,
 		&(palgo3->VL53LX_p_006));
 
-	VL53LX_hist_estimate_ambient_from_ambient_bins(
-			&(palgo3->VL53LX_p_006));
-
-
-	VL53LX_hist_remove_ambient_bins(&(palgo3->VL53LX_p_006));
-
 
 	if (ppost_cfg->algo__crosstalk_compensation_enable > 0)
 		VL53LX_f_005(
@@ -134,6 +138,7 @@ VL53LX_Error VL53LX_f_025(
 				pdmax_cfg,
 				&(palgo3->VL53LX_p_006),
 				pdmax_algo,
+				pdmax_cache,
 				&(presults->VL53LX_p_022[p]));
 		}
 	}
@@ -243,6 +248,14 @@ VL53LX_Error VL53LX_f_025(
 					pfiltered,
 					palgo3);
 
+		if (status == VL53LX_ERROR_NONE)
+			status =
+				VL53LX_hist_refine_peak_phase(
+					p,
+					ppost_cfg->hist_peak_estimator,
+					&(palgo3->VL53LX_p_048),
+					palgo3);
+
 		if (status == VL53LX_ERROR_NONE)
 			status =
 			VL53LX_f_014(
@@ -535,3 +548,211 @@ VL53LX_Error VL53LX_f_028(
 }
 
 
+VL53LX_Error VL53LX_hist_refine_peak_phase(
+	uint8_t                                pulse_no,
+	VL53LX_HistPeakEstimator               peak_estimator,
+	VL53LX_histogram_bin_data_t           *ppulse,
+	VL53LX_hist_gen3_algo_private_data_t  *palgo3)
+{
+
+	/*
+	 * Gaussian interpolation of the pulse peak: a parabola fitted to the
+	 * log2 of the 5 ambient-removed bins around the highest bin, each
+	 * weighted by the inverse variance of its log, y^2 / (y + ambient)
+	 * for Poisson counts. The first fit weights by the measured counts,
+	 * the second by the first fit's counts, so that a bin pushed up by
+	 * noise does not also get more weight. The filter phase of
+	 * VL53LX_f_028 is kept when there is no clear peak, or when the pulse
+	 * is wider than about one bin sigma, where the filter's wider window
+	 * gives the lower jitter.
+	 */
+
+	VL53LX_Error  status = VL53LX_ERROR_NONE;
+
+	VL53LX_hist_pulse_data_t *pdata = &(palgo3->VL53LX_p_003[pulse_no]);
+
+	uint8_t  ns        = palgo3->VL53LX_p_030;
+	uint8_t  nb        = palgo3->VL53LX_p_021;
+	int32_t  amb       = palgo3->VL53LX_p_028;
+	uint8_t  lb        = 0;
+	uint8_t  i         = 0;
+	uint8_t  peak      = 0xFF;
+	uint8_t  w         = 0;
+	int32_t  x         = 0;
+	int32_t  max_value = 0;
+	int64_t  y[5];
+	int32_t  l[5];
+	uint64_t wt[5];
+	int64_t  coef[3];
+	int32_t  l_peak    = 0;
+	int64_t  fit       = 0;
+	uint64_t fit_y     = 0;
+	int64_t  phase     = 0;
+
+	if (peak_estimator != VL53LX_HIST_PEAK_ESTIMATOR__GAUSSIAN ||
+		ns == 0 || pdata->VL53LX_p_023 == 0xFF)
+		return status;
+
+	if (amb < 0)
+		amb = 0;
+
+	for (lb = pdata->VL53LX_p_012; lb <= pdata->VL53LX_p_013; lb++) {
+		i = lb % ns;
+		if (i < nb && (peak == 0xFF || ppulse->bin_data[i] > max_value)) {
+			max_value = ppulse->bin_data[i];
+			peak = lb;
+		}
+	}
+	if (peak == 0xFF)
+		return status;
+
+	for (w = 0; w < 5; w++) {
+		i = (uint8_t)(((uint16_t)peak + ns + w - 2) % ns);
+		if (i >= nb)
+			return status;
+		y[w] = (int64_t)ppulse->bin_data[i] - (int64_t)amb;
+		if (y[w] > 0xFFFFFFFF)
+			return status;
+	}
+	if (y[2] <= 0)
+		return status;
+
+	/* log2 in 20.12, about the peak bin's */
+
+	l_peak = VL53LX_log2_q16((uint32_t)y[2]);
+	for (w = 0; w < 5; w++) {
+		l[w] = 0;
+		wt[w] = 0;
+		if (y[w] <= 0)
+			continue;
+		l[w] = (VL53LX_log2_q16((uint32_t)y[w]) - l_peak) / 16;
+		wt[w] = ((uint64_t)y[w] * (uint64_t)y[w]) /
+			(uint64_t)(y[w] + amb);
+	}
+
+	if (VL53LX_hist_fit_log_parabola(wt, l, coef) == 0)
+		return status;
+
+	/*
+	 * Refit with the weights of the fitted counts, 2^fit * y[2], where
+	 * 2^f for the fraction f is 1 + f * (0.657 + 0.343 f), within 0.3%
+	 */
+
+	for (w = 0; w < 5; w++) {
+		if (y[w] <= 0)
+			continue;
+		x = (int32_t)w - 2;
+		fit = coef[0] + coef[1] * x + coef[2] * x * x;
+		if (fit > 2 * 4096)
+			fit = 2 * 4096;
+		if (fit < -32 * 4096) {
+			wt[w] = 0;
+			continue;
+		}
+		fit_y = (uint64_t)(fit & 0xFFF);
+		fit_y = 4096 + ((fit_y * (2690 + ((fit_y * 1406) >> 12))) >> 12);
+		fit_y = ((uint64_t)y[2] * fit_y) >> 12;
+		if (fit >= 0)
+			fit_y <<= (fit >> 12);
+		else
+			fit_y >>= ((-fit + 0xFFF) >> 12);
+		if (fit_y > 0xFFFFFFFF)
+			fit_y = 0xFFFFFFFF;
+		wt[w] = (fit_y * fit_y) / (fit_y + (uint64_t)amb + 1);
+	}
+
+	if (VL53LX_hist_fit_log_parabola(wt, l, coef) == 0)
+		return status;
+
+	if (coef[2] > -VL53LX_HIST_PEAK_MIN_CURVATURE)
+		return status;
+
+	phase = do_division_s(-1024 * coef[1], coef[2]);
+	if (phase < -1024 || phase > 1024)
+		return status;
+
+	phase += 1024 + (2048 * (int64_t)peak);
+
+	if (phase < 0)
+		phase = 0;
+	if (phase > VL53LX_MAX_ALLOWED_PHASE)
+		phase = VL53LX_MAX_ALLOWED_PHASE;
+
+	pdata->VL53LX_p_011 =
+		(uint32_t)((int32_t)phase % ((int32_t)ns * 2048));
+
+	return status;
+}
+
+
+uint8_t VL53LX_hist_fit_log_parabola(
+	uint64_t      *pweights,
+	int32_t       *plog2,
+	int64_t       *pcoef)
+{
+
+	/*
+	 * Weighted least squares of l = a + b x + c x^2 over x = -2 .. 2,
+	 * by Cramer's rule on the normal equations. The weights are scaled
+	 * to 8 bits, which keeps every product within 64 bits.
+	 */
+
+	uint64_t wt_max = 0;
+	uint8_t  shift  = 0;
+	uint8_t  w      = 0;
+	int32_t  x      = 0;
+	int32_t  wt     = 0;
+	int32_t  s[5]   = {0, 0, 0, 0, 0};
+	int32_t  t[3]   = {0, 0, 0};
+	int64_t  m[3];
+	int64_t  det    = 0;
+
+	for (w = 0; w < 5; w++)
+		if (pweights[w] > wt_max)
+			wt_max = pweights[w];
+
+	while ((wt_max >> shift) > VL53LX_HIST_PEAK_MAX_WEIGHT)
+		shift++;
+
+	for (w = 0; w < 5; w++) {
+		wt = (int32_t)(pweights[w] >> shift);
+		x  = (int32_t)w - 2;
+		s[0] += wt;
+		s[1] += wt * x;
+		s[2] += wt * x * x;
+		s[3] += wt * x * x * x;
+		s[4] += wt * x * x * x * x;
+		t[0] += wt * plog2[w];
+		t[1] += wt * x * plog2[w];
+		t[2] += wt * x * x * plog2[w];
+	}
+
+	m[0] = (int64_t)s[2] * s[4] - (int64_t)s[3] * s[3];
+	m[1] = (int64_t)s[1] * s[4] - (int64_t)s[2] * s[3];
+	m[2] = (int64_t)s[1] * s[3] - (int64_t)s[2] * s[2];
+
+	det = s[0] * m[0] - s[1] * m[1] + s[2] * m[2];
+	if (det <= 0)
+		return 0;
+
+	pcoef[0] =
+		t[0] * m[0] -
+		s[1] * ((int64_t)t[1] * s[4] - (int64_t)s[3] * t[2]) +
+		s[2] * ((int64_t)t[1] * s[3] - (int64_t)s[2] * t[2]);
+	pcoef[1] =
+		s[0] * ((int64_t)t[1] * s[4] - (int64_t)s[3] * t[2]) -
+		t[0] * m[1] +
+		s[2] * ((int64_t)s[1] * t[2] - (int64_t)t[1] * s[2]);
+	pcoef[2] =
+		s[0] * ((int64_t)s[2] * t[2] - (int64_t)t[1] * s[3]) -
+		s[1] * ((int64_t)s[1] * t[2] - (int64_t)t[1] * s[2]) +
+		t[0] * m[2];
+
+	pcoef[0] = do_division_s(pcoef[0], det);
+	pcoef[1] = do_division_s(pcoef[1], det);
+	pcoef[2] = do_division_s(pcoef[2], det);
+
+	return 1;
+}
+
+
@@ -50,12 +50,33 @@ VL53LX_Error VL53LX_f_025(
 	VL53LX_hist_gen3_algo_private_data_t   *palgo,
 	VL53LX_hist_gen4_algo_filtered_data_t  *pfiltered,
 	VL53LX_hist_gen3_dmax_private_data_t   *pdmax_algo,
+	VL53LX_dmax_cache_t                    *pdmax_cache,
 	VL53LX_range_results_t                 *presults,
 	uint8_t                                histo_merge_nb);
 
 
 
 
+#ifdef VL53LX_HIST_TEMPLATED
+
+VL53LX_Error VL53LX_f_025_templated(
+	VL53LX_dmax_calibration_data_t         *pdmax_cal,
+	VL53LX_hist_gen3_dmax_config_t         *pdmax_cfg,
+	VL53LX_hist_post_process_config_t      *ppost_cfg,
+	VL53LX_histogram_bin_data_t            *pbins,
+	VL53LX_histogram_bin_data_t            *pxtalk,
+	VL53LX_hist_gen3_algo_private_data_t   *palgo,
+	VL53LX_hist_gen4_algo_filtered_data_t  *pfiltered,
+	VL53LX_hist_gen3_dmax_private_data_t   *pdmax_algo,
+	VL53LX_dmax_cache_t                    *pdmax_cache,
+	VL53LX_range_results_t                 *presults,
+	uint8_t                                histo_merge_nb);
+
+#endif
+
+
+
+
 VL53LX_Error VL53LX_f_026(
 	uint8_t                                pulse_no,
 	VL53LX_histogram_bin_data_t           *ppulse,
@@ -87,6 +108,29 @@ VL53LX_Error VL53LX_f_028(
 	uint32_t *pmedian_phase);
 
 
+
+
+/* Replaces the f_028 phase of a detected pulse with a sub-bin estimate
+ * of the selected peak_estimator; VL53LX_HIST_PEAK_ESTIMATOR__FILTER
+ * leaves it unchanged. */
+
+VL53LX_Error VL53LX_hist_refine_peak_phase(
+	uint8_t                                pulse_no,
+	VL53LX_HistPeakEstimator               peak_estimator,
+	VL53LX_histogram_bin_data_t           *ppulse,
+	VL53LX_hist_gen3_algo_private_data_t  *palgo);
+
+
+/* Weighted least squares parabola through 5 log2 values (20.12) at
+ * x = -2 .. 2: pcoef gets a, b and c of a + b x + c x^2 (20.12).
+ * Returns 0 if the weights do not determine a parabola. */
+
+uint8_t VL53LX_hist_fit_log_parabola(
+	uint64_t      *pweights,
+	int32_t       *plog2,
+	int64_t       *pcoef);
+
+
 #ifdef __cplusplus
 }
 #endif
@@ -63,6 +63,7 @@ VL53LX_Error VL53LX_hist_process_data(
 	VL53LX_xtalk_histogram_data_t      *pxtalk_shape,
 	uint8_t                            *pArea1,
 	uint8_t                            *pArea2,
+	VL53LX_dmax_cache_t                *pdmax_cache,
 	VL53LX_range_results_t             *presults,
 	uint8_t                            *HistMergeNumber)
 {
@@ -175,7 +176,11 @@ VL53LX_Error VL53LX_hist_process_data(
 
 
 		status =
+#ifdef VL53LX_HIST_TEMPLATED
+		VL53LX_f_025_templated(
+#else
 		VL53LX_f_025(
+#endif
 			pdmax_cal,
 			pdmax_cfg,
 			ppost_cfg,
@@ -184,6 +189,7 @@ VL53LX_Error VL53LX_hist_process_data(
 			palgo_gen3,
 			pfiltered4,
 			pdmax_algo_gen3,
+			pdmax_cache,
 			presults,
 			*HistMergeNumber);
 
@@ -273,9 +279,12 @@ VL53LX_Error VL53LX_hist_ambient_dmax(
 
 	VL53LX_hist_gen3_dmax_private_data_t   dmax_algo;
 	VL53LX_hist_gen3_dmax_private_data_t  *pdmax_algo = &dmax_algo;
+	VL53LX_dmax_cache_t                    dmax_cache;
 
 	LOG_FUNCTION_START("");
 
+	memset(&dmax_cache, 0, sizeof(dmax_cache));
+
 	status =
 		VL53LX_f_001(
 			target_reflectance,
@@ -283,6 +292,7 @@ VL53LX_Error VL53LX_hist_ambient_dmax(
 			pdmax_cfg,
 			pbins,
 			pdmax_algo,
+			&dmax_cache,
 			pambient_dmax_mm);
 
 	LOG_FUNCTION_END(status);
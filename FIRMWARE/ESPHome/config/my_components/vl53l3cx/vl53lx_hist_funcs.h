@@ -45,6 +45,7 @@ VL53LX_Error VL53LX_hist_process_data(
 	VL53LX_xtalk_histogram_data_t     *pxtalk,
 	uint8_t                           *pArea1,
 	uint8_t                           *pArea2,
+	VL53LX_dmax_cache_t               *pdmax_cache,
 	VL53LX_range_results_t            *presults,
 	uint8_t                           *HistMergeNumber);
 
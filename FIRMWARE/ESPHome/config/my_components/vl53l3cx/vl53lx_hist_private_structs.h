@@ -261,6 +261,7 @@ typedef struct {
 
 } VL53LX_hist_gen4_algo_filtered_data_t;
 
+
 #ifdef __cplusplus
 }
 #endif
@@ -80,6 +80,9 @@ typedef struct {
 	VL53LX_HistTargetOrder hist_target_order;
 
 
+	VL53LX_HistPeakEstimator hist_peak_estimator;
+
+
 	uint8_t   filter_woi0;
 
 	uint8_t   filter_woi1;
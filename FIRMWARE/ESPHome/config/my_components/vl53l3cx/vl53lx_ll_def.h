@@ -638,6 +638,13 @@ typedef struct {
 
 	uint32_t	nodetect_counter;
 
+
+	/* accumulator / current_samples, kept as each sample is added */
+	uint32_t	accumulator_mean;
+
+
+	uint32_t	accumulator_remainder;
+
 } VL53LX_smudge_corrector_internals_t;
 
 
@@ -1413,12 +1420,17 @@ typedef struct {
 
 	uint8_t  wArea1[1536];
 	uint8_t  wArea2[512];
+	VL53LX_dmax_cache_t dmax_cache;
 	VL53LX_per_vcsel_period_offset_cal_data_t per_vcsel_cal_data;
 
 	uint8_t bin_rec_pos;
 
 	uint8_t pos_before_next_recom;
 
+	/* Set by VL53LX_restart_histo_merge until the merge is complete
+	 * again: the smudge corrector then scales part merges to a full one. */
+	uint8_t hist_merge_restarted;
+
 	int32_t  multi_bins_rec[VL53LX_BIN_REC_SIZE]
 		[VL53LX_TIMING_CONF_A_B_SIZE][VL53LX_HISTOGRAM_BUFFER_SIZE];
 
@@ -319,6 +319,18 @@ typedef uint8_t VL53LX_HistTargetOrder;
 
 
 
+typedef uint8_t VL53LX_HistPeakEstimator;
+
+#define VL53LX_HIST_PEAK_ESTIMATOR__FILTER \
+	((VL53LX_HistPeakEstimator) 0)
+#define VL53LX_HIST_PEAK_ESTIMATOR__GAUSSIAN \
+	((VL53LX_HistPeakEstimator) 1)
+
+
+
+
+
+
 typedef uint8_t VL53LX_HistAmbEstMethod;
 
 #define VL53LX_HIST_AMB_EST_METHOD__AMBIENT_BINS \
@@ -550,7 +562,7 @@ typedef uint16_t VL53LX_TuningParms;
 #define VL53LX_TUNINGPARMS_LLD_PUBLIC_MIN_ADDRESS \
 	((VL53LX_TuningParms) VL53LX_TUNINGPARM_PUBLIC_PAGE_BASE_ADDRESS)
 #define VL53LX_TUNINGPARMS_LLD_PUBLIC_MAX_ADDRESS \
-	((VL53LX_TuningParms) VL53LX_TUNINGPARM_UWR_LONG_CORRECTION_ZONE_5_RANGEB)
+	((VL53LX_TuningParms) VL53LX_TUNINGPARM_HIST_PEAK_ESTIMATOR)
 
 #define VL53LX_TUNINGPARMS_LLD_PRIVATE_MIN_ADDRESS \
 	((VL53LX_TuningParms) VL53LX_TUNINGPARM_PRIVATE_PAGE_BASE_ADDRESS)
@@ -929,6 +941,8 @@ typedef uint16_t VL53LX_TuningParms;
 ((VL53LX_TuningParms) (VL53LX_TUNINGPARM_PUBLIC_PAGE_BASE_ADDRESS + 184))
 #define VL53LX_TUNINGPARM_UWR_LONG_CORRECTION_ZONE_5_RANGEB \
 ((VL53LX_TuningParms) (VL53LX_TUNINGPARM_PUBLIC_PAGE_BASE_ADDRESS + 185))
+#define VL53LX_TUNINGPARM_HIST_PEAK_ESTIMATOR \
+((VL53LX_TuningParms) (VL53LX_TUNINGPARM_PUBLIC_PAGE_BASE_ADDRESS + 186))
 
 
 
@@ -7,6 +7,7 @@
 #include <algorithm>
 #include <vector>
 #include <cstring>
+#include "esp_timer.h"
 
 // Include ST library headers
 extern "C" {
@@ -16,22 +17,26 @@ extern "C" {
 
 static const char *const TAG = "vl53l3cx.platform";
 
-// Global pointer to current component for platform functions
-static esphome::vl53l3cx::VL53L3CXComponent *g_component = nullptr;
-
-void vl53lx_set_i2c_component(esphome::vl53l3cx::VL53L3CXComponent *component) {
-  g_component = component;
+// Each device structure carries the hub component that owns it, so several
+// sensors can share the bus without a global "current device"
+static esphome::vl53l3cx::VL53L3CXComponent *component_for(VL53LX_DEV Dev) {
+  if (Dev == nullptr) {
+    return nullptr;
+  }
+  return static_cast<esphome::vl53l3cx::VL53L3CXComponent *>(Dev->comms_handle);
 }
 
 extern "C" {
 
 // I2C Read implementation using ESPHome's I2C
 VL53LX_Error VL53LX_ReadMulti(VL53LX_DEV Dev, uint16_t index, uint8_t *pdata, uint32_t count) {
-  if (g_component == nullptr) {
+  esphome::vl53l3cx::VL53L3CXComponent *component = component_for(Dev);
+  if (component == nullptr) {
     ESP_LOGE(TAG, "Platform component not set!");
     return VL53LX_ERROR_CONTROL_INTERFACE;
   }
 
+  const uint64_t start_us = esp_timer_get_time();
   const uint32_t MAX_CHUNK_SIZE = 32;  // Conservative chunk size
   uint32_t remaining = count;
   uint32_t offset = 0;
@@ -45,13 +50,13 @@ VL53LX_Error VL53LX_ReadMulti(VL53LX_DEV Dev, uint16_t index, uint8_t *pdata, ui
     addr_bytes[1] = cur_index & 0xFF;
 
     // Write register address for this chunk
-    if (g_component->write(addr_bytes, 2) != esphome::i2c::ERROR_OK) {
+    if (component->write(addr_bytes, 2) != esphome::i2c::ERROR_OK) {
       ESP_LOGD(TAG, "Failed to write register address 0x%04X", cur_index);
       return VL53LX_ERROR_CONTROL_INTERFACE;
     }
 
     // Read chunk
-    if (g_component->read(pdata + offset, chunk) != esphome::i2c::ERROR_OK) {
+    if (component->read(pdata + offset, chunk) != esphome::i2c::ERROR_OK) {
       ESP_LOGD(TAG, "Failed to read %u bytes from 0x%04X", chunk, cur_index);
       return VL53LX_ERROR_CONTROL_INTERFACE;
     }
@@ -63,17 +68,21 @@ VL53LX_Error VL53LX_ReadMulti(VL53LX_DEV Dev, uint16_t index, uint8_t *pdata, ui
     esphome::delay(1);
   }
 
+  component->record_i2c_transfer(count, (uint32_t)(esp_timer_get_time() - start_us));
+  component->record_i2c_read(index, pdata, count);
   ESP_LOGVV(TAG, "Read %u bytes from 0x%04X", count, index);
   return VL53LX_ERROR_NONE;
 }
 
 // I2C Write implementation using ESPHome's I2C
 VL53LX_Error VL53LX_WriteMulti(VL53LX_DEV Dev, uint16_t index, uint8_t *pdata, uint32_t count) {
-  if (g_component == nullptr) {
+  esphome::vl53l3cx::VL53L3CXComponent *component = component_for(Dev);
+  if (component == nullptr) {
     ESP_LOGE(TAG, "Platform component not set!");
     return VL53LX_ERROR_CONTROL_INTERFACE;
   }
 
+  const uint64_t start_us = esp_timer_get_time();
   // ESPHome I2C may have transaction size limits, so chunk large writes
   const uint32_t MAX_CHUNK_SIZE = 32;  // Conservative chunk size
   
@@ -84,7 +93,7 @@ VL53LX_Error VL53LX_WriteMulti(VL53LX_DEV Dev, uint16_t index, uint8_t *pdata, u
     buffer[1] = index & 0xFF;
     std::memcpy(&buffer[2], pdata, count);
 
-    if (g_component->write(buffer.data(), buffer.size()) != esphome::i2c::ERROR_OK) {
+    if (component->write(buffer.data(), buffer.size()) != esphome::i2c::ERROR_OK) {
       ESP_LOGD(TAG, "Failed to write %u bytes to 0x%04X", count, index);
       return VL53LX_ERROR_CONTROL_INTERFACE;
     }
@@ -101,7 +110,7 @@ VL53LX_Error VL53LX_WriteMulti(VL53LX_DEV Dev, uint16_t index, uint8_t *pdata, u
       buffer[1] = chunk_addr & 0xFF;
       std::memcpy(&buffer[2], pdata + offset, chunk_size);
 
-      if (g_component->write(buffer.data(), buffer.size()) != esphome::i2c::ERROR_OK) {
+      if (component->write(buffer.data(), buffer.size()) != esphome::i2c::ERROR_OK) {
         ESP_LOGD(TAG, "Failed to write chunk %u bytes to 0x%04X (offset %u)", 
                  chunk_size, chunk_addr, offset);
         return VL53LX_ERROR_CONTROL_INTERFACE;
@@ -112,6 +121,7 @@ VL53LX_Error VL53LX_WriteMulti(VL53LX_DEV Dev, uint16_t index, uint8_t *pdata, u
     }
   }
 
+  component->record_i2c_transfer(count, (uint32_t)(esp_timer_get_time() - start_us));
   ESP_LOGVV(TAG, "Wrote %u bytes to 0x%04X", count, index);
   return VL53LX_ERROR_NONE;
 }
@@ -177,19 +187,27 @@ VL53LX_Error VL53LX_WaitUs(VL53LX_DEV Dev, int32_t wait_us) {
   return VL53LX_ERROR_NONE;
 }
 
+// Monotonic µs timebase (esp_timer, 64-bit, never wraps in practice).
+// Tick count and timer value are truncated views of it; callers only ever
+// use differences, which stay correct across the 32-bit wrap.
+VL53LX_Error VL53LX_GetTimestampUs(uint64_t *ptimestamp_us) {
+  *ptimestamp_us = (uint64_t) esp_timer_get_time();
+  return VL53LX_ERROR_NONE;
+}
+
 VL53LX_Error VL53LX_GetTickCount(VL53LX_DEV Dev, uint32_t *ptick_count_ms) {
-  *ptick_count_ms = esphome::millis();
+  *ptick_count_ms = (uint32_t)(esp_timer_get_time() / 1000);
   return VL53LX_ERROR_NONE;
 }
 
 // Timer functions (not used by core, but required by API)
 VL53LX_Error VL53LX_GetTimerFrequency(int32_t *ptimer_freq_hz) {
-  *ptimer_freq_hz = 1000;  // 1kHz (millisecond timer)
+  *ptimer_freq_hz = 1000000;  // 1MHz (microsecond timer)
   return VL53LX_ERROR_NONE;
 }
 
 VL53LX_Error VL53LX_GetTimerValue(int32_t *ptimer_count) {
-  *ptimer_count = esphome::millis();
+  *ptimer_count = (int32_t)(uint32_t) esp_timer_get_time();
   return VL53LX_ERROR_NONE;
 }
 
@@ -247,10 +265,14 @@ VL53LX_Error VL53LX_WaitValueMaskEx(
     uint8_t mask,
     uint32_t poll_delay_ms) {
   
-  uint32_t start_time_ms = esphome::millis();
+  uint32_t start_time_ms = 0;
+  uint32_t now_ms = 0;
   uint8_t byte_value;
   
-  while ((esphome::millis() - start_time_ms) < timeout_ms) {
+  VL53LX_GetTickCount(Dev, &start_time_ms);
+  now_ms = start_time_ms;
+  
+  while ((now_ms - start_time_ms) < timeout_ms) {
     VL53LX_Error status = VL53LX_RdByte(Dev, index, &byte_value);
     if (status != VL53LX_ERROR_NONE) {
       return status;
@@ -261,6 +283,7 @@ VL53LX_Error VL53LX_WaitValueMaskEx(
     }
     
     esphome::delay(poll_delay_ms);
+    VL53LX_GetTickCount(Dev, &now_ms);
   }
   
   return VL53LX_ERROR_TIME_OUT;
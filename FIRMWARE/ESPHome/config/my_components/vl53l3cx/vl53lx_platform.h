@@ -267,6 +267,20 @@ VL53LX_Error VL53LX_GetTimerFrequency(int32_t *ptimer_freq_hz);
 
 VL53LX_Error VL53LX_GetTimerValue(int32_t *ptimer_count);
 
+/**
+* @brief Get the 64-bit monotonic platform timebase in [us]
+*
+* Does not wrap for the lifetime of the device. VL53LX_GetTickCount() and
+* VL53LX_GetTimerValue() are derived from the same counter.
+*
+* @param[out] ptimestamp_us : pointer for timestamp value
+*
+ * @return  VL53LX_ERROR_NONE     Success
+ * @return  "Other error code"    See ::VL53LX_Error
+*/
+
+VL53LX_Error VL53LX_GetTimestampUs(uint64_t *ptimestamp_us);
+
 
 /**
  * @brief Set the mode of a specified GPIO pin
@@ -41,8 +41,7 @@ VL53LX_Error VL53LX_ipp_hist_process_data(
 
 
 	VL53LX_Error status         = VL53LX_ERROR_NONE;
-
-	SUPPRESS_UNUSED_WARNING(Dev);
+	VL53LX_LLDriverData_t *pdev = VL53LXDevStructGetLLDriverHandle(Dev);
 
 	status =
 		VL53LX_hist_process_data(
@@ -53,6 +52,7 @@ VL53LX_Error VL53LX_ipp_hist_process_data(
 			pxtalk,
 			pArea1,
 			pArea2,
+			&(pdev->dmax_cache),
 			presults,
 			phisto_merge_nb);
 
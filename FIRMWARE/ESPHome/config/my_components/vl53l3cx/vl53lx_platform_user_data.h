@@ -43,6 +43,9 @@ typedef struct {
 
 	uint32_t  new_data_ready_poll_duration_ms;
 
+
+	void     *comms_handle;
+
 } VL53LX_Dev_t;
 
 
@@ -22,6 +22,11 @@ extern "C"
 
 
 
+/* Layout version of VL53LX_DevData_t. Histogram captures log it with each
+ * driver state snapshot, so replay tools reject snapshots of another
+ * layout. Increment it when a change to the driver structures changes it. */
+#define VL53LX_DEVDATA_VERSION 3
+
 #define do_division_u(dividend, divisor) (dividend / divisor)
 
 
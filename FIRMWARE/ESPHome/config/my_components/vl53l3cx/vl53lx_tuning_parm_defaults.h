@@ -397,6 +397,8 @@ extern "C" {
 ((int16_t) 0)
 #define VL53LX_TUNINGPARM_UWR_LONG_CORRECTION_ZONE_5_RANGEB_DEFAULT \
 ((int16_t) 0)
+#define VL53LX_TUNINGPARM_HIST_PEAK_ESTIMATOR_DEFAULT \
+((uint8_t) 0)
 
 #ifdef __cplusplus
 }
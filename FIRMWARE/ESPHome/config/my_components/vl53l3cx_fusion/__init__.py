@@ -0,0 +1,79 @@
+"""Multi-sensor fusion of VL53L3CX hubs into a single nearest-target estimate."""
+
+import esphome.codegen as cg
+import esphome.config_validation as cv
+from esphome.components import sensor
+from esphome.const import (
+    CONF_ID,
+    DEVICE_CLASS_DISTANCE,
+    STATE_CLASS_MEASUREMENT,
+    UNIT_METER,
+)
+
+from ..vl53l3cx import VL53L3CXComponent
+
+CODEOWNERS = ["@mssaleh"]
+DEPENDENCIES = ["vl53l3cx"]
+AUTO_LOAD = ["sensor"]
+
+# Configuration keys
+CONF_SENSORS = "sensors"
+CONF_MAX_SIGMA = "max_sigma"
+CONF_MIN_SIGNAL_RATE = "min_signal_rate"
+CONF_ALIGNMENT_WINDOW = "alignment_window"
+CONF_DISTANCE = "distance"
+CONF_SOURCE = "source"
+
+# Must match VL53L3CXFusion::MAX_SOURCES
+MAX_SOURCES = 4
+
+vl53l3cx_fusion_ns = cg.esphome_ns.namespace("vl53l3cx_fusion")
+VL53L3CXFusion = vl53l3cx_fusion_ns.class_("VL53L3CXFusion", cg.Component)
+
+CONFIG_SCHEMA = cv.Schema(
+    {
+        cv.GenerateID(): cv.declare_id(VL53L3CXFusion),
+        cv.Required(CONF_SENSORS): cv.All(
+            cv.ensure_list(cv.use_id(VL53L3CXComponent)),
+            cv.Length(min=1, max=MAX_SOURCES),
+        ),
+        # Per-target confidence gates (in addition to range status)
+        cv.Optional(CONF_MAX_SIGMA, default=30.0): cv.float_range(min=1.0, max=1000.0),
+        cv.Optional(CONF_MIN_SIGNAL_RATE, default=0.5): cv.float_range(min=0.0, max=100.0),
+        # Frames older than this relative to the newest one are not fused
+        cv.Optional(
+            CONF_ALIGNMENT_WINDOW, default="250ms"
+        ): cv.positive_time_period_microseconds,
+        cv.Optional(CONF_DISTANCE): sensor.sensor_schema(
+            unit_of_measurement=UNIT_METER,
+            accuracy_decimals=3,
+            device_class=DEVICE_CLASS_DISTANCE,
+            state_class=STATE_CLASS_MEASUREMENT,
+        ),
+        cv.Optional(CONF_SOURCE): sensor.sensor_schema(
+            accuracy_decimals=0,
+            icon="mdi:radar",
+        ),
+    }
+).extend(cv.COMPONENT_SCHEMA)
+
+
+async def to_code(config):
+    """Generate the C++ code for the fusion component."""
+    var = cg.new_Pvariable(config[CONF_ID])
+    await cg.register_component(var, config)
+
+    for hub_id in config[CONF_SENSORS]:
+        hub = await cg.get_variable(hub_id)
+        cg.add(var.add_source(hub))
+
+    cg.add(var.set_max_sigma_mm(config[CONF_MAX_SIGMA]))
+    cg.add(var.set_min_signal_rate_mcps(config[CONF_MIN_SIGNAL_RATE]))
+    cg.add(var.set_alignment_window_us(int(config[CONF_ALIGNMENT_WINDOW].total_microseconds)))
+
+    if CONF_DISTANCE in config:
+        sens = await sensor.new_sensor(config[CONF_DISTANCE])
+        cg.add(var.set_distance_sensor(sens))
+    if CONF_SOURCE in config:
+        sens = await sensor.new_sensor(config[CONF_SOURCE])
+        cg.add(var.set_source_sensor(sens))
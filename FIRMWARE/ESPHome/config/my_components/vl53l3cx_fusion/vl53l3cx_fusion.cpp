@@ -0,0 +1,83 @@
+#include "vl53l3cx_fusion.h"
+#include "esphome/core/log.h"
+#include <cmath>
+
+namespace esphome {
+namespace vl53l3cx_fusion {
+
+static const char *const TAG = "vl53l3cx_fusion";
+
+void VL53L3CXFusion::add_source(vl53l3cx::VL53L3CXComponent *hub) {
+  if (this->num_sources_ < MAX_SOURCES) {
+    this->sources_[this->num_sources_++].hub = hub;
+  }
+}
+
+void VL53L3CXFusion::setup() {
+  for (uint8_t i = 0; i < this->num_sources_; i++) {
+    this->sources_[i].hub->add_on_frame_callback([this, i](const vl53l3cx::Frame &frame) { this->on_frame_(i, frame); });
+  }
+}
+
+void VL53L3CXFusion::dump_config() {
+  ESP_LOGCONFIG(TAG, "VL53L3CX Fusion:");
+  ESP_LOGCONFIG(TAG, "  Sources: %u", this->num_sources_);
+  ESP_LOGCONFIG(TAG, "  Max Sigma: %.1f mm", this->max_sigma_ / 65536.0f);
+  ESP_LOGCONFIG(TAG, "  Min Signal Rate: %.2f MCPS", this->min_signal_rate_ / 65536.0f);
+  ESP_LOGCONFIG(TAG, "  Alignment Window: %u µs", this->alignment_window_us_);
+  LOG_SENSOR("  ", "Distance", this->distance_sensor_);
+  LOG_SENSOR("  ", "Source", this->source_sensor_);
+}
+
+bool VL53L3CXFusion::accept_(const vl53l3cx::FrameTarget &target) const {
+  if (target.is_background) {
+    return false;
+  }
+  if (target.range_status != VL53LX_RANGESTATUS_RANGE_VALID &&
+      target.range_status != VL53LX_RANGESTATUS_RANGE_VALID_MERGED_PULSE) {
+    return false;
+  }
+  return target.range_mm > 0 && target.sigma_mm <= this->max_sigma_ &&
+         target.signal_rate_mcps >= this->min_signal_rate_;
+}
+
+void VL53L3CXFusion::on_frame_(uint8_t index, const vl53l3cx::Frame &frame) {
+  Source &source = this->sources_[index];
+  source.timestamp_us = frame.timestamp_us;
+  source.has_frame = true;
+  source.range_mm = -1;
+  for (uint8_t i = 0; i < frame.num_targets; i++) {
+    const vl53l3cx::FrameTarget &target = frame.targets[i];
+    if (this->accept_(target) && (source.range_mm < 0 || target.range_mm < source.range_mm)) {
+      source.range_mm = target.range_mm;
+    }
+  }
+  this->fuse_(frame.timestamp_us);
+}
+
+void VL53L3CXFusion::fuse_(uint64_t newest_us) {
+  // Nearest candidate among hubs whose latest frame lies inside the window
+  int16_t best_range_mm = -1;
+  int8_t best_source = -1;
+  for (uint8_t i = 0; i < this->num_sources_; i++) {
+    const Source &source = this->sources_[i];
+    if (!source.has_frame || source.range_mm < 0 || source.timestamp_us + this->alignment_window_us_ < newest_us) {
+      continue;
+    }
+    if (best_source < 0 || source.range_mm < best_range_mm) {
+      best_range_mm = source.range_mm;
+      best_source = i;
+    }
+  }
+
+  if (this->distance_sensor_ != nullptr) {
+    this->distance_sensor_->publish_state(best_source < 0 ? NAN : best_range_mm / 1000.0f);
+  }
+  if (this->source_sensor_ != nullptr && best_source != this->last_source_) {
+    this->source_sensor_->publish_state(best_source < 0 ? NAN : (float) best_source);
+  }
+  this->last_source_ = best_source;
+}
+
+}  // namespace vl53l3cx_fusion
+}  // namespace esphome
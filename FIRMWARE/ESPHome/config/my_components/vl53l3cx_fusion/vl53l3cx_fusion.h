@@ -0,0 +1,58 @@
+#pragma once
+
+#include "esphome/core/component.h"
+#include "esphome/components/sensor/sensor.h"
+#include "../vl53l3cx/vl53l3cx.h"
+#include <array>
+
+namespace esphome {
+namespace vl53l3cx_fusion {
+
+// Fuses frames from several VL53L3CX hubs into one nearest-target estimate.
+// Each hub keeps only its latest accepted candidate; fusion is a fixed pass
+// over at most MAX_SOURCES entries, so per-frame cost is bounded and nothing
+// is allocated after setup.
+class VL53L3CXFusion : public Component {
+ public:
+  static const uint8_t MAX_SOURCES = 4;
+
+  void setup() override;
+  void dump_config() override;
+  float get_setup_priority() const override { return setup_priority::DATA; }
+
+  // Configuration setters
+  void add_source(vl53l3cx::VL53L3CXComponent *hub);
+  void set_max_sigma_mm(float sigma_mm) { this->max_sigma_ = (FixPoint1616_t)(sigma_mm * 65536.0f); }
+  void set_min_signal_rate_mcps(float rate_mcps) { this->min_signal_rate_ = (FixPoint1616_t)(rate_mcps * 65536.0f); }
+  void set_alignment_window_us(uint32_t window_us) { this->alignment_window_us_ = window_us; }
+  void set_distance_sensor(sensor::Sensor *sensor) { this->distance_sensor_ = sensor; }
+  void set_source_sensor(sensor::Sensor *sensor) { this->source_sensor_ = sensor; }
+
+ protected:
+  // Latest accepted candidate of one hub
+  struct Source {
+    vl53l3cx::VL53L3CXComponent *hub{nullptr};
+    uint64_t timestamp_us{0};
+    int16_t range_mm{-1};  // Nearest accepted target, -1 if none
+    bool has_frame{false};
+  };
+
+  void on_frame_(uint8_t index, const vl53l3cx::Frame &frame);
+  bool accept_(const vl53l3cx::FrameTarget &target) const;
+  void fuse_(uint64_t newest_us);
+
+  std::array<Source, MAX_SOURCES> sources_{};
+  uint8_t num_sources_{0};
+
+  // Configuration parameters (driver fixed-point units)
+  FixPoint1616_t max_sigma_{30u << 16};
+  FixPoint1616_t min_signal_rate_{1u << 15};  // 0.5 MCPS
+  uint32_t alignment_window_us_{250000};
+
+  sensor::Sensor *distance_sensor_{nullptr};
+  sensor::Sensor *source_sensor_{nullptr};
+  int8_t last_source_{-2};  // Forces the first source publish
+};
+
+}  // namespace vl53l3cx_fusion
+}  // namespace esphome
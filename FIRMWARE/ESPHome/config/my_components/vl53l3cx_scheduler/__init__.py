@@ -0,0 +1,80 @@
+"""Round-robin ranging scheduler that keeps VL53L3CX emissions from overlapping."""
+
+import esphome.codegen as cg
+import esphome.config_validation as cv
+from esphome.const import CONF_ID, CONF_MODE
+
+from ..vl53l3cx import VL53L3CXComponent
+
+CODEOWNERS = ["@mssaleh"]
+DEPENDENCIES = ["vl53l3cx"]
+
+# Configuration keys
+CONF_SENSORS = "sensors"
+CONF_SENSOR_ID = "sensor_id"
+CONF_SLOT = "slot"
+CONF_GUARD_TIME = "guard_time"
+
+# Must match VL53L3CXScheduler::MAX_SENSORS
+MAX_SENSORS = 4
+
+vl53l3cx_scheduler_ns = cg.esphome_ns.namespace("vl53l3cx_scheduler")
+VL53L3CXScheduler = vl53l3cx_scheduler_ns.class_("VL53L3CXScheduler", cg.Component)
+SchedulerMode = vl53l3cx_scheduler_ns.enum("SchedulerMode")
+
+# STRICT: one emitter at a time (full immunity, longest cycle)
+# GROUPED: sensors sharing a slot emit together (shorter cycle; only for
+#          sensors that cannot see each other's VCSEL)
+SCHEDULER_MODES = {
+    "STRICT": SchedulerMode.SCHEDULER_MODE_STRICT,
+    "GROUPED": SchedulerMode.SCHEDULER_MODE_GROUPED,
+}
+
+SENSOR_SCHEMA = cv.Schema(
+    {
+        cv.Required(CONF_SENSOR_ID): cv.use_id(VL53L3CXComponent),
+        cv.Optional(CONF_SLOT): cv.int_range(min=0, max=MAX_SENSORS - 1),
+    }
+)
+
+
+def _validate_slots(cfg):
+    if cfg[CONF_MODE] == "STRICT":
+        for entry in cfg[CONF_SENSORS]:
+            if CONF_SLOT in entry:
+                raise cv.Invalid("slot is only used in GROUPED mode")
+    return cfg
+
+
+CONFIG_SCHEMA = cv.All(
+    cv.Schema(
+        {
+            cv.GenerateID(): cv.declare_id(VL53L3CXScheduler),
+            cv.Required(CONF_SENSORS): cv.All(
+                cv.ensure_list(SENSOR_SCHEMA),
+                cv.Length(min=1, max=MAX_SENSORS),
+            ),
+            cv.Optional(CONF_MODE, default="STRICT"): cv.enum(SCHEDULER_MODES, upper=True),
+            # Idle time between the end of one slot and the start of the next
+            cv.Optional(
+                CONF_GUARD_TIME, default="1ms"
+            ): cv.positive_time_period_microseconds,
+        }
+    ).extend(cv.COMPONENT_SCHEMA),
+    _validate_slots,
+)
+
+
+async def to_code(config):
+    """Generate the C++ code for the ranging scheduler."""
+    var = cg.new_Pvariable(config[CONF_ID])
+    await cg.register_component(var, config)
+
+    cg.add(var.set_mode(config[CONF_MODE]))
+    cg.add(var.set_guard_time_us(int(config[CONF_GUARD_TIME].total_microseconds)))
+
+    for index, entry in enumerate(config[CONF_SENSORS]):
+        hub = await cg.get_variable(entry[CONF_SENSOR_ID])
+        cg.add(hub.set_externally_triggered(True))
+        # STRICT ignores the slot and gives every sensor its own, in list order
+        cg.add(var.add_sensor(hub, entry.get(CONF_SLOT, index)))
@@ -0,0 +1,161 @@
+#include "vl53l3cx_scheduler.h"
+#include "esphome/core/log.h"
+#include "esp_timer.h"
+#include <algorithm>
+
+namespace esphome {
+namespace vl53l3cx_scheduler {
+
+static const char *const TAG = "vl53l3cx_scheduler";
+
+// Interval between per-sensor frame rate / overlap reports
+static const uint64_t STATS_INTERVAL_US = 10000000;
+
+void VL53L3CXScheduler::add_sensor(vl53l3cx::VL53L3CXComponent *hub, uint8_t slot) {
+  if (this->num_members_ >= MAX_SENSORS) {
+    return;
+  }
+  Member &member = this->members_[this->num_members_++];
+  member.hub = hub;
+  member.slot = slot;
+}
+
+void VL53L3CXScheduler::setup() {
+  // STRICT gives every sensor its own slot, in the order they were added
+  this->num_slots_ = 0;
+  for (uint8_t i = 0; i < this->num_members_; i++) {
+    Member &member = this->members_[i];
+    if (this->mode_ == SCHEDULER_MODE_STRICT) {
+      member.slot = i;
+    }
+    this->num_slots_ = std::max<uint8_t>(this->num_slots_, member.slot + 1);
+  }
+  // Slot boundaries need sub-millisecond loop resolution
+  this->high_freq_.start();
+}
+
+void VL53L3CXScheduler::dump_config() {
+  ESP_LOGCONFIG(TAG, "VL53L3CX Scheduler:");
+  ESP_LOGCONFIG(TAG, "  Mode: %s", this->mode_ == SCHEDULER_MODE_STRICT ? "STRICT" : "GROUPED");
+  ESP_LOGCONFIG(TAG, "  Guard Time: %u µs", this->guard_time_us_);
+  for (uint8_t i = 0; i < this->num_members_; i++) {
+    ESP_LOGCONFIG(TAG, "  Sensor %u: slot %u, timing budget %u µs", i, this->members_[i].slot,
+                  this->members_[i].hub->get_timing_budget_us());
+  }
+}
+
+void VL53L3CXScheduler::loop() {
+  const uint64_t now = esp_timer_get_time();
+
+  if (!this->running_) {
+    for (uint8_t i = 0; i < this->num_members_; i++) {
+      const auto *hub = this->members_[i].hub;
+      if (!hub->is_device_ready() && !hub->is_failed() && hub->get_supervisor().is_healthy()) {
+        return;  // Wait until every hub has finished its setup; one in recovery joins when it is back
+      }
+    }
+    this->running_ = true;
+    this->stats_start_us_ = now;
+    this->start_slot_(0, now);
+    return;
+  }
+
+  // Nothing in this slot can have finished before its timing budget elapsed
+  const uint64_t elapsed = now - this->slot_start_us_;
+  if (elapsed < this->slot_budget_us_) {
+    return;
+  }
+
+  if (this->slot_done_us_ == 0) {
+    // Wait for the slowest range, but never more than two budgets
+    if (!this->slot_complete_() && elapsed < 2ull * this->slot_budget_us_ + this->guard_time_us_) {
+      return;
+    }
+    this->slot_done_us_ = now;
+  }
+  if (now - this->slot_done_us_ < this->guard_time_us_) {
+    return;
+  }
+
+  // Advance to the next slot that has a ready sensor in it
+  uint8_t next = this->current_slot_;
+  for (uint8_t i = 0; i < this->num_slots_; i++) {
+    next = (next + 1) % this->num_slots_;
+    bool used = false;
+    for (uint8_t m = 0; m < this->num_members_; m++) {
+      used |= this->members_[m].slot == next && this->members_[m].hub->is_device_ready();
+    }
+    if (used) {
+      break;
+    }
+  }
+  this->start_slot_(next, now);
+
+  if (now - this->stats_start_us_ >= STATS_INTERVAL_US) {
+    this->log_stats_(now);
+  }
+}
+
+bool VL53L3CXScheduler::slot_complete_() {
+  bool complete = true;
+  for (uint8_t i = 0; i < this->num_members_; i++) {
+    Member &member = this->members_[i];
+    if (member.slot != this->current_slot_ || !member.triggered) {
+      continue;
+    }
+    if (member.hub->is_range_in_flight()) {
+      // Collect the result right away instead of waiting for the hub's poll
+      member.hub->update();
+    }
+    if (member.hub->is_range_in_flight()) {
+      complete = false;
+    }
+  }
+  return complete;
+}
+
+void VL53L3CXScheduler::start_slot_(uint8_t slot, uint64_t now_us) {
+  // Close out the previous slot
+  for (uint8_t i = 0; i < this->num_members_; i++) {
+    Member &member = this->members_[i];
+    if (member.slot != this->current_slot_ || !member.triggered) {
+      continue;
+    }
+    if (member.hub->is_range_in_flight()) {
+      member.overlaps++;
+    } else {
+      member.frames++;
+    }
+    member.triggered = false;
+  }
+
+  this->current_slot_ = slot;
+  this->slot_start_us_ = now_us;
+  this->slot_done_us_ = 0;
+  this->slot_budget_us_ = 0;
+  for (uint8_t i = 0; i < this->num_members_; i++) {
+    Member &member = this->members_[i];
+    if (member.slot != slot || !member.hub->is_device_ready()) {
+      continue;  // Failed, or in recovery
+    }
+    // A range that never reported back is restarted rather than waited on forever
+    member.triggered = member.hub->trigger_measurement(member.hub->is_range_in_flight());
+    if (member.triggered) {
+      this->slot_budget_us_ = std::max(this->slot_budget_us_, member.hub->get_timing_budget_us());
+    }
+  }
+}
+
+void VL53L3CXScheduler::log_stats_(uint64_t now_us) {
+  const float elapsed_s = (now_us - this->stats_start_us_) / 1e6f;
+  for (uint8_t i = 0; i < this->num_members_; i++) {
+    Member &member = this->members_[i];
+    ESP_LOGD(TAG, "Sensor %u: %.1f frames/s, %u overlap(s)", i, member.frames / elapsed_s, member.overlaps);
+    member.frames = 0;
+    member.overlaps = 0;
+  }
+  this->stats_start_us_ = now_us;
+}
+
+}  // namespace vl53l3cx_scheduler
+}  // namespace esphome
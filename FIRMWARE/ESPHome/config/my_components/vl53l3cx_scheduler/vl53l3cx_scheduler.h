@@ -0,0 +1,66 @@
+#pragma once
+
+#include "esphome/core/component.h"
+#include "esphome/core/helpers.h"
+#include "../vl53l3cx/vl53l3cx.h"
+#include <array>
+
+namespace esphome {
+namespace vl53l3cx_scheduler {
+
+enum SchedulerMode : uint8_t {
+  SCHEDULER_MODE_STRICT = 0,   // One emitter at a time
+  SCHEDULER_MODE_GROUPED = 1,  // Sensors sharing a slot emit together
+};
+
+// Staggers ranging of several VL53L3CX hubs so their VCSEL emissions do not
+// overlap. Each slot lasts as long as the longest timing budget among its
+// sensors; the next slot starts as soon as every range of the current one has
+// completed (plus the guard time), so the cycle is as short as the budgets
+// allow.
+class VL53L3CXScheduler : public Component {
+ public:
+  static const uint8_t MAX_SENSORS = 4;
+
+  void setup() override;
+  void loop() override;
+  void dump_config() override;
+  // After the hubs, which must be initialized before the first trigger
+  float get_setup_priority() const override { return setup_priority::PROCESSOR; }
+
+  // Configuration setters. The slot is only used in GROUPED mode.
+  void add_sensor(vl53l3cx::VL53L3CXComponent *hub, uint8_t slot = 0);
+  void set_mode(SchedulerMode mode) { this->mode_ = mode; }
+  void set_guard_time_us(uint32_t guard_us) { this->guard_time_us_ = guard_us; }
+
+ protected:
+  struct Member {
+    vl53l3cx::VL53L3CXComponent *hub{nullptr};
+    uint8_t slot{0};
+    bool triggered{false};  // Triggered in the current slot
+    uint32_t frames{0};     // Completed ranges since last stats report
+    uint32_t overlaps{0};   // Ranges still running when the next slot started
+  };
+
+  void start_slot_(uint8_t slot, uint64_t now_us);
+  bool slot_complete_();
+  void log_stats_(uint64_t now_us);
+
+  std::array<Member, MAX_SENSORS> members_{};
+  uint8_t num_members_{0};
+  uint8_t num_slots_{0};
+  SchedulerMode mode_{SCHEDULER_MODE_STRICT};
+  uint32_t guard_time_us_{1000};
+
+  // Runtime state
+  bool running_{false};
+  uint8_t current_slot_{0};
+  uint64_t slot_start_us_{0};
+  uint32_t slot_budget_us_{0};  // Longest timing budget in the current slot
+  uint64_t slot_done_us_{0};    // When the current slot completed (0 = still running)
+  uint64_t stats_start_us_{0};
+  HighFrequencyLoopRequester high_freq_;
+};
+
+}  // namespace vl53l3cx_scheduler
+}  // namespace esphome
@@ -0,0 +1,97 @@
+// VL53LX_hist_estimate_and_remove_ambient against the three calls it
+// fuses in VL53LX_f_025, on random histograms, and the time per call of
+// both on a typical frame.
+
+#include <initializer_list>
+
+#include "driver_check.h"
+
+extern "C" {
+#include "vl53lx_core_support.h"
+}
+
+using namespace vl53l3cx_tools;
+
+namespace {
+
+constexpr uint64_t CALLS = 1000000;
+
+// What VL53LX_f_025 ran before the fused call
+void three_calls(int32_t sigma, VL53LX_histogram_bin_data_t *hist) {
+  VL53LX_hist_estimate_ambient_from_thresholded_bins(sigma, hist);
+  VL53LX_hist_estimate_ambient_from_ambient_bins(hist);
+  VL53LX_hist_remove_ambient_bins(hist);
+}
+
+// Any bin and ambient bin count, including ambient bins past the bin count,
+// and bin values from a few counts to values near the int32 limit
+void random_histogram(Lcg &rng, VL53LX_histogram_bin_data_t *hist) {
+  rng.fill(hist, sizeof(*hist));
+  hist->VL53LX_p_020 = (uint8_t) rng.below(VL53LX_HISTOGRAM_BUFFER_SIZE + 1);
+  hist->VL53LX_p_021 = (uint8_t) rng.below(hist->VL53LX_p_020 + 1);
+  hist->number_of_ambient_bins = rng.below(3) == 0 ? 0 : (uint8_t) rng.below(hist->VL53LX_p_020 + 1);
+  const uint32_t scale = rng.below(4);
+  for (int32_t &bin : hist->bin_data) {
+    const uint32_t r = rng.next();
+    switch (scale) {
+      case 0:
+        bin = (int32_t) (r % 64);
+        break;
+      case 1:
+        bin = (int32_t) (r % 100000);
+        break;
+      case 2:
+        bin = (int32_t) (r % 4000000) - 100;
+        break;
+      default:
+        bin = (int32_t) (r << 8);
+        break;
+    }
+  }
+}
+
+uint64_t compare() {
+  Lcg rng(1);
+  uint64_t mismatches = 0;
+  for (uint64_t i = 0; i < CALLS; i++) {
+    VL53LX_histogram_bin_data_t expected, fused;
+    random_histogram(rng, &expected);
+    fused = expected;
+    const int32_t sigma = (int32_t) rng.below(256);
+    three_calls(sigma, &expected);
+    VL53LX_hist_estimate_and_remove_ambient(sigma, &fused);
+    if (std::memcmp(&expected, &fused, sizeof(fused)) != 0 && mismatches++ < 4) {
+      std::printf("  histogram %llu: %u bins, %u ambient bins\n", (unsigned long long) i, fused.VL53LX_p_021,
+                  fused.number_of_ambient_bins);
+    }
+  }
+  return mismatches;
+}
+
+// A 24-bin frame as the sensor reports it, with `ambient_bins` leading ambient bins
+template<typename F> double bench(uint8_t ambient_bins, F remove_ambient) {
+  VL53LX_histogram_bin_data_t frame{}, work;
+  frame.VL53LX_p_020 = VL53LX_HISTOGRAM_BUFFER_SIZE;
+  frame.VL53LX_p_021 = VL53LX_HISTOGRAM_BUFFER_SIZE;
+  frame.number_of_ambient_bins = ambient_bins;
+  for (int i = 0; i < VL53LX_HISTOGRAM_BUFFER_SIZE; i++) {
+    frame.bin_data[i] = 1000 + i * 37 % 200;
+  }
+  const double ns = ns_per_call(CALLS, [&](uint64_t) {
+    work = frame;
+    remove_ambient(64, &work);
+    keep(&work.VL53LX_p_028, sizeof(work.VL53LX_p_028));
+  });
+  return ns;
+}
+
+}  // namespace
+
+int main() {
+  const int failed = report("estimate_and_remove_ambient", CALLS, compare());
+  for (uint8_t ambient_bins : {0, 4}) {
+    std::printf("time per call, %u ambient bins: three calls %.1f ns, fused %.1f ns\n", ambient_bins,
+                bench(ambient_bins, three_calls), bench(ambient_bins, VL53LX_hist_estimate_and_remove_ambient));
+  }
+  return failed;
+}
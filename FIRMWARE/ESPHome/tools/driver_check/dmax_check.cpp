@@ -0,0 +1,195 @@
+// VL53LX_f_001 with its per-device memo against the driver's original,
+// over 20k-frame sequences of dmax inputs, with the memo hit rate and the
+// time per frame of both.
+
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+#include "dmax_reference.h"
+#include "driver_check.h"
+
+using namespace vl53l3cx_tools;
+
+namespace {
+
+constexpr size_t FRAMES = 20000;
+
+// The dmax inputs of one frame of one sensor
+struct Frame {
+  size_t sensor;
+  VL53LX_dmax_calibration_data_t cal;
+  VL53LX_hist_gen3_dmax_config_t cfg;
+  VL53LX_histogram_bin_data_t bins;
+};
+
+// Calibration and configuration as the driver's defaults set them
+Frame typical_frame() {
+  Frame frame{};
+  frame.cal.ref__actual_effective_spads = 0x5000;
+  frame.cal.ref__peak_signal_count_rate_mcps = 0x0EA0;
+  frame.cal.ref__distance_mm = 600;
+  frame.cal.ref_reflectance_pc = 17;
+  frame.cal.coverglass_transmission = 0x83;
+  frame.cfg.signal_thresh_sigma = 0x20;
+  frame.cfg.ambient_thresh_sigma = 0x70;
+  frame.cfg.min_ambient_thresh_events = 16;
+  frame.cfg.signal_total_events_limit = 100;
+  frame.cfg.max_effective_spads = 0xFFFF;
+  frame.cfg.dss_config__target_total_rate_mcps = 0x1400;
+  const uint16_t reflectances[VL53LX_MAX_AMBIENT_DMAX_VALUES] = {15, 52, 200, 364, 400};
+  for (int p = 0; p < VL53LX_MAX_AMBIENT_DMAX_VALUES; p++) {
+    frame.cfg.target_reflectance_for_dmax_calc[p] = reflectances[p];
+  }
+  frame.bins.VL53LX_p_015 = 0xB00;
+  frame.bins.total_periods_elapsed = 2000;
+  frame.bins.VL53LX_p_028 = 300;
+  frame.bins.result__dss_actual_effective_spads = 0x3000;
+  frame.bins.vcsel_width = 0x30;
+  return frame;
+}
+
+// `sensors` sensors ranging in turn; `ambient` sets each frame's ambient events
+std::vector<Frame> sequence(size_t sensors, const std::function<int32_t(size_t frame, size_t sensor)> &ambient) {
+  std::vector<Frame> frames(FRAMES, typical_frame());
+  for (size_t f = 0; f < FRAMES; f++) {
+    frames[f].sensor = f % sensors;
+    frames[f].bins.VL53LX_p_028 = ambient(f, frames[f].sensor);
+    frames[f].bins.result__dss_actual_effective_spads += (uint16_t) (0x100 * frames[f].sensor);
+  }
+  return frames;
+}
+
+// Any field values, with the zero-SPAD, zero-reflectance and zero-period
+// paths; the calibration changes every 50 frames on average and the
+// histogram every 5
+std::vector<Frame> random_frames() {
+  Lcg rng(7);
+  std::vector<Frame> frames(FRAMES);
+  Frame frame;
+  for (size_t f = 0; f < FRAMES; f++) {
+    if (f == 0 || rng.below(50) == 0) {
+      rng.fill(&frame.cal, sizeof(frame.cal));
+      rng.fill(&frame.cfg, sizeof(frame.cfg));
+      if (rng.below(4) == 0)
+        frame.cal.ref_reflectance_pc = 0;
+      if (rng.below(8) == 0)
+        frame.cal.ref__actual_effective_spads = 0;
+      frame.cal.ref__peak_signal_count_rate_mcps %= 20000;
+      frame.cfg.min_ambient_thresh_events %= 100000;
+      frame.cfg.signal_total_events_limit %= 1000;
+    }
+    if (f == 0 || rng.below(5) == 0) {
+      rng.fill(&frame.bins, sizeof(frame.bins));
+      frame.bins.VL53LX_p_015 = rng.below(3) == 0 ? 0 : (uint16_t) (0xA00 + rng.below(0x400));
+      frame.bins.total_periods_elapsed = rng.below(10) == 0 ? 0 : frame.bins.total_periods_elapsed % 5000;
+      frame.bins.VL53LX_p_028 = (int32_t) rng.below(4000);
+      frame.bins.vcsel_width %= 0x100;
+    } else if (rng.below(3) == 0) {
+      frame.bins.VL53LX_p_028 = (int32_t) rng.below(4000);
+    }
+    frame.sensor = 0;
+    frames[f] = frame;
+  }
+  return frames;
+}
+
+struct Result {
+  uint64_t mismatches{0};
+  double hit_rate{0};
+  double reference_ns{0};  // Per frame of five reflectances
+  double memo_ns{0};
+};
+
+// `shared`: every sensor uses one cache, as the driver did before the memo was per device
+Result run(std::vector<Frame> frames, bool shared) {
+  size_t sensors = 0;
+  for (const Frame &frame : frames) {
+    sensors = std::max(sensors, frame.sensor + 1);
+  }
+  std::vector<VL53LX_dmax_cache_t> caches(sensors);
+  auto cache = [&](const Frame &frame) { return &caches[shared ? 0 : frame.sensor]; };
+  auto reset = [&] {
+    for (VL53LX_dmax_cache_t &c : caches) {
+      std::memset(&c, 0, sizeof(c));
+    }
+  };
+
+  Result result;
+  reset();
+  VL53LX_hist_gen3_dmax_private_data_t ref_data{}, memo_data{};
+  for (Frame &frame : frames) {
+    for (int p = 0; p < VL53LX_MAX_AMBIENT_DMAX_VALUES; p++) {
+      const uint16_t reflectance = frame.cfg.target_reflectance_for_dmax_calc[p];
+      int16_t ref_dmax = -1, memo_dmax = -1;
+      const VL53LX_Error ref_status =
+          VL53LX_f_001_reference(reflectance, &frame.cal, &frame.cfg, &frame.bins, &ref_data, &ref_dmax);
+      const VL53LX_Error memo_status =
+          VL53LX_f_001(reflectance, &frame.cal, &frame.cfg, &frame.bins, &memo_data, cache(frame), &memo_dmax);
+      if (ref_status != memo_status || ref_dmax != memo_dmax ||
+          std::memcmp(&ref_data, &memo_data, sizeof(ref_data)) != 0) {
+        if (result.mismatches++ < 4) {
+          std::printf("  frame %zu, reflectance %u: dmax %d, expected %d\n", (size_t) (&frame - frames.data()),
+                      reflectance, memo_dmax, ref_dmax);
+        }
+        memo_data = ref_data;
+      }
+    }
+  }
+  uint64_t lookups = 0, hits = 0;
+  for (const VL53LX_dmax_cache_t &c : caches) {
+    lookups += c.lookups;
+    hits += c.hits;
+  }
+  result.hit_rate = lookups ? 100.0 * hits / lookups : 0;
+
+  int16_t dmax;
+  result.reference_ns = ns_per_call(frames.size(), [&](uint64_t f) {
+    Frame &frame = frames[f];
+    for (int p = 0; p < VL53LX_MAX_AMBIENT_DMAX_VALUES; p++) {
+      VL53LX_f_001_reference(frame.cfg.target_reflectance_for_dmax_calc[p], &frame.cal, &frame.cfg, &frame.bins,
+                             &ref_data, &dmax);
+      keep(&dmax, sizeof(dmax));
+    }
+  });
+  reset();
+  result.memo_ns = ns_per_call(frames.size(), [&](uint64_t f) {
+    Frame &frame = frames[f];
+    for (int p = 0; p < VL53LX_MAX_AMBIENT_DMAX_VALUES; p++) {
+      VL53LX_f_001(frame.cfg.target_reflectance_for_dmax_calc[p], &frame.cal, &frame.cfg, &frame.bins, &memo_data,
+                   cache(frame), &dmax);
+      keep(&dmax, sizeof(dmax));
+    }
+  });
+  return result;
+}
+
+}  // namespace
+
+int main() {
+  struct Scenario {
+    const char *name;
+    std::vector<Frame> frames;
+    bool shared;
+  };
+  // Photon noise moves a sensor's ambient events by a few counts from frame to frame
+  auto noisy = [](size_t f, size_t sensor) { return (int32_t) (300 + 200 * sensor + (f * 7919 % 23)); };
+  auto steady = [](size_t, size_t sensor) { return (int32_t) (300 + 200 * sensor); };
+  const Scenario scenarios[] = {
+      {"random inputs", random_frames(), false},
+      {"1 sensor, steady ambient", sequence(1, steady), false},
+      {"1 sensor, ambient noise", sequence(1, noisy), false},
+      {"2 sensors in turn, steady", sequence(2, steady), false},
+      {"2 sensors in turn, one cache", sequence(2, steady), true},
+  };
+  int failed = 0;
+  std::printf("%-30s %9s %11s %11s\n", "per frame of 5 calls", "hit rate", "original", "memo");
+  for (const Scenario &scenario : scenarios) {
+    const Result result = run(scenario.frames, scenario.shared);
+    std::printf("%-30s %8.1f%% %8.0f ns %8.0f ns\n", scenario.name, result.hit_rate, result.reference_ns,
+                result.memo_ns);
+    failed |= result.mismatches != 0;
+  }
+  std::printf("%zu frames each, %s\n", FRAMES, failed ? "results differ  FAILED" : "all results identical");
+  return failed;
+}
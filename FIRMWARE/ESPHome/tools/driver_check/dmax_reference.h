@@ -0,0 +1,16 @@
+#pragma once
+
+#include "vl53lx_dmax.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// The driver's VL53LX_f_001 before the dmax memo
+VL53LX_Error VL53LX_f_001_reference(uint16_t target_reflectance, VL53LX_dmax_calibration_data_t *pcal,
+                                    VL53LX_hist_gen3_dmax_config_t *pcfg, VL53LX_histogram_bin_data_t *pbins,
+                                    VL53LX_hist_gen3_dmax_private_data_t *pdata, int16_t *pambient_dmax_mm);
+
+#ifdef __cplusplus
+}
+#endif
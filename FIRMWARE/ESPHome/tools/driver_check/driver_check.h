@@ -0,0 +1,57 @@
+#pragma once
+
+// Shared pieces of the driver check programs: a reproducible input
+// generator, a wall-clock timer and the pass/fail report.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+namespace vl53l3cx_tools {
+
+// Same inputs on every run and every host
+class Lcg {
+ public:
+  explicit Lcg(uint32_t seed) : state_(seed) {}
+  uint32_t next() {
+    this->state_ = this->state_ * 1664525u + 1013904223u;
+    return this->state_;
+  }
+  uint32_t below(uint32_t n) { return (uint32_t) (((uint64_t) this->next() * n) >> 32); }
+  void fill(void *data, size_t len) {
+    auto *bytes = static_cast<uint8_t *>(data);
+    for (size_t i = 0; i < len; i++) {
+      bytes[i] = (uint8_t) (this->next() >> 24);
+    }
+  }
+
+ protected:
+  uint32_t state_;
+};
+
+// Nanoseconds per call of `body`, run `calls` times
+template<typename F> double ns_per_call(uint64_t calls, F body) {
+  const auto start = std::chrono::steady_clock::now();
+  for (uint64_t i = 0; i < calls; i++) {
+    body(i);
+  }
+  const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count() / calls;
+}
+
+// Keeps a result alive, so the optimiser cannot drop the timed calls
+inline void keep(const void *data, size_t len) {
+  static volatile uint8_t sink;
+  for (size_t i = 0; i < len; i++) {
+    sink = sink + static_cast<const uint8_t *>(data)[i];
+  }
+}
+
+inline int report(const char *what, uint64_t checked, uint64_t mismatches) {
+  std::printf("%-32s %12llu checked, %llu mismatch(es)%s\n", what, (unsigned long long) checked,
+              (unsigned long long) mismatches, mismatches ? "  FAILED" : "");
+  return mismatches != 0;
+}
+
+}  // namespace vl53l3cx_tools
@@ -0,0 +1,114 @@
+#include "host_device.h"
+
+#include <cmath>
+#include <cstring>
+
+extern "C" {
+#include "vl53lx_platform.h"
+#include "vl53lx_register_map.h"
+}
+
+namespace vl53l3cx_tools {
+
+static uint8_t registers[0x10000];
+
+static void set_frame_registers() {
+  std::memset(registers, 0, sizeof(registers));
+  registers[VL53LX_FIRMWARE__SYSTEM_STATUS] = 0x01;
+  // Fast oscillator frequency and calibration value, which the driver divides by
+  registers[0x0006] = 0xBC;
+  registers[0x0007] = 0xCC;
+  registers[0x00DE] = 0x01;
+  registers[0x00DF] = 0x30;
+  // Result block: one target pulse on a flat ambient, as tools/sensor_emu produces it
+  uint8_t *result = &registers[VL53LX_RESULT__INTERRUPT_STATUS];
+  result[0] = 0x02;
+  result[1] = 0x09;
+  result[4] = 0x20;
+  for (int i = 0; i < 24; i++) {
+    const double d = (i - 8.0) / 0.8;
+    const uint32_t count = (uint32_t) (500.0 + 4000.0 * std::exp(-0.5 * d * d));
+    uint8_t *bin = &result[6 + 3 * i];
+    bin[0] = (uint8_t) (count >> 16);
+    bin[1] = (uint8_t) (count >> 8);
+    bin[2] = (uint8_t) count;
+  }
+}
+
+bool host_device_start(VL53LX_Dev_t *dev, VL53LX_DistanceModes mode) {
+  set_frame_registers();
+  std::memset(dev, 0, sizeof(*dev));
+  VL53LX_MultiRangingData_t data;
+  return VL53LX_WaitDeviceBooted(dev) == VL53LX_ERROR_NONE && VL53LX_DataInit(dev) == VL53LX_ERROR_NONE &&
+         VL53LX_SetDistanceMode(dev, mode) == VL53LX_ERROR_NONE &&
+         VL53LX_SetMeasurementTimingBudgetMicroSeconds(dev, 33000) == VL53LX_ERROR_NONE &&
+         VL53LX_StartMeasurement(dev) == VL53LX_ERROR_NONE &&
+         VL53LX_GetMultiRangingData(dev, &data) == VL53LX_ERROR_NONE;
+}
+
+bool host_device_next(VL53LX_Dev_t *dev) {
+  VL53LX_MultiRangingData_t data;
+  return VL53LX_ClearInterruptAndStartMeasurement(dev) == VL53LX_ERROR_NONE &&
+         VL53LX_GetMultiRangingData(dev, &data) == VL53LX_ERROR_NONE;
+}
+
+}  // namespace vl53l3cx_tools
+
+// The platform layer of the driver, on the register file
+
+using vl53l3cx_tools::registers;
+
+extern "C" {
+
+VL53LX_Error VL53LX_ReadMulti(VL53LX_DEV, uint16_t index, uint8_t *data, uint32_t count) {
+  for (uint32_t i = 0; i < count; i++) {
+    data[i] = registers[(uint16_t) (index + i)];
+  }
+  return VL53LX_ERROR_NONE;
+}
+
+VL53LX_Error VL53LX_WriteMulti(VL53LX_DEV, uint16_t, uint8_t *, uint32_t) { return VL53LX_ERROR_NONE; }
+
+VL53LX_Error VL53LX_RdByte(VL53LX_DEV dev, uint16_t index, uint8_t *data) {
+  return VL53LX_ReadMulti(dev, index, data, 1);
+}
+
+VL53LX_Error VL53LX_RdWord(VL53LX_DEV, uint16_t index, uint16_t *data) {
+  *data = (uint16_t) (registers[index] << 8 | registers[(uint16_t) (index + 1)]);
+  return VL53LX_ERROR_NONE;
+}
+
+VL53LX_Error VL53LX_RdDWord(VL53LX_DEV, uint16_t index, uint32_t *data) {
+  *data = 0;
+  for (int i = 0; i < 4; i++) {
+    *data = *data << 8 | registers[(uint16_t) (index + i)];
+  }
+  return VL53LX_ERROR_NONE;
+}
+
+VL53LX_Error VL53LX_WrByte(VL53LX_DEV, uint16_t, uint8_t) { return VL53LX_ERROR_NONE; }
+VL53LX_Error VL53LX_WrWord(VL53LX_DEV, uint16_t, uint16_t) { return VL53LX_ERROR_NONE; }
+VL53LX_Error VL53LX_WrDWord(VL53LX_DEV, uint16_t, uint32_t) { return VL53LX_ERROR_NONE; }
+VL53LX_Error VL53LX_WaitUs(VL53LX_DEV, int32_t) { return VL53LX_ERROR_NONE; }
+VL53LX_Error VL53LX_WaitMs(VL53LX_DEV, int32_t) { return VL53LX_ERROR_NONE; }
+
+VL53LX_Error VL53LX_GetTickCount(VL53LX_DEV, uint32_t *ptime_ms) {
+  *ptime_ms = 0;
+  return VL53LX_ERROR_NONE;
+}
+
+VL53LX_Error VL53LX_GetTimerFrequency(int32_t *ptimer_freq_hz) {
+  *ptimer_freq_hz = 0;
+  return VL53LX_ERROR_NONE;
+}
+
+VL53LX_Error VL53LX_GetTimerValue(int32_t *ptimer_count) {
+  *ptimer_count = 0;
+  return VL53LX_ERROR_NONE;
+}
+
+VL53LX_Error VL53LX_WaitValueMaskEx(VL53LX_DEV, uint32_t, uint16_t, uint8_t, uint8_t, uint32_t) {
+  return VL53LX_ERROR_NONE;
+}
+
+}  // extern "C"
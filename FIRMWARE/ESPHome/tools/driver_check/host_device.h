@@ -0,0 +1,25 @@
+#pragma once
+
+// A VL53LX device for the checks that run the driver's post-processing:
+// the platform layer serves reads from a register file and ignores
+// writes, so the API brings the device to histogram ranging with its
+// default tuning, and GetMultiRangingData decodes one fixed frame.
+
+#include <cstdint>
+
+extern "C" {
+#include "vl53lx_api.h"
+}
+
+namespace vl53l3cx_tools {
+
+// DataInit, the distance mode and a 33 ms budget, then one frame read, so
+// LLData holds a 24-bin histogram and every post-processing config.
+// False if the API reports an error.
+bool host_device_start(VL53LX_Dev_t *dev, VL53LX_DistanceModes mode = VL53LX_DISTANCEMODE_MEDIUM);
+
+// Reads another frame. The driver moves between the two bin sequences and
+// VCSEL periods of the mode as its stream count advances.
+bool host_device_next(VL53LX_Dev_t *dev);
+
+}  // namespace vl53l3cx_tools
@@ -0,0 +1,80 @@
+// VL53LX_isqrt against the bit-by-bit loop it replaced, for every 32-bit
+// input, and the time per call of both.
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "driver_check.h"
+
+extern "C" {
+#include "vl53lx_core_support.h"
+}
+
+using namespace vl53l3cx_tools;
+
+namespace {
+
+// The driver's original VL53LX_isqrt
+__attribute__((noinline)) uint32_t isqrt_reference(uint32_t num) {
+  uint32_t res = 0;
+  uint32_t bit = 1 << 30;
+
+  while (bit > num)
+    bit >>= 2;
+
+  while (bit != 0) {
+    if (num >= res + bit) {
+      num -= res + bit;
+      res = (res >> 1) + bit;
+    } else {
+      res >>= 1;
+    }
+    bit >>= 2;
+  }
+  return res;
+}
+
+uint64_t exhaustive() {
+  const unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+  std::atomic<uint64_t> mismatches{0};
+  std::vector<std::thread> workers;
+  for (unsigned t = 0; t < threads; t++) {
+    workers.emplace_back([t, threads, &mismatches] {
+      uint64_t local = 0;
+      for (uint64_t num = t; num <= UINT32_MAX; num += threads) {
+        if (VL53LX_isqrt((uint32_t) num) != isqrt_reference((uint32_t) num)) {
+          if (local++ < 4) {
+            std::printf("  isqrt(%llu): %u, expected %u\n", (unsigned long long) num, VL53LX_isqrt((uint32_t) num),
+                        isqrt_reference((uint32_t) num));
+          }
+        }
+      }
+      mismatches += local;
+    });
+  }
+  for (auto &worker : workers) {
+    worker.join();
+  }
+  return mismatches;
+}
+
+// Inputs spread over every magnitude, as the driver's variances and event counts are
+template<typename F> double bench(F isqrt) {
+  constexpr uint64_t CALLS = 50000000;
+  Lcg rng(12345);
+  uint32_t sum = 0;
+  const double ns = ns_per_call(CALLS, [&](uint64_t i) { sum += isqrt(rng.next() >> (i & 31)); });
+  keep(&sum, sizeof(sum));
+  return ns;
+}
+
+}  // namespace
+
+int main() {
+  const int failed = report("VL53LX_isqrt, all inputs", 1ull << 32, exhaustive());
+  std::printf("time per call: original %.2f ns, VL53LX_isqrt %.2f ns\n", bench(isqrt_reference),
+              bench(VL53LX_isqrt));
+  return failed;
+}
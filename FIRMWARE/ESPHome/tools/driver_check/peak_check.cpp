@@ -0,0 +1,241 @@
+// The GAUSSIAN peak estimator against ST's FILTER estimator, through
+// VL53LX_f_025 on the host device's medium mode frame. Gaussian pulses of
+// several widths and peak counts on a flat ambient, with Poisson noise, are
+// put at 16 sub-bin positions across one bin. For each estimator: the jitter
+// (the standard deviation of the phase at each position, as an RMS over the
+// positions), the systematic error (the peak-to-peak over the positions of
+// the mean phase less the true one), and the time per frame. The jitter is
+// compared with the Cramer-Rao bound of the pulse, for a known ambient.
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "driver_check.h"
+#include "host_device.h"
+
+extern "C" {
+#include "vl53lx_api_core.h"
+#include "vl53lx_core_support.h"
+#include "vl53lx_hist_algos_gen4.h"
+#include "vl53lx_hist_core.h"
+}
+
+using namespace vl53l3cx_tools;
+
+namespace {
+
+constexpr int POSITIONS = 16;
+constexpr int FRAMES = 8000;  // Per position
+constexpr double AMBIENT = 500;
+constexpr double FIRST = 5;  // The pulses' bin, after the ambient bins and clear of the wrap
+
+struct Inputs {
+  VL53LX_dmax_calibration_data_t dmax_cal;
+  VL53LX_hist_gen3_dmax_config_t dmax_cfg;
+  VL53LX_hist_post_process_config_t post_cfg;
+  VL53LX_histogram_bin_data_t bins;
+  VL53LX_histogram_bin_data_t xtalk;
+  uint16_t fast_osc_frequency;
+};
+
+struct State {
+  VL53LX_hist_gen3_algo_private_data_t algo;
+  VL53LX_hist_gen4_algo_filtered_data_t filtered;
+  VL53LX_hist_gen3_dmax_private_data_t dmax_algo;
+  VL53LX_dmax_cache_t dmax_cache;
+  VL53LX_range_results_t results;
+};
+
+struct Pulse {
+  double sigma;  // Bins
+  double peak;   // Counts at the centre of the pulse
+};
+
+bool device_inputs(Inputs *inputs) {
+  static VL53LX_Dev_t dev;
+  if (!host_device_start(&dev, VL53LX_DISTANCEMODE_MEDIUM))
+    return false;
+  VL53LX_LLDriverData_t *pdev = &dev.Data.LLData;
+  std::memset(inputs, 0, sizeof(*inputs));
+  VL53LX_get_dmax_calibration_data(&dev, pdev->dmax_mode, &inputs->dmax_cal);
+  inputs->dmax_cfg = pdev->dmax_cfg;
+  inputs->post_cfg = pdev->histpostprocess;
+  inputs->post_cfg.algo__crosstalk_compensation_enable = 0;
+  VL53LX_f_031(&pdev->hist_data, &inputs->bins);
+  VL53LX_init_histogram_bin_data_struct(0, inputs->bins.VL53LX_p_021, &inputs->xtalk);
+  inputs->fast_osc_frequency = inputs->bins.VL53LX_p_015;
+  return true;
+}
+
+// Zero-mean, unit-variance normal deviate
+double gauss(Lcg &rng) {
+  const double u = (rng.next() + 1.0) / 4294967297.0;
+  const double v = rng.next() / 4294967296.0;
+  return std::sqrt(-2 * std::log(u)) * std::cos(6.283185307179586 * v);
+}
+
+// Mean counts of bin `i`: the pulse integrated over the bin, on the
+// ambient. `centre` is in bins from the start of the first bin.
+double bin_mean(const Pulse &pulse, double centre, const VL53LX_histogram_bin_data_t &bins, uint8_t i) {
+  if (i < bins.number_of_ambient_bins)
+    return AMBIENT;
+  const double area = pulse.peak * pulse.sigma * std::sqrt(2 * M_PI);
+  const double lo = (i - centre) / (pulse.sigma * std::sqrt(2.0));
+  return AMBIENT + area * 0.5 * (std::erf(lo + 1 / (pulse.sigma * std::sqrt(2.0))) - std::erf(lo));
+}
+
+// The bins with Poisson noise
+void make_bins(Lcg &rng, const Pulse &pulse, double centre, VL53LX_histogram_bin_data_t *bins) {
+  for (uint8_t i = 0; i < bins->VL53LX_p_021; i++) {
+    const double mean = bin_mean(pulse, centre, *bins, i);
+    bins->bin_data[i] = (int32_t) std::max(0.0, std::lround(mean + std::sqrt(mean) * gauss(rng)) + 0.0);
+  }
+}
+
+// Cramer-Rao bound of the centre in phase units, as an RMS over the positions
+double cramer_rao(const VL53LX_histogram_bin_data_t &bins, const Pulse &pulse, double first) {
+  double var_sum = 0;
+  for (int p = 0; p < POSITIONS; p++) {
+    const double centre = first + (p + 0.5) / POSITIONS;
+    double information = 0;
+    for (uint8_t i = bins.number_of_ambient_bins; i < bins.VL53LX_p_021; i++) {
+      const double slope = (bin_mean(pulse, centre + 1e-4, bins, i) - bin_mean(pulse, centre - 1e-4, bins, i)) / 2e-4;
+      information += slope * slope / bin_mean(pulse, centre, bins, i);
+    }
+    var_sum += 1 / information;
+  }
+  return std::sqrt(var_sum / POSITIONS) * 2048;
+}
+
+struct Outcome {
+  double jitter;    // Phase units, 2048 per bin
+  double bias;      // Peak-to-peak, phase units
+  double detected;  // Share of the frames with a target
+};
+
+Outcome measure(const Inputs &base, const Pulse &pulse, uint8_t estimator) {
+  Inputs inputs = base;
+  inputs.post_cfg.hist_peak_estimator = estimator;
+  static State state;
+  std::memset(&state, 0, sizeof(state));
+  Lcg rng(17);
+  double var_sum = 0, lo = 1e9, hi = -1e9;
+  int found = 0;
+  // The driver's phase starts at the first bin after the ambient bins
+  const double first = inputs.bins.number_of_ambient_bins + FIRST;
+  for (int p = 0; p < POSITIONS; p++) {
+    const double centre = first + (p + 0.5) / POSITIONS;
+    double sum = 0, sum_sq = 0;
+    int n = 0;
+    for (int f = 0; f < FRAMES; f++) {
+      VL53LX_histogram_bin_data_t bins = inputs.bins;
+      VL53LX_histogram_bin_data_t xtalk = inputs.xtalk;
+      make_bins(rng, pulse, centre, &bins);
+      VL53LX_f_025(&inputs.dmax_cal, &inputs.dmax_cfg, &inputs.post_cfg, &bins, &xtalk, &state.algo, &state.filtered,
+                   &state.dmax_algo, &state.dmax_cache, &state.results, 1);
+      // The result nearest the pulse
+      double best = 1e9;
+      for (uint8_t r = 0; r < state.results.active_results; r++) {
+        const double error = state.results.VL53LX_p_003[r].VL53LX_p_011 - (centre - inputs.bins.number_of_ambient_bins) * 2048;
+        if (std::fabs(error) < std::fabs(best))
+          best = error;
+      }
+      if (std::fabs(best) > 2048)
+        continue;
+      sum += best;
+      sum_sq += best * best;
+      n++;
+    }
+    if (n < 2)
+      continue;
+    const double mean = sum / n;
+    var_sum += sum_sq / n - mean * mean;
+    lo = std::min(lo, mean);
+    hi = std::max(hi, mean);
+    found += n;
+  }
+  return {std::sqrt(var_sum / POSITIONS), hi - lo, (double) found / (POSITIONS * FRAMES)};
+}
+
+// Nanoseconds per call on 64 frames of the pulse, best of nine runs: of
+// VL53LX_f_025 with the FILTER estimator, and of the GAUSSIAN refinement
+// alone on each frame's pulse data from it
+struct Timing {
+  double pipeline;
+  double refine;
+};
+
+Timing time_per_frame(const Inputs &base, const Pulse &pulse) {
+  Inputs inputs = base;
+  inputs.post_cfg.hist_peak_estimator = VL53LX_HIST_PEAK_ESTIMATOR__FILTER;
+  Lcg rng(23);
+  std::vector<VL53LX_histogram_bin_data_t> frames(64, inputs.bins);
+  for (int f = 0; f < 64; f++) {
+    make_bins(rng, pulse, inputs.bins.number_of_ambient_bins + FIRST + f / 64.0, &frames[f]);
+  }
+  static State state;
+  std::memset(&state, 0, sizeof(state));
+  auto best_of = [](uint64_t calls, auto body) {
+    double best = 0;
+    for (int r = 0; r < 9; r++) {
+      const double ns = ns_per_call(calls, body);
+      best = r == 0 ? ns : std::min(best, ns);
+    }
+    return best;
+  };
+  Timing timing;
+  timing.pipeline = best_of(20000, [&](uint64_t f) {
+    VL53LX_histogram_bin_data_t bins = frames[f % frames.size()];
+    VL53LX_histogram_bin_data_t xtalk = inputs.xtalk;
+    VL53LX_f_025(&inputs.dmax_cal, &inputs.dmax_cfg, &inputs.post_cfg, &bins, &xtalk, &state.algo, &state.filtered,
+                 &state.dmax_algo, &state.dmax_cache, &state.results, 1);
+    keep(&state.results.active_results, sizeof(state.results.active_results));
+  });
+  // The refinement's inputs, as VL53LX_f_025 leaves them for the last pulse
+  std::vector<VL53LX_hist_gen3_algo_private_data_t> algos(frames.size());
+  for (size_t f = 0; f < frames.size(); f++) {
+    VL53LX_histogram_bin_data_t bins = frames[f];
+    VL53LX_histogram_bin_data_t xtalk = inputs.xtalk;
+    VL53LX_f_025(&inputs.dmax_cal, &inputs.dmax_cfg, &inputs.post_cfg, &bins, &xtalk, &state.algo, &state.filtered,
+                 &state.dmax_algo, &state.dmax_cache, &state.results, 1);
+    algos[f] = state.algo;
+  }
+  timing.refine = best_of(200000, [&](uint64_t f) {
+    VL53LX_hist_gen3_algo_private_data_t &algo = algos[f % algos.size()];
+    if (algo.VL53LX_p_046 == 0)
+      return;
+    const uint8_t pulse_no = algo.VL53LX_p_046 - 1;
+    VL53LX_hist_refine_peak_phase(pulse_no, VL53LX_HIST_PEAK_ESTIMATOR__GAUSSIAN, &algo.VL53LX_p_048, &algo);
+    keep(&algo.VL53LX_p_003[pulse_no].VL53LX_p_011, sizeof(algo.VL53LX_p_003[pulse_no].VL53LX_p_011));
+  });
+  return timing;
+}
+
+}  // namespace
+
+int main() {
+  static Inputs inputs;
+  if (!device_inputs(&inputs)) {
+    std::printf("device bring-up failed\n");
+    return 1;
+  }
+  // Range per bin from the driver's own phase to range conversion
+  const double mm_per_bin = VL53LX_range_maths(inputs.fast_osc_frequency, 16 * 2048, 0, 2, 0x0800, 0) / 4.0 / 16;
+  std::printf("%u bins, %u ambient bins, %.1f mm per bin, ambient %.0f counts per bin\n", inputs.bins.VL53LX_p_021,
+              inputs.bins.number_of_ambient_bins, mm_per_bin, AMBIENT);
+  const Pulse pulses[] = {{0.6, 4000}, {0.6, 300}, {0.8, 1000}, {0.8, 300}, {1.2, 300}};
+  const double to_mm = mm_per_bin / 2048;
+  std::printf("%-6s %6s | %9s %9s %9s | %9s %9s | %8s %8s | %8s %8s\n", "sigma", "peak", "bound", "jitter F",
+              "jitter G", "bias F", "bias G", "found F", "found G", "f_025", "refine");
+  for (const Pulse &pulse : pulses) {
+    const Outcome f = measure(inputs, pulse, VL53LX_HIST_PEAK_ESTIMATOR__FILTER);
+    const Outcome g = measure(inputs, pulse, VL53LX_HIST_PEAK_ESTIMATOR__GAUSSIAN);
+    const Timing t = time_per_frame(inputs, pulse);
+    const double bound = cramer_rao(inputs.bins, pulse, inputs.bins.number_of_ambient_bins + FIRST);
+    std::printf("%-6.1f %6.0f | %6.1f mm %6.1f mm %6.1f mm | %6.1f mm %6.1f mm | %7.1f%% %7.1f%% | %5.0f ns %5.0f ns\n",
+                pulse.sigma, pulse.peak, bound * to_mm, f.jitter * to_mm, g.jitter * to_mm, f.bias * to_mm,
+                g.bias * to_mm, 100 * f.detected, 100 * g.detected, t.pipeline, t.refine);
+  }
+  return 0;
+}
@@ -0,0 +1,232 @@
+// VL53LX_f_025_templated against VL53LX_f_025, on frames built from every
+// distance mode's two frame shapes plus fuzzed frames: results, the
+// algorithm, filter and dmax private data, the dmax cache and the
+// histograms they modify are compared after every frame. Then the time
+// per frame of both on each mode's frames. Needs a driver built with
+// VL53LX_HIST_TEMPLATED.
+
+#include <algorithm>
+#include <vector>
+
+#include "driver_check.h"
+#include "host_device.h"
+
+extern "C" {
+#include "vl53lx_api_core.h"
+#include "vl53lx_core_support.h"
+#include "vl53lx_hist_algos_gen4.h"
+#include "vl53lx_hist_core.h"
+#include "vl53lx_xtalk.h"
+}
+
+using namespace vl53l3cx_tools;
+
+namespace {
+
+constexpr size_t FRAMES = 200000;
+
+// One frame shape of one distance mode, as VL53LX_hist_process_data hands
+// it to the pipeline
+struct Shape {
+  const char *mode;
+  VL53LX_dmax_calibration_data_t dmax_cal;
+  VL53LX_hist_gen3_dmax_config_t dmax_cfg;
+  VL53LX_hist_post_process_config_t post_cfg;
+  VL53LX_histogram_bin_data_t bins;  // Averaged
+  VL53LX_xtalk_histogram_shape_t xtalk_shape;
+};
+
+// The state one pipeline keeps from frame to frame, as in the device data
+struct State {
+  VL53LX_hist_gen3_algo_private_data_t algo;
+  VL53LX_hist_gen4_algo_filtered_data_t filtered;
+  VL53LX_hist_gen3_dmax_private_data_t dmax_algo;
+  VL53LX_dmax_cache_t dmax_cache;
+  VL53LX_range_results_t results;
+};
+
+struct Frame {
+  VL53LX_dmax_calibration_data_t dmax_cal;
+  VL53LX_hist_gen3_dmax_config_t dmax_cfg;
+  VL53LX_hist_post_process_config_t post_cfg;
+  VL53LX_histogram_bin_data_t bins;
+  VL53LX_histogram_bin_data_t xtalk;
+  uint8_t merge;
+};
+
+uint8_t pipeline_bins(const VL53LX_histogram_bin_data_t &bins) {
+  return bins.VL53LX_p_021 - bins.number_of_ambient_bins;
+}
+
+std::vector<Shape> device_shapes() {
+  struct Mode {
+    const char *name;
+    VL53LX_DistanceModes mode;
+  };
+  const Mode modes[] = {{"short", VL53LX_DISTANCEMODE_SHORT},
+                        {"medium", VL53LX_DISTANCEMODE_MEDIUM},
+                        {"long", VL53LX_DISTANCEMODE_LONG}};
+  // A cover glass pulse: the default shape is empty
+  static const uint32_t pulse[] = {0, 0, 0, 40, 180, 420, 300, 80, 4, 0, 0, 0};
+  std::vector<Shape> shapes;
+  for (const Mode &mode : modes) {
+    static VL53LX_Dev_t dev;
+    if (!host_device_start(&dev, mode.mode))
+      return {};
+    const size_t first = shapes.size();
+    for (int frame = 0; frame < 4 && shapes.size() < first + 2; frame++) {
+      if (frame > 0 && !host_device_next(&dev))
+        return {};
+      VL53LX_LLDriverData_t *pdev = &dev.Data.LLData;
+      Shape shape{};
+      shape.mode = mode.name;
+      VL53LX_get_dmax_calibration_data(&dev, pdev->dmax_mode, &shape.dmax_cal);
+      shape.dmax_cfg = pdev->dmax_cfg;
+      shape.post_cfg = pdev->histpostprocess;
+      VL53LX_f_031(&pdev->hist_data, &shape.bins);
+      shape.xtalk_shape = pdev->xtalk_shapes.xtalk_shape;
+      for (uint8_t i = 0; i < shape.xtalk_shape.VL53LX_p_021 && i < sizeof(pulse) / sizeof(pulse[0]); i++) {
+        shape.xtalk_shape.bin_data[i] = pulse[i];
+      }
+      if (first == shapes.size() || pipeline_bins(shapes.back().bins) != pipeline_bins(shape.bins))
+        shapes.push_back(shape);
+    }
+  }
+  return shapes;
+}
+
+// Ambient and up to three targets on the shape's bins. Fuzzed frames get
+// any bin values and any bin, ambient bin and VCSEL period codes.
+Frame make_frame(Lcg &rng, const Shape &shape, bool fuzz) {
+  Frame frame;
+  frame.dmax_cal = shape.dmax_cal;
+  frame.dmax_cfg = shape.dmax_cfg;
+  frame.post_cfg = shape.post_cfg;
+  frame.bins = shape.bins;
+  frame.merge = (uint8_t) (1 + rng.below(4));
+  const uint8_t nbins = frame.bins.VL53LX_p_021;
+  const int32_t ambient = (int32_t) rng.below(6000);
+  for (uint8_t i = 0; i < nbins; i++) {
+    frame.bins.bin_data[i] = ambient + (int32_t) rng.below(1 + ambient / 8);
+  }
+  const uint32_t targets = rng.below(4);
+  for (uint32_t t = 0; t < targets; t++) {
+    const int32_t peak = (int32_t) (rng.below(4) == 0 ? rng.below(200) : rng.below(200000));
+    const uint32_t centre = frame.bins.number_of_ambient_bins + rng.below(nbins - frame.bins.number_of_ambient_bins);
+    for (uint8_t i = frame.bins.number_of_ambient_bins; i < nbins; i++) {
+      const uint32_t d = i > centre ? i - centre : centre - i;
+      frame.bins.bin_data[i] += d == 0 ? peak : d == 1 ? peak / 3 : d == 2 ? peak / 20 : 0;
+    }
+  }
+  if (fuzz) {
+    for (int32_t &bin : frame.bins.bin_data) {
+      bin = (int32_t) (rng.next() >> rng.below(32));
+    }
+    frame.bins.number_of_ambient_bins = (uint8_t) rng.below(7);
+    frame.bins.VL53LX_p_021 = (uint8_t) (8 + rng.below(VL53LX_HISTOGRAM_BUFFER_SIZE - 7));
+    frame.bins.VL53LX_p_005 = (uint8_t) (3 + 2 * rng.below(5) + (rng.below(4) == 0));
+    frame.post_cfg.sigma_thresh = (uint16_t) rng.below(0x4000);
+    frame.post_cfg.algo__consistency_check__phase_tolerance = (uint8_t) rng.below(16);
+    frame.post_cfg.noise_threshold = (uint16_t) rng.below(200);
+  }
+  frame.bins.VL53LX_p_028 = 0;
+  frame.bins.total_periods_elapsed = 500 + rng.below(2000);
+  frame.bins.result__dss_actual_effective_spads = (uint16_t) (0x800 + rng.below(0x4000));
+
+  // The crosstalk histogram VL53LX_hist_process_data builds for the frame
+  frame.post_cfg.algo__crosstalk_compensation_enable = rng.below(2);
+  frame.post_cfg.algo__crosstalk_compensation_plane_offset_kcps = rng.below(800);
+  VL53LX_xtalk_histogram_shape_t xtalk_shape = shape.xtalk_shape;
+  uint32_t xtalk_rate_kcps = 0;
+  VL53LX_init_histogram_bin_data_struct(0, xtalk_shape.VL53LX_p_021, &frame.xtalk);
+  VL53LX_copy_xtalk_bin_data_to_histogram_data_struct(&xtalk_shape, &frame.xtalk);
+  VL53LX_f_032(frame.post_cfg.algo__crosstalk_compensation_plane_offset_kcps, 0, 0, 0, 0,
+               frame.bins.result__dss_actual_effective_spads, frame.bins.roi_config__user_roi_centre_spad,
+               frame.bins.roi_config__user_roi_requested_global_xy_size, &xtalk_rate_kcps);
+  VL53LX_f_033(&frame.bins, &xtalk_shape, xtalk_rate_kcps, &frame.xtalk);
+  return frame;
+}
+
+template<typename F> VL53LX_Error run(F pipeline, Frame frame, State *state) {
+  return pipeline(&frame.dmax_cal, &frame.dmax_cfg, &frame.post_cfg, &frame.bins, &frame.xtalk, &state->algo,
+                  &state->filtered, &state->dmax_algo, &state->dmax_cache, &state->results, frame.merge);
+}
+
+struct Counts {
+  uint64_t frames{0};
+  uint64_t specialised{0};
+  uint64_t mismatches{0};
+};
+
+Counts compare(const std::vector<Shape> &shapes) {
+  Lcg rng(9);
+  static State c_state, t_state;
+  std::memset(&c_state, 0, sizeof(c_state));
+  std::memset(&t_state, 0, sizeof(t_state));
+  Counts counts;
+  for (uint64_t f = 0; f < FRAMES; f++) {
+    Frame c_frame = make_frame(rng, shapes[rng.below(shapes.size())], rng.below(8) == 0);
+    Frame t_frame = c_frame;
+    const VL53LX_Error c_status =
+        VL53LX_f_025(&c_frame.dmax_cal, &c_frame.dmax_cfg, &c_frame.post_cfg, &c_frame.bins, &c_frame.xtalk,
+                     &c_state.algo, &c_state.filtered, &c_state.dmax_algo, &c_state.dmax_cache, &c_state.results,
+                     c_frame.merge);
+    const VL53LX_Error t_status =
+        VL53LX_f_025_templated(&t_frame.dmax_cal, &t_frame.dmax_cfg, &t_frame.post_cfg, &t_frame.bins, &t_frame.xtalk,
+                               &t_state.algo, &t_state.filtered, &t_state.dmax_algo, &t_state.dmax_cache,
+                               &t_state.results, t_frame.merge);
+    counts.frames++;
+    const uint8_t slots = VL53LX_decode_vcsel_period(t_frame.bins.VL53LX_p_005);
+    counts.specialised += pipeline_bins(t_frame.bins) == slots && slots % 4 == 0 && slots >= 8 && slots <= 24;
+    if (c_status != t_status || std::memcmp(&c_state, &t_state, sizeof(c_state)) != 0 ||
+        std::memcmp(&c_frame, &t_frame, sizeof(c_frame)) != 0) {
+      if (counts.mismatches++ < 4) {
+        std::printf("  frame %llu (%u bins, %u ambient bins, %u slots): outputs differ\n", (unsigned long long) f,
+                    t_frame.bins.VL53LX_p_021, t_frame.bins.number_of_ambient_bins, slots);
+      }
+      t_state = c_state;
+    }
+  }
+  return counts;
+}
+
+}  // namespace
+
+int main() {
+  const std::vector<Shape> shapes = device_shapes();
+  if (shapes.empty()) {
+    std::printf("device bring-up failed\n");
+    return 1;
+  }
+  const Counts counts = compare(shapes);
+  const int failed = report("f_025_templated against f_025", counts.frames, counts.mismatches);
+  std::printf("%llu of them specialised, the rest on the C fallback\n", (unsigned long long) counts.specialised);
+
+  // 64 unfuzzed frames of each shape in turn, best of five runs
+  std::printf("%-8s %5s %6s %10s %12s\n", "mode", "bins", "slots", "C", "templated");
+  for (const Shape &shape : shapes) {
+    Lcg rng(21);
+    std::vector<Frame> frames;
+    while (frames.size() < 64) {
+      frames.push_back(make_frame(rng, shape, false));
+    }
+    static State state;
+    std::memset(&state, 0, sizeof(state));
+    auto time = [&](auto pipeline) {
+      double best = 0;
+      for (int r = 0; r < 5; r++) {
+        const double ns = ns_per_call(20000, [&](uint64_t f) {
+          run(pipeline, frames[f % frames.size()], &state);
+          keep(&state.results.active_results, sizeof(state.results.active_results));
+        });
+        best = r == 0 ? ns : std::min(best, ns);
+      }
+      return best;
+    };
+    const double c_ns = time(VL53LX_f_025);
+    const double t_ns = time(VL53LX_f_025_templated);
+    std::printf("%-8s %5u %6u %7.0f ns %9.0f ns\n", shape.mode, pipeline_bins(shape.bins),
+                VL53LX_decode_vcsel_period(shape.bins.VL53LX_p_005), c_ns, t_ns);
+  }
+  return failed;
+}
@@ -0,0 +1,294 @@
+// VL53LX_dynamic_xtalk_correction_corrector against the driver's original,
+// over nine 400k-frame sequences of crosstalk monitor and target results:
+// the whole device data is compared after every frame, which covers
+// HasXtalkValueChanged and the applied plane offset. Then the time per
+// frame of both on each sequence.
+
+#include <algorithm>
+#include <vector>
+
+#include "driver_check.h"
+#include "smudge_reference.h"
+
+extern "C" {
+#include "vl53lx_api_core.h"
+#include "vl53lx_core.h"
+}
+
+using namespace vl53l3cx_tools;
+
+namespace {
+
+constexpr size_t FRAMES = 400000;
+constexpr int RUNS = 11;
+
+// The results of one frame the corrector reads
+struct Frame {
+  uint8_t xmonitor_status;
+  uint32_t xmonitor_peak;  // VL53LX_p_009
+  uint32_t xmonitor_p016;
+  uint32_t xmonitor_p017;
+  uint32_t peak_duration_us;
+  uint16_t xmonitor_p004;
+  uint16_t xmonitor_ambient;
+  uint8_t active_results;
+  uint8_t range_status[VL53LX_MAX_RANGE_RESULTS];
+  int16_t median_range_mm[VL53LX_MAX_RANGE_RESULTS];
+  uint16_t ambient[VL53LX_MAX_RANGE_RESULTS];
+  uint8_t merged;  // Histograms merged so far
+  uint8_t timing;  // Which of the two bin sequences
+};
+
+struct Scenario {
+  const char *name;
+  uint32_t xmonitor_pct;  // Frames with a crosstalk monitor result
+  uint32_t merged_pct;    // Frames with the merge complete
+  uint32_t far_pct;       // Targets beyond the no-target distance
+  uint32_t step_permille;  // Frames where the smudge level steps
+  uint32_t noise;
+  uint32_t count_scale;
+  uint16_t margin;  // smudge_margin, 0 by default
+  uint8_t enabled, apply, single, user_scaler, method, hist_merge;
+};
+
+// Roughly normal, from four uniform draws
+double gauss(Lcg &rng) {
+  double sum = 0;
+  for (int i = 0; i < 4; i++) {
+    sum += rng.next() / 4294967296.0;
+  }
+  return (sum - 2.0) * 1.732;
+}
+
+double uniform(Lcg &rng) { return rng.next() / 4294967296.0; }
+
+// A crosstalk level that steps up or down now and then, with noise, and
+// targets near and beyond the no-target distance
+std::vector<Frame> sequence(const Scenario &scenario) {
+  Lcg rng(1234);
+  std::vector<Frame> frames(FRAMES);
+  double level = 1600;
+  for (size_t k = 0; k < frames.size(); k++) {
+    Frame &f = frames[k];
+    if (rng.below(1000) < scenario.step_permille)
+      level += (rng.below(10) < 7 ? 1 : -1) * (500 + 3000 * uniform(rng));
+    if (level < 0)
+      level = 200;
+    f.xmonitor_status =
+        rng.below(100) < scenario.xmonitor_pct ? VL53LX_DEVICEERROR_RANGECOMPLETE : VL53LX_DEVICEERROR_NOUPDATE;
+    const double peak = level + scenario.noise * gauss(rng);
+    f.xmonitor_peak = peak < 0 ? 0 : (uint32_t) peak;
+    f.xmonitor_p016 = (uint32_t) (scenario.count_scale * (20 + 80 * uniform(rng)));
+    f.xmonitor_p017 = (uint32_t) (scenario.count_scale * (5 + 20 * uniform(rng)));
+    f.peak_duration_us = rng.below(100) == 0 ? 0 : 5000 + rng.below(30000);
+    f.xmonitor_p004 = (uint16_t) (rng.below(100) == 0 ? 0 : 1000 + rng.below(20000));
+    f.xmonitor_ambient = (uint16_t) (rng.below(10) < 9 ? rng.below(60) : rng.below(2000));
+    f.active_results = (uint8_t) rng.below(VL53LX_MAX_RANGE_RESULTS + 1);
+    for (int i = 0; i < VL53LX_MAX_RANGE_RESULTS; i++) {
+      f.range_status[i] = rng.below(10) < 8 ? VL53LX_DEVICEERROR_RANGECOMPLETE : VL53LX_DEVICEERROR_NOUPDATE;
+      f.median_range_mm[i] = (int16_t) (rng.below(100) < scenario.far_pct ? 901 + rng.below(3000) : rng.below(900));
+      f.ambient[i] = (uint16_t) (rng.below(10) < 8 ? rng.below(100) : rng.below(65536));
+    }
+    f.merged = (uint8_t) (rng.below(100) < scenario.merged_pct ? VL53LX_BIN_REC_SIZE : rng.below(VL53LX_BIN_REC_SIZE));
+    f.timing = k & 1;
+  }
+  return frames;
+}
+
+// The corrector's configuration and calibration, from the driver's defaults
+void start(VL53LX_Dev_t *dev, const Scenario &scenario) {
+  std::memset(dev, 0, sizeof(*dev));
+  VL53LX_dynamic_xtalk_correction_data_init(dev);
+  VL53LX_LLDriverData_t *pdev = &dev->Data.LLData;
+  pdev->smudge_correct_config.smudge_corr_enabled = scenario.enabled;
+  pdev->smudge_correct_config.smudge_corr_apply_enabled = scenario.apply;
+  pdev->smudge_correct_config.smudge_corr_single_apply = scenario.single;
+  pdev->smudge_correct_config.user_scaler_set = scenario.user_scaler;
+  pdev->smudge_correct_config.scaler_calc_method = scenario.method;
+  pdev->smudge_correct_config.smudge_margin = scenario.margin;
+  pdev->tuning_parms.tp_hist_merge = scenario.hist_merge;
+  pdev->tuning_parms.tp_hist_merge_max_size = VL53LX_BIN_REC_SIZE;
+  pdev->xtalk_cfg.algo__crosstalk_compensation_plane_offset_kcps = 400;
+  pdev->xtalk_cfg.nvm_default__crosstalk_compensation_plane_offset_kcps = 380;
+  pdev->xtalk_cfg.nvm_default__crosstalk_compensation_x_plane_gradient_kcps = 12;
+  pdev->xtalk_cfg.nvm_default__crosstalk_compensation_y_plane_gradient_kcps = -7;
+  pdev->xtalk_cal.algo__crosstalk_compensation_plane_offset_kcps = 400;
+  pdev->xtalk_cal.algo__crosstalk_compensation_y_plane_gradient_kcps = -20;
+  for (int i = 0; i < VL53LX_BIN_REC_SIZE; i++) {
+    pdev->xtalk_cal.algo__xtalk_cpo_HistoMerge_kcps[i] = 70 * (i + 1);
+  }
+}
+
+void apply(VL53LX_Dev_t *dev, const Frame &f) {
+  VL53LX_LLDriverData_t *pdev = &dev->Data.LLData;
+  VL53LX_range_results_t *results = &dev->Data.llresults.range_results;
+  results->xmonitor.range_status = f.xmonitor_status;
+  results->xmonitor.VL53LX_p_009 = f.xmonitor_peak;
+  results->xmonitor.VL53LX_p_016 = f.xmonitor_p016;
+  results->xmonitor.VL53LX_p_017 = f.xmonitor_p017;
+  results->xmonitor.peak_duration_us = f.peak_duration_us;
+  results->xmonitor.VL53LX_p_004 = f.xmonitor_p004;
+  results->xmonitor.ambient_count_rate_mcps = f.xmonitor_ambient;
+  results->active_results = f.active_results;
+  for (int i = 0; i < VL53LX_MAX_RANGE_RESULTS; i++) {
+    results->VL53LX_p_003[i].range_status = f.range_status[i];
+    results->VL53LX_p_003[i].median_range_mm = f.median_range_mm[i];
+    results->VL53LX_p_003[i].ambient_count_rate_mcps = f.ambient[i];
+  }
+  // VL53LX_compute_histo_merge_nb counts the non-zero records of this timing
+  pdev->hist_data.bin_seq[0] = f.timing ? 7 : 0;
+  for (int i = 0; i < VL53LX_BIN_REC_SIZE; i++) {
+    pdev->multi_bins_rec[i][f.timing][7] = i < f.merged ? 100 : 0;
+  }
+}
+
+struct Result {
+  uint64_t mismatches{0};
+  uint64_t samples{0};  // Frames with samples accumulated
+  uint64_t applied{0};  // Frames with HasXtalkValueChanged
+  double reference_ns{0};
+  double current_ns{0};
+};
+
+Result check(const Scenario &scenario) {
+  const std::vector<Frame> frames = sequence(scenario);
+  static VL53LX_Dev_t ref_dev, cur_dev;
+  start(&ref_dev, scenario);
+  start(&cur_dev, scenario);
+  Result result;
+  for (size_t k = 0; k < frames.size(); k++) {
+    apply(&ref_dev, frames[k]);
+    apply(&cur_dev, frames[k]);
+    VL53LX_dynamic_xtalk_correction_corrector_reference(&ref_dev);
+    VL53LX_dynamic_xtalk_correction_corrector(&cur_dev);
+    // The original keeps no running mean: it is checked against the sum
+    // it stands for, then copied across for the comparison
+    auto &cur_int = cur_dev.Data.LLData.smudge_corrector_internals;
+    auto &ref_int = ref_dev.Data.LLData.smudge_corrector_internals;
+    if ((uint64_t) cur_int.accumulator_mean * cur_int.current_samples + cur_int.accumulator_remainder !=
+            cur_int.accumulator ||
+        (cur_int.current_samples > 0 ? cur_int.accumulator_remainder >= cur_int.current_samples
+                                     : cur_int.accumulator_mean != 0 || cur_int.accumulator_remainder != 0)) {
+      if (result.mismatches++ < 4)
+        std::printf("  %s, frame %zu: running mean differs from the sum\n", scenario.name, k);
+    }
+    ref_int.accumulator_mean = cur_int.accumulator_mean;
+    ref_int.accumulator_remainder = cur_int.accumulator_remainder;
+    if (std::memcmp(&ref_dev, &cur_dev, sizeof(ref_dev)) != 0) {
+      if (result.mismatches++ < 4)
+        std::printf("  %s, frame %zu: device data differs\n", scenario.name, k);
+      cur_dev = ref_dev;
+    }
+    result.applied += ref_dev.Data.llresults.range_results.smudge_corrector_data.new_xtalk_applied_flag;
+    result.samples += ref_dev.Data.LLData.smudge_corrector_internals.current_samples > 0;
+  }
+
+  // Writing the frame costs the same for all three and is subtracted. The
+  // runs of the three are interleaved, so a slow spell of the host does not
+  // fall on one of them, and the best of RUNS is kept.
+  auto run = [&](auto corrector) {
+    start(&cur_dev, scenario);
+    return ns_per_call(frames.size(), [&](uint64_t k) {
+      apply(&cur_dev, frames[k]);
+      corrector(&cur_dev);
+    });
+  };
+  double apply_ns = 0, reference_ns = 0, current_ns = 0;
+  for (int r = 0; r < RUNS; r++) {
+    const double a = run([](VL53LX_Dev_t *) { __asm__ volatile("" ::: "memory"); });
+    const double o = run(VL53LX_dynamic_xtalk_correction_corrector_reference);
+    const double c = run(VL53LX_dynamic_xtalk_correction_corrector);
+    apply_ns = r == 0 ? a : std::min(apply_ns, a);
+    reference_ns = r == 0 ? o : std::min(reference_ns, o);
+    current_ns = r == 0 ? c : std::min(current_ns, c);
+  }
+  result.reference_ns = reference_ns - apply_ns;
+  result.current_ns = current_ns - apply_ns;
+  return result;
+}
+
+// The hub's histogram accumulation restarts the merge after every frame with
+// a near target, so the corrector sees one histogram per frame. The crosstalk
+// level is steady and differs from the calibration; get_device_results()
+// sets the plane offset for the frame's merge count around the corrector, as
+// here. Returns the full merge's plane offset after the sequence, and counts
+// the frames that applied new crosstalk.
+uint32_t restarted(const Scenario &scenario, bool restart, bool reference, uint64_t *applied) {
+  static VL53LX_Dev_t dev;
+  start(&dev, scenario);
+  VL53LX_LLDriverData_t *pdev = &dev.Data.LLData;
+  uint32_t *cpo = pdev->xtalk_cal.algo__xtalk_cpo_HistoMerge_kcps;
+  Lcg rng(99);
+  *applied = 0;
+  for (size_t k = 0; k < FRAMES / 20; k++) {
+    Frame f{};
+    f.xmonitor_status = VL53LX_DEVICEERROR_RANGECOMPLETE;
+    f.merged = restart ? 1 : VL53LX_BIN_REC_SIZE;
+    // The monitor sums the histograms merged
+    const double peak = (3200 + 40 * gauss(rng)) * f.merged / VL53LX_BIN_REC_SIZE;
+    f.xmonitor_peak = (uint32_t) peak;
+    f.xmonitor_p016 = 50 * 1000 * f.merged / VL53LX_BIN_REC_SIZE;
+    f.xmonitor_p017 = 15 * 1000 * f.merged / VL53LX_BIN_REC_SIZE;
+    f.peak_duration_us = 20000;
+    f.xmonitor_p004 = 10000;
+    f.xmonitor_ambient = 20;
+    f.active_results = 1;
+    f.range_status[0] = VL53LX_DEVICEERROR_RANGECOMPLETE;
+    f.median_range_mm[0] = 500;
+    f.timing = k & 1;
+    apply(&dev, f);
+    pdev->xtalk_cfg.algo__crosstalk_compensation_plane_offset_kcps = cpo[f.merged - 1];
+    if (reference)
+      VL53LX_dynamic_xtalk_correction_corrector_reference(&dev);
+    else
+      VL53LX_dynamic_xtalk_correction_corrector(&dev);
+    pdev->xtalk_cfg.algo__crosstalk_compensation_plane_offset_kcps = cpo[0];
+    *applied += dev.Data.llresults.range_results.smudge_corrector_data.new_xtalk_applied_flag;
+    if (restart)
+      VL53LX_restart_histo_merge(&dev);
+  }
+  return cpo[VL53LX_BIN_REC_SIZE - 1];
+}
+
+}  // namespace
+
+int main() {
+  // Crosstalk monitor, merge complete and far target shares in %, smudge
+  // steps per 1000 frames, noise, count scale, margin, then the corrector
+  // config: enabled, apply, single apply, user scaler, scaler method, merge
+  const Scenario scenarios[] = {
+      {"continuous, static", 95, 95, 30, 0, 40, 1000, 0, 1, 1, 0, 0, 0, 1},
+      {"continuous, smudge steps", 95, 95, 30, 10, 40, 1000, 20, 1, 1, 0, 0, 0, 1},
+      {"continuous, empty room", 10, 95, 95, 0, 40, 1000, 0, 1, 1, 0, 0, 0, 1},
+      {"continuous, no merge", 90, 50, 50, 10, 40, 1000, 0, 1, 1, 0, 0, 1, 0},
+      {"single apply", 90, 90, 50, 10, 40, 1000, 20, 1, 1, 1, 0, 0, 1},
+      {"debug, no apply", 90, 90, 50, 10, 40, 1000, 0, 1, 0, 0, 0, 0, 1},
+      {"user scaler", 90, 90, 50, 10, 40, 1000, 0, 1, 1, 0, 1, 0, 1},
+      {"large counts", 90, 90, 50, 10, 2000, 3000000, 20, 1, 1, 0, 0, 1, 1},
+      {"disabled", 90, 90, 50, 10, 40, 1000, 0, 0, 0, 0, 0, 0, 1},
+  };
+  uint64_t checked = 0, mismatches = 0;
+  std::printf("%-26s %8s %8s %10s %10s\n", "sequence", "samples", "applied", "original", "current");
+  for (const Scenario &scenario : scenarios) {
+    const Result result = check(scenario);
+    checked += FRAMES;
+    mismatches += result.mismatches;
+    std::printf("%-26s %8llu %8llu %7.1f ns %7.1f ns\n", scenario.name, (unsigned long long) result.samples,
+                (unsigned long long) result.applied, result.reference_ns, result.current_ns);
+  }
+  const int failed = report("smudge corrector, per frame", checked, mismatches);
+
+  // Full merges against merges restarted after every frame, CONTINUOUS mode
+  const Scenario &continuous = scenarios[0];
+  uint64_t full_applied, ref_applied, cur_applied;
+  const uint32_t full = restarted(continuous, false, false, &full_applied);
+  const uint32_t ref = restarted(continuous, true, true, &ref_applied);
+  const uint32_t cur = restarted(continuous, true, false, &cur_applied);
+  std::printf("%-26s %8s %10s\n", "merge", "applied", "crosstalk");
+  std::printf("%-26s %8llu %10u\n", "full", (unsigned long long) full_applied, full);
+  std::printf("%-26s %8llu %10u\n", "restarted, original", (unsigned long long) ref_applied, ref);
+  std::printf("%-26s %8llu %10u\n", "restarted, current", (unsigned long long) cur_applied, cur);
+  // The restarted samples are noisier: within 2% of the full merges' crosstalk
+  const bool tracks = cur_applied > 0 && cur * 50 > full * 49 && cur * 50 < full * 51;
+  return report("smudge corrector, restarted merges", 1, !tracks) || failed;
+}
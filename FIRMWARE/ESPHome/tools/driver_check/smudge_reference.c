@@ -0,0 +1,617 @@
+
+// SPDX-License-Identifier: GPL-2.0+ OR BSD-3-Clause
+/******************************************************************************
+ * Copyright (c) 2020, STMicroelectronics - All Rights Reserved
+
+ This file is part of VL53LX and is dual licensed,
+ either GPL-2.0+
+ or 'BSD 3-clause "New" or "Revised" License' , at your option.
+ ******************************************************************************
+ */
+
+/*
+ * VL53LX_dynamic_xtalk_correction_corrector and the two functions it calls,
+ * as ST ships them, before the corrector sorted frames ahead of the sample
+ * maths and divided in 32 bits, for smudge_check to compare against. Only
+ * the names are changed.
+ */
+
+#include "vl53lx_platform.h"
+#include "vl53lx_ll_def.h"
+#include "vl53lx_ll_device.h"
+#include "vl53lx_core.h"
+
+#include "smudge_reference.h"
+
+#define LOG_FUNCTION_START(fmt, ...) \
+	_LOG_FUNCTION_START(VL53LX_TRACE_MODULE_CORE, fmt, ##__VA_ARGS__)
+#define LOG_FUNCTION_END(status, ...) \
+	_LOG_FUNCTION_END(VL53LX_TRACE_MODULE_CORE, status, ##__VA_ARGS__)
+#define LOG_FUNCTION_END_FMT(status, fmt, ...) \
+	_LOG_FUNCTION_END_FMT(VL53LX_TRACE_MODULE_CORE, \
+		status, fmt, ##__VA_ARGS__)
+
+
+static VL53LX_Error VL53LX_dynamic_xtalk_correction_calc_required_samples_reference(
+	VL53LX_DEV                          Dev
+	)
+{
+
+
+
+	VL53LX_Error  status = VL53LX_ERROR_NONE;
+
+	VL53LX_LLDriverData_t *pdev = VL53LXDevStructGetLLDriverHandle(Dev);
+	VL53LX_LLDriverResults_t *pres = VL53LXDevStructGetLLResultsHandle(Dev);
+	VL53LX_smudge_corrector_config_t *pconfig =
+				&(pdev->smudge_correct_config);
+	VL53LX_smudge_corrector_internals_t *pint =
+				&(pdev->smudge_corrector_internals);
+
+	VL53LX_range_results_t *presults = &(pres->range_results);
+	VL53LX_range_data_t *pxmonitor = &(presults->xmonitor);
+
+	uint32_t peak_duration_us = pxmonitor->peak_duration_us;
+
+	uint64_t temp64a;
+	uint64_t temp64z;
+
+	LOG_FUNCTION_START("");
+
+	temp64a = pxmonitor->VL53LX_p_017 +
+		pxmonitor->VL53LX_p_016;
+	if (peak_duration_us == 0)
+		peak_duration_us = 1000;
+	temp64a = do_division_u((temp64a * 1000), peak_duration_us);
+	temp64a = do_division_u((temp64a * 1000), peak_duration_us);
+
+	temp64z = pconfig->noise_margin * pxmonitor->VL53LX_p_004;
+	if (temp64z == 0)
+		temp64z = 1;
+	temp64a = temp64a * 1000 * 256;
+	temp64a = do_division_u(temp64a, temp64z);
+	temp64a = temp64a * 1000 * 256;
+	temp64a = do_division_u(temp64a, temp64z);
+
+	pint->required_samples = (uint32_t)temp64a;
+
+
+	if (pint->required_samples < 2)
+		pint->required_samples = 2;
+
+	LOG_FUNCTION_END(status);
+
+	return status;
+}
+
+static VL53LX_Error VL53LX_dynamic_xtalk_correction_calc_new_xtalk_reference(
+	VL53LX_DEV				Dev,
+	uint32_t				xtalk_offset_out,
+	VL53LX_smudge_corrector_config_t	*pconfig,
+	VL53LX_smudge_corrector_data_t		*pout,
+	uint8_t					add_smudge,
+	uint8_t					soft_update
+	)
+{
+
+
+
+	VL53LX_Error  status = VL53LX_ERROR_NONE;
+	VL53LX_LLDriverData_t *pdev = VL53LXDevStructGetLLDriverHandle(Dev);
+
+	int16_t  x_gradient_scaler;
+	int16_t  y_gradient_scaler;
+	uint32_t orig_xtalk_offset;
+	int16_t  orig_x_gradient;
+	int16_t  orig_y_gradient;
+	uint8_t  histo_merge_nb;
+	uint8_t  i;
+	int32_t  itemp32;
+	long int SmudgeFactor;
+	VL53LX_xtalk_config_t  *pX = &(pdev->xtalk_cfg);
+	VL53LX_xtalk_calibration_results_t  *pC = &(pdev->xtalk_cal);
+	uint32_t *pcpo;
+	uint32_t max, nXtalk, cXtalk;
+	uint32_t incXtalk, cval;
+
+	LOG_FUNCTION_START("");
+
+
+	if (add_smudge == 1) {
+		pout->algo__crosstalk_compensation_plane_offset_kcps =
+			(uint32_t)xtalk_offset_out +
+			(uint32_t)pconfig->smudge_margin;
+	} else {
+		pout->algo__crosstalk_compensation_plane_offset_kcps =
+			(uint32_t)xtalk_offset_out;
+	}
+
+
+	orig_xtalk_offset =
+	pX->nvm_default__crosstalk_compensation_plane_offset_kcps;
+
+	orig_x_gradient =
+		pX->nvm_default__crosstalk_compensation_x_plane_gradient_kcps;
+
+	orig_y_gradient =
+		pX->nvm_default__crosstalk_compensation_y_plane_gradient_kcps;
+
+	if (((pconfig->user_scaler_set == 0) ||
+		(pconfig->scaler_calc_method == 1)) &&
+		(pC->algo__crosstalk_compensation_plane_offset_kcps != 0)) {
+
+		VL53LX_compute_histo_merge_nb(Dev, &histo_merge_nb);
+
+		if (histo_merge_nb == 0)
+			histo_merge_nb = 1;
+		if (pdev->tuning_parms.tp_hist_merge != 1)
+			orig_xtalk_offset =
+			pC->algo__crosstalk_compensation_plane_offset_kcps;
+		else
+			orig_xtalk_offset =
+			pC->algo__xtalk_cpo_HistoMerge_kcps[histo_merge_nb-1];
+
+		orig_x_gradient =
+			pC->algo__crosstalk_compensation_x_plane_gradient_kcps;
+
+		orig_y_gradient =
+			pC->algo__crosstalk_compensation_y_plane_gradient_kcps;
+	}
+
+
+	if ((pconfig->user_scaler_set == 0) && (orig_x_gradient == 0))
+		pout->gradient_zero_flag |= 0x01;
+
+	if ((pconfig->user_scaler_set == 0) && (orig_y_gradient == 0))
+		pout->gradient_zero_flag |= 0x02;
+
+
+
+	if (orig_xtalk_offset == 0)
+		orig_xtalk_offset = 1;
+
+
+
+	if (pconfig->user_scaler_set == 1) {
+		x_gradient_scaler = pconfig->x_gradient_scaler;
+		y_gradient_scaler = pconfig->y_gradient_scaler;
+	} else {
+
+		x_gradient_scaler = (int16_t)do_division_s(
+				(((int32_t)orig_x_gradient) << 6),
+				orig_xtalk_offset);
+		pconfig->x_gradient_scaler = x_gradient_scaler;
+		y_gradient_scaler = (int16_t)do_division_s(
+				(((int32_t)orig_y_gradient) << 6),
+				orig_xtalk_offset);
+		pconfig->y_gradient_scaler = y_gradient_scaler;
+	}
+
+
+
+	if (pconfig->scaler_calc_method == 0) {
+
+
+		itemp32 = (int32_t)(
+			pout->algo__crosstalk_compensation_plane_offset_kcps *
+				x_gradient_scaler);
+		itemp32 = itemp32 >> 6;
+		if (itemp32 > 0xFFFF)
+			itemp32 = 0xFFFF;
+
+		pout->algo__crosstalk_compensation_x_plane_gradient_kcps =
+			(int16_t)itemp32;
+
+		itemp32 = (int32_t)(
+			pout->algo__crosstalk_compensation_plane_offset_kcps *
+				y_gradient_scaler);
+		itemp32 = itemp32 >> 6;
+		if (itemp32 > 0xFFFF)
+			itemp32 = 0xFFFF;
+
+		pout->algo__crosstalk_compensation_y_plane_gradient_kcps =
+			(int16_t)itemp32;
+	} else if (pconfig->scaler_calc_method == 1) {
+
+
+		itemp32 = (int32_t)(orig_xtalk_offset -
+			pout->algo__crosstalk_compensation_plane_offset_kcps);
+		itemp32 = (int32_t)(do_division_s(itemp32, 16));
+		itemp32 = itemp32 << 2;
+		itemp32 = itemp32 + (int32_t)(orig_x_gradient);
+		if (itemp32 > 0xFFFF)
+			itemp32 = 0xFFFF;
+
+		pout->algo__crosstalk_compensation_x_plane_gradient_kcps =
+			(int16_t)itemp32;
+
+		itemp32 = (int32_t)(orig_xtalk_offset -
+			pout->algo__crosstalk_compensation_plane_offset_kcps);
+		itemp32 = (int32_t)(do_division_s(itemp32, 80));
+		itemp32 = itemp32 << 2;
+		itemp32 = itemp32 + (int32_t)(orig_y_gradient);
+		if (itemp32 > 0xFFFF)
+			itemp32 = 0xFFFF;
+
+		pout->algo__crosstalk_compensation_y_plane_gradient_kcps =
+			(int16_t)itemp32;
+	}
+
+
+	if ((pconfig->smudge_corr_apply_enabled == 1) &&
+		(soft_update != 1)) {
+
+		pout->new_xtalk_applied_flag = 1;
+		nXtalk = pout->algo__crosstalk_compensation_plane_offset_kcps;
+
+		VL53LX_compute_histo_merge_nb(Dev, &histo_merge_nb);
+		max = pdev->tuning_parms.tp_hist_merge_max_size;
+		pcpo = &(pC->algo__xtalk_cpo_HistoMerge_kcps[0]);
+		if ((histo_merge_nb > 0) &&
+			(pdev->tuning_parms.tp_hist_merge == 1) &&
+			(nXtalk != 0)) {
+			cXtalk =
+			pX->algo__crosstalk_compensation_plane_offset_kcps;
+			SmudgeFactor = ((long int)(nXtalk) - (long int)(cXtalk))/512;
+			if ((max ==  0)||
+				(SmudgeFactor >= (long int)(pconfig->max_smudge_factor)))
+				pout->new_xtalk_applied_flag = 0;
+			else {
+				incXtalk = nXtalk / max;
+				cval = 0;
+				for (i = 0; i < max-1; i++) {
+					cval += incXtalk;
+					*pcpo = cval + cval/100;
+					pcpo++;
+				}
+				*pcpo = nXtalk;
+			}
+		}
+		if (pout->new_xtalk_applied_flag) {
+
+		pX->algo__crosstalk_compensation_plane_offset_kcps =
+		pout->algo__crosstalk_compensation_plane_offset_kcps;
+		pX->algo__crosstalk_compensation_x_plane_gradient_kcps =
+		pout->algo__crosstalk_compensation_x_plane_gradient_kcps;
+		pX->algo__crosstalk_compensation_y_plane_gradient_kcps =
+		pout->algo__crosstalk_compensation_y_plane_gradient_kcps;
+
+		if (pconfig->smudge_corr_single_apply == 1) {
+
+			pconfig->smudge_corr_apply_enabled = 0;
+			pconfig->smudge_corr_single_apply = 0;
+		}
+		}
+	}
+
+
+	if (soft_update != 1)
+		pout->smudge_corr_valid = 1;
+
+	LOG_FUNCTION_END(status);
+
+	return status;
+}
+
+#define CONT_CONTINUE	0
+#define CONT_NEXT_LOOP	1
+#define CONT_RESET	2
+VL53LX_Error VL53LX_dynamic_xtalk_correction_corrector_reference(
+	VL53LX_DEV                          Dev
+	)
+{
+
+
+
+	VL53LX_Error  status = VL53LX_ERROR_NONE;
+
+	VL53LX_LLDriverData_t *pdev = VL53LXDevStructGetLLDriverHandle(Dev);
+	VL53LX_LLDriverResults_t *pres = VL53LXDevStructGetLLResultsHandle(Dev);
+	VL53LX_smudge_corrector_config_t *pconfig =
+				&(pdev->smudge_correct_config);
+	VL53LX_smudge_corrector_internals_t *pint =
+				&(pdev->smudge_corrector_internals);
+	VL53LX_smudge_corrector_data_t *pout =
+			&(pres->range_results.smudge_corrector_data);
+	VL53LX_range_results_t  *pR = &(pres->range_results);
+	VL53LX_xtalk_config_t  *pX = &(pdev->xtalk_cfg);
+
+	uint8_t	run_smudge_detection = 0;
+	uint8_t merging_complete = 0;
+	uint8_t	run_nodetect = 0;
+	uint8_t ambient_check = 0;
+	int32_t itemp32 = 0;
+	uint64_t utemp64 = 0;
+	uint8_t continue_processing = CONT_CONTINUE;
+	uint32_t xtalk_offset_out = 0;
+	uint32_t xtalk_offset_in = 0;
+	uint32_t current_xtalk = 0;
+	uint32_t smudge_margin_adjusted = 0;
+	uint8_t i = 0;
+	uint8_t nodetect_index = 0;
+	uint16_t    amr;
+	uint32_t    cco;
+	uint8_t histo_merge_nb;
+
+
+	LOG_FUNCTION_START("");
+
+	VL53LX_compute_histo_merge_nb(Dev, &histo_merge_nb);
+	if ((histo_merge_nb == 0) ||
+		(pdev->tuning_parms.tp_hist_merge != 1))
+		histo_merge_nb = 1;
+
+
+	VL53LX_dynamic_xtalk_correction_output_init(pres);
+
+
+	ambient_check = (pconfig->smudge_corr_ambient_threshold == 0) ||
+		((pconfig->smudge_corr_ambient_threshold * histo_merge_nb)  >
+		((uint32_t)pR->xmonitor.ambient_count_rate_mcps));
+
+
+	merging_complete =
+		((pdev->tuning_parms.tp_hist_merge != 1) ||
+		(histo_merge_nb == pdev->tuning_parms.tp_hist_merge_max_size));
+	run_smudge_detection =
+		(pconfig->smudge_corr_enabled == 1) &&
+		ambient_check &&
+		(pR->xmonitor.range_status
+			== VL53LX_DEVICEERROR_RANGECOMPLETE) &&
+		merging_complete;
+
+
+	if ((pR->xmonitor.range_status
+		!= VL53LX_DEVICEERROR_RANGECOMPLETE) &&
+			(pconfig->smudge_corr_enabled == 1)) {
+
+		run_nodetect = 2;
+		for (i = 0; i < pR->active_results; i++) {
+			if (pR->VL53LX_p_003[i].range_status ==
+				VL53LX_DEVICEERROR_RANGECOMPLETE) {
+				if (pR->VL53LX_p_003[i].median_range_mm
+						<=
+					pconfig->nodetect_min_range_mm) {
+					run_nodetect = 0;
+				} else {
+					if (run_nodetect == 2) {
+						run_nodetect = 1;
+						nodetect_index = i;
+					}
+				}
+			}
+		}
+
+		if (run_nodetect == 2)
+
+			run_nodetect = 0;
+
+		amr =
+		pR->VL53LX_p_003[nodetect_index].ambient_count_rate_mcps;
+
+		if (run_nodetect == 1) {
+
+
+
+
+			utemp64 = 1000 * ((uint64_t)amr);
+
+
+			utemp64 = utemp64 << 9;
+
+
+			if (utemp64 < pconfig->nodetect_ambient_threshold)
+				run_nodetect = 1;
+			else
+				run_nodetect = 0;
+
+		}
+	}
+
+
+	if (run_smudge_detection) {
+
+		pint->nodetect_counter = 0;
+
+
+		VL53LX_dynamic_xtalk_correction_calc_required_samples_reference(Dev);
+
+
+		xtalk_offset_in =
+			pR->xmonitor.VL53LX_p_009;
+
+
+		cco = pX->algo__crosstalk_compensation_plane_offset_kcps;
+		current_xtalk = ((uint32_t)cco) << 2;
+
+
+		smudge_margin_adjusted =
+				((uint32_t)(pconfig->smudge_margin)) << 2;
+
+
+		itemp32 = xtalk_offset_in - current_xtalk +
+			smudge_margin_adjusted;
+
+		if (itemp32 < 0)
+			itemp32 = itemp32 * (-1);
+
+
+		if (itemp32 > ((int32_t)pconfig->single_xtalk_delta)) {
+			if ((int32_t)xtalk_offset_in >
+				((int32_t)current_xtalk -
+					(int32_t)smudge_margin_adjusted)) {
+				pout->single_xtalk_delta_flag = 1;
+			} else {
+				pout->single_xtalk_delta_flag = 2;
+			}
+		}
+
+
+		pint->current_samples = pint->current_samples + 1;
+
+
+		if (pint->current_samples > pconfig->sample_limit) {
+			pout->sample_limit_exceeded_flag = 1;
+			continue_processing = CONT_RESET;
+		} else {
+			pint->accumulator = pint->accumulator +
+				xtalk_offset_in;
+		}
+
+		if (pint->current_samples < pint->required_samples)
+			continue_processing = CONT_NEXT_LOOP;
+
+
+		xtalk_offset_out =
+		(uint32_t)(do_division_u(pint->accumulator,
+			pint->current_samples));
+
+
+		itemp32 = xtalk_offset_out - current_xtalk +
+			smudge_margin_adjusted;
+
+		if (itemp32 < 0)
+			itemp32 = itemp32 * (-1);
+
+		if (continue_processing == CONT_CONTINUE &&
+			(itemp32 >= ((int32_t)(pconfig->averaged_xtalk_delta)))
+			) {
+			if ((int32_t)xtalk_offset_out >
+				((int32_t)current_xtalk -
+					(int32_t)smudge_margin_adjusted))
+				pout->averaged_xtalk_delta_flag = 1;
+			else
+				pout->averaged_xtalk_delta_flag = 2;
+		}
+
+		if (continue_processing == CONT_CONTINUE &&
+			(itemp32 < ((int32_t)(pconfig->averaged_xtalk_delta)))
+			)
+
+			continue_processing = CONT_RESET;
+
+
+
+		pout->smudge_corr_clipped = 0;
+		if ((continue_processing == CONT_CONTINUE) &&
+			(pconfig->smudge_corr_clip_limit != 0)) {
+			if (xtalk_offset_out >
+			(pconfig->smudge_corr_clip_limit * histo_merge_nb)) {
+				pout->smudge_corr_clipped = 1;
+				continue_processing = CONT_RESET;
+			}
+		}
+
+
+
+		if (pconfig->user_xtalk_offset_limit_hi &&
+			(xtalk_offset_out >
+				pconfig->user_xtalk_offset_limit))
+			xtalk_offset_out =
+				pconfig->user_xtalk_offset_limit;
+
+
+
+		if ((pconfig->user_xtalk_offset_limit_hi == 0) &&
+			(xtalk_offset_out <
+				pconfig->user_xtalk_offset_limit))
+			xtalk_offset_out =
+				pconfig->user_xtalk_offset_limit;
+
+
+
+		xtalk_offset_out = xtalk_offset_out >> 2;
+		if (xtalk_offset_out > 0x3FFFF)
+			xtalk_offset_out = 0x3FFFF;
+
+
+		if (continue_processing == CONT_CONTINUE) {
+
+			VL53LX_dynamic_xtalk_correction_calc_new_xtalk_reference(
+				Dev,
+				xtalk_offset_out,
+				pconfig,
+				pout,
+				1,
+				0
+				);
+
+
+			continue_processing = CONT_RESET;
+		} else {
+
+			VL53LX_dynamic_xtalk_correction_calc_new_xtalk_reference(
+				Dev,
+				xtalk_offset_out,
+				pconfig,
+				pout,
+				1,
+				1
+				);
+		}
+
+
+		if (continue_processing == CONT_RESET) {
+			pint->accumulator = 0;
+			pint->current_samples = 0;
+			pint->nodetect_counter = 0;
+		}
+
+	}
+
+	continue_processing = CONT_CONTINUE;
+	if (run_nodetect == 1) {
+
+		pint->nodetect_counter += 1;
+
+
+		if (pint->nodetect_counter < pconfig->nodetect_sample_limit)
+			continue_processing = CONT_NEXT_LOOP;
+
+
+		xtalk_offset_out = (uint32_t)(pconfig->nodetect_xtalk_offset);
+
+		if (pdev->tuning_parms.tp_hist_merge == 1)
+			xtalk_offset_out = xtalk_offset_out *
+			(uint32_t)(pdev->tuning_parms.tp_hist_merge_max_size);
+
+		if (continue_processing == CONT_CONTINUE) {
+
+			VL53LX_dynamic_xtalk_correction_calc_new_xtalk_reference(
+				Dev,
+				xtalk_offset_out,
+				pconfig,
+				pout,
+				0,
+				0
+				);
+
+
+			pout->smudge_corr_valid = 2;
+
+
+			continue_processing = CONT_RESET;
+		} else {
+
+			VL53LX_dynamic_xtalk_correction_calc_new_xtalk_reference(
+				Dev,
+				xtalk_offset_out,
+				pconfig,
+				pout,
+				0,
+				1
+				);
+		}
+
+
+		if (continue_processing == CONT_RESET) {
+			pint->accumulator = 0;
+			pint->current_samples = 0;
+			pint->nodetect_counter = 0;
+		}
+	}
+
+	LOG_FUNCTION_END(status);
+
+	return status;
+}
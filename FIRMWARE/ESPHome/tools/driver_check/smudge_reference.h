@@ -0,0 +1,15 @@
+#pragma once
+
+#include "vl53lx_platform.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// The driver's VL53LX_dynamic_xtalk_correction_corrector before it sorted
+// frames ahead of the sample maths and divided in 32 bits
+VL53LX_Error VL53LX_dynamic_xtalk_correction_corrector_reference(VL53LX_DEV Dev);
+
+#ifdef __cplusplus
+}
+#endif
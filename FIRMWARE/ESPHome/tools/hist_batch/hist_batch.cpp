@@ -0,0 +1,414 @@
+#include "hist_batch.h"
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+extern "C" {
+#include "vl53lx_core_support.h"
+}
+
+namespace vl53l3cx_tools {
+
+static_assert(HistogramBatch::LANES == 8, "one lane per int32 of a 256-bit vector");
+
+// Eight int32 lanes, one per frame. Masks are all-ones or zero per lane.
+#ifdef __AVX2__
+struct Lanes {
+  __m256i v;
+
+  static Lanes load(const int32_t *p) { return {_mm256_loadu_si256((const __m256i *) p)}; }
+  static Lanes set1(int32_t x) { return {_mm256_set1_epi32(x)}; }
+  void store(int32_t *p) const { _mm256_storeu_si256((__m256i *) p, this->v); }
+
+  friend Lanes operator+(Lanes a, Lanes b) { return {_mm256_add_epi32(a.v, b.v)}; }
+  friend Lanes operator-(Lanes a, Lanes b) { return {_mm256_sub_epi32(a.v, b.v)}; }
+  friend Lanes operator*(Lanes a, Lanes b) { return {_mm256_mullo_epi32(a.v, b.v)}; }
+  friend Lanes min(Lanes a, Lanes b) { return {_mm256_min_epi32(a.v, b.v)}; }
+  friend Lanes max(Lanes a, Lanes b) { return {_mm256_max_epi32(a.v, b.v)}; }
+  friend Lanes greater(Lanes a, Lanes b) { return {_mm256_cmpgt_epi32(a.v, b.v)}; }
+  friend Lanes select(Lanes mask, Lanes a, Lanes b) { return {_mm256_blendv_epi8(b.v, a.v, mask.v)}; }
+  template<int N> Lanes shift_right() const { return {_mm256_srai_epi32(this->v, N)}; }
+
+  // Truncating division through doubles. Exact while |d| < 2^22, which
+  // covers every divisor here (repeat and sample counts). Lanes with d == 0
+  // give garbage and must be masked out by the caller.
+  friend Lanes operator/(Lanes n, Lanes d) {
+    const __m256d lo = _mm256_div_pd(_mm256_cvtepi32_pd(_mm256_castsi256_si128(n.v)),
+                                     _mm256_cvtepi32_pd(_mm256_castsi256_si128(d.v)));
+    const __m256d hi = _mm256_div_pd(_mm256_cvtepi32_pd(_mm256_extracti128_si256(n.v, 1)),
+                                     _mm256_cvtepi32_pd(_mm256_extracti128_si256(d.v, 1)));
+    return {_mm256_set_m128i(_mm256_cvttpd_epi32(hi), _mm256_cvttpd_epi32(lo))};
+  }
+
+  // VL53LX_isqrt of each lane read as uint32. floor(sqrt(double)) is exact
+  // below 2^52, as a correctly rounded root cannot reach the next integer.
+  Lanes isqrt() const {
+    const __m256d two32 = _mm256_set1_pd(4294967296.0);
+    const __m256d zero = _mm256_setzero_pd();
+    __m256d lo = _mm256_cvtepi32_pd(_mm256_castsi256_si128(this->v));
+    __m256d hi = _mm256_cvtepi32_pd(_mm256_extracti128_si256(this->v, 1));
+    lo = _mm256_add_pd(lo, _mm256_and_pd(_mm256_cmp_pd(lo, zero, _CMP_LT_OQ), two32));
+    hi = _mm256_add_pd(hi, _mm256_and_pd(_mm256_cmp_pd(hi, zero, _CMP_LT_OQ), two32));
+    return {_mm256_set_m128i(_mm256_cvttpd_epi32(_mm256_sqrt_pd(hi)), _mm256_cvttpd_epi32(_mm256_sqrt_pd(lo)))};
+  }
+};
+#else
+struct Lanes {
+  int32_t v[HistogramBatch::LANES];
+
+  template<typename F> static Lanes map(F f) {
+    Lanes r;
+    for (size_t l = 0; l < HistogramBatch::LANES; l++)
+      r.v[l] = f(l);
+    return r;
+  }
+  static Lanes load(const int32_t *p) {
+    return map([p](size_t l) { return p[l]; });
+  }
+  static Lanes set1(int32_t x) {
+    return map([x](size_t) { return x; });
+  }
+  void store(int32_t *p) const { memcpy(p, this->v, sizeof(this->v)); }
+
+  friend Lanes operator+(Lanes a, Lanes b) {
+    return map([&](size_t l) { return (int32_t) ((uint32_t) a.v[l] + (uint32_t) b.v[l]); });
+  }
+  friend Lanes operator-(Lanes a, Lanes b) {
+    return map([&](size_t l) { return (int32_t) ((uint32_t) a.v[l] - (uint32_t) b.v[l]); });
+  }
+  friend Lanes operator*(Lanes a, Lanes b) {
+    return map([&](size_t l) { return (int32_t) ((uint32_t) a.v[l] * (uint32_t) b.v[l]); });
+  }
+  friend Lanes min(Lanes a, Lanes b) {
+    return map([&](size_t l) { return std::min(a.v[l], b.v[l]); });
+  }
+  friend Lanes max(Lanes a, Lanes b) {
+    return map([&](size_t l) { return std::max(a.v[l], b.v[l]); });
+  }
+  friend Lanes greater(Lanes a, Lanes b) {
+    return map([&](size_t l) { return a.v[l] > b.v[l] ? -1 : 0; });
+  }
+  friend Lanes select(Lanes mask, Lanes a, Lanes b) {
+    return map([&](size_t l) { return mask.v[l] ? a.v[l] : b.v[l]; });
+  }
+  template<int N> Lanes shift_right() const {
+    return map([this](size_t l) { return this->v[l] >> N; });
+  }
+  friend Lanes operator/(Lanes n, Lanes d) {
+    return map([&](size_t l) { return d.v[l] != 0 ? n.v[l] / d.v[l] : 0; });
+  }
+  Lanes isqrt() const {
+    return map([this](size_t l) { return (int32_t) VL53LX_isqrt((uint32_t) this->v[l]); });
+  }
+};
+#endif
+
+void HistogramBatch::reset(const VL53LX_histogram_bin_data_t &shape, size_t capacity) {
+  this->shape_ = shape;
+  this->size_ = 0;
+  this->capacity_ = capacity;
+  this->stride_ = std::max<size_t>((capacity + LANES - 1) / LANES * LANES, LANES);
+  // Not cleared: lanes past size() are computed on but never read back
+  this->bins_.resize(VL53LX_HISTOGRAM_BUFFER_SIZE * this->stride_);
+  this->min_bin_value_.resize(this->stride_);
+  this->max_bin_value_.resize(this->stride_);
+  this->ambient_events_sum_.resize(this->stride_);
+  this->number_of_ambient_samples_.resize(this->stride_);
+  this->ambient_.resize(this->stride_);
+  this->zero_distance_phase_.resize(this->stride_);
+}
+
+bool HistogramBatch::same_shape_(const VL53LX_histogram_bin_data_t &hist) const {
+  const VL53LX_histogram_bin_data_t &s = this->shape_;
+  return hist.VL53LX_p_019 == s.VL53LX_p_019 && hist.VL53LX_p_020 == s.VL53LX_p_020 &&
+         hist.VL53LX_p_021 == s.VL53LX_p_021 && hist.number_of_ambient_bins == s.number_of_ambient_bins &&
+         hist.VL53LX_p_005 == s.VL53LX_p_005 && memcmp(hist.bin_seq, s.bin_seq, sizeof(s.bin_seq)) == 0 &&
+         memcmp(hist.bin_rep, s.bin_rep, sizeof(s.bin_rep)) == 0;
+}
+
+bool HistogramBatch::add(const VL53LX_histogram_bin_data_t &hist) {
+  if (this->size_ >= this->capacity_ || !this->same_shape_(hist))
+    return false;
+  const size_t f = this->size_++;
+  for (uint8_t b = 0; b < VL53LX_HISTOGRAM_BUFFER_SIZE; b++)
+    this->bin(b)[f] = hist.bin_data[b];
+  this->min_bin_value_[f] = hist.min_bin_value;
+  this->max_bin_value_[f] = hist.max_bin_value;
+  this->ambient_events_sum_[f] = hist.ambient_events_sum;
+  this->number_of_ambient_samples_[f] = hist.number_of_ambient_samples;
+  this->ambient_[f] = hist.VL53LX_p_028;
+  this->zero_distance_phase_[f] = hist.zero_distance_phase;
+  return true;
+}
+
+void HistogramBatch::get(size_t frame, VL53LX_histogram_bin_data_t *hist) const {
+  const VL53LX_histogram_bin_data_t &s = this->shape_;
+  hist->VL53LX_p_019 = s.VL53LX_p_019;
+  hist->VL53LX_p_020 = s.VL53LX_p_020;
+  hist->VL53LX_p_021 = s.VL53LX_p_021;
+  hist->number_of_ambient_bins = s.number_of_ambient_bins;
+  memcpy(hist->bin_seq, s.bin_seq, sizeof(s.bin_seq));
+  memcpy(hist->bin_rep, s.bin_rep, sizeof(s.bin_rep));
+  for (uint8_t b = 0; b < VL53LX_HISTOGRAM_BUFFER_SIZE; b++)
+    hist->bin_data[b] = this->bin(b)[frame];
+  hist->min_bin_value = this->min_bin_value_[frame];
+  hist->max_bin_value = this->max_bin_value_[frame];
+  hist->ambient_events_sum = this->ambient_events_sum_[frame];
+  hist->number_of_ambient_samples = (uint8_t) this->number_of_ambient_samples_[frame];
+  hist->VL53LX_p_028 = this->ambient_[frame];
+  hist->zero_distance_phase = this->zero_distance_phase_[frame];
+}
+
+void bin_average(HistogramBatch *batch) {
+  VL53LX_histogram_bin_data_t &shape = batch->shape_;
+  const size_t stride = batch->stride_;
+  uint8_t initial_index[VL53LX_MAX_BIN_SEQUENCE_CODE + 1] = {0};
+  uint8_t repeat_count[VL53LX_MAX_BIN_SEQUENCE_CODE + 1] = {0};
+  uint8_t seq[VL53LX_MAX_BIN_SEQUENCE_LENGTH];
+  uint8_t seq_length = 0;
+
+  for (uint8_t lc = 0; lc < VL53LX_MAX_BIN_SEQUENCE_LENGTH; lc++)
+    seq[lc] = VL53LX_MAX_BIN_SEQUENCE_CODE + 1;
+  for (uint8_t lc = 0; lc < VL53LX_MAX_BIN_SEQUENCE_LENGTH; lc++) {
+    const uint8_t code = shape.bin_seq[lc];
+    if (repeat_count[code] == 0) {
+      initial_index[code] = seq_length * 4;
+      seq[seq_length++] = code;
+    }
+    repeat_count[code]++;
+  }
+
+  std::vector<int32_t> &out = batch->scratch_;
+  out.resize(VL53LX_HISTOGRAM_BUFFER_SIZE * stride);
+  for (uint8_t b = 0; b < VL53LX_HISTOGRAM_BUFFER_SIZE; b++) {
+    if (b < shape.VL53LX_p_020)
+      std::fill_n(&out[b * stride], stride, 0);
+    else
+      std::copy_n(batch->bin(b), stride, &out[b * stride]);
+  }
+  for (uint8_t lc = 0; lc < VL53LX_MAX_BIN_SEQUENCE_LENGTH; lc++) {
+    const uint8_t first = initial_index[shape.bin_seq[lc]];
+    for (uint8_t i = 0; i < 4; i++) {
+      int32_t *dst = &out[(first + i) * stride];
+      const int32_t *src = batch->bin(lc * 4 + i);
+      for (size_t f = 0; f < stride; f += HistogramBatch::LANES)
+        (Lanes::load(dst + f) + Lanes::load(src + f)).store(dst + f);
+    }
+  }
+  for (uint8_t code = 0; code <= VL53LX_MAX_BIN_SEQUENCE_CODE; code++) {
+    const int32_t repeats = repeat_count[code];
+    if (repeats <= 1)
+      continue;
+    const Lanes half = Lanes::set1(repeats / 2);
+    const Lanes divisor = Lanes::set1(repeats);
+    for (uint8_t i = 0; i < 4; i++) {
+      int32_t *row = &out[(initial_index[code] + i) * stride];
+      for (size_t f = 0; f < stride; f += HistogramBatch::LANES)
+        ((Lanes::load(row + f) + half) / divisor).store(row + f);
+    }
+  }
+  batch->bins_.swap(out);
+
+  memcpy(shape.bin_seq, seq, sizeof(seq));
+  for (uint8_t lc = 0; lc < VL53LX_MAX_BIN_SEQUENCE_LENGTH; lc++)
+    shape.bin_rep[lc] = seq[lc] <= VL53LX_MAX_BIN_SEQUENCE_CODE ? repeat_count[seq[lc]] : 0;
+  shape.VL53LX_p_021 = seq_length * 4;
+  shape.number_of_ambient_bins = (repeat_count[7] > 0 || repeat_count[15] > 0) ? 4 : 0;
+}
+
+void estimate_and_remove_ambient(int32_t ambient_threshold_sigma, HistogramBatch *batch) {
+  VL53LX_histogram_bin_data_t &shape = batch->shape_;
+  const uint8_t nbins = shape.VL53LX_p_021;
+  const uint8_t nab = shape.number_of_ambient_bins;
+  const Lanes zero = Lanes::set1(0);
+  const Lanes one = Lanes::set1(1);
+
+  for (size_t f = 0; f < batch->stride_; f += HistogramBatch::LANES) {
+    Lanes lo = Lanes::load(&batch->min_bin_value_[f]);
+    Lanes hi = Lanes::load(&batch->max_bin_value_[f]);
+    if (nbins > 0) {
+      lo = hi = Lanes::load(batch->bin(0) + f);
+      for (uint8_t b = 1; b < nbins; b++) {
+        const Lanes value = Lanes::load(batch->bin(b) + f);
+        lo = min(lo, value);
+        hi = max(hi, value);
+      }
+    }
+    lo.store(&batch->min_bin_value_[f]);
+    hi.store(&batch->max_bin_value_[f]);
+
+    Lanes ambient = Lanes::load(&batch->ambient_[f]);
+    Lanes sum = zero;
+    Lanes samples = zero;
+    if (nab > 0) {
+      for (uint8_t b = 0; b < nab; b++)
+        sum = sum + Lanes::load(batch->bin(b) + f);
+      samples = Lanes::set1(nab);
+      ambient = (sum + Lanes::set1(nab / 2)) / samples;
+    } else {
+      const Lanes threshold =
+          (lo.isqrt() * Lanes::set1(ambient_threshold_sigma) + Lanes::set1(0x07)).shift_right<4>() + lo;
+      for (uint8_t b = 0; b < nbins; b++) {
+        const Lanes value = Lanes::load(batch->bin(b) + f);
+        const Lanes below = greater(threshold, value);
+        sum = sum + select(below, value, zero);
+        samples = samples - below;
+      }
+      // Frames without samples keep their previous estimate
+      const Lanes has_samples = greater(samples, zero);
+      const Lanes quotient = (sum + samples.shift_right<1>()) / select(has_samples, samples, one);
+      ambient = select(has_samples, quotient, ambient);
+    }
+    sum.store(&batch->ambient_events_sum_[f]);
+    samples.store(&batch->number_of_ambient_samples_[f]);
+    ambient.store(&batch->ambient_[f]);
+  }
+
+  // VL53LX_hist_remove_ambient_bins
+  if ((shape.bin_seq[0] & 0x07) == 0x07) {
+    uint8_t i = 0;
+    for (uint8_t lc = 0; lc < VL53LX_MAX_BIN_SEQUENCE_LENGTH; lc++) {
+      if ((shape.bin_seq[lc] & 0x07) != 0x07) {
+        shape.bin_seq[i] = shape.bin_seq[lc];
+        shape.bin_rep[i] = shape.bin_rep[lc];
+        i++;
+      }
+    }
+    for (uint8_t lc = i; lc < VL53LX_MAX_BIN_SEQUENCE_LENGTH; lc++) {
+      shape.bin_seq[lc] = VL53LX_MAX_BIN_SEQUENCE_CODE + 1;
+      shape.bin_rep[lc] = 0;
+    }
+  }
+  if (nab > 0) {
+    for (uint8_t b = nab; b < shape.VL53LX_p_020; b++)
+      std::copy_n(batch->bin(b), batch->stride_, batch->bin(b - nab));
+    shape.VL53LX_p_021 -= nab;
+    shape.number_of_ambient_bins = 0;
+  }
+}
+
+// VL53LX_f_030: whole-bin offset between the frame and the crosstalk zero-distance phases
+static int8_t xtalk_bin_offset(uint16_t frame_phase, uint32_t remapped_phase) {
+  const int32_t phase_delta = (int32_t) frame_phase - (int32_t) remapped_phase;
+  if (phase_delta > 0)
+    return (int8_t) ((phase_delta + 1024) / 2048);
+  return (int8_t) ((phase_delta - 1024) / 2048);
+}
+
+// Bin of the frame that crosstalk bin i lands on, or -1 where the C code
+// would index outside the histogram (offsets beyond a full period)
+static int16_t xtalk_bin_access(uint8_t i, int8_t offset, uint8_t nbins) {
+  int8_t access;
+  if (offset >= 0)
+    access = ((int8_t) i + offset) % (int8_t) nbins;
+  else
+    access = ((int8_t) nbins + ((int8_t) i + offset)) % (int8_t) nbins;
+  return (uint8_t) access < VL53LX_HISTOGRAM_BUFFER_SIZE ? (uint8_t) access : -1;
+}
+
+void subtract_xtalk(const VL53LX_histogram_bin_data_t &xtalk, HistogramBatch *batch, HistogramBatch *realigned) {
+  const VL53LX_histogram_bin_data_t &shape = batch->shape_;
+  const size_t stride = batch->stride_;
+  if (realigned != nullptr) {
+    // A copy of the frames with the first VL53LX_p_020 bins cleared
+    realigned->reset(shape, batch->capacity_);
+    realigned->size_ = batch->size_;
+    for (uint8_t b = 0; b < VL53LX_HISTOGRAM_BUFFER_SIZE; b++) {
+      if (b < shape.VL53LX_p_020)
+        std::fill_n(realigned->bin(b), stride, 0);
+      else
+        std::copy_n(batch->bin(b), stride, realigned->bin(b));
+    }
+    realigned->min_bin_value_ = batch->min_bin_value_;
+    realigned->max_bin_value_ = batch->max_bin_value_;
+    realigned->ambient_events_sum_ = batch->ambient_events_sum_;
+    realigned->number_of_ambient_samples_ = batch->number_of_ambient_samples_;
+    realigned->ambient_ = batch->ambient_;
+    realigned->zero_distance_phase_ = batch->zero_distance_phase_;
+  }
+
+  const uint32_t period = 2048 * (uint32_t) VL53LX_decode_vcsel_period(shape.VL53LX_p_005);
+  const uint32_t remapped_phase = period != 0 ? (uint32_t) xtalk.zero_distance_phase % period : 0;
+  const uint8_t nbins = shape.VL53LX_p_021;
+  const uint8_t min_bins = std::min(xtalk.VL53LX_p_021, nbins);
+  if (min_bins == 0)
+    return;
+
+  for (size_t f = 0; f < stride; f += HistogramBatch::LANES) {
+    int8_t offsets[HistogramBatch::LANES];
+    bool uniform = true;
+    for (size_t l = 0; l < HistogramBatch::LANES; l++) {
+      offsets[l] = xtalk_bin_offset(batch->zero_distance_phase_[f + l], remapped_phase);
+      uniform &= offsets[l] == offsets[0];
+    }
+
+    if (uniform) {
+      for (uint8_t i = 0; i < min_bins; i++) {
+        const int16_t access = xtalk_bin_access(i, offsets[0], nbins);
+        if (access < 0)
+          continue;
+        int32_t *row = batch->bin(access) + f;
+        const Lanes x = Lanes::set1(xtalk.bin_data[i]);
+        const Lanes value = Lanes::load(row);
+        select(greater(value, x), value - x, Lanes::set1(0)).store(row);
+        if (realigned != nullptr)
+          x.store(realigned->bin(access) + f);
+      }
+      continue;
+    }
+    // Frames of this block disagree on the offset: per frame
+    for (size_t l = 0; l < HistogramBatch::LANES; l++) {
+      for (uint8_t i = 0; i < min_bins; i++) {
+        const int16_t access = xtalk_bin_access(i, offsets[l], nbins);
+        if (access < 0)
+          continue;
+        int32_t &value = batch->bin(access)[f + l];
+        value = value > xtalk.bin_data[i] ? value - xtalk.bin_data[i] : 0;
+        if (realigned != nullptr)
+          realigned->bin(access)[f + l] = xtalk.bin_data[i];
+      }
+    }
+  }
+}
+
+void WindowSums::compute(uint8_t filter_woi, const HistogramBatch &batch) {
+  const uint8_t nbins = batch.shape().VL53LX_p_021;
+  const size_t stride = batch.stride();
+  this->stride_ = stride;
+  // Wider windows make the C code index before the histogram
+  if (filter_woi > nbins) {
+    for (std::vector<int32_t> *sums : {&this->a_, &this->b_, &this->c_, &this->d0_, &this->d1_})
+      sums->assign(nbins * stride, 0);
+    return;
+  }
+  for (std::vector<int32_t> *sums : {&this->a_, &this->b_, &this->c_, &this->d0_, &this->d1_})
+    sums->resize(nbins * stride);
+
+  const int32_t *window[VL53LX_HISTOGRAM_BUFFER_SIZE];
+  for (uint8_t i = 0; i < nbins; i++) {
+    const size_t row = i * stride;
+    for (uint8_t w = 0; w < (filter_woi << 1) + 1; w++)
+      window[w] = batch.bin((i + w + nbins - filter_woi) % nbins);
+    for (size_t f = 0; f < stride; f += HistogramBatch::LANES) {
+      Lanes a = Lanes::set1(0);
+      Lanes c = Lanes::set1(0);
+      for (uint8_t w = 0; w < filter_woi; w++)
+        a = a + Lanes::load(window[w] + f);
+      for (uint8_t w = filter_woi + 1; w < (filter_woi << 1) + 1; w++)
+        c = c + Lanes::load(window[w] + f);
+      const Lanes b = Lanes::load(batch.bin(i) + f);
+      const Lanes ambient = Lanes::load(&batch.ambient_[f]);
+      a.store(&this->a_[row + f]);
+      b.store(&this->b_[row + f]);
+      c.store(&this->c_[row + f]);
+      ((a + b) - (c + ambient)).store(&this->d0_[row + f]);
+      ((b + c) - (a + ambient)).store(&this->d1_[row + f]);
+    }
+  }
+}
+
+}  // namespace vl53l3cx_tools
@@ -0,0 +1,97 @@
+#pragma once
+
+// Host-only batch versions of the per-bin stages of the ST histogram
+// pipeline, for replay and tuning tools. Frames are stored structure-of-
+// arrays (bin-major, one lane per frame), so every stage runs across 8
+// frames per AVX2 instruction; without AVX2 the same kernels run as plain
+// loops. Results are identical to the scalar driver functions named on
+// each stage.
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+extern "C" {
+#include "vl53lx_hist_structs.h"
+}
+
+namespace vl53l3cx_tools {
+
+// A batch of histograms sharing one shape: bin sequence, repeat counts,
+// bin counts and VCSEL period. Replays group frames by shape first; with
+// the default presets there are two, one per alternating bin sequence.
+class HistogramBatch {
+ public:
+  static constexpr size_t LANES = 8;
+
+  // Empty batch for histograms shaped like `shape`, with room for `capacity` frames
+  void reset(const VL53LX_histogram_bin_data_t &shape, size_t capacity);
+  // Appends a frame. False when it has a different shape or the batch is full.
+  bool add(const VL53LX_histogram_bin_data_t &hist);
+  // Writes back everything the stages change: the shape, bin data and
+  // ambient statistics. Other fields of `hist` are left as they are.
+  void get(size_t frame, VL53LX_histogram_bin_data_t *hist) const;
+
+  size_t size() const { return this->size_; }
+  size_t stride() const { return this->stride_; }
+  const VL53LX_histogram_bin_data_t &shape() const { return this->shape_; }
+
+  // Row of one bin across all frames. Rows are padded to a multiple of LANES.
+  int32_t *bin(uint8_t b) { return &this->bins_[b * this->stride_]; }
+  const int32_t *bin(uint8_t b) const { return &this->bins_[b * this->stride_]; }
+
+ protected:
+  friend void bin_average(HistogramBatch *batch);
+  friend void estimate_and_remove_ambient(int32_t ambient_threshold_sigma, HistogramBatch *batch);
+  friend void subtract_xtalk(const VL53LX_histogram_bin_data_t &xtalk, HistogramBatch *batch,
+                             HistogramBatch *realigned);
+  friend class WindowSums;
+
+  bool same_shape_(const VL53LX_histogram_bin_data_t &hist) const;
+
+  VL53LX_histogram_bin_data_t shape_{};
+  size_t size_{0};
+  size_t capacity_{0};
+  size_t stride_{0};
+  std::vector<int32_t> bins_;  // VL53LX_HISTOGRAM_BUFFER_SIZE rows
+  // Per-frame fields read or written by the stages
+  std::vector<int32_t> min_bin_value_;
+  std::vector<int32_t> max_bin_value_;
+  std::vector<int32_t> ambient_events_sum_;
+  std::vector<int32_t> number_of_ambient_samples_;
+  std::vector<int32_t> ambient_;  // VL53LX_p_028
+  std::vector<uint16_t> zero_distance_phase_;
+  std::vector<int32_t> scratch_;  // bin_average output, swapped with bins_
+};
+
+// VL53LX_f_031: merge repeated bin codes and average them
+void bin_average(HistogramBatch *batch);
+
+// VL53LX_hist_estimate_and_remove_ambient: ambient estimate per frame,
+// then the ambient bins are dropped
+void estimate_and_remove_ambient(int32_t ambient_threshold_sigma, HistogramBatch *batch);
+
+// VL53LX_f_005: subtract the crosstalk histogram, realigned to each frame's
+// zero-distance phase. `realigned` (optional) receives the realigned
+// crosstalk per frame, as the gen4 stages use it.
+void subtract_xtalk(const VL53LX_histogram_bin_data_t &xtalk, HistogramBatch *batch, HistogramBatch *realigned);
+
+// VL53LX_f_022 at every bin, plus the gen4 filter differences of
+// VL53LX_f_026: d0 = (a + b) - (c + ambient), d1 = (b + c) - (a + ambient)
+class WindowSums {
+ public:
+  void compute(uint8_t filter_woi, const HistogramBatch &batch);
+
+  // Row of one bin across frames, for bins below the batch's VL53LX_p_021
+  const int32_t *a(uint8_t b) const { return &this->a_[b * this->stride_]; }
+  const int32_t *b(uint8_t b) const { return &this->b_[b * this->stride_]; }
+  const int32_t *c(uint8_t b) const { return &this->c_[b * this->stride_]; }
+  const int32_t *d0(uint8_t b) const { return &this->d0_[b * this->stride_]; }
+  const int32_t *d1(uint8_t b) const { return &this->d1_[b * this->stride_]; }
+
+ protected:
+  size_t stride_{0};
+  std::vector<int32_t> a_, b_, c_, d0_, d1_;
+};
+
+}  // namespace vl53l3cx_tools
@@ -0,0 +1,205 @@
+#include "capture.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+extern "C" {
+#include "vl53lx_platform_user_data.h"
+}
+
+namespace vl53l3cx_tools {
+
+static const char *const CAPTURE_TAG = "vl53l3cx.capture";
+
+// Drops ANSI colour sequences, which `esphome logs` writes around each line
+static std::string strip_colours(const std::string &line) {
+  std::string out;
+  out.reserve(line.size());
+  for (size_t i = 0; i < line.size(); i++) {
+    if (line[i] == '\x1b') {
+      while (i < line.size() && line[i] != 'm')
+        i++;
+      continue;
+    }
+    out += line[i];
+  }
+  return out;
+}
+
+static bool parse_hex(const std::string &hex, std::vector<uint8_t> *out) {
+  if (hex.size() % 2 != 0)
+    return false;
+  for (size_t i = 0; i < hex.size(); i += 2) {
+    char byte[3] = {hex[i], hex[i + 1], 0};
+    char *end = nullptr;
+    const unsigned long value = std::strtoul(byte, &end, 16);
+    if (end != byte + 2)
+      return false;
+    out->push_back((uint8_t) value);
+  }
+  return true;
+}
+
+namespace {
+
+// Segment being assembled from the lines of one file
+struct Parser {
+  std::vector<CaptureSegment> *segments;
+  CaptureSegment segment;
+  size_t state_size{0};
+  size_t state_filled{0};
+  bool open{false};  // Snapshot complete: frames can be added
+  CaptureFrame frame{};
+  int32_t truth_mm;
+
+  void close() {
+    if (this->open && !this->segment.frames.empty())
+      this->segments->push_back(std::move(this->segment));
+    this->segment = CaptureSegment{};
+    this->open = false;
+    this->state_size = 0;
+    this->state_filled = 0;
+    this->frame = CaptureFrame{};
+  }
+
+  // One "S" line. Offset 0 starts a new snapshot.
+  bool state(size_t size, size_t offset, const std::string &hex, const std::string &source) {
+    if (offset == 0) {
+      this->close();
+      this->segment.source = source;
+      this->segment.state.reserve(size);
+      this->state_size = size;
+    }
+    if (this->open || this->state_size != size || offset != this->state_filled) {
+      // A chunk went missing: wait for the next snapshot
+      this->close();
+      return true;
+    }
+    if (!parse_hex(hex, &this->segment.state))
+      return false;
+    this->state_filled = this->segment.state.size();
+    this->open = this->state_filled == this->state_size;
+    return true;
+  }
+
+  bool read(uint16_t index, uint16_t count, const std::string &hex) {
+    if (!this->open)
+      return true;
+    this->frame.reads.push_back({index, count, {}});
+    return parse_hex(hex, &this->frame.reads.back().data);
+  }
+
+  bool more(const std::string &hex) {
+    if (!this->open || this->frame.reads.empty())
+      return true;
+    return parse_hex(hex, &this->frame.reads.back().data);
+  }
+
+  void end(uint8_t stream_count) {
+    if (!this->open)
+      return;
+    for (const CaptureRead &read : this->frame.reads) {
+      if (read.data.size() != read.count) {
+        // Without this frame the driver state of the rest would be wrong
+        this->close();
+        return;
+      }
+    }
+    this->frame.stream_count = stream_count;
+    this->frame.truth_mm = this->truth_mm;
+    this->segment.frames.push_back(std::move(this->frame));
+    this->frame = CaptureFrame{};
+  }
+};
+
+}  // namespace
+
+bool load_capture(const std::string &path, int32_t default_truth_mm, std::vector<CaptureSegment> *segments,
+                  std::string *error) {
+  std::ifstream file(path);
+  if (!file) {
+    *error = path + ": cannot open";
+    return false;
+  }
+  Parser parser;
+  parser.segments = segments;
+  parser.truth_mm = default_truth_mm;
+  // Set by the first V line; a later one can be lost like any other line
+  bool layout_checked = false;
+
+  std::string raw;
+  for (size_t line_number = 1; std::getline(file, raw); line_number++) {
+    const std::string line = strip_colours(raw);
+    const std::string source = path + ":" + std::to_string(line_number);
+    std::istringstream in;
+    bool ok = true;
+
+    const size_t tag = line.find(std::string("[") + CAPTURE_TAG + ":");
+    if (tag == std::string::npos) {
+      std::istringstream words(line);
+      std::string key, value;
+      if (!(words >> key >> value) || key != "T")
+        continue;
+      if (value == "none") {
+        parser.truth_mm = TRUTH_ABSENT;
+      } else if (value == "?") {
+        parser.truth_mm = TRUTH_UNKNOWN;
+      } else {
+        char *end = nullptr;
+        parser.truth_mm = (int32_t) std::strtol(value.c_str(), &end, 10);
+        ok = *end == 0 && parser.truth_mm > 0;
+      }
+    } else {
+      const size_t body = line.find("]: ", tag);
+      if (body == std::string::npos)
+        continue;
+      in.str(line.substr(body + 3));
+      std::string kind, hex;
+      in >> kind;
+      if (kind == "S") {
+        size_t size = 0, offset = 0;
+        ok = bool(in >> size >> offset >> hex);
+        if (ok && offset == 0 && !layout_checked) {
+          *error = source + ": driver state without a V line, captured by firmware older than this tool";
+          return false;
+        }
+        ok = ok && parser.state(size, offset, hex, source);
+      } else if (kind == "V") {
+        unsigned version = 0;
+        size_t size = 0;
+        ok = bool(in >> version >> size);
+        if (ok && (version != VL53LX_DEVDATA_VERSION || size != sizeof(VL53LX_DevData_t))) {
+          *error = source + ": driver state layout " + std::to_string(version) + " (" + std::to_string(size) +
+                   " bytes), this build has layout " + std::to_string(VL53LX_DEVDATA_VERSION) + " (" +
+                   std::to_string(sizeof(VL53LX_DevData_t)) + " bytes)";
+          return false;
+        }
+        layout_checked = layout_checked || ok;
+      } else if (kind == "R") {
+        std::string index;
+        unsigned count = 0;
+        ok = bool(in >> index >> count >> hex) && count <= UINT16_MAX &&
+             parser.read((uint16_t) std::strtoul(index.c_str(), nullptr, 16), (uint16_t) count, hex);
+      } else if (kind == "+") {
+        ok = bool(in >> hex) && parser.more(hex);
+      } else if (kind == "F") {
+        unsigned stream_count = 0;
+        ok = bool(in >> stream_count) && stream_count <= UINT8_MAX;
+        if (ok)
+          parser.end((uint8_t) stream_count);
+      } else {
+        ok = false;
+      }
+    }
+    if (!ok) {
+      *error = source + ": cannot parse \"" + line + "\"";
+      return false;
+    }
+  }
+  parser.close();
+  return true;
+}
+
+}  // namespace vl53l3cx_tools
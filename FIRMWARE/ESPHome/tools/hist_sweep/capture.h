@@ -0,0 +1,54 @@
+#pragma once
+
+// Reader for the component's histogram_capture output: ESPHome log lines
+// tagged vl53l3cx.capture, as saved by `esphome logs`.
+//
+//   V <version> <size>           layout of the driver state that follows
+//   S <size> <offset> <hex>      driver state (VL53LX_DevData_t), in chunks
+//   R <index> <count> <hex>      one I2C read of the next frame...
+//   + <hex>                      ...continued when longer than a line
+//   F <stream_count>             end of the frame
+//
+// Ground truth is added by hand as untagged lines, applying to the frames
+// that follow: `T <mm>` (target at that distance), `T none` (nothing in the
+// field of view) or `T ?` (not scored).
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace vl53l3cx_tools {
+
+static constexpr int32_t TRUTH_UNKNOWN = -1;
+static constexpr int32_t TRUTH_ABSENT = -2;
+
+struct CaptureRead {
+  uint16_t index;
+  uint16_t count;
+  std::vector<uint8_t> data;
+};
+
+struct CaptureFrame {
+  std::vector<CaptureRead> reads;
+  uint8_t stream_count;
+  int32_t truth_mm;
+};
+
+// Frames replayable from one driver state snapshot. The component takes a
+// new snapshot after every restart and after a failed read.
+struct CaptureSegment {
+  std::string source;  // file:line of the snapshot
+  std::vector<uint8_t> state;
+  std::vector<CaptureFrame> frames;
+};
+
+// Appends the segments of one log file. `default_truth_mm` applies until
+// the first T line. Incomplete snapshots and frames with missing lines are
+// dropped together with the rest of their segment. False if the file can't
+// be read, holds a line that doesn't parse, or has driver state of another
+// VL53LX_DEVDATA_VERSION or size than this build, or none at all (firmware
+// from before the V line).
+bool load_capture(const std::string &path, int32_t default_truth_mm, std::vector<CaptureSegment> *segments,
+                  std::string *error);
+
+}  // namespace vl53l3cx_tools
@@ -0,0 +1,369 @@
+// Sweeps component options over captured frames: every combination of the
+// given values is replayed through the driver on every capture segment,
+// scored against the ground truth, and the Pareto set is printed as YAML.
+//
+//   hist_sweep [options] capture.log[@mm]...
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "capture.h"
+#include "replay.h"
+#include "score.h"
+#include "work_pool.h"
+
+using namespace vl53l3cx_tools;
+
+static void usage() {
+  std::fprintf(stderr,
+               "usage: hist_sweep [options] capture.log[@mm]...\n"
+               "  @mm                 ground truth for frames before the first T line\n"
+               "  --<option> VALUES   values to sweep, as a,b,c or start:stop:step\n"
+               "                      options:");
+  for (const ParamInfo &param : PARAMS)
+    std::fprintf(stderr, " %s", param.name);
+  std::fprintf(stderr,
+               "\n"
+               "  --threads N         worker threads (default: all cores)\n"
+               "  --tolerance MM      match tolerance (default 30)\n"
+               "  --tolerance-pct P   ...or P%% of the distance when larger (default 3)\n"
+               "  --top N             settings listed (default 20)\n"
+               "  --csv FILE          every setting and its score\n");
+}
+
+static bool parse_number(const std::string &text, double *value) {
+  char *end;
+  *value = std::strtod(text.c_str(), &end);
+  return !text.empty() && *end == '\0' && std::isfinite(*value);
+}
+
+static std::string format_value(double value) {
+  char buffer[32];
+  std::snprintf(buffer, sizeof(buffer), "%g", value);
+  return buffer;
+}
+
+static bool parse_values(const ParamInfo &param, const std::string &text, std::vector<double> *values,
+                         std::string *error) {
+  values->clear();
+  const size_t colon = text.find(':');
+  if (colon != std::string::npos) {
+    const size_t colon2 = text.find(':', colon + 1);
+    double start, stop, step;
+    if (colon2 == std::string::npos || !parse_number(text.substr(0, colon), &start) ||
+        !parse_number(text.substr(colon + 1, colon2 - colon - 1), &stop) ||
+        !parse_number(text.substr(colon2 + 1), &step) || step <= 0 || stop < start) {
+      *error = std::string("--") + param.name + ": expected start:stop:step";
+      return false;
+    }
+    // Counted rather than accumulated, so 0.1 steps land on their values
+    const long count = (long) std::floor((stop - start) / step + 1e-9) + 1;
+    for (long i = 0; i < count; i++)
+      values->push_back(start + i * step);
+  } else {
+    size_t begin = 0;
+    while (begin <= text.size()) {
+      size_t comma = text.find(',', begin);
+      if (comma == std::string::npos)
+        comma = text.size();
+      double value;
+      if (!parse_number(text.substr(begin, comma - begin), &value)) {
+        *error = std::string("--") + param.name + ": '" + text + "' is not a list of numbers";
+        return false;
+      }
+      values->push_back(value);
+      begin = comma + 1;
+    }
+  }
+  for (double value : *values) {
+    if (value < param.min || value > param.max || (param.integer && value != std::floor(value))) {
+      *error = std::string("--") + param.name + ": " + format_value(value) + " is outside " +
+               format_value(param.min) + ".." + format_value(param.max) +
+               (param.integer ? " or not an integer" : "");
+      return false;
+    }
+  }
+  std::sort(values->begin(), values->end());
+  values->erase(std::unique(values->begin(), values->end()), values->end());
+  return true;
+}
+
+static std::string format_metric(double value, const char *format) {
+  if (std::isnan(value))
+    return "-";
+  char buffer[32];
+  std::snprintf(buffer, sizeof(buffer), format, value);
+  return buffer;
+}
+
+int main(int argc, char **argv) {
+  std::array<std::vector<double>, PARAM_COUNT> axes;
+  std::vector<std::string> paths;
+  size_t threads = std::max(1u, std::thread::hardware_concurrency());
+  size_t top = 20;
+  std::string csv_path;
+  ScoreConfig config;
+  std::string error;
+
+  for (int i = 1; i < argc; i++) {
+    const std::string arg = argv[i];
+    if (arg.compare(0, 2, "--") != 0) {
+      paths.push_back(arg);
+      continue;
+    }
+    if (i + 1 >= argc) {
+      usage();
+      return 2;
+    }
+    const std::string value = argv[++i];
+    double number;
+    bool known = false;
+    for (uint8_t p = 0; p < PARAM_COUNT; p++) {
+      if (arg.compare(2, std::string::npos, PARAMS[p].name) != 0)
+        continue;
+      known = true;
+      if (!parse_values(PARAMS[p], value, &axes[p], &error)) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 2;
+      }
+    }
+    if (known)
+      continue;
+    if (arg == "--threads" && parse_number(value, &number) && number >= 1) {
+      threads = (size_t) number;
+    } else if (arg == "--tolerance" && parse_number(value, &number) && number >= 0) {
+      config.tolerance_mm = (int32_t) number;
+    } else if (arg == "--tolerance-pct" && parse_number(value, &number) && number >= 0) {
+      config.tolerance_pct = number;
+    } else if (arg == "--top" && parse_number(value, &number) && number >= 1) {
+      top = (size_t) number;
+    } else if (arg == "--csv") {
+      csv_path = value;
+    } else {
+      usage();
+      return 2;
+    }
+  }
+  if (paths.empty()) {
+    usage();
+    return 2;
+  }
+
+  // Corpus
+  std::vector<CaptureSegment> segments;
+  for (const std::string &arg : paths) {
+    std::string path = arg;
+    int32_t truth = TRUTH_UNKNOWN;
+    const size_t at = arg.rfind('@');
+    double number;
+    if (at != std::string::npos && parse_number(arg.substr(at + 1), &number) && number > 0) {
+      path = arg.substr(0, at);
+      truth = (int32_t) number;
+    }
+    if (!load_capture(path, truth, &segments, &error)) {
+      std::fprintf(stderr, "%s\n", error.c_str());
+      return 1;
+    }
+  }
+  // A frame that doesn't replay with the captured settings lost lines in
+  // the log; the driver state after it is unknown, so its segment ends there
+  {
+    Setting captured;
+    captured.fill(NAN);
+    Replayer replayer;
+    std::vector<ReplayFrame> frames;
+    for (CaptureSegment &segment : segments) {
+      if (!replayer.run(segment, captured, &frames, &error)) {
+        std::fprintf(stderr, "%s; %zu of %zu frames kept\n", error.c_str(), frames.size(), segment.frames.size());
+        segment.frames.resize(frames.size());
+      }
+    }
+    segments.erase(std::remove_if(segments.begin(), segments.end(),
+                                  [](const CaptureSegment &segment) { return segment.frames.empty(); }),
+                   segments.end());
+  }
+
+  size_t frame_count = 0, present = 0, absent = 0;
+  for (const CaptureSegment &segment : segments) {
+    frame_count += segment.frames.size();
+    for (const CaptureFrame &frame : segment.frames) {
+      present += frame.truth_mm > 0;
+      absent += frame.truth_mm == TRUTH_ABSENT;
+    }
+  }
+  std::printf("Corpus: %zu segments, %zu frames (%zu with a target, %zu without)\n", segments.size(), frame_count,
+              present, absent);
+  if (present + absent == 0) {
+    std::fprintf(stderr, "No frame has a ground truth: add T lines or give file@mm\n");
+    return 1;
+  }
+
+  // Grid: an option that isn't swept keeps its captured value (NaN)
+  std::vector<uint8_t> swept;
+  size_t setting_count = 1;
+  for (uint8_t p = 0; p < PARAM_COUNT; p++) {
+    if (axes[p].empty()) {
+      axes[p].push_back(NAN);
+    } else {
+      swept.push_back(p);
+    }
+    setting_count *= axes[p].size();
+  }
+  std::array<size_t, PARAM_COUNT> strides;
+  size_t stride = 1;
+  for (int p = PARAM_COUNT - 1; p >= 0; p--) {
+    strides[p] = stride;
+    stride *= axes[p].size();
+  }
+  std::vector<Setting> settings(setting_count);
+  for (size_t s = 0; s < setting_count; s++) {
+    for (uint8_t p = 0; p < PARAM_COUNT; p++)
+      settings[s][p] = axes[p][(s / strides[p]) % axes[p].size()];
+  }
+
+  // Replay every setting on every segment
+  const size_t task_count = setting_count * segments.size();
+  threads = std::min(threads, std::max<size_t>(1, task_count));
+  std::vector<Score> task_scores(task_count);
+  std::vector<std::string> task_errors(task_count);
+  std::vector<Replayer> replayers(threads);
+  std::vector<std::vector<ReplayFrame>> buffers(threads);
+  WorkPool pool(threads, task_count);
+  const auto start = std::chrono::steady_clock::now();
+  pool.run([&](size_t worker, size_t task) {
+    const Setting &setting = settings[task / segments.size()];
+    const CaptureSegment &segment = segments[task % segments.size()];
+    if (replayers[worker].run(segment, setting, &buffers[worker], &task_errors[task]))
+      score_segment(segment, buffers[worker], config, &task_scores[task]);
+  });
+  const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  for (const std::string &task_error : task_errors) {
+    if (!task_error.empty()) {
+      std::fprintf(stderr, "%s\n", task_error.c_str());
+      return 1;
+    }
+  }
+  size_t steals = 0;
+  for (size_t worker_steals : pool.steals())
+    steals += worker_steals;
+  std::printf("Replayed %zu settings x %zu segments on %zu threads in %.2f s (%.0f frames/s, %zu tasks stolen)\n",
+              setting_count, segments.size(), threads, seconds, setting_count * frame_count / seconds, steals);
+
+  std::vector<Score> scores(setting_count);
+  for (size_t task = 0; task < task_count; task++)
+    scores[task / segments.size()].add(task_scores[task]);
+
+  // Ranking: most detections, then the smallest error
+  std::vector<size_t> order(setting_count);
+  for (size_t s = 0; s < setting_count; s++)
+    order[s] = s;
+  auto key = [](double value, double missing) { return std::isnan(value) ? missing : value; };
+  std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    const double da = key(scores[a].detection_pct(), -1), db = key(scores[b].detection_pct(), -1);
+    if (da != db)
+      return da > db;
+    return key(scores[a].mean_error_mm(), INFINITY) < key(scores[b].mean_error_mm(), INFINITY);
+  });
+
+  std::printf("\n");
+  for (uint8_t p : swept)
+    std::printf("%-22s", PARAMS[p].name);
+  std::printf("%8s %7s %8s %8s %7s %8s\n", "detect%", "false%", "mae_mm", "jitter", "settle", "us/frame");
+  for (size_t i = 0; i < std::min(top, order.size()); i++) {
+    const Score &score = scores[order[i]];
+    for (uint8_t p : swept)
+      std::printf("%-22s", format_value(settings[order[i]][p]).c_str());
+    std::printf("%8s %7s %8s %8s %7s %8s\n", format_metric(score.detection_pct(), "%.1f").c_str(),
+                format_metric(score.false_pct(), "%.1f").c_str(), format_metric(score.mean_error_mm(), "%.1f").c_str(),
+                format_metric(score.jitter_mm(), "%.1f").c_str(),
+                format_metric(score.settle_frames_mean(), "%.1f").c_str(),
+                format_metric(score.process_us(), "%.1f").c_str());
+  }
+
+  // Options whose values never change a result, whatever the other options are
+  for (uint8_t p : swept) {
+    if (axes[p].size() < 2)
+      continue;
+    bool flat = true;
+    for (size_t s = 0; s < setting_count && flat; s++) {
+      if ((s / strides[p]) % axes[p].size() != 0)
+        continue;
+      for (size_t v = 1; v < axes[p].size() && flat; v++)
+        flat = scores[s].same_results(scores[s + v * strides[p]]);
+    }
+    if (flat)
+      std::printf("\n%s has no effect on this corpus", PARAMS[p].name);
+  }
+  std::printf("\n");
+
+  // Pareto set over distinct results; settings with the same result are
+  // reported once, with the first of them in ranking order
+  std::vector<size_t> distinct;
+  std::vector<size_t> equivalents;
+  for (size_t s : order) {
+    bool seen = false;
+    for (size_t d = 0; d < distinct.size() && !seen; d++) {
+      if (scores[distinct[d]].same_results(scores[s])) {
+        equivalents[d]++;
+        seen = true;
+      }
+    }
+    if (!seen) {
+      distinct.push_back(s);
+      equivalents.push_back(0);
+    }
+  }
+  std::printf("\nPareto set (missed, false, error, jitter, settle):\n");
+  for (size_t d = 0; d < distinct.size(); d++) {
+    const Score &score = scores[distinct[d]];
+    bool dominated = false;
+    for (size_t other : distinct)
+      dominated |= dominates(scores[other], score);
+    if (dominated)
+      continue;
+    std::printf("\n# detect %s%%, false %s%%, mae %s mm, jitter %s mm, settle %s frames",
+                format_metric(score.detection_pct(), "%.1f").c_str(), format_metric(score.false_pct(), "%.1f").c_str(),
+                format_metric(score.mean_error_mm(), "%.1f").c_str(), format_metric(score.jitter_mm(), "%.1f").c_str(),
+                format_metric(score.settle_frames_mean(), "%.1f").c_str());
+    if (equivalents[d] > 0)
+      std::printf(" (+%zu equivalent)", equivalents[d]);
+    std::printf("\n");
+    for (uint8_t p : swept)
+      std::printf("%s: %s\n", PARAMS[p].name, format_value(settings[distinct[d]][p]).c_str());
+  }
+
+  if (!csv_path.empty()) {
+    FILE *csv = std::fopen(csv_path.c_str(), "w");
+    if (csv == nullptr) {
+      std::fprintf(stderr, "%s: %s\n", csv_path.c_str(), std::strerror(errno));
+      return 1;
+    }
+    for (uint8_t p : swept)
+      std::fprintf(csv, "%s,", PARAMS[p].name);
+    std::fprintf(csv,
+                 "present_frames,detected_frames,absent_frames,false_frames,detection_pct,false_pct,mean_error_mm,"
+                 "jitter_mm,settle_frames,unsettled_runs,process_us\n");
+    for (size_t s = 0; s < setting_count; s++) {
+      const Score &score = scores[s];
+      for (uint8_t p : swept)
+        std::fprintf(csv, "%s,", format_value(settings[s][p]).c_str());
+      std::fprintf(csv, "%u,%u,%u,%u,%s,%s,%s,%s,%s,%u,%s\n", score.present_frames, score.detected_frames,
+                   score.absent_frames, score.false_frames, format_metric(score.detection_pct(), "%.2f").c_str(),
+                   format_metric(score.false_pct(), "%.2f").c_str(),
+                   format_metric(score.mean_error_mm(), "%.2f").c_str(),
+                   format_metric(score.jitter_mm(), "%.2f").c_str(),
+                   format_metric(score.settle_frames_mean(), "%.2f").c_str(), score.unsettled_runs,
+                   format_metric(score.process_us(), "%.2f").c_str());
+    }
+    std::fclose(csv);
+  }
+  return 0;
+}
@@ -0,0 +1,189 @@
+#include "replay.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+extern "C" {
+#include "vl53lx_api.h"
+#include "vl53lx_platform.h"
+}
+
+namespace vl53l3cx_tools {
+
+const ParamInfo PARAMS[PARAM_COUNT] = {
+    {"merge_threshold", 1000, 30000, true},
+    {"hist_noise_threshold", 10, 200, true},
+    {"hist_merge_max_size", 1, VL53LX_BIN_REC_SIZE, true},
+    {"sigma_threshold", 1.0, 1000.0, false},
+    {"signal_rate_limit", 0.1, 100.0, false},
+    {"peak_estimator", 0, 1, true},
+};
+
+// Reads of the frame being replayed, in the order the driver made them
+struct ReplaySource {
+  const CaptureFrame *frame;
+  size_t next;
+  bool mismatch;
+};
+
+// Same conversions as VL53L3CXComponent::initialize_device_(), so that a
+// setting means what it means in the YAML
+static VL53LX_Error apply_setting(VL53LX_DEV dev, const Setting &setting) {
+  VL53LX_Error status = VL53LX_ERROR_NONE;
+  auto set = [&](uint16_t id, int32_t value) {
+    if (status == VL53LX_ERROR_NONE)
+      status = VL53LX_SetTuningParameter(dev, id, value);
+  };
+  if (!std::isnan(setting[MERGE_THRESHOLD]))
+    set(VL53LX_TUNINGPARM_RESET_MERGE_THRESHOLD, (int32_t) setting[MERGE_THRESHOLD]);
+  if (!std::isnan(setting[HIST_NOISE_THRESHOLD]))
+    set(VL53LX_TUNINGPARM_HIST_NOISE_THRESHOLD, (int32_t) setting[HIST_NOISE_THRESHOLD]);
+  if (!std::isnan(setting[HIST_MERGE_MAX_SIZE]))
+    set(VL53LX_TUNINGPARM_HIST_MERGE_MAX_SIZE, (int32_t) setting[HIST_MERGE_MAX_SIZE]);
+  if (!std::isnan(setting[SIGMA_THRESHOLD]))
+    set(VL53LX_TUNINGPARM_HIST_SIGMA_THRESH_MM, (int32_t) std::lround((float) setting[SIGMA_THRESHOLD] * 4.0f));
+  if (!std::isnan(setting[SIGNAL_RATE_LIMIT])) {
+    uint16_t id;
+    switch (dev->Data.CurrentParameters.DistanceMode) {
+      case VL53LX_DISTANCEMODE_SHORT:
+        id = VL53LX_TUNINGPARM_LITE_SHORT_MIN_COUNT_RATE_RTN_MCPS;
+        break;
+      case VL53LX_DISTANCEMODE_LONG:
+        id = VL53LX_TUNINGPARM_LITE_LONG_MIN_COUNT_RATE_RTN_MCPS;
+        break;
+      default:
+        id = VL53LX_TUNINGPARM_LITE_MED_MIN_COUNT_RATE_RTN_MCPS;
+        break;
+    }
+    set(id, (int32_t)((float) setting[SIGNAL_RATE_LIMIT] * 65536.0f));
+  }
+  if (!std::isnan(setting[PEAK_ESTIMATOR]))
+    set(VL53LX_TUNINGPARM_HIST_PEAK_ESTIMATOR, (int32_t) setting[PEAK_ESTIMATOR]);
+  return status;
+}
+
+bool Replayer::run(const CaptureSegment &segment, const Setting &setting, std::vector<ReplayFrame> *frames,
+                   std::string *error) {
+  frames->clear();
+  if (segment.state.size() != sizeof(this->dev_.Data)) {
+    *error = segment.source + ": driver state is " + std::to_string(segment.state.size()) + " bytes, " +
+             std::to_string(sizeof(this->dev_.Data)) + " in this build";
+    return false;
+  }
+  ReplaySource source{};
+  std::memcpy(&this->dev_.Data, segment.state.data(), sizeof(this->dev_.Data));
+  this->dev_.comms_handle = &source;
+  if (apply_setting(&this->dev_, setting) != VL53LX_ERROR_NONE) {
+    *error = segment.source + ": setting rejected by the driver";
+    return false;
+  }
+
+  frames->reserve(segment.frames.size());
+  for (const CaptureFrame &frame : segment.frames) {
+    source = {&frame, 0, false};
+    VL53LX_MultiRangingData_t data;
+    const auto start = std::chrono::steady_clock::now();
+    // The component goes on after a failed read only through a retry,
+    // which the capture never contains, so statuses can be ignored here
+    VL53LX_GetMultiRangingData(&this->dev_, &data);
+    VL53LX_ClearInterruptAndStartMeasurement(&this->dev_);
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    if (source.mismatch || source.next != frame.reads.size()) {
+      *error = segment.source + ": frame " + std::to_string(frames->size()) +
+               " does not replay (driver reads differ from the capture)";
+      return false;
+    }
+
+    ReplayFrame result{};
+    result.num_targets = std::min<uint8_t>(data.NumberOfObjectsFound, VL53LX_MAX_RANGE_RESULTS);
+    for (uint8_t i = 0; i < result.num_targets; i++)
+      result.targets[i] = {data.RangeData[i].RangeMilliMeter, data.RangeData[i].RangeStatus};
+    result.process_ns = (uint32_t) std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+    frames->push_back(result);
+  }
+  this->dev_.comms_handle = nullptr;
+  return true;
+}
+
+}  // namespace vl53l3cx_tools
+
+using vl53l3cx_tools::ReplaySource;
+
+// Host platform layer for the driver. Reads must match the capture in
+// order, register and length; anything else marks the frame as diverged.
+extern "C" {
+
+VL53LX_Error VL53LX_ReadMulti(VL53LX_DEV Dev, uint16_t index, uint8_t *pdata, uint32_t count) {
+  ReplaySource *source = static_cast<ReplaySource *>(Dev->comms_handle);
+  if (source == nullptr || source->frame == nullptr || source->next >= source->frame->reads.size()) {
+    if (source != nullptr)
+      source->mismatch = true;
+    std::memset(pdata, 0, count);
+    return VL53LX_ERROR_NONE;
+  }
+  const vl53l3cx_tools::CaptureRead &read = source->frame->reads[source->next++];
+  if (read.index != index || read.count != count) {
+    source->mismatch = true;
+    std::memset(pdata, 0, count);
+    return VL53LX_ERROR_NONE;
+  }
+  std::memcpy(pdata, read.data.data(), count);
+  return VL53LX_ERROR_NONE;
+}
+
+VL53LX_Error VL53LX_WriteMulti(VL53LX_DEV Dev, uint16_t index, uint8_t *pdata, uint32_t count) {
+  return VL53LX_ERROR_NONE;
+}
+
+VL53LX_Error VL53LX_RdByte(VL53LX_DEV Dev, uint16_t index, uint8_t *pdata) {
+  return VL53LX_ReadMulti(Dev, index, pdata, 1);
+}
+
+VL53LX_Error VL53LX_WrByte(VL53LX_DEV Dev, uint16_t index, uint8_t data) { return VL53LX_ERROR_NONE; }
+
+VL53LX_Error VL53LX_RdWord(VL53LX_DEV Dev, uint16_t index, uint16_t *pdata) {
+  uint8_t buffer[2];
+  VL53LX_Error status = VL53LX_ReadMulti(Dev, index, buffer, 2);
+  *pdata = ((uint16_t) buffer[0] << 8) | buffer[1];
+  return status;
+}
+
+VL53LX_Error VL53LX_WrWord(VL53LX_DEV Dev, uint16_t index, uint16_t data) { return VL53LX_ERROR_NONE; }
+
+VL53LX_Error VL53LX_RdDWord(VL53LX_DEV Dev, uint16_t index, uint32_t *pdata) {
+  uint8_t buffer[4];
+  VL53LX_Error status = VL53LX_ReadMulti(Dev, index, buffer, 4);
+  *pdata = ((uint32_t) buffer[0] << 24) | ((uint32_t) buffer[1] << 16) | ((uint32_t) buffer[2] << 8) | buffer[3];
+  return status;
+}
+
+VL53LX_Error VL53LX_WrDWord(VL53LX_DEV Dev, uint16_t index, uint32_t data) { return VL53LX_ERROR_NONE; }
+
+VL53LX_Error VL53LX_WaitUs(VL53LX_DEV Dev, int32_t wait_us) { return VL53LX_ERROR_NONE; }
+
+VL53LX_Error VL53LX_WaitMs(VL53LX_DEV Dev, int32_t wait_ms) { return VL53LX_ERROR_NONE; }
+
+VL53LX_Error VL53LX_GetTickCount(VL53LX_DEV Dev, uint32_t *ptime_ms) {
+  *ptime_ms = 0;
+  return VL53LX_ERROR_NONE;
+}
+
+VL53LX_Error VL53LX_GetTimerFrequency(int32_t *ptimer_freq_hz) {
+  *ptimer_freq_hz = 0;
+  return VL53LX_ERROR_NONE;
+}
+
+VL53LX_Error VL53LX_GetTimerValue(int32_t *ptimer_count) {
+  *ptimer_count = 0;
+  return VL53LX_ERROR_NONE;
+}
+
+VL53LX_Error VL53LX_WaitValueMaskEx(VL53LX_DEV Dev, uint32_t timeout_ms, uint16_t index, uint8_t value, uint8_t mask,
+                                    uint32_t poll_delay_ms) {
+  // Only used while booting and calibrating, never by a replayed frame
+  return VL53LX_ERROR_TIME_OUT;
+}
+
+}  // extern "C"
@@ -0,0 +1,70 @@
+#pragma once
+
+// Replays captured frames through the ST driver on the host. The driver
+// runs unmodified, from VL53LX_GetMultiRangingData down: its I2C reads are
+// served from the capture and its writes are dropped.
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "capture.h"
+
+extern "C" {
+#include "vl53lx_platform_user_data.h"
+}
+
+namespace vl53l3cx_tools {
+
+// The component options a sweep can vary, as in the YAML
+enum Param : uint8_t {
+  MERGE_THRESHOLD,
+  HIST_NOISE_THRESHOLD,
+  HIST_MERGE_MAX_SIZE,
+  SIGMA_THRESHOLD,
+  SIGNAL_RATE_LIMIT,
+  PEAK_ESTIMATOR,  // VL53LX_HIST_PEAK_ESTIMATOR__*: 0 FILTER, 1 GAUSSIAN
+  PARAM_COUNT,
+};
+
+struct ParamInfo {
+  const char *name;
+  double min;  // Same limits as the component's schema
+  double max;
+  bool integer;
+};
+
+extern const ParamInfo PARAMS[PARAM_COUNT];
+
+// One value per option; NaN keeps the value the capture was taken with
+using Setting = std::array<double, PARAM_COUNT>;
+
+struct ReplayTarget {
+  int16_t range_mm;
+  uint8_t range_status;
+};
+
+struct ReplayFrame {
+  uint8_t num_targets;
+  std::array<ReplayTarget, VL53LX_MAX_RANGE_RESULTS> targets;
+  uint32_t process_ns;  // GetMultiRangingData and ClearInterruptAndStartMeasurement on this host
+};
+
+// Driver state of one worker. Replays on different Replayers may run
+// concurrently, as the driver keeps no state outside the device struct.
+class Replayer {
+ public:
+  // Replays a segment from its snapshot with `setting` applied the way the
+  // component applies it. One result per frame, Range1 included. False when
+  // the snapshot comes from a different driver build, or the driver asks
+  // for reads the capture doesn't have; `frames` then holds the frames
+  // before the one that failed.
+  bool run(const CaptureSegment &segment, const Setting &setting, std::vector<ReplayFrame> *frames,
+           std::string *error);
+
+ protected:
+  VL53LX_Dev_t dev_{};
+};
+
+}  // namespace vl53l3cx_tools
@@ -0,0 +1,171 @@
+#include "score.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+
+extern "C" {
+#include "vl53lx_def.h"
+}
+
+namespace vl53l3cx_tools {
+
+static const double NOT_AVAILABLE = std::numeric_limits<double>::quiet_NaN();
+
+void Score::add(const Score &other) {
+  this->present_frames += other.present_frames;
+  this->detected_frames += other.detected_frames;
+  this->absent_frames += other.absent_frames;
+  this->false_frames += other.false_frames;
+  this->abs_error_mm += other.abs_error_mm;
+  this->squared_deviation += other.squared_deviation;
+  this->deviation_dof += other.deviation_dof;
+  this->runs += other.runs;
+  this->settle_frames += other.settle_frames;
+  this->unsettled_runs += other.unsettled_runs;
+  this->process_ns += other.process_ns;
+  this->frames += other.frames;
+}
+
+double Score::detection_pct() const {
+  return this->present_frames > 0 ? 100.0 * this->detected_frames / this->present_frames : NOT_AVAILABLE;
+}
+
+double Score::false_pct() const {
+  return this->absent_frames > 0 ? 100.0 * this->false_frames / this->absent_frames : NOT_AVAILABLE;
+}
+
+double Score::mean_error_mm() const {
+  return this->detected_frames > 0 ? this->abs_error_mm / this->detected_frames : NOT_AVAILABLE;
+}
+
+double Score::jitter_mm() const {
+  return this->deviation_dof > 0 ? std::sqrt(this->squared_deviation / this->deviation_dof) : NOT_AVAILABLE;
+}
+
+double Score::settle_frames_mean() const {
+  return this->runs > 0 ? (double) this->settle_frames / this->runs : NOT_AVAILABLE;
+}
+
+double Score::process_us() const { return this->frames > 0 ? this->process_ns / 1000.0 / this->frames : NOT_AVAILABLE; }
+
+std::array<double, 5> Score::objectives() const {
+  return {100.0 - this->detection_pct(), this->false_pct(), this->mean_error_mm(), this->jitter_mm(),
+          this->settle_frames_mean()};
+}
+
+bool Score::same_results(const Score &other) const {
+  return this->present_frames == other.present_frames && this->detected_frames == other.detected_frames &&
+         this->absent_frames == other.absent_frames && this->false_frames == other.false_frames &&
+         this->abs_error_mm == other.abs_error_mm && this->squared_deviation == other.squared_deviation &&
+         this->deviation_dof == other.deviation_dof && this->runs == other.runs &&
+         this->settle_frames == other.settle_frames && this->unsettled_runs == other.unsettled_runs;
+}
+
+bool dominates(const Score &a, const Score &b) {
+  const std::array<double, 5> oa = a.objectives();
+  const std::array<double, 5> ob = b.objectives();
+  bool better = false;
+  for (size_t i = 0; i < oa.size(); i++) {
+    if (std::isnan(oa[i]) || std::isnan(ob[i]))
+      continue;
+    if (oa[i] > ob[i])
+      return false;
+    better |= oa[i] < ob[i];
+  }
+  return better;
+}
+
+static bool is_published(uint8_t range_status) {
+  return range_status == VL53LX_RANGESTATUS_RANGE_VALID || range_status == VL53LX_RANGESTATUS_RANGE_VALID_MERGED_PULSE;
+}
+
+void score_segment(const CaptureSegment &segment, const std::vector<ReplayFrame> &frames, const ScoreConfig &config,
+                   Score *score) {
+  // Current run: consecutive frames with the same distance as truth
+  int32_t run_truth = TRUTH_UNKNOWN;
+  uint32_t run_length = 0;
+  uint32_t streak = 0;
+  bool settled = false;
+  std::vector<int16_t> ranges;  // Matched ranges of the settled part (or of the streak that may settle it)
+
+  auto close_run = [&]() {
+    if (run_truth > 0 && run_length > 0) {
+      score->runs++;
+      if (!settled) {
+        score->settle_frames += run_length;
+        score->unsettled_runs++;
+      } else if (ranges.size() > 1) {
+        double mean = 0;
+        for (int16_t range : ranges)
+          mean += range;
+        mean /= ranges.size();
+        for (int16_t range : ranges)
+          score->squared_deviation += (range - mean) * (range - mean);
+        score->deviation_dof += ranges.size() - 1;
+      }
+    }
+    run_length = 0;
+    streak = 0;
+    settled = false;
+    ranges.clear();
+  };
+
+  for (size_t i = 1; i < frames.size() && i < segment.frames.size(); i++) {
+    const ReplayFrame &frame = frames[i];
+    const int32_t truth = segment.frames[i].truth_mm;
+    score->frames++;
+    score->process_ns += frame.process_ns;
+    if (truth != run_truth) {
+      close_run();
+      run_truth = truth;
+    }
+
+    if (truth == TRUTH_UNKNOWN)
+      continue;
+    if (truth == TRUTH_ABSENT) {
+      score->absent_frames++;
+      for (uint8_t t = 0; t < frame.num_targets; t++) {
+        if (is_published(frame.targets[t].range_status)) {
+          score->false_frames++;
+          break;
+        }
+      }
+      continue;
+    }
+
+    score->present_frames++;
+    run_length++;
+    const int32_t tolerance = std::max<int32_t>(config.tolerance_mm, (int32_t)(truth * config.tolerance_pct / 100.0));
+    int32_t best_error = -1;
+    int16_t best_range = 0;
+    for (uint8_t t = 0; t < frame.num_targets; t++) {
+      if (!is_published(frame.targets[t].range_status))
+        continue;
+      const int32_t error = std::abs(frame.targets[t].range_mm - truth);
+      if (error <= tolerance && (best_error < 0 || error < best_error)) {
+        best_error = error;
+        best_range = frame.targets[t].range_mm;
+      }
+    }
+
+    if (best_error < 0) {
+      streak = 0;
+      if (!settled)
+        ranges.clear();
+      continue;
+    }
+    score->detected_frames++;
+    score->abs_error_mm += best_error;
+    ranges.push_back(best_range);
+    streak++;
+    if (!settled && streak >= config.settle_frames) {
+      settled = true;
+      score->settle_frames += run_length - streak;
+    }
+  }
+  close_run();
+}
+
+}  // namespace vl53l3cx_tools
@@ -0,0 +1,63 @@
+#pragma once
+
+// Accuracy, latency and stability of replayed frames against the capture's
+// ground truth. A target counts when the component would publish it
+// (valid or merged-pulse status), and it matches the truth within
+// max(tolerance_mm, tolerance_pct of the distance).
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "capture.h"
+#include "replay.h"
+
+namespace vl53l3cx_tools {
+
+struct ScoreConfig {
+  int32_t tolerance_mm{30};
+  double tolerance_pct{3.0};
+  uint8_t settle_frames{3};  // Consecutive matches that end a settling period
+};
+
+// Sums over frames; every field adds up across segments
+struct Score {
+  uint32_t present_frames{0};  // Truth is a distance
+  uint32_t detected_frames{0};  // ...and a published target matched it
+  uint32_t absent_frames{0};  // Truth is "none"
+  uint32_t false_frames{0};  // ...and something was published anyway
+  double abs_error_mm{0};  // Of the matching target, over detected frames
+  double squared_deviation{0};  // Of matched ranges from their run mean, once settled
+  uint32_t deviation_dof{0};
+  uint32_t runs{0};  // Stretches of frames with the same distance as truth
+  uint32_t settle_frames{0};  // Frames from the start of each run to its first settled frame
+  uint32_t unsettled_runs{0};  // Runs that never settled (counted at full length above)
+  uint64_t process_ns{0};
+  uint32_t frames{0};
+
+  void add(const Score &other);
+
+  // NaN when the corpus has no frames to compute them from
+  double detection_pct() const;
+  double false_pct() const;
+  double mean_error_mm() const;
+  double jitter_mm() const;  // Standard deviation
+  double settle_frames_mean() const;
+  double process_us() const;
+
+  // Objectives to minimise for the Pareto set: missed %, false %, error,
+  // jitter and settle time. NaN objectives are ignored.
+  std::array<double, 5> objectives() const;
+  // Same frame counts and errors; host time is not compared
+  bool same_results(const Score &other) const;
+};
+
+// Scores one replayed segment. Its first frame (Range1) is skipped, as the
+// component discards it.
+void score_segment(const CaptureSegment &segment, const std::vector<ReplayFrame> &frames, const ScoreConfig &config,
+                   Score *score);
+
+// True when `a` is at least as good as `b` everywhere and better somewhere
+bool dominates(const Score &a, const Score &b);
+
+}  // namespace vl53l3cx_tools
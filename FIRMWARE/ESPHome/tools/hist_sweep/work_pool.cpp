@@ -0,0 +1,52 @@
+#include "work_pool.h"
+
+#include <thread>
+
+namespace vl53l3cx_tools {
+
+WorkPool::WorkPool(size_t workers, size_t tasks) {
+  for (size_t w = 0; w < workers; w++)
+    this->queues_.push_back(std::unique_ptr<Queue>(new Queue()));
+  for (size_t t = 0; t < tasks; t++)
+    this->queues_[t % workers]->tasks.push_back(t);
+  this->steals_.assign(workers, 0);
+}
+
+bool WorkPool::take_(size_t worker, size_t *task) {
+  {
+    Queue &own = *this->queues_[worker];
+    std::lock_guard<std::mutex> guard(own.lock);
+    if (!own.tasks.empty()) {
+      *task = own.tasks.front();
+      own.tasks.pop_front();
+      return true;
+    }
+  }
+  // Tasks never create tasks, so once every queue is empty the worker is done
+  for (size_t i = 1; i < this->queues_.size(); i++) {
+    Queue &victim = *this->queues_[(worker + i) % this->queues_.size()];
+    std::lock_guard<std::mutex> guard(victim.lock);
+    if (!victim.tasks.empty()) {
+      *task = victim.tasks.back();
+      victim.tasks.pop_back();
+      this->steals_[worker]++;
+      return true;
+    }
+  }
+  return false;
+}
+
+void WorkPool::run(const std::function<void(size_t, size_t)> &run) {
+  std::vector<std::thread> threads;
+  for (size_t w = 0; w < this->queues_.size(); w++) {
+    threads.emplace_back([this, w, &run]() {
+      size_t task;
+      while (this->take_(w, &task))
+        run(w, task);
+    });
+  }
+  for (std::thread &thread : threads)
+    thread.join();
+}
+
+}  // namespace vl53l3cx_tools
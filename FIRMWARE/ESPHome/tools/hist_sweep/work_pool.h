@@ -0,0 +1,41 @@
+#pragma once
+
+// Fixed set of independent tasks spread over worker threads. Each worker
+// takes tasks from the front of its own queue and, once that is empty,
+// steals from the back of the others, so a worker that drew long segments
+// doesn't hold up the rest.
+
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace vl53l3cx_tools {
+
+class WorkPool {
+ public:
+  // Task ids are dealt round-robin to `workers` queues
+  WorkPool(size_t workers, size_t tasks);
+
+  // Runs every task once: run(worker, task). A worker index is only ever
+  // used by one thread at a time, so per-worker state needs no locking.
+  void run(const std::function<void(size_t, size_t)> &run);
+
+  // Tasks each worker took from another worker's queue in the last run
+  const std::vector<size_t> &steals() const { return this->steals_; }
+
+ protected:
+  struct Queue {
+    std::mutex lock;
+    std::deque<size_t> tasks;
+  };
+
+  bool take_(size_t worker, size_t *task);
+
+  std::vector<std::unique_ptr<Queue>> queues_;
+  std::vector<size_t> steals_;
+};
+
+}  // namespace vl53l3cx_tools
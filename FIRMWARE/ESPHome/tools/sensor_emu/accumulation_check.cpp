@@ -0,0 +1,110 @@
+// Histogram accumulation on one emulated hub at a 25 ms budget, with shot
+// noise: the number of histograms the driver's merge sums into each frame,
+// and what that does to a weak target. The scenes:
+//   - a weak target at 1.5 m, beyond near_distance (1 m): valid frames with
+//     accumulation and with the merge off, and histograms per frame
+//   - a strong target at 0.5 m, within near_distance: every frame is from
+//     one histogram, as the hub restarts the merge
+//   - the strong target, then the weak one: frames until the merge is full
+//     again
+// Every run is a child process, as the hub's driver state is static.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "rig.h"
+
+using namespace vl53l3cx_tools;
+
+namespace {
+
+constexpr uint64_t S = 1000000;
+constexpr uint16_t NEAR_MM = 1000;
+constexpr EmuTarget WEAK{1500, 100};
+constexpr EmuTarget STRONG{500, 2000};
+
+struct Counts {
+  uint32_t frames{0};
+  uint32_t valid{0};       // Frames with a valid target within 50 mm of the scene's
+  uint32_t histograms{0};  // Summed over the frames
+  uint32_t full{0};        // Frames before the first with VL53LX_BIN_REC_SIZE histograms
+  bool was_full{false};
+};
+
+// One hub on `first` for 2 s, then on `scene` for 5 s, counted over the 5 s
+Counts run(const EmuTarget &first, const EmuTarget &scene, bool accumulate) {
+  Rig rig(1);
+  Counts counts;
+  if (accumulate) {
+    rig.hub(0).set_histogram_accumulation(NEAR_MM);
+  } else {
+    rig.hub(0).set_hist_merge_enabled(false);
+  }
+  rig.hub(0).set_timing_budget(25000);
+  rig.hub(0).set_update_interval(10);
+  rig.hub(0).add_on_frame_callback([&counts, &scene](const esphome::vl53l3cx::Frame &frame) {
+    counts.frames++;
+    counts.histograms += frame.histograms;
+    counts.was_full |= frame.histograms == VL53LX_BIN_REC_SIZE;
+    counts.full += !counts.was_full;
+    for (uint8_t i = 0; i < frame.num_targets; i++) {
+      const auto &target = frame.targets[i];
+      if ((target.range_status == VL53LX_RANGESTATUS_RANGE_VALID ||
+           target.range_status == VL53LX_RANGESTATUS_RANGE_VALID_MERGED_PULSE) &&
+          std::fabs(target.range_mm - scene.range_mm) < 50) {
+        counts.valid++;
+        break;
+      }
+    }
+  });
+  rig.sensor(0).shot_noise = true;
+  rig.sensor(0).targets = {first};
+  rig.setup();
+  rig.run(2 * S);
+  counts = Counts{};
+  rig.sensor(0).targets = {scene};
+  rig.run(5 * S);
+  std::printf("    %-20s %4u frames, %4u valid, %4.2f histograms per frame, full after %u frames\n",
+              accumulate ? "accumulation" : "merge off", counts.frames, counts.valid,
+              (double) counts.histograms / std::max<uint32_t>(counts.frames, 1), counts.full);
+  return counts;
+}
+
+// Through the child's return value: valid frames, histograms per frame in
+// hundredths and frames until full, 16 bits each
+uint64_t pack(const Counts &c) {
+  return (uint64_t) c.valid << 32 | (uint64_t) (c.histograms * 100 / std::max<uint32_t>(c.frames, 1)) << 16 |
+         std::min<uint32_t>(c.full, 0xFFFF);
+}
+uint32_t valid(uint64_t packed) { return (uint32_t) (packed >> 32); }
+double histograms(uint64_t packed) { return ((packed >> 16) & 0xFFFF) / 100.0; }
+uint32_t full(uint64_t packed) { return (uint32_t) (packed & 0xFFFF); }
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  if (argc > 1 && std::strcmp(argv[1], "-v") == 0) {
+    esphome::emu_log_level = esphome::ESPHOME_LOG_LEVEL_DEBUG;
+  }
+  std::printf("weak target at 1.5 m\n");
+  const uint64_t merge_off = isolated([] { return pack(run(WEAK, WEAK, false)); });
+  const uint64_t weak = isolated([] { return pack(run(WEAK, WEAK, true)); });
+  check(histograms(weak) > VL53LX_BIN_REC_SIZE - 0.5, "every frame sums a full merge");
+  check(valid(weak) > 2 * valid(merge_off), "more than twice the valid frames of the merge off");
+
+  std::printf("strong target at 0.5 m\n");
+  const uint64_t near = isolated([] { return pack(run(STRONG, STRONG, true)); });
+  check(histograms(near) < 1.01, "every frame from one histogram");
+  check(valid(near) > 0 && full(near) == valid(near), "every frame valid, the merge never full");
+
+  std::printf("strong target at 0.5 m, then the weak one at 1.5 m\n");
+  const uint64_t leaving = isolated([] { return pack(run(STRONG, WEAK, true)); });
+  // The merge grows by one histogram per timing, and the timings alternate
+  check(full(leaving) <= 2 * VL53LX_BIN_REC_SIZE, "full merge within two frames per histogram");
+
+  std::printf(check_failures ? "FAILED\n" : "all scenes passed\n");
+  return check_failures != 0;
+}
@@ -0,0 +1,313 @@
+#include "emu.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdarg>
+#include <cstring>
+
+#include "esp_timer.h"
+#include "esphome/core/log.h"
+#include "esphome/core/preferences.h"
+
+extern "C" {
+#include "vl53lx_hist_map.h"
+#include "vl53lx_ll_device.h"
+#include "vl53lx_register_map.h"
+#include "vl53lx_tuning_parm_defaults.h"
+}
+
+namespace vl53l3cx_tools {
+
+static uint64_t now_ns = 0;
+
+// 400 kHz: 9 clocks per byte, plus start/stop
+static constexpr uint64_t BYTE_NS = 22500;
+static constexpr uint64_t TRANSFER_NS = 5000;
+// XSHUT release -> I2C interface up; the firmware boot takes longer
+static constexpr uint64_t COMMS_UP_US = 200;
+
+static constexpr uint8_t HISTOGRAM_BINS = 24;
+static constexpr double PULSE_WIDTH_BINS = 0.8;
+// The bin sequences the driver configures start with one ambient sequence of 4 bins
+static constexpr uint8_t AMBIENT_BINS = 4;
+// Phase of the reference return, in bins: the zero distance of the histogram
+static constexpr double REFERENCE_PHASE_BINS = 2.5;
+static constexpr uint8_t MODE_ABORT = 0x80;
+static constexpr uint8_t MODE_SINGLESHOT = 0x10;
+
+uint64_t emu_now_us() { return now_ns / 1000; }
+void emu_advance_ns(uint64_t ns) { now_ns += ns; }
+
+EmuSensor::EmuSensor(std::string name) : name_(std::move(name)), regs_(0x10000) { this->power_on_defaults_(); }
+
+void EmuSensor::power_on_defaults_() {
+  std::fill(this->regs_.begin(), this->regs_.end(), 0);
+  this->address_ = 0x29;
+  this->regs_[VL53LX_I2C_SLAVE__DEVICE_ADDRESS] = 0x29;
+  // Fast oscillator frequency and calibration value, which the driver divides by
+  this->regs_[0x0006] = 0xBC;
+  this->regs_[0x0007] = 0xCC;
+  this->regs_[0x00DE] = 0x01;
+  this->regs_[0x00DF] = 0x30;
+  this->ranging_ = false;
+  this->set_data_ready_(false);
+  this->next_frame_us_ = NEVER;
+  this->stream_count_ = 0;
+}
+
+void EmuSensor::set_xshut(bool high) {
+  if (high == this->powered_) {
+    return;
+  }
+  this->powered_ = high;
+  this->power_on_defaults_();
+  this->faults.stall_from_us = NEVER;  // A reset clears a wedged sensor
+  if (high) {
+    this->power_on_us_ = emu_now_us();
+    this->boot_time_us_ = this->faults.boot_us;
+    if (this->faults.late_boots > 0) {
+      this->faults.late_boots--;
+      this->boot_time_us_ = this->faults.late_boot_us;
+    }
+    this->boots++;
+  }
+}
+
+bool EmuSensor::acknowledges(uint8_t address) const {
+  const uint64_t now = emu_now_us();
+  if (!this->powered_ || address != this->address_ || now < this->power_on_us_ + COMMS_UP_US) {
+    return false;
+  }
+  return now < this->faults.nack_from_us || now >= this->faults.nack_until_us;
+}
+
+bool EmuSensor::write(const uint8_t *data, size_t len) {
+  if (len < 2) {
+    return false;
+  }
+  this->index_ = (uint16_t)(data[0] << 8 | data[1]);
+  for (size_t i = 2; i < len; i++) {
+    const uint16_t index = (uint16_t)(this->index_ + i - 2);
+    if (index == VL53LX_I2C_SLAVE__DEVICE_ADDRESS && this->faults.rejected_addresses > 0) {
+      this->faults.rejected_addresses--;
+      return false;
+    }
+    this->write_register_(index, data[i]);
+  }
+  return true;
+}
+
+void EmuSensor::read(uint8_t *data, size_t len) {
+  const bool booted = !this->faults.never_boots && emu_now_us() >= this->power_on_us_ + this->boot_time_us_;
+  this->regs_[VL53LX_FIRMWARE__SYSTEM_STATUS] = booted ? 0x01 : 0x00;
+  for (size_t i = 0; i < len; i++) {
+    data[i] = this->regs_[(uint16_t)(this->index_ + i)];
+  }
+  this->index_ = (uint16_t)(this->index_ + len);
+}
+
+void EmuSensor::write_register_(uint16_t index, uint8_t value) {
+  this->regs_[index] = value;
+  switch (index) {
+    case VL53LX_I2C_SLAVE__DEVICE_ADDRESS:
+      this->address_ = value & 0x7F;
+      break;
+    case VL53LX_GPIO_HV_MUX__CTRL:
+      this->set_data_ready_(this->data_ready_);
+      break;
+    case VL53LX_SYSTEM__INTERRUPT_CLEAR:
+      if (value & 0x01) {
+        this->set_data_ready_(false);
+      }
+      break;
+    case VL53LX_SYSTEM__MODE_START:
+      if ((value & MODE_ABORT) || value == 0) {
+        this->ranging_ = false;
+        this->next_frame_us_ = NEVER;
+      } else {
+        this->ranging_ = true;
+        this->single_shot_ = (value & 0x70) == MODE_SINGLESHOT;
+        this->range_start_us_ = emu_now_us();
+        this->next_frame_us_ = this->range_start_us_ + this->frame_us;
+      }
+      break;
+    default:
+      break;
+  }
+}
+
+void EmuSensor::set_data_ready_(bool ready) {
+  this->data_ready_ = ready;
+  // GPIO__TIO_HV_STATUS reads back the interrupt line at the polarity GPIO_HV_MUX__CTRL selects
+  const bool active_low = (this->regs_[VL53LX_GPIO_HV_MUX__CTRL] & 0x10) != 0;
+  this->regs_[VL53LX_GPIO__TIO_HV_STATUS] = (ready != active_low) ? 0x01 : 0x00;
+}
+
+void EmuSensor::tick() {
+  const uint64_t now = emu_now_us();
+  if (!this->powered_ || !this->ranging_ || this->data_ready_ || now < this->next_frame_us_ ||
+      now >= this->faults.stall_from_us) {
+    return;
+  }
+  this->produce_frame_();
+  if (this->single_shot_) {
+    this->ranging_ = false;
+    this->next_frame_us_ = NEVER;
+  } else {
+    this->range_start_us_ = now;
+    this->next_frame_us_ = now + this->frame_us;
+  }
+}
+
+void EmuSensor::produce_frame_() {
+  // The driver reads the first frame after the start and then every odd one with VCSEL
+  // period A and the even bin sequences of the low ambient configuration; the others
+  // with period B and the odd sequences. The sequences live in the registers the
+  // driver reuses for them (VL53LX_copy_hist_cfg_to_static_cfg).
+  const bool timing_b = this->stream_count_ != 0 && (this->stream_count_ & 1) == 0;
+  const uint8_t *regs = this->regs_.data();
+  const uint8_t sequences[2][3] = {
+      {regs[VL53LX_RANGE_CONFIG__SIGMA_THRESH], regs[VL53LX_RANGE_CONFIG__SIGMA_THRESH + 1],
+       regs[VL53LX_RANGE_CONFIG__MIN_COUNT_RATE_RTN_LIMIT_MCPS]},
+      {regs[VL53LX_RANGE_CONFIG__MIN_COUNT_RATE_RTN_LIMIT_MCPS + 1], regs[VL53LX_RANGE_CONFIG__VALID_PHASE_LOW],
+       regs[VL53LX_RANGE_CONFIG__VALID_PHASE_HIGH]}};
+  const uint8_t *sequence = sequences[timing_b];
+  const uint8_t period_reg = regs[timing_b ? VL53LX_RANGE_CONFIG__VCSEL_PERIOD_B : VL53LX_RANGE_CONFIG__VCSEL_PERIOD_A];
+  const double period_bins = (period_reg + 1) * 2;
+
+  // The driver turns the phase of a return into range_mm with the PLL period of the
+  // fast oscillator and the histogram gain factor (VL53LX_range_maths); invert that
+  const uint16_t fast_osc = (uint16_t)(regs[0x0006] << 8 | regs[0x0007]);
+  const double pll_period_us = (double) ((1u << 30) / fast_osc);
+  const double mm_per_bin = 2048.0 * pll_period_us / 512.0 * VL53LX_SPEED_OF_LIGHT_IN_AIR_DIV_8 / 4194304.0 *
+                            VL53LX_TUNINGPARM_HIST_GAIN_FACTOR_DEFAULT / 2048.0 / 4.0;
+
+  // The reference return at a fixed phase, so the driver's zero distance phase is
+  // REFERENCE_PHASE_BINS for both timings
+  const uint16_t reference_phase = (uint16_t)(REFERENCE_PHASE_BINS * 2048);
+  this->regs_[VL53LX_PHASECAL_RESULT__REFERENCE_PHASE] = (uint8_t)(reference_phase >> 8);
+  this->regs_[VL53LX_PHASECAL_RESULT__REFERENCE_PHASE + 1] = (uint8_t) reference_phase;
+  this->regs_[VL53LX_PHASECAL_RESULT__VCSEL_START] = regs[VL53LX_CAL_CONFIG__VCSEL_START];
+
+  // The targets of the scene on a flat ambient. Each group of 4 bins holds the group
+  // of the VCSEL period its sequence entry names, or only ambient for entry 7.
+  uint8_t *result = &this->regs_[VL53LX_RESULT__INTERRUPT_STATUS];
+  result[0] = 0x02;
+  result[1] = 0x09;
+  result[2] = 0x00;
+  result[3] = this->stream_count_;
+  result[4] = 0x20;
+  result[5] = 0x00;
+  uint32_t count = 0;
+  for (uint8_t i = 0; i < HISTOGRAM_BINS; i++) {
+    const uint8_t entry = (sequence[i / 8] >> (i & 4)) & 0x0F;
+    double count_f = this->ambient;
+    for (const EmuTarget &target : this->targets) {
+      if ((entry & 0x07) == 0x07) {
+        break;
+      }
+      // The driver puts a count at the middle of its bin
+      const double centre = std::fmod(REFERENCE_PHASE_BINS + target.range_mm / mm_per_bin - 0.5, period_bins);
+      double d = std::fabs(std::fmod(entry * 4 + i % 4, period_bins) - centre);
+      d = std::min(d, period_bins - d) / PULSE_WIDTH_BINS;
+      count_f += target.peak * std::exp(-0.5 * d * d);
+    }
+    if (this->shot_noise) {
+      count_f = std::max(0.0, count_f + std::normal_distribution<double>(0.0, std::sqrt(count_f))(this->rng_));
+    }
+    count = (uint32_t) count_f;
+    uint8_t *bin = &result[6 + 3 * i];
+    bin[0] = (uint8_t)(count >> 16);
+    bin[1] = (uint8_t)(count >> 8);
+    bin[2] = (uint8_t) count;
+  }
+  // The low byte of the last bin is read back from two other registers
+  this->regs_[VL53LX_RESULT__HISTOGRAM_BIN_23_0_MSB] = (uint8_t)(count >> 2) & 0x3F;
+  this->regs_[VL53LX_RESULT__HISTOGRAM_BIN_23_0_LSB] = (uint8_t) count & 0x03;
+  this->stream_count_ = this->stream_count_ == 255 ? 128 : this->stream_count_ + 1;
+  this->frames++;
+  this->emissions.push_back({this->range_start_us_, this->next_frame_us_});
+  this->set_data_ready_(true);
+}
+
+void EmuPin::digital_write(bool value) {
+  this->value_ = value;
+  this->sensor_->set_xshut(value);
+}
+
+std::vector<EmuSensor *> &EmuBus::transfer_(uint8_t address, size_t len) {
+  const uint64_t ns = TRANSFER_NS + BYTE_NS * (len + 1);
+  emu_advance_ns(ns);
+  this->busy_ns_ += ns;
+  this->matched_.clear();
+  for (auto *sensor : this->sensors_) {
+    sensor->tick();
+    if (sensor->acknowledges(address)) {
+      this->matched_.push_back(sensor);
+    }
+  }
+  if (this->matched_.empty()) {
+    this->nacks++;
+  } else if (this->matched_.size() > 1) {
+    this->collisions++;
+  }
+  return this->matched_;
+}
+
+esphome::i2c::ErrorCode EmuBus::read(uint8_t address, uint8_t *data, size_t len) {
+  auto &sensors = this->transfer_(address, len);
+  if (sensors.empty()) {
+    return esphome::i2c::ERROR_NOT_ACKNOWLEDGED;
+  }
+  std::memset(data, 0xFF, len);
+  std::vector<uint8_t> chunk(len);
+  for (auto *sensor : sensors) {
+    sensor->read(chunk.data(), len);
+    for (size_t i = 0; i < len; i++) {
+      data[i] &= chunk[i];
+    }
+  }
+  return esphome::i2c::ERROR_OK;
+}
+
+esphome::i2c::ErrorCode EmuBus::write(uint8_t address, const uint8_t *data, size_t len, bool stop) {
+  auto &sensors = this->transfer_(address, len);
+  bool acked = !sensors.empty();
+  for (auto *sensor : sensors) {
+    acked &= sensor->write(data, len);
+  }
+  return acked ? esphome::i2c::ERROR_OK : esphome::i2c::ERROR_NOT_ACKNOWLEDGED;
+}
+
+}  // namespace vl53l3cx_tools
+
+// The ESPHome and ESP-IDF functions the hub links against, on the virtual clock
+
+namespace esphome {
+
+int emu_log_level = ESPHOME_LOG_LEVEL_WARN;
+ESPPreferences *global_preferences = nullptr;
+
+void emu_log(int level, const char *tag, const char *format, ...) {
+  if (level > emu_log_level) {
+    return;
+  }
+  static const char LETTERS[] = "-EWICDVV";
+  const uint64_t now = vl53l3cx_tools::emu_now_us();
+  std::fprintf(stderr, "%8.3f [%c][%s]: ", now / 1e6, LETTERS[level], tag);
+  va_list args;
+  va_start(args, format);
+  std::vfprintf(stderr, format, args);
+  va_end(args);
+  std::fputc('\n', stderr);
+}
+
+void delay(uint32_t ms) { vl53l3cx_tools::emu_advance_ns(ms * 1000000ull); }
+void delayMicroseconds(uint32_t us) { vl53l3cx_tools::emu_advance_ns(us * 1000ull); }
+uint32_t millis() { return (uint32_t)(vl53l3cx_tools::emu_now_us() / 1000); }
+uint32_t micros() { return (uint32_t) vl53l3cx_tools::emu_now_us(); }
+void yield() {}
+
+}  // namespace esphome
+
+extern "C" int64_t esp_timer_get_time(void) { return (int64_t) vl53l3cx_tools::emu_now_us(); }
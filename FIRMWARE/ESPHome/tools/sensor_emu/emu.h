@@ -0,0 +1,137 @@
+#pragma once
+
+// Host emulation of several VL53L3CX sensors sharing one I2C bus, with
+// their XSHUT lines, for running the hub component unmodified. Time is
+// virtual: it advances only with delay() and with bus transfers, at the
+// 400 kHz byte time. Host CPU time is not modelled.
+//
+// A sensor answers on 0x29 after leaving XSHUT reset and moves when the
+// driver writes I2C_SLAVE__DEVICE_ADDRESS. Ranging produces one histogram
+// frame of the sensor's scene per frame period, alternating between the two
+// VCSEL periods as the driver expects. Transfers that more than one powered
+// sensor acknowledges are counted as collisions; reads then return the
+// wired-AND of their data, as on an open-drain bus.
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "esphome/components/i2c/i2c.h"
+#include "esphome/core/hal.h"
+
+namespace vl53l3cx_tools {
+
+static constexpr uint64_t NEVER = UINT64_MAX;
+
+uint64_t emu_now_us();
+void emu_advance_ns(uint64_t ns);
+
+// Faults of one sensor. Counts limit a fault to the first N boots or attempts.
+struct SensorFaults {
+  uint32_t boot_us{1000};           // XSHUT release -> firmware booted
+  uint32_t late_boots{0};           // Boots that take late_boot_us instead
+  uint32_t late_boot_us{700000};    // Longer than the driver's 500 ms boot timeout
+  bool never_boots{false};          // Acknowledges, but the firmware never reports booted
+  uint32_t rejected_addresses{0};   // Address writes NACKed
+  uint64_t stall_from_us{NEVER};    // Ranging stops producing frames until the next reset
+  uint64_t nack_from_us{NEVER};     // Every transfer NACKed in [nack_from_us, nack_until_us)
+  uint64_t nack_until_us{NEVER};
+};
+
+// One range, from the start of ranging to its result: while the VCSEL emits
+struct EmuEmission {
+  uint64_t start_us;
+  uint64_t end_us;
+};
+
+// One return in the histogram: a Gaussian pulse over the flat ambient, placed
+// at the bin the driver converts back to range_mm for the timing of the frame
+struct EmuTarget {
+  double range_mm;
+  double peak;  // Counts at the centre, above the ambient
+};
+
+class EmuSensor {
+ public:
+  explicit EmuSensor(std::string name);
+
+  void set_xshut(bool high);
+  bool is_powered() const { return this->powered_; }
+  bool acknowledges(uint8_t address) const;
+  uint8_t get_address() const { return this->address_; }
+  const std::string &get_name() const { return this->name_; }
+
+  // One transfer, already addressed to this sensor. False NACKs it.
+  bool write(const uint8_t *data, size_t len);
+  void read(uint8_t *data, size_t len);
+  // Brings the ranging state up to the current time
+  void tick();
+
+  SensorFaults faults;
+  // The scene every frame shows from now on
+  std::vector<EmuTarget> targets{{1000.0, 4000.0}};
+  uint32_t ambient{500};  // Counts per bin
+  bool shot_noise{false};  // Gaussian noise of sqrt(count) on every bin, from a fixed seed
+  uint32_t frame_us{33000};
+  uint32_t frames{0};  // Frames produced since the start
+  std::vector<EmuEmission> emissions;  // Of every frame produced
+  uint32_t boots{0};   // XSHUT releases
+
+ protected:
+  void power_on_defaults_();
+  void write_register_(uint16_t index, uint8_t value);
+  void set_data_ready_(bool ready);
+  void produce_frame_();
+
+  std::string name_;
+  std::vector<uint8_t> regs_;
+  bool powered_{false};
+  uint8_t address_{0x29};
+  uint16_t index_{0};
+  uint64_t power_on_us_{0};
+  uint32_t boot_time_us_{0};
+  bool ranging_{false};
+  bool single_shot_{false};
+  bool data_ready_{false};
+  uint64_t next_frame_us_{NEVER};
+  uint64_t range_start_us_{0};
+  uint8_t stream_count_{0};
+  std::mt19937 rng_{1};
+};
+
+class EmuPin : public esphome::GPIOPin {
+ public:
+  explicit EmuPin(EmuSensor *sensor) : sensor_(sensor) {}
+  void setup() override {}
+  void pin_mode(esphome::gpio::Flags flags) override {}
+  bool digital_read() override { return this->value_; }
+  void digital_write(bool value) override;
+  std::string dump_summary() const override { return "XSHUT of " + this->sensor_->get_name(); }
+
+ protected:
+  EmuSensor *sensor_;
+  bool value_{false};
+};
+
+class EmuBus : public esphome::i2c::I2CBus {
+ public:
+  void add(EmuSensor *sensor) { this->sensors_.push_back(sensor); }
+  esphome::i2c::ErrorCode read(uint8_t address, uint8_t *data, size_t len) override;
+  esphome::i2c::ErrorCode write(uint8_t address, const uint8_t *data, size_t len, bool stop = true) override;
+
+  uint32_t collisions{0};  // Transfers acknowledged by more than one sensor
+  uint32_t nacks{0};
+  uint64_t busy_us() const { return this->busy_ns_ / 1000; }
+
+ protected:
+  // Advances the clock by the transfer time and returns the sensors that acknowledge
+  std::vector<EmuSensor *> &transfer_(uint8_t address, size_t len);
+
+  std::vector<EmuSensor *> sensors_;
+  std::vector<EmuSensor *> matched_;
+  uint64_t busy_ns_{0};
+};
+
+}  // namespace vl53l3cx_tools
@@ -0,0 +1,13 @@
+#pragma once
+
+// Host stand-in for ESP-IDF's esp_timer: the emulator's virtual clock, in µs.
+
+#include <cstdint>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+int64_t esp_timer_get_time(void);
+#ifdef __cplusplus
+}
+#endif
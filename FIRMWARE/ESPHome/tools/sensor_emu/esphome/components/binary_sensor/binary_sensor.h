@@ -0,0 +1,24 @@
+#pragma once
+
+// Host stand-in for ESPHome's binary sensor entity: keeps the last state.
+
+#include "esphome/core/log.h"
+
+namespace esphome {
+namespace binary_sensor {
+
+class BinarySensor {
+ public:
+  void publish_state(bool state) { this->state = state; }
+  void publish_initial_state(bool state) { this->state = state; }
+
+  bool state{false};
+};
+
+}  // namespace binary_sensor
+}  // namespace esphome
+
+#define LOG_BINARY_SENSOR(prefix, type, obj) \
+  if ((obj) != nullptr) { \
+    ESP_LOGCONFIG(TAG, "%s%s", prefix, type); \
+  }
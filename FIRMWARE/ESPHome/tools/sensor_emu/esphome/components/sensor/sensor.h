@@ -0,0 +1,33 @@
+#pragma once
+
+// Host stand-in for ESPHome's sensor entity: keeps the last state.
+
+#include <string>
+#include "esphome/core/log.h"
+
+namespace esphome {
+namespace sensor {
+
+class Sensor {
+ public:
+  void publish_state(float state) {
+    this->state = state;
+    this->has_state_ = true;
+    this->publishes++;
+  }
+  bool has_state() const { return this->has_state_; }
+
+  float state{0.0f};
+  unsigned publishes{0};
+
+ protected:
+  bool has_state_{false};
+};
+
+}  // namespace sensor
+}  // namespace esphome
+
+#define LOG_SENSOR(prefix, type, obj) \
+  if ((obj) != nullptr) { \
+    ESP_LOGCONFIG(TAG, "%s%s", prefix, type); \
+  }
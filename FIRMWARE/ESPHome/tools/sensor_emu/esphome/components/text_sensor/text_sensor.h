@@ -0,0 +1,24 @@
+#pragma once
+
+// Host stand-in for ESPHome's text sensor entity: keeps the last state.
+
+#include <string>
+#include "esphome/core/log.h"
+
+namespace esphome {
+namespace text_sensor {
+
+class TextSensor {
+ public:
+  void publish_state(const std::string &state) { this->state = state; }
+
+  std::string state;
+};
+
+}  // namespace text_sensor
+}  // namespace esphome
+
+#define LOG_TEXT_SENSOR(prefix, type, obj) \
+  if ((obj) != nullptr) { \
+    ESP_LOGCONFIG(TAG, "%s%s", prefix, type); \
+  }
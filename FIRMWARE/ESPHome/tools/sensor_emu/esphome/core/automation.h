@@ -0,0 +1,14 @@
+#pragma once
+
+// Host stand-in for ESPHome's automation trigger: counts its firings.
+
+namespace esphome {
+
+template<typename... Ts> class Trigger {
+ public:
+  void trigger(Ts... x) { this->fired++; }
+
+  unsigned fired{0};
+};
+
+}  // namespace esphome
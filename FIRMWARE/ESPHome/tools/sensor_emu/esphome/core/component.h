@@ -0,0 +1,54 @@
+#pragma once
+
+// Host stand-in for ESPHome's Component and PollingComponent. The emulator
+// drives setup(), loop() and update() itself.
+
+#include <cstdint>
+#include "esphome/core/hal.h"
+#include "esphome/core/log.h"
+
+namespace esphome {
+
+namespace setup_priority {
+static const float BUS = 1000.0f;
+static const float IO = 900.0f;
+static const float HARDWARE = 800.0f;
+static const float DATA = 600.0f;
+static const float PROCESSOR = 400.0f;
+static const float LATE = -100.0f;
+}  // namespace setup_priority
+
+class Component {
+ public:
+  virtual ~Component() = default;
+  virtual void setup() {}
+  virtual void loop() {}
+  virtual void dump_config() {}
+  virtual float get_setup_priority() const { return setup_priority::DATA; }
+
+  void mark_failed() { this->failed_ = true; }
+  bool is_failed() const { return this->failed_; }
+  void status_set_warning() { this->warning_ = true; }
+  void status_clear_warning() { this->warning_ = false; }
+  bool status_has_warning() const { return this->warning_; }
+
+ protected:
+  bool failed_{false};
+  bool warning_{false};
+};
+
+class PollingComponent : public Component {
+ public:
+  PollingComponent() = default;
+  explicit PollingComponent(uint32_t update_interval) : update_interval_(update_interval) {}
+  virtual void update() = 0;
+  virtual void set_update_interval(uint32_t update_interval) { this->update_interval_ = update_interval; }
+  virtual uint32_t get_update_interval() const { return this->update_interval_; }
+  void start_poller() {}
+  void stop_poller() {}
+
+ protected:
+  uint32_t update_interval_{100};
+};
+
+}  // namespace esphome
@@ -0,0 +1,40 @@
+#pragma once
+
+// Host stand-in for ESPHome's HAL. Time is the emulator's virtual clock:
+// delays advance it instead of sleeping.
+
+#include <cstdint>
+#include <string>
+
+namespace esphome {
+
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+uint32_t millis();
+uint32_t micros();
+void yield();
+
+namespace gpio {
+enum Flags : uint8_t {
+  FLAG_NONE = 0x00,
+  FLAG_INPUT = 0x01,
+  FLAG_OUTPUT = 0x02,
+  FLAG_OPEN_DRAIN = 0x04,
+  FLAG_PULLUP = 0x08,
+  FLAG_PULLDOWN = 0x10,
+};
+}  // namespace gpio
+
+class GPIOPin {
+ public:
+  virtual ~GPIOPin() = default;
+  virtual void setup() = 0;
+  virtual void pin_mode(gpio::Flags flags) = 0;
+  virtual bool digital_read() = 0;
+  virtual void digital_write(bool value) = 0;
+  virtual std::string dump_summary() const = 0;
+};
+
+inline gpio::Flags operator|(gpio::Flags a, gpio::Flags b) { return static_cast<gpio::Flags>((uint8_t) a | (uint8_t) b); }
+
+}  // namespace esphome
@@ -0,0 +1,50 @@
+#pragma once
+
+// Host stand-in for the ESPHome helpers the hub uses.
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace esphome {
+
+using std::clamp;
+
+inline std::string format_hex(const uint8_t *data, size_t length) {
+  static const char *const DIGITS = "0123456789abcdef";
+  std::string out;
+  out.reserve(length * 2);
+  for (size_t i = 0; i < length; i++) {
+    out += DIGITS[data[i] >> 4];
+    out += DIGITS[data[i] & 0x0F];
+  }
+  return out;
+}
+
+template<typename... Ts> class CallbackManager;
+
+template<typename... Ts> class CallbackManager<void(Ts...)> {
+ public:
+  void add(std::function<void(Ts...)> &&callback) { this->callbacks_.push_back(std::move(callback)); }
+  void call(Ts... args) {
+    for (auto &cb : this->callbacks_)
+      cb(args...);
+  }
+  size_t size() const { return this->callbacks_.size(); }
+
+ protected:
+  std::vector<std::function<void(Ts...)>> callbacks_;
+};
+
+class HighFrequencyLoopRequester {
+ public:
+  void start() {}
+  void stop() {}
+};
+
+}  // namespace esphome
@@ -0,0 +1,24 @@
+#pragma once
+
+// Host stand-in for ESPHome's preferences. The emulator starts with empty
+// flash: global_preferences is null unless a program installs one.
+
+#include <cstdint>
+
+namespace esphome {
+
+class ESPPreferenceObject {
+ public:
+  template<typename T> bool save(const T *src) { return false; }
+  template<typename T> bool load(T *dest) { return false; }
+};
+
+class ESPPreferences {
+ public:
+  template<typename T> ESPPreferenceObject make_preference(uint32_t type, bool in_flash) { return {}; }
+  bool sync() { return true; }
+};
+
+extern ESPPreferences *global_preferences;
+
+}  // namespace esphome
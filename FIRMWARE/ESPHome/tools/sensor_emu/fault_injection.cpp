@@ -0,0 +1,297 @@
+// Fault injection for the hub's recovery supervisor and the ranging
+// scheduler: faults are switched on and off on the emulated sensors while
+// the hubs run, and the recovery stages, back-off and frame flow are checked.
+// The scheduler's healthy STRICT and GROUPED cycles come first, as a baseline.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "rig.h"
+#include "vl53l3cx_scheduler.h"
+
+using namespace vl53l3cx_tools;
+using esphome::vl53l3cx::RecoveryStage;
+using esphome::vl53l3cx_scheduler::SchedulerMode;
+using esphome::vl53l3cx_scheduler::VL53L3CXScheduler;
+
+namespace {
+
+constexpr uint64_t S = 1000000;
+constexpr uint64_t SAMPLE_US = 10000;
+
+const char *stage_name(RecoveryStage stage) {
+  static const char *const NAMES[] = {"OK", "SOFT_RESTART", "HARD_RESET", "REINIT"};
+  return NAMES[stage];
+}
+
+// Stage changes and recovery attempts of one hub, sampled while the rig runs
+struct Trace {
+  struct Step {
+    uint64_t us;
+    RecoveryStage stage;
+  };
+  std::vector<Step> stages;
+  std::vector<uint64_t> attempts;  // When each attempt of the current fault ran
+  uint32_t last_attempts{0};
+
+  void sample(const VL53L3CXComponent &hub) {
+    const auto &supervisor = hub.get_supervisor();
+    if (this->stages.empty() || this->stages.back().stage != supervisor.get_stage()) {
+      this->stages.push_back({emu_now_us(), supervisor.get_stage()});
+    }
+    if (supervisor.get_attempts() != this->last_attempts) {
+      this->last_attempts = supervisor.get_attempts();
+      if (this->last_attempts > 0) {
+        this->attempts.push_back(emu_now_us());
+      }
+    }
+  }
+  bool reached(RecoveryStage stage) const {
+    for (const Step &step : this->stages) {
+      if (step.stage == stage) {
+        return true;
+      }
+    }
+    return false;
+  }
+  void print() const {
+    std::string line = "    stages:";
+    char buf[48];
+    for (const Step &step : this->stages) {
+      std::snprintf(buf, sizeof(buf), " %.2f s %s,", step.us / 1e6, stage_name(step.stage));
+      line += buf;
+    }
+    line.pop_back();
+    std::printf("%s\n", line.c_str());
+  }
+};
+
+// Runs the rig, sampling `hub` every SAMPLE_US
+void run(Rig &rig, uint64_t duration_us, Trace *trace = nullptr, size_t hub = 0,
+         esphome::Component *extra = nullptr) {
+  for (uint64_t t = 0; t < duration_us; t += SAMPLE_US) {
+    rig.run(SAMPLE_US, extra);
+    if (trace != nullptr) {
+      trace->sample(rig.hub(hub));
+    }
+  }
+}
+
+struct Health {
+  esphome::text_sensor::TextSensor state;
+  esphome::sensor::Sensor recoveries;
+  esphome::sensor::Sensor time_to_recover;
+
+  void attach(VL53L3CXComponent &hub) {
+    hub.set_health_text_sensor(&this->state);
+    hub.set_recoveries_sensor(&this->recoveries);
+    hub.set_time_to_recover_sensor(&this->time_to_recover);
+  }
+};
+
+void check_recovered(Rig &rig, Health &health, uint32_t frames_before) {
+  check(rig.hub(0).is_device_ready() && rig.hub(0).get_supervisor().is_healthy(), "hub healthy again");
+  check(rig.frames[0] > frames_before, "frames arrive after the fault");
+  check(health.state.state == "OK", "health text sensor back to OK");
+  check(health.recoveries.has_state() && health.recoveries.state == 1, "recoveries sensor counts 1");
+  check(health.time_to_recover.has_state() && health.time_to_recover.state > 0, "time to recover published");
+  check(!rig.hub(0).is_failed(), "never marked failed");
+  std::printf("    time to recover: %.2f s\n", health.time_to_recover.state);
+}
+
+// Ranging stops, but the sensor still answers; only an XSHUT reset clears it
+void wedged() {
+  Rig rig(1);
+  Health health;
+  health.attach(rig.hub(0));
+  Trace trace;
+  rig.setup();
+  run(rig, 1 * S);
+  rig.sensor(0).faults.stall_from_us = emu_now_us();
+  const uint32_t frames = rig.frames[0];
+  run(rig, 15 * S, &trace);
+  trace.print();
+  check(trace.reached(esphome::vl53l3cx::RECOVERY_SOFT_RESTART), "stall detected, soft restart tried first");
+  check(trace.reached(esphome::vl53l3cx::RECOVERY_HARD_RESET), "escalated to a hard reset");
+  check(!trace.reached(esphome::vl53l3cx::RECOVERY_REINIT), "hard reset was enough");
+  check(rig.sensor(0).boots == 2, "one XSHUT reset");
+  check_recovered(rig, health, frames);
+}
+
+// Every transfer NACKed for `outage_us`, as with a loose connector
+void bus_outage(uint64_t outage_us, bool reinit) {
+  Rig rig(1);
+  Health health;
+  health.attach(rig.hub(0));
+  Trace trace;
+  rig.setup();
+  run(rig, 1 * S);
+  rig.sensor(0).faults.nack_from_us = emu_now_us();
+  rig.sensor(0).faults.nack_until_us = emu_now_us() + outage_us;
+  const uint32_t frames = rig.frames[0];
+  run(rig, outage_us, &trace);
+  const size_t attempts = trace.attempts.size();
+  run(rig, outage_us / 2 + 20 * S, &trace);
+  trace.print();
+  check(trace.reached(esphome::vl53l3cx::RECOVERY_REINIT) == reinit,
+        reinit ? "escalated to re-init" : "recovered before re-init");
+  // Waits between attempts grow (doubling back-off plus the verify timeout), so a
+  // long outage costs a handful of attempts instead of one per second
+  bool growing = true;
+  for (size_t i = 2; i < trace.attempts.size(); i++) {
+    growing &= trace.attempts[i] - trace.attempts[i - 1] >= trace.attempts[i - 1] - trace.attempts[i - 2];
+  }
+  check(growing, "back-off between attempts never shrinks");
+  std::printf("    %zu attempt(s) during the %.0f s outage\n", attempts, outage_us / 1e6);
+  if (reinit) {
+    check(attempts <= 8, "at most 8 attempts during the outage");
+  }
+  check_recovered(rig, health, frames);
+}
+
+// Three scheduled hubs; `fault` breaks hub 2 at `fault_us` (0: before setup) and `repair` fixes it `outage_us` later
+void scheduled(const std::function<void(EmuSensor &)> &fault, const std::function<void(EmuSensor &)> &repair,
+               uint64_t fault_us, uint64_t outage_us) {
+  Rig rig(3);
+  VL53L3CXScheduler scheduler;
+  for (size_t i = 0; i < 3; i++) {
+    rig.hub(i).set_externally_triggered(true);
+    scheduler.add_sensor(&rig.hub(i), i);
+  }
+  if (fault_us == 0) {
+    fault(rig.sensor(1));
+  }
+  rig.setup();
+  scheduler.setup();
+  Trace trace;
+  if (fault_us > 0) {
+    run(rig, fault_us, &trace, 1, &scheduler);
+    fault(rig.sensor(1));
+  }
+  const std::vector<uint32_t> before = rig.frames;
+  run(rig, outage_us, &trace, 1, &scheduler);
+  const std::vector<uint32_t> during = rig.frames;
+  repair(rig.sensor(1));
+  run(rig, 30 * S, &trace, 1, &scheduler);
+  trace.print();
+  const double rate_1 = (during[0] - before[0]) / (outage_us / 1e6);
+  const double rate_3 = (during[2] - before[2]) / (outage_us / 1e6);
+  std::printf("    during the fault: sensor 1 %.1f frames/s, sensor 3 %.1f frames/s\n", rate_1, rate_3);
+  // A healthy three-slot cycle gives about 8 frames/s each
+  check(rate_1 > 5 && rate_3 > 5, "other sensors keep ranging in their slots");
+  check(rig.hub(1).is_device_ready() && rig.frames[1] > during[1], "faulted sensor rejoins its slot");
+  check(rig.bus.collisions == 0, "no collision");
+}
+
+// Time both sensors emitted at once, from their emissions since `from_us`
+uint64_t overlap_us(const EmuSensor &a, const EmuSensor &b, uint64_t from_us) {
+  uint64_t total = 0;
+  for (const EmuEmission &x : a.emissions) {
+    for (const EmuEmission &y : b.emissions) {
+      const uint64_t start = std::max({x.start_us, y.start_us, from_us});
+      const uint64_t end = std::min(x.end_us, y.end_us);
+      total += end > start ? end - start : 0;
+    }
+  }
+  return total;
+}
+
+// Four healthy scheduled hubs: the frame rate of each and the time any two emit at once.
+// GROUPED puts sensors 1 and 3 in slot 0 and sensors 2 and 4 in slot 1.
+void healthy(SchedulerMode mode) {
+  constexpr size_t COUNT = 4;
+  Rig rig(COUNT);
+  VL53L3CXScheduler scheduler;
+  scheduler.set_mode(mode);
+  for (size_t i = 0; i < COUNT; i++) {
+    rig.hub(i).set_externally_triggered(true);
+    scheduler.add_sensor(&rig.hub(i), i % 2);
+  }
+  rig.setup();
+  scheduler.setup();
+  run(rig, 1 * S, nullptr, 0, &scheduler);
+  const std::vector<uint32_t> before = rig.frames;
+  const uint64_t from_us = emu_now_us();
+  run(rig, 10 * S, nullptr, 0, &scheduler);
+  std::string line = "    frames/s:";
+  char buf[32];
+  bool even = true;
+  for (size_t i = 0; i < COUNT; i++) {
+    const double rate = (rig.frames[i] - before[i]) / 10.0;
+    std::snprintf(buf, sizeof(buf), " %.1f,", rate);
+    line += buf;
+    even &= std::abs(rate - (rig.frames[0] - before[0]) / 10.0) <= 0.2;
+  }
+  line.pop_back();
+  std::printf("%s\n", line.c_str());
+  bool apart = true, together = true;
+  for (size_t a = 0; a < COUNT; a++) {
+    for (size_t b = a + 1; b < COUNT; b++) {
+      const uint64_t us = overlap_us(rig.sensor(a), rig.sensor(b), from_us);
+      std::printf("    sensors %zu and %zu emit together for %.1f ms\n", a + 1, b + 1, us / 1e3);
+      if (mode == esphome::vl53l3cx_scheduler::SCHEDULER_MODE_GROUPED && a % 2 == b % 2) {
+        // Triggered one after the other over the bus, so most of each range, not all
+        together &= us > (rig.frames[a] - before[a]) * rig.sensor(a).frame_us * 8 / 10;
+      } else {
+        apart &= us == 0;
+      }
+    }
+  }
+  // One range of the 33 ms budget, plus the slot overhead, per slot of the cycle
+  const double slots = mode == esphome::vl53l3cx_scheduler::SCHEDULER_MODE_GROUPED ? 2 : COUNT;
+  const double rate = (rig.frames[0] - before[0]) / 10.0;
+  check(even, "every sensor at the same rate");
+  check(rate > 0.8 * 1e6 / (slots * 33000) && rate <= 1e6 / (slots * 33000), "rate within 80 % of one budget per slot");
+  check(apart, "sensors of different slots never emit together");
+  if (mode == esphome::vl53l3cx_scheduler::SCHEDULER_MODE_GROUPED) {
+    check(together, "sensors of one slot emit together for 80 % of a range");
+  }
+  check(rig.bus.collisions == 0, "no collision");
+}
+
+struct Scenario {
+  const char *name;
+  std::function<void()> run;
+};
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  if (argc > 1 && std::strcmp(argv[1], "-v") == 0) {
+    esphome::emu_log_level = esphome::ESPHOME_LOG_LEVEL_DEBUG;
+  }
+  const Scenario scenarios[] = {
+      {"scheduled, healthy, STRICT", [] { healthy(esphome::vl53l3cx_scheduler::SCHEDULER_MODE_STRICT); }},
+      {"scheduled, healthy, GROUPED", [] { healthy(esphome::vl53l3cx_scheduler::SCHEDULER_MODE_GROUPED); }},
+      {"wedged ranging, cleared by a reset", wedged},
+      {"bus NACKs for 3 s", [] { bus_outage(3 * S, false); }},
+      {"bus NACKs for 60 s", [] { bus_outage(60 * S, true); }},
+      {"scheduled: sensor 2 does not boot for 10 s",
+       [] {
+         scheduled([](EmuSensor &s) { s.faults.never_boots = true; },
+                   [](EmuSensor &s) { s.faults.never_boots = false; }, 0, 10 * S);
+       }},
+      {"scheduled: sensor 2 wedges while ranging",
+       [] {
+         scheduled([](EmuSensor &s) { s.faults.stall_from_us = emu_now_us(); }, [](EmuSensor &) {}, 2 * S,
+                   10 * S);
+       }},
+  };
+  int failed = 0;
+  for (const Scenario &scenario : scenarios) {
+    std::printf("%s\n", scenario.name);
+    const int before = check_failures;
+    isolated([&scenario]() -> uint64_t {
+      scenario.run();
+      return 0;
+    });
+    failed += check_failures != before;
+  }
+  std::printf(failed ? "%d scenario(s) FAILED\n" : "all scenarios passed\n", failed);
+  return failed != 0;
+}
@@ -0,0 +1,173 @@
+// The hub's range filters against an exponential moving average, on one
+// emulated hub with shot noise in its histograms and tracking off. One scene
+// for every filter:
+//   - 1.0 m for 6 s: jitter, the RMS of the published range around its mean
+//     over the last 5 s
+//   - 1.0 m -> 0.4 m at 0.5 m/s: lag, the mean of published minus true
+//     range over the approach divided by the speed (the true range is the
+//     scene's when the range is published)
+//   - 0.4 m, then another object at 1.4 m takes the slot: frames published
+//     before the range is within 20 mm of 1.4 m
+// The EMA runs on the unfiltered ranges of the same scene. Every filter runs
+// in a child process, as the hub's driver state is static.
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <vector>
+
+#include "rig.h"
+
+using namespace vl53l3cx_tools;
+
+namespace {
+
+constexpr uint64_t MS = 1000;
+constexpr uint64_t S = 1000000;
+constexpr double PEAK = 600;  // About 8 mm sigma in the driver
+
+constexpr uint64_t STATIC_END_US = 6 * S;
+constexpr uint64_t APPROACH_US = 1200 * MS;  // 0.6 m at 0.5 m/s
+constexpr uint64_t JUMP_US = STATIC_END_US + APPROACH_US + 2 * S;
+constexpr uint64_t END_US = JUMP_US + 2 * S;
+constexpr double SPEED_MM_PER_US = 0.5e-3;
+
+// The scene's range at `t_us` from the start of the scene
+double scene_mm(uint64_t t_us) {
+  if (t_us < STATIC_END_US) {
+    return 1000;
+  }
+  if (t_us < STATIC_END_US + APPROACH_US) {
+    return 1000 - (t_us - STATIC_END_US) * SPEED_MM_PER_US;
+  }
+  return t_us < JUMP_US ? 400 : 1400;
+}
+
+struct Sample {
+  uint64_t t_us;  // From the start of the scene
+  double mm;
+  double true_mm;
+};
+
+class Sink : public esphome::vl53l3cx::VL53L3CXSensorBase {
+ public:
+  void set_target_number(uint8_t target) override {}
+  void publish_distance_state(float distance_m) override {
+    if (!std::isnan(distance_m)) {
+      const uint64_t t_us = emu_now_us() - this->start_us;
+      this->samples.push_back({t_us, distance_m * 1000.0, scene_mm(t_us)});
+    }
+  }
+
+  uint64_t start_us{0};
+  std::vector<Sample> samples;
+};
+
+struct Metrics {
+  double jitter_mm;
+  double lag_ms;
+  int jump_frames;
+};
+
+Metrics measure(const std::vector<Sample> &samples) {
+  double sum = 0, sum_sq = 0, lag_sum = 0;
+  int n = 0, lag_n = 0;
+  for (const Sample &s : samples) {
+    if (s.t_us >= 1 * S && s.t_us < STATIC_END_US) {
+      sum += s.mm;
+      sum_sq += s.mm * s.mm;
+      n++;
+    }
+    // Skip the first 200 ms of the approach, where every filter is still catching up
+    if (s.t_us >= STATIC_END_US + 200 * MS && s.t_us < STATIC_END_US + APPROACH_US) {
+      lag_sum += s.mm - s.true_mm;
+      lag_n++;
+    }
+  }
+  // Frames after the jump until the first one within 20 mm of the new object
+  int after = 0, jump_frames = -1;
+  for (const Sample &s : samples) {
+    if (s.t_us < JUMP_US) {
+      continue;
+    }
+    if (std::fabs(s.mm - 1400) < 20) {
+      jump_frames = after;
+      break;
+    }
+    after++;
+  }
+  const double mean = sum / n;
+  return {std::sqrt(sum_sq / n - mean * mean), lag_sum / lag_n / (SPEED_MM_PER_US * 1000), jump_frames};
+}
+
+void print(const char *name, const Metrics &m) {
+  std::printf("%-26s %7.1f mm %7.0f ms %8d\n", name, m.jitter_mm, m.lag_ms, m.jump_frames);
+}
+
+// Runs the scene through slot 0 of one hub with `configure` applied to it
+std::vector<Sample> run_scene(const std::function<void(VL53L3CXComponent &)> &configure) {
+  Rig rig(1);
+  Sink sink;
+  rig.hub(0).register_distance_sensor(&sink, 0);
+  configure(rig.hub(0));
+  rig.sensor(0).shot_noise = true;
+  rig.sensor(0).targets = {{scene_mm(0), PEAK}};
+  rig.setup();
+  sink.start_us = emu_now_us();
+  while (emu_now_us() - sink.start_us < END_US) {
+    rig.sensor(0).targets = {{scene_mm(emu_now_us() - sink.start_us), PEAK}};
+    rig.run(1 * MS);
+  }
+  return sink.samples;
+}
+
+std::vector<Sample> ema(const std::vector<Sample> &raw, double alpha) {
+  std::vector<Sample> out = raw;
+  for (size_t i = 1; i < out.size(); i++) {
+    out[i].mm = out[i - 1].mm + alpha * (raw[i].mm - out[i - 1].mm);
+  }
+  return out;
+}
+
+struct Filter {
+  const char *name;
+  std::function<void(VL53L3CXComponent &)> configure;
+};
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  if (argc > 1 && std::strcmp(argv[1], "-v") == 0) {
+    esphome::emu_log_level = esphome::ESPHOME_LOG_LEVEL_DEBUG;
+  }
+  // The first runs unfiltered, and the EMA is computed from its ranges
+  const Filter filters[] = {
+      {"none", [](VL53L3CXComponent &) {}},
+      {"MEDIAN, window 5", [](VL53L3CXComponent &hub) { hub.set_median_filter(0, 5); }},
+      {"ONE_EURO, 0.5 Hz, 0.5", [](VL53L3CXComponent &hub) { hub.set_one_euro_filter(0, 0.5f, 0.5f, 1.0f); }},
+      {"KALMAN, 30 mm/sqrt(s)", [](VL53L3CXComponent &hub) { hub.set_kalman_filter(0, 30.0f); }},
+  };
+  std::printf("%-26s %10s %10s %8s\n", "filter", "jitter", "lag", "jump");
+  int raw_jump_frames = -1;
+  for (const Filter &filter : filters) {
+    const bool unfiltered = &filter == &filters[0];
+    const int jump_frames = (int) isolated([&filter, unfiltered, raw_jump_frames]() -> uint64_t {
+      const std::vector<Sample> samples = run_scene(filter.configure);
+      const Metrics metrics = measure(samples);
+      print(filter.name, metrics);
+      if (unfiltered) {
+        print("EMA, alpha 0.1", measure(ema(samples, 0.1)));
+        print("EMA, alpha 0.3", measure(ema(samples, 0.3)));
+      } else {
+        check(metrics.jump_frames >= 0 && metrics.jump_frames <= raw_jump_frames, "on the new object with the raw ranges");
+      }
+      return metrics.jump_frames;
+    });
+    if (unfiltered) {
+      raw_jump_frames = jump_frames;
+    }
+  }
+  std::printf(check_failures ? "FAILED\n" : "all filters passed\n");
+  return check_failures != 0;
+}
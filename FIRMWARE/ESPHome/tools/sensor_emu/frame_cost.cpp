@@ -0,0 +1,83 @@
+// Host CPU time of one hub's frame path with and without its per-frame logs:
+// one emulated hub with two targets, and the host time of the main loop per
+// frame, which covers the driver's result read and processing, the hub's
+// frame path and the emulator. Built twice, with and without
+// VL53L3CX_FRAME_DEBUG, and measured with the logger filtering the lines and
+// with it writing them (to stderr, redirected to /dev/null).
+// Host time is real here, unlike the emulated sensor's virtual clock.
+
+#include <algorithm>
+#include <cstdio>
+#include <ctime>
+
+#include "rig.h"
+
+using namespace vl53l3cx_tools;
+
+namespace {
+
+constexpr uint64_t MS = 1000;
+constexpr uint32_t FRAMES = 1000;
+constexpr int RUNS = 20;
+
+// A distance sensor for each of the two targets, so the hub publishes them
+class Sink : public esphome::vl53l3cx::VL53L3CXSensorBase {
+ public:
+  void set_target_number(uint8_t target) override {}
+  void publish_distance_state(float distance_m) override { this->published++; }
+
+  uint32_t published{0};
+};
+
+uint64_t thread_ns() {
+  timespec ts;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return (uint64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+// Host µs per frame at `log_level`, best of RUNS
+double per_frame_us(int log_level) {
+  return (double) isolated([log_level]() -> uint64_t {
+           Rig rig(1);
+           Sink sinks[2];
+           rig.hub(0).register_distance_sensor(&sinks[0], 0);
+           rig.hub(0).register_distance_sensor(&sinks[1], 1);
+           rig.sensor(0).targets = {{300, 4000}, {1600, 4000}};
+           rig.setup();
+           rig.run(500 * MS);
+           esphome::emu_log_level = log_level;
+           uint64_t best_ns = UINT64_MAX;
+           for (int run = 0; run < RUNS; run++) {
+             const uint32_t frames = rig.frames[0];
+             const uint64_t start_ns = thread_ns();
+             while (rig.frames[0] - frames < FRAMES) {
+               rig.run(10 * MS);
+             }
+             best_ns = std::min(best_ns, (thread_ns() - start_ns) / (rig.frames[0] - frames));
+           }
+           return best_ns;
+         }) /
+         1e3;
+}
+
+}  // namespace
+
+int main() {
+#ifdef VL53L3CX_FRAME_DEBUG
+  const char *build = "frame_debug";
+#else
+  const char *build = "default";
+#endif
+  const struct {
+    const char *name;
+    int level;
+  } levels[] = {
+      {"logger at WARN", esphome::ESPHOME_LOG_LEVEL_WARN},
+      {"logger at DEBUG", esphome::ESPHOME_LOG_LEVEL_DEBUG},
+      {"logger at VERBOSE", esphome::ESPHOME_LOG_LEVEL_VERBOSE},
+  };
+  for (const auto &level : levels) {
+    std::printf("%-12s %-20s %8.1f us/frame\n", build, level.name, per_frame_us(level.level));
+  }
+  return check_failures != 0;
+}
@@ -0,0 +1,144 @@
+// VL53L3CXFusion over three emulated hubs on one bus: the nearest accepted
+// target wins, a hub whose frames stop drops out after the alignment window,
+// and targets outside the sigma or signal gate are ignored. Every scenario
+// runs in a child process, as the hub's driver state is static.
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+
+#include "rig.h"
+#include "vl53l3cx_fusion.h"
+
+using namespace vl53l3cx_tools;
+using esphome::vl53l3cx_fusion::VL53L3CXFusion;
+
+namespace {
+
+constexpr uint64_t MS = 1000;
+constexpr uint64_t S = 1000000;
+constexpr uint64_t SAMPLE_US = 1000;
+
+// A strong return (sigma about 2.5 mm, 8 to 11 MCPS) and a weak one (sigma
+// about 15 mm, 0.6 to 1.6 MCPS) in the emulated histogram
+constexpr double STRONG = 4000;
+constexpr double WEAK = 300;
+
+// Three hubs, each seeing one target, and a fusion over all of them
+struct Fused {
+  Rig rig{3};
+  VL53L3CXFusion fusion;
+  esphome::sensor::Sensor distance;
+  esphome::sensor::Sensor source;
+
+  Fused(const double (&ranges_mm)[3], const double (&peaks)[3]) {
+    for (size_t i = 0; i < 3; i++) {
+      this->rig.sensor(i).targets = {{ranges_mm[i], peaks[i]}};
+      this->fusion.add_source(&this->rig.hub(i));
+    }
+    this->fusion.set_distance_sensor(&this->distance);
+    this->fusion.set_source_sensor(&this->source);
+  }
+  void start() {
+    this->rig.setup();
+    this->fusion.setup();
+  }
+  bool near(double metres) const {
+    return this->distance.has_state() && std::fabs(this->distance.state - metres) < 0.02;
+  }
+  bool from(int source) const { return this->source.has_state() && this->source.state == source; }
+};
+
+void nearest_wins() {
+  Fused fused({1200, 600, 900}, {STRONG, STRONG, STRONG});
+  fused.start();
+  fused.rig.run(1 * S);
+  std::printf("    fused %.3f m from source %.0f\n", fused.distance.state, fused.source.state);
+  check(fused.near(0.6) && fused.from(1), "nearest of three sources");
+  fused.rig.sensor(1).targets = {{1500, STRONG}};
+  fused.rig.run(200 * MS);
+  check(fused.near(0.9) && fused.from(2), "next nearest once it moves away");
+  fused.rig.sensor(0).targets = {{300, STRONG}};
+  fused.rig.run(200 * MS);
+  check(fused.near(0.3) && fused.from(0), "a new nearest takes over");
+}
+
+// The nearest source's sensor wedges; the time until the next source takes
+// over is the window plus at most one frame of the others
+void stale_source(uint32_t window_us) {
+  Fused fused({600, 900, 1200}, {STRONG, STRONG, STRONG});
+  fused.fusion.set_alignment_window_us(window_us);
+  fused.start();
+  fused.rig.run(1 * S);
+  check(fused.from(0), "nearest source before the stall");
+  const uint32_t frames = fused.rig.frames[0];
+  const uint64_t stall_us = emu_now_us();
+  fused.rig.sensor(0).faults.stall_from_us = stall_us;
+  uint64_t switched_us = 0;
+  while (switched_us == 0 && emu_now_us() < stall_us + window_us + 1 * S) {
+    fused.rig.run(SAMPLE_US);
+    if (fused.from(1)) {
+      switched_us = emu_now_us() - stall_us;
+    }
+  }
+  // The stalled hub's last frame can be up to one frame period old at the stall
+  const uint64_t frame_us = fused.rig.sensor(0).frame_us;
+  std::printf("    window %.0f ms: source 2 after %.1f ms\n", window_us / 1e3, switched_us / 1e3);
+  check(fused.rig.frames[0] <= frames + 1, "stalled hub delivers no more frames");
+  check(switched_us + frame_us >= window_us, "stale source kept for the alignment window");
+  check(switched_us > 0 && switched_us <= window_us + 2 * frame_us, "dropped within two frames after it");
+  check(fused.near(0.9), "next nearest published");
+}
+
+// A weak near target against strong far ones; `source` is the one that should win
+void gate(float max_sigma_mm, float min_signal_mcps, int source, const char *what) {
+  Fused fused({500, 1000, 1500}, {WEAK, STRONG, STRONG});
+  fused.fusion.set_max_sigma_mm(max_sigma_mm);
+  fused.fusion.set_min_signal_rate_mcps(min_signal_mcps);
+  fused.start();
+  fused.rig.run(1 * S);
+  // The weak target's sigma and rate differ between the two timings; sample many frames
+  uint32_t hits = 0, samples = 0;
+  for (int k = 0; k < 100; k++) {
+    fused.rig.run(10 * MS);
+    samples++;
+    hits += fused.from(source);
+  }
+  std::printf("    sigma <= %.0f mm, signal >= %.1f MCPS: source %d in %u of %u samples\n", max_sigma_mm,
+              min_signal_mcps, source + 1, hits, samples);
+  check(hits == samples, what);
+}
+
+struct Scenario {
+  const char *name;
+  std::function<void()> run;
+};
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  if (argc > 1 && std::strcmp(argv[1], "-v") == 0) {
+    esphome::emu_log_level = esphome::ESPHOME_LOG_LEVEL_DEBUG;
+  }
+  const Scenario scenarios[] = {
+      {"nearest source wins", nearest_wins},
+      {"stale source, 250 ms window", [] { stale_source(250000); }},
+      {"stale source, 1 s window", [] { stale_source(1000000); }},
+      {"gates open", [] { gate(30.0f, 0.1f, 0, "weak near target accepted"); }},
+      {"signal gate at 2 MCPS", [] { gate(30.0f, 2.0f, 1, "weak near target rejected, next nearest wins"); }},
+      {"sigma gate at 8 mm", [] { gate(8.0f, 0.1f, 1, "weak near target rejected, next nearest wins"); }},
+  };
+  int failed = 0;
+  for (const Scenario &scenario : scenarios) {
+    std::printf("%s\n", scenario.name);
+    const int before = check_failures;
+    isolated([&scenario]() -> uint64_t {
+      scenario.run();
+      return 0;
+    });
+    failed += check_failures != before;
+  }
+  std::printf(failed ? "%d scenario(s) FAILED\n" : "all scenarios passed\n", failed);
+  return failed != 0;
+}
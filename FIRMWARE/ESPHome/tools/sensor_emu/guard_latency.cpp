@@ -0,0 +1,167 @@
+// Decision latency of the proximity guard on one emulated hub: the scene
+// steps from far to near, or back, and the time until the near or far
+// action fires is split into the wait for the first frame that shows the
+// step, the grace or hold time, and the guard's own latency after that.
+// Every scenario runs in a child process, as the hub's driver state is static.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <vector>
+
+#include "proximity_guard.h"
+#include "rig.h"
+
+using namespace vl53l3cx_tools;
+using esphome::proximity_guard::ProximityGuard;
+
+namespace {
+
+constexpr uint64_t MS = 1000;
+constexpr uint64_t S = 1000000;
+
+constexpr double NEAR_MM = 500;
+constexpr double FAR_MM = 1500;
+// The main loop runs every 250 µs; a decision after its deadline should take one iteration
+constexpr uint32_t MAX_DECISION_LATENCY_US = 1000;
+
+// One hub with the guard on it (close 0.8 m, far 1.0 m), recording when things happen
+struct Guarded {
+  Rig rig{1};
+  ProximityGuard guard;
+  uint64_t near_us{0};
+  uint64_t far_us{0};
+  // Data-ready time of each frame, when the hub had read it, and its valid range (-1 if none)
+  std::vector<uint64_t> frame_us;
+  std::vector<uint64_t> read_us;
+  std::vector<int16_t> frame_mm;
+
+  Guarded(uint32_t grace_ms, uint32_t hold_ms, double start_mm) {
+    this->rig.sensor(0).targets = {{start_mm, 4000}};
+    this->guard.set_hub(&this->rig.hub(0));
+    this->guard.set_close_grace_ms(grace_ms);
+    this->guard.set_far_hold_ms(hold_ms);
+    this->guard.add_on_near_callback([this] { this->near_us = emu_now_us(); });
+    this->guard.add_on_far_callback([this] { this->far_us = emu_now_us(); });
+    this->rig.hub(0).add_on_frame_callback([this](const esphome::vl53l3cx::Frame &frame) {
+      // What the guard sees: the first target only with a valid status
+      const bool valid = frame.num_targets > 0 && frame.targets[0].range_status == VL53LX_RANGESTATUS_RANGE_VALID;
+      this->frame_us.push_back(frame.timestamp_us);
+      this->read_us.push_back(emu_now_us());
+      this->frame_mm.push_back(valid ? frame.targets[0].range_mm : -1);
+    });
+    this->rig.setup();
+    this->guard.setup();
+  }
+  void run(uint64_t duration_us) { this->rig.run(duration_us, &this->guard); }
+  // Index of the first frame after `step_us` that `shows` the new scene, or -1
+  int first_frame(uint64_t step_us, const std::function<bool(int16_t)> &shows) const {
+    for (size_t i = 0; i < this->frame_us.size(); i++) {
+      if (this->frame_us[i] >= step_us && shows(this->frame_mm[i])) {
+        return (int) i;
+      }
+    }
+    return -1;
+  }
+};
+
+bool is_near(int16_t mm) { return mm > 0 && mm < 800; }
+bool is_far(int16_t mm) { return mm < 0 || mm > 1000; }
+
+// `decided_us` after the step at `step_us`, where frame `i` first showed it. The
+// guard decides in loop() once the wait ran out, or on the frame itself once the
+// hub has read it (the frame timestamp is its data-ready time).
+void report(Guarded &g, uint64_t step_us, int i, uint64_t decided_us, uint64_t wait_us) {
+  check(i >= 0, "step seen");
+  if (i < 0) {
+    return;
+  }
+  const uint64_t frame_us = g.frame_us[i];
+  const uint64_t read_us = g.read_us[i];
+  const uint32_t latency_us = g.guard.get_last_decision_latency_us();
+  std::printf("    first frame %.1f ms after the step, read %.1f ms later; action %.1f ms after the step "
+              "(wait %.0f ms, latency %u us)\n",
+              (frame_us - step_us) / 1e3, (read_us - frame_us) / 1e3, (decided_us - step_us) / 1e3, wait_us / 1e3,
+              latency_us);
+  // The step can fall just after a range started; that range still shows the
+  // old scene or fails the driver's checks, so allow two frame periods
+  const uint64_t frame_budget_us = 2 * g.rig.sensor(0).frame_us + g.rig.hub(0).get_update_interval() * MS;
+  const uint64_t deadline_us = std::max(frame_us + wait_us, read_us);
+  check(frame_us - step_us <= frame_budget_us, "step seen within two frames and one poll");
+  check(decided_us >= frame_us + wait_us, "action not before the grace or hold time ran out");
+  check(decided_us <= deadline_us + MAX_DECISION_LATENCY_US, "action within 1 ms of its deadline or of the read");
+  check(latency_us <= deadline_us - (frame_us + wait_us) + MAX_DECISION_LATENCY_US,
+        "reported decision latency matches");
+}
+
+void near_step(uint32_t grace_ms) {
+  Guarded g(grace_ms, 2000, FAR_MM);
+  g.run(1 * S);
+  const uint64_t step_us = emu_now_us();
+  g.rig.sensor(0).targets = {{NEAR_MM, 4000}};
+  g.run(grace_ms * MS + 500 * MS);
+  check(g.near_us > 0 && g.guard.is_active(), "near action fired, protection active");
+  report(g, step_us, g.first_frame(step_us, is_near), g.near_us, grace_ms * MS);
+}
+
+// `leave` changes the scene once the guard is active
+void far_step(uint32_t hold_ms, const std::function<void(EmuSensor &)> &leave) {
+  Guarded g(0, hold_ms, NEAR_MM);
+  g.run(1 * S);
+  check(g.guard.is_active(), "active before the step");
+  const uint64_t step_us = emu_now_us();
+  leave(g.rig.sensor(0));
+  g.run(hold_ms * MS + 500 * MS);
+  check(g.far_us > 0 && !g.guard.is_active(), "far action fired, protection released");
+  report(g, step_us, g.first_frame(step_us, is_far), g.far_us, hold_ms * MS);
+}
+
+// The sensor wedges right after the first near frame; the grace time must still run out on time
+void wedged_after_step() {
+  Guarded g(2000, 2000, FAR_MM);
+  g.run(1 * S);
+  const uint64_t step_us = emu_now_us();
+  g.rig.sensor(0).targets = {{NEAR_MM, 4000}};
+  while (g.first_frame(step_us, is_near) < 0) {
+    g.run(250);
+  }
+  g.rig.sensor(0).faults.stall_from_us = emu_now_us();
+  const size_t frames = g.frame_us.size();
+  g.run(2500 * MS);
+  check(g.frame_us.size() == frames, "no frame after the stall");
+  check(g.near_us > 0, "near action fired without another frame");
+  report(g, step_us, g.first_frame(step_us, is_near), g.near_us, 2000 * MS);
+}
+
+struct Scenario {
+  const char *name;
+  std::function<void()> run;
+};
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  if (argc > 1 && std::strcmp(argv[1], "-v") == 0) {
+    esphome::emu_log_level = esphome::ESPHOME_LOG_LEVEL_DEBUG;
+  }
+  const Scenario scenarios[] = {
+      {"1.5 m -> 0.5 m, 2 s grace", [] { near_step(2000); }},
+      {"1.5 m -> 0.5 m, no grace", [] { near_step(0); }},
+      {"0.5 m -> 1.5 m, 2 s hold", [] { far_step(2000, [](EmuSensor &s) { s.targets = {{FAR_MM, 4000}}; }); }},
+      {"0.5 m -> empty, 2 s hold", [] { far_step(2000, [](EmuSensor &s) { s.targets = {}; }); }},
+      {"1.5 m -> 0.5 m, sensor wedges after one frame", wedged_after_step},
+  };
+  int failed = 0;
+  for (const Scenario &scenario : scenarios) {
+    std::printf("%s\n", scenario.name);
+    const int before = check_failures;
+    isolated([&scenario]() -> uint64_t {
+      scenario.run();
+      return 0;
+    });
+    failed += check_failures != before;
+  }
+  std::printf(failed ? "%d scenario(s) FAILED\n" : "all scenarios passed\n", failed);
+  return failed != 0;
+}
@@ -0,0 +1,147 @@
+// Predictive mode of the proximity guard on one emulated hub, over walked
+// trajectories: steady approaches that cross the close threshold, and
+// approaches that brake and stop short of it. Each trajectory is run from ten
+// start times spread over a frame period, with shot noise in the histograms.
+// The reaction time is when the near action fires, from the moment the target
+// crosses the close threshold; negative is early. Any near action on an
+// approach that stops short is a false trigger. Every run is a child process,
+// as the hub's driver state is static.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "proximity_guard.h"
+#include "rig.h"
+
+using namespace vl53l3cx_tools;
+using esphome::proximity_guard::ProximityGuard;
+
+namespace {
+
+constexpr uint64_t MS = 1000;
+constexpr uint64_t S = 1000000;
+constexpr int RUNS = 10;
+
+constexpr double PEAK = 1500;
+constexpr double CLOSE_MM = 800;
+constexpr double START_MM = 1700;
+
+// From START_MM at `speed` (m/s), braking at a constant rate over the last
+// `braking_mm` to stop at `stop_mm`. A braking distance of 0 walks on at
+// constant speed.
+struct Trajectory {
+  const char *name;
+  double speed;
+  double stop_mm;
+  double braking_mm;
+
+  double range_mm(double t_s) const {
+    const double v = this->speed * 1000;
+    const double cruise_s = (START_MM - this->stop_mm - this->braking_mm) / v;
+    if (t_s < cruise_s || this->braking_mm <= 0) {
+      return START_MM - v * t_s;
+    }
+    const double a = v * v / (2 * this->braking_mm);
+    const double t = std::min(t_s - cruise_s, v / a);
+    return this->stop_mm + this->braking_mm - (v * t - a * t * t / 2);
+  }
+  // When the trajectory passes the close threshold
+  double crossing_s() const {
+    double lo = 0, hi = 60;
+    for (int k = 0; k < 60; k++) {
+      const double mid = (lo + hi) / 2;
+      (this->range_mm(mid) < CLOSE_MM ? hi : lo) = mid;
+    }
+    return hi;
+  }
+};
+
+// Returns when the near action fired in µs from the start of the walk plus 1, or 0 if it did not
+uint64_t walk(const Trajectory &trajectory, uint64_t offset_us) {
+  Rig rig(1);
+  ProximityGuard guard;
+  rig.sensor(0).shot_noise = true;
+  rig.sensor(0).targets = {{START_MM, PEAK}};
+  guard.set_hub(&rig.hub(0));
+  guard.set_close_threshold(CLOSE_MM / 1000);
+  guard.set_far_threshold(1.0f);
+  guard.set_close_grace_ms(2000);
+  guard.set_predictive(400, 0.25f, 3);
+  uint64_t near_us = 0;
+  guard.add_on_near_callback([&near_us] { near_us = emu_now_us(); });
+  rig.setup();
+  guard.setup();
+  rig.run(1 * S + offset_us, &guard);
+  const uint64_t start_us = emu_now_us();
+  // Walk, and stand at the end of it, for 10 s at most
+  while (near_us == 0 && emu_now_us() - start_us < 10 * S) {
+    rig.sensor(0).targets = {{trajectory.range_mm((emu_now_us() - start_us) / 1e6), PEAK}};
+    rig.run(1 * MS, &guard);
+  }
+  return near_us == 0 ? 0 : near_us - start_us + 1;
+}
+
+struct Outcome {
+  int fired{0};
+  int early{0};  // Fired before the crossing
+  double min_ms{1e9}, max_ms{-1e9}, sum_ms{0};
+};
+
+Outcome run(const Trajectory &trajectory) {
+  Outcome outcome;
+  const double crossing_ms = trajectory.crossing_s() * 1000;
+  for (int k = 0; k < RUNS; k++) {
+    // Spread over one frame period, about 44 ms
+    const uint64_t fired_us = isolated([&trajectory, k] { return walk(trajectory, k * 4400); });
+    if (fired_us == 0) {
+      continue;
+    }
+    outcome.fired++;
+    const double reaction_ms = (fired_us - 1) / 1e3 - crossing_ms;
+    outcome.early += reaction_ms < 0;
+    outcome.min_ms = std::min(outcome.min_ms, reaction_ms);
+    outcome.max_ms = std::max(outcome.max_ms, reaction_ms);
+    outcome.sum_ms += reaction_ms;
+  }
+  return outcome;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+  if (argc > 1 && std::strcmp(argv[1], "-v") == 0) {
+    esphome::emu_log_level = esphome::ESPHOME_LOG_LEVEL_DEBUG;
+  }
+  const Trajectory crossing[] = {
+      {"0.3 m/s to 0.4 m", 0.3, 400, 0},
+      {"0.5 m/s to 0.4 m", 0.5, 400, 0},
+      {"1.0 m/s to 0.4 m", 1.0, 400, 0},
+      {"1.5 m/s to 0.4 m", 1.5, 400, 0},
+      {"1.0 m/s, brakes over 0.3 m to 0.7 m", 1.0, 700, 300},
+  };
+  const Trajectory stopping[] = {
+      {"0.5 m/s, brakes over 0.2 m to 0.9 m", 0.5, 900, 200},
+      {"1.0 m/s, brakes over 0.3 m to 0.9 m", 1.0, 900, 300},
+      {"1.0 m/s, brakes over 0.5 m to 0.9 m", 1.0, 900, 500},
+      {"1.5 m/s, brakes over 0.5 m to 0.9 m", 1.5, 900, 500},
+      {"1.0 m/s, brakes over 0.3 m to 1.1 m", 1.0, 1100, 300},
+  };
+  std::printf("%-38s %6s %6s %26s\n", "crossing", "fired", "early", "reaction min/mean/max");
+  for (const Trajectory &trajectory : crossing) {
+    const Outcome o = run(trajectory);
+    std::printf("%-38s %3d/%d %3d/%d %8.0f %7.0f %7.0f ms\n", trajectory.name, o.fired, RUNS, o.early, RUNS, o.min_ms,
+                o.fired ? o.sum_ms / o.fired : 0.0, o.max_ms);
+    check(o.fired == RUNS && o.max_ms < 200, "every approach fired within 200 ms of the crossing");
+  }
+  std::printf("%-38s %6s\n", "stopping short", "false");
+  for (const Trajectory &trajectory : stopping) {
+    const Outcome o = run(trajectory);
+    std::printf("%-38s %3d/%d\n", trajectory.name, o.fired, RUNS);
+    check(o.fired == 0, "no false trigger");
+  }
+  std::printf(check_failures ? "FAILED\n" : "all trajectories passed\n");
+  return check_failures != 0;
+}
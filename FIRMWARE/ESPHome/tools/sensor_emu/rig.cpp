@@ -0,0 +1,91 @@
+#include "rig.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace vl53l3cx_tools {
+
+// Main loop step; the scheduler asks for sub-millisecond loop resolution
+static constexpr uint64_t LOOP_STEP_NS = 250000;
+
+Rig::Rig(size_t count, uint8_t first_address) : frames(count, 0), next_update_us(count, 0) {
+  for (size_t i = 0; i < count; i++) {
+    this->sensors.push_back(std::make_unique<EmuSensor>("sensor " + std::to_string(i + 1)));
+    this->pins.push_back(std::make_unique<EmuPin>(this->sensors.back().get()));
+    this->bus.add(this->sensors.back().get());
+
+    auto hub = std::make_unique<VL53L3CXComponent>();
+    hub->set_i2c_bus(&this->bus);
+    hub->set_i2c_address(first_address + i);
+    hub->set_xshut_pin(this->pins.back().get());
+    hub->set_update_interval(33);
+    hub->set_timing_budget(33000);
+    hub->set_recovery_backoff(1000, 300000);
+    hub->add_on_frame_callback([this, i](const esphome::vl53l3cx::Frame &) { this->frames[i]++; });
+    this->hubs.push_back(std::move(hub));
+  }
+}
+
+uint64_t Rig::setup() {
+  const uint64_t start_us = emu_now_us();
+  for (auto &hub : this->hubs) {
+    hub->setup();
+  }
+  return emu_now_us() - start_us;
+}
+
+void Rig::run(uint64_t duration_us, esphome::Component *extra) {
+  const uint64_t end_us = emu_now_us() + duration_us;
+  while (emu_now_us() < end_us) {
+    for (size_t i = 0; i < this->hubs.size(); i++) {
+      VL53L3CXComponent &hub = *this->hubs[i];
+      if (hub.is_failed() || emu_now_us() < this->next_update_us[i]) {
+        continue;
+      }
+      hub.update();
+      this->next_update_us[i] = emu_now_us() + hub.get_update_interval() * 1000ull;
+    }
+    if (extra != nullptr) {
+      extra->loop();
+    }
+    emu_advance_ns(LOOP_STEP_NS);
+  }
+}
+
+int check_failures = 0;
+
+void check(bool ok, const char *what) {
+  std::printf("    %-58s %s\n", what, ok ? "ok" : "FAILED");
+  check_failures += !ok;
+}
+
+uint64_t isolated(const std::function<uint64_t()> &fn) {
+  int fds[2];
+  if (pipe(fds) != 0) {
+    std::perror("pipe");
+    std::exit(2);
+  }
+  std::fflush(stdout);
+  const pid_t pid = fork();
+  if (pid == 0) {
+    check_failures = 0;  // Only this scenario's
+    const uint64_t result = fn();
+    std::fflush(stdout);
+    _exit(write(fds[1], &result, sizeof(result)) != sizeof(result) || check_failures != 0);
+  }
+  close(fds[1]);
+  uint64_t result = 0;
+  if (read(fds[0], &result, sizeof(result)) != sizeof(result)) {
+    result = 0;
+  }
+  close(fds[0]);
+  int status = 0;
+  waitpid(pid, &status, 0);
+  check_failures += !WIFEXITED(status) || WEXITSTATUS(status) != 0;
+  return result;
+}
+
+}  // namespace vl53l3cx_tools
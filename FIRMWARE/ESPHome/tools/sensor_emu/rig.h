@@ -0,0 +1,46 @@
+#pragma once
+
+// A bus of emulated sensors, each with a hub component on its XSHUT line,
+// and a main loop on the virtual clock.
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "emu.h"
+#include "vl53l3cx.h"
+
+namespace vl53l3cx_tools {
+
+using esphome::vl53l3cx::VL53L3CXComponent;
+
+struct Rig {
+  // Sensors at addresses first_address, first_address + 1, ...
+  explicit Rig(size_t count, uint8_t first_address = 0x30);
+
+  // setup() of every hub in order, as App.setup() does. Returns the virtual time it took.
+  uint64_t setup();
+  // update() of each hub at its update interval and loop() of `extra`, for `duration_us`.
+  // Successive calls continue the same schedule.
+  void run(uint64_t duration_us, esphome::Component *extra = nullptr);
+
+  EmuSensor &sensor(size_t i) { return *this->sensors[i]; }
+  VL53L3CXComponent &hub(size_t i) { return *this->hubs[i]; }
+
+  EmuBus bus;
+  std::vector<std::unique_ptr<EmuSensor>> sensors;
+  std::vector<std::unique_ptr<EmuPin>> pins;
+  std::vector<std::unique_ptr<VL53L3CXComponent>> hubs;
+  std::vector<uint32_t> frames;  // Frames each hub delivered
+  std::vector<uint64_t> next_update_us;
+};
+
+// Checks of the test programs. A failed one counts in check_failures.
+extern int check_failures;
+void check(bool ok, const char *what);
+// Runs `fn` in a child process and returns its result; failed checks in the child count here.
+// The hub's XSHUT group and the driver's caches are static, so every scenario needs a fresh process.
+uint64_t isolated(const std::function<uint64_t()> &fn);
+
+}  // namespace vl53l3cx_tools